@@ -0,0 +1,356 @@
+/****************************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/// @file pcm_kernel_bench_main.c
+
+#include <tinyara/config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <media/pcm_kernels.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BENCH_FRAMES	256
+#define BENCH_LOOPS	100
+#define BENCH_MAXCH	6
+#define BENCH_NTAPS	20
+
+/* Cycle counters can only be read in privileged mode */
+
+#if !defined(CONFIG_BUILD_PROTECTED) && !defined(CONFIG_BUILD_KERNEL)
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+#define BENCH_DWT
+#elif defined(__ARM_ARCH_7R__) || defined(__ARM_ARCH_7A__)
+#define BENCH_PMU
+#endif
+#endif
+
+#ifdef BENCH_DWT
+#define DWT_CTRL	(*(volatile uint32_t *)0xe0001000)
+#define DWT_CYCCNT	(*(volatile uint32_t *)0xe0001004)
+#define DEMCR		(*(volatile uint32_t *)0xe000edfc)
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_s {
+	const char *name;
+	void (*kernel)(int16_t *out);	/* Run the PCM kernel on BENCH_FRAMES frames */
+	void (*scalar)(int16_t *out);	/* Same result with a plain scalar loop */
+	size_t outsize;					/* Bytes of output to compare */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int16_t g_in[BENCH_MAXCH * BENCH_FRAMES];
+static int32_t g_out[BENCH_FRAMES * 2];
+static int32_t g_ref[BENCH_FRAMES * 2];
+
+/* Integer parts of the 44.1kHz -> 22.05kHz filter used by the resampler */
+
+static const int16_t g_taps[BENCH_NTAPS] = {
+	31, 44, -89, -160, 290, 466, -771, -1244, 2327, 7301,
+	7301, 2327, -1244, -771, 466, 290, -160, -89, 44, 31
+};
+
+/* 16.16 step of a 48kHz -> 44.1kHz conversion */
+
+static const uint32_t g_step = (uint32_t)(((uint64_t)48000 << 16) / 44100);
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int16_t sat16(int32_t x)
+{
+	return x < INT16_MIN ? INT16_MIN : (x > INT16_MAX ? INT16_MAX : x);
+}
+
+static void bench_start_counter(void)
+{
+#if defined(BENCH_DWT)
+	DEMCR |= (1 << 24);
+	DWT_CYCCNT = 0;
+	DWT_CTRL |= 1;
+#elif defined(BENCH_PMU)
+	uint32_t val;
+	__asm__ volatile("mrc p15, 0, %0, c9, c12, 0" : "=r"(val));
+	__asm__ volatile("mcr p15, 0, %0, c9, c12, 0" : : "r"(val | 0x1));
+	__asm__ volatile("mcr p15, 0, %0, c9, c12, 1" : : "r"(0x80000000));
+#endif
+}
+
+/* Return the current time in cycles, or in ns without a cycle counter */
+
+static uint64_t bench_now(void)
+{
+#if defined(BENCH_DWT)
+	return DWT_CYCCNT;
+#elif defined(BENCH_PMU)
+	uint32_t val;
+	__asm__ volatile("mrc p15, 0, %0, c9, c13, 0" : "=r"(val));
+	return val;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+/* Run 'func' BENCH_LOOPS times, return the cost per frame in 1/100 units */
+
+static uint32_t bench_measure(void (*func)(int16_t *out), int16_t *out)
+{
+	uint64_t start;
+	uint64_t elapsed;
+	int i;
+
+	func(out);	/* Warm up the caches */
+
+	start = bench_now();
+	for (i = 0; i < BENCH_LOOPS; i++) {
+		func(out);
+	}
+	elapsed = (uint32_t)(bench_now() - start);
+
+	return (uint32_t)(elapsed * 100 / ((uint64_t)BENCH_LOOPS * BENCH_FRAMES));
+}
+
+/* Channel remix */
+
+static void k_mono_to_stereo(int16_t *out)
+{
+	pcm_mono_to_stereo(g_in, out, BENCH_FRAMES);
+}
+
+static void s_mono_to_stereo(int16_t *out)
+{
+	int n;
+	for (n = 0; n < BENCH_FRAMES; n++) {
+		out[2 * n] = g_in[n];
+		out[2 * n + 1] = g_in[n];
+	}
+}
+
+static void k_stereo_to_mono(int16_t *out)
+{
+	pcm_stereo_to_mono(g_in, out, BENCH_FRAMES);
+}
+
+static void s_stereo_to_mono(int16_t *out)
+{
+	int n;
+	for (n = 0; n < BENCH_FRAMES; n++) {
+		out[n] = ((int32_t)g_in[2 * n] + g_in[2 * n + 1]) >> 1;
+	}
+}
+
+static void k_mix_center(int16_t *out)
+{
+	pcm_mix_center(g_in, 3, out, BENCH_FRAMES);
+}
+
+static void s_mix_center(int16_t *out)
+{
+	int n;
+	for (n = 0; n < BENCH_FRAMES; n++) {
+		out[2 * n] = sat16(g_in[3 * n] + g_in[3 * n + 2] / 2);
+		out[2 * n + 1] = sat16(g_in[3 * n + 1] + g_in[3 * n + 2] / 2);
+	}
+}
+
+static void k_mix_quad(int16_t *out)
+{
+	pcm_mix_quad(g_in, out, BENCH_FRAMES);
+}
+
+static void s_mix_quad(int16_t *out)
+{
+	int n;
+	for (n = 0; n < BENCH_FRAMES; n++) {
+		out[2 * n] = ((int32_t)g_in[4 * n] + g_in[4 * n + 2]) >> 1;
+		out[2 * n + 1] = ((int32_t)g_in[4 * n + 1] + g_in[4 * n + 3]) >> 1;
+	}
+}
+
+static void k_mix_surround(int16_t *out)
+{
+	pcm_mix_surround(g_in, 6, 4, out, BENCH_FRAMES);
+}
+
+static void s_mix_surround(int16_t *out)
+{
+	int n;
+	for (n = 0; n < BENCH_FRAMES; n++) {
+		const int16_t *in = &g_in[6 * n];
+		out[2 * n] = sat16(in[0] + ((int32_t)in[2] + in[4]) * 7071 / 10000);
+		out[2 * n + 1] = sat16(in[1] + ((int32_t)in[2] + in[5]) * 7071 / 10000);
+	}
+}
+
+/* Gain and format conversion, on stereo frames */
+
+static void k_gain(int16_t *out)
+{
+	pcm_gain(g_in, out, 2 * BENCH_FRAMES, PCM_GAIN_UNITY * 3 / 2);
+}
+
+static void s_gain(int16_t *out)
+{
+	int n;
+	for (n = 0; n < 2 * BENCH_FRAMES; n++) {
+		out[n] = sat16(((int32_t)g_in[n] * (PCM_GAIN_UNITY * 3 / 2)) >> 12);
+	}
+}
+
+static void k_s16_to_s32(int16_t *out)
+{
+	pcm_s16_to_s32(g_in, (int32_t *)out, 2 * BENCH_FRAMES);
+}
+
+static void s_s16_to_s32(int16_t *out)
+{
+	int n;
+	for (n = 0; n < 2 * BENCH_FRAMES; n++) {
+		((int32_t *)out)[n] = (int32_t)g_in[n] << 16;
+	}
+}
+
+static void k_s32_to_s16(int16_t *out)
+{
+	pcm_s32_to_s16((const int32_t *)g_in, out, BENCH_FRAMES);
+}
+
+static void s_s32_to_s16(int16_t *out)
+{
+	const int32_t *in = (const int32_t *)g_in;
+	int n;
+	for (n = 0; n < BENCH_FRAMES; n++) {
+		out[n] = sat16((int32_t)(((int64_t)in[n] + 0x8000) >> 16));
+	}
+}
+
+/* Resampling */
+
+static void k_fir_stereo(int16_t *out)
+{
+	int n;
+	for (n = 0; n < 2 * BENCH_FRAMES; n++) {
+		out[n] = (pcm_fir(&g_in[n], g_taps, BENCH_NTAPS, 2) + (1 << 13)) >> 14;
+	}
+}
+
+static void s_fir_stereo(int16_t *out)
+{
+	int n;
+	int i;
+	for (n = 0; n < 2 * BENCH_FRAMES; n++) {
+		int32_t sum = 1 << 13;
+		for (i = 0; i < BENCH_NTAPS; i++) {
+			sum += g_in[n + 2 * i] * g_taps[i];
+		}
+		out[n] = sum >> 14;
+	}
+}
+
+static void k_interpolate(int16_t *out)
+{
+	(void)pcm_interpolate(g_in, 2, out, BENCH_FRAMES, 0, g_step);
+}
+
+static void s_interpolate(int16_t *out)
+{
+	uint32_t index = 0;
+	int n;
+	int j;
+	for (n = 0; n < BENCH_FRAMES; n++, index += g_step) {
+		const int16_t *in = &g_in[(index >> 16) * 2];
+		int32_t frac = (index & 0xffff) >> 1;
+		for (j = 0; j < 2; j++) {
+			*out++ = in[j] + (((in[j + 2] - in[j]) * frac) >> 15);
+		}
+	}
+}
+
+static const struct bench_s g_bench[] = {
+	{"mono_to_stereo", k_mono_to_stereo, s_mono_to_stereo, 4 * BENCH_FRAMES},
+	{"stereo_to_mono", k_stereo_to_mono, s_stereo_to_mono, 2 * BENCH_FRAMES},
+	{"mix_center", k_mix_center, s_mix_center, 4 * BENCH_FRAMES},
+	{"mix_quad", k_mix_quad, s_mix_quad, 4 * BENCH_FRAMES},
+	{"mix_surround", k_mix_surround, s_mix_surround, 4 * BENCH_FRAMES},
+	{"gain", k_gain, s_gain, 4 * BENCH_FRAMES},
+	{"s16_to_s32", k_s16_to_s32, s_s16_to_s32, 8 * BENCH_FRAMES},
+	{"s32_to_s16", k_s32_to_s16, s_s32_to_s16, 2 * BENCH_FRAMES},
+	{"fir_stereo", k_fir_stereo, s_fir_stereo, 4 * BENCH_FRAMES},
+	{"interpolate", k_interpolate, s_interpolate, 4 * BENCH_FRAMES},
+};
+
+/****************************************************************************
+ * pcm_kernel_bench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int pcm_kernel_bench_main(int argc, char *argv[])
+#endif
+{
+	const struct bench_s *b;
+	uint32_t kcost;
+	uint32_t scost;
+	int fail = 0;
+	int i;
+
+	srand(1);
+	for (i = 0; i < BENCH_MAXCH * BENCH_FRAMES; i++) {
+		g_in[i] = (int16_t)(rand() & 0xffff);
+	}
+
+	bench_start_counter();
+
+#if defined(BENCH_DWT) || defined(BENCH_PMU)
+	printf("%-16s %14s %14s\n", "kernel", "cycles/frame", "scalar");
+#else
+	printf("%-16s %14s %14s\n", "kernel", "ns/frame", "scalar");
+#endif
+
+	for (i = 0; i < sizeof(g_bench) / sizeof(g_bench[0]); i++) {
+		b = &g_bench[i];
+
+		kcost = bench_measure(b->kernel, (int16_t *)g_out);
+		scost = bench_measure(b->scalar, (int16_t *)g_ref);
+
+		printf("%-16s %11u.%02u %11u.%02u", b->name, kcost / 100, kcost % 100, scost / 100, scost % 100);
+		if (memcmp(g_out, g_ref, b->outsize) != 0) {
+			printf("  MISMATCH");
+			fail++;
+		}
+		printf("\n");
+	}
+
+	return fail ? -1 : 0;
+}
@@ -43,6 +43,8 @@ static const struct tag_list ttrace_tags[] = {
 	{"lock",    "Lock",          TTRACE_TAG_LOCK},
 	{"task",    "TASK",          TTRACE_TAG_TASK},
 	{"ipc",     "IPC",           TTRACE_TAG_IPC},
+	{"irq",     "IRQ",           TTRACE_TAG_IRQ},
+	{"sys",     "Syscall",       TTRACE_TAG_SYSCALL},
 };
 
 int param = 0;
@@ -52,6 +54,7 @@ int is_overwritable = 0;
 static void show_help(void);
 void wait_ttrace_dump(void);
 
+#ifndef CONFIG_TTRACE_BINARY
 static int print_uid_packet(struct trace_packet *packet)
 {
 	int8_t uid = packet->codelen & ~TTRACE_CODE_UNIQUE;
@@ -101,6 +104,27 @@ static int print_packet(struct trace_packet *packet)
 		return print_message_packet(packet);
 	}
 }
+#else
+/* The binary dump is printed as lines of hexadecimal bytes prefixed with
+ * "TTRB:" and their offset, which tools/ttrace_parser/ttrace_binary.py
+ * picks from a console log.
+ */
+
+static void print_binary_dump(const unsigned char *buffer, int len)
+{
+	int offset;
+	int i;
+
+	for (offset = 0; offset < len; offset += 32) {
+		printf("TTRB:%06x ", offset);
+		for (i = offset; i < len && i < offset + 32; i++) {
+			printf("%02x", buffer[i]);
+		}
+		printf("\r\n");
+	}
+	printf("TTRB:end %06x\r\n", len);
+}
+#endif
 
 static void show_help()
 {
@@ -235,7 +259,9 @@ static int read_tracebuffer(FILE *file, int bufsize)
 {
 	char *buffer = NULL;
 	int read_len = 0;
+#ifndef CONFIG_TTRACE_BINARY
 	int offset = 0;
+#endif
 
 	buffer = alloc_tracebuffer(bufsize);
 	if (buffer == NULL) {
@@ -247,9 +273,13 @@ static int read_tracebuffer(FILE *file, int bufsize)
 		return TTRACE_INVALID;
 	}
 
+#ifdef CONFIG_TTRACE_BINARY
+	print_binary_dump((const unsigned char *)buffer, read_len);
+#else
 	while (offset < read_len) {
 		offset += print_packet((struct trace_packet *)(buffer + offset));
 	}
+#endif
 
 	free_tracebuffer(buffer);
 	return TTRACE_VALID;
@@ -0,0 +1,155 @@
+/* ****************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @ingroup MEDIA
+ * @{
+ */
+
+/**
+ * @file media/pcm_kernels.h
+ * @brief Sample processing kernels for 16 bits PCM
+ * @details The kernels use ARM NEON or ARMv6/v7 SIMD32 (DSP) instructions
+ *          when the compiler targets them and portable C otherwise. Some
+ *          have a NEON path only, and pcm_mix_surround() and
+ *          pcm_interpolate() are portable C only. All
+ *          paths give the same results: sums saturate to the int16_t range and
+ *          halving averages round toward minus infinity.
+ */
+
+#ifndef __PCM_KERNELS_H
+#define __PCM_KERNELS_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief Q12 fixed point gain of 1.0, see pcm_gain()
+ */
+#define PCM_GAIN_UNITY (1 << 12)
+
+/**
+ * @brief   Duplicate mono samples into stereo frames
+ * @param   input: mono samples
+ * @param   output: stereo frames, it can be same with input
+ * @param   frames: number of frames
+ */
+void pcm_mono_to_stereo(const int16_t *input, int16_t *output, uint32_t frames);
+
+/**
+ * @brief   Average stereo frames into mono samples
+ * @param   input: stereo frames
+ * @param   output: mono samples, it can be same with input
+ * @param   frames: number of frames
+ */
+void pcm_stereo_to_mono(const int16_t *input, int16_t *output, uint32_t frames);
+
+/**
+ * @brief   Take the front left and right channels of multi-channel frames
+ * @param   input: frames of in_ch channels, front left and right first
+ * @param   in_ch: number of input channels
+ * @param   output: stereo frames, it can be same with input
+ * @param   frames: number of frames
+ */
+void pcm_mix_front(const int16_t *input, uint32_t in_ch, int16_t *output, uint32_t frames);
+
+/**
+ * @brief   Mix front and half of the center channel into stereo frames
+ * @param   input: frames of in_ch channels in FL, FR, FC order
+ * @param   in_ch: number of input channels
+ * @param   output: stereo frames, it can be same with input
+ * @param   frames: number of frames
+ */
+void pcm_mix_center(const int16_t *input, uint32_t in_ch, int16_t *output, uint32_t frames);
+
+/**
+ * @brief   Average front and back channels of quad frames into stereo frames
+ * @param   input: frames in FL, FR, BL, BR order
+ * @param   output: stereo frames, it can be same with input
+ * @param   frames: number of frames
+ */
+void pcm_mix_quad(const int16_t *input, int16_t *output, uint32_t frames);
+
+/**
+ * @brief   Mix 5.0 or 5.1 frames into stereo frames
+ * @details output[0] = FL + 0.7071 * (FC + BL), output[1] = FR + 0.7071 * (FC + BR)
+ * @param   input: frames of in_ch channels in FL, FR, FC order
+ * @param   in_ch: number of input channels
+ * @param   back: index of the back left channel, back right follows it
+ * @param   output: stereo frames, it can be same with input
+ * @param   frames: number of frames
+ */
+void pcm_mix_surround(const int16_t *input, uint32_t in_ch, uint32_t back, int16_t *output, uint32_t frames);
+
+/**
+ * @brief   Scale samples by a gain
+ * @param   input: samples
+ * @param   output: scaled samples, it can be same with input
+ * @param   samples: number of samples
+ * @param   gain: Q12 fixed point gain, PCM_GAIN_UNITY is 1.0
+ */
+void pcm_gain(const int16_t *input, int16_t *output, uint32_t samples, int16_t gain);
+
+/**
+ * @brief   Convert unsigned 8 bits samples to 16 bits samples
+ */
+void pcm_u8_to_s16(const uint8_t *input, int16_t *output, uint32_t samples);
+
+/**
+ * @brief   Convert 16 bits samples to 32 bits samples
+ */
+void pcm_s16_to_s32(const int16_t *input, int32_t *output, uint32_t samples);
+
+/**
+ * @brief   Convert 32 bits samples to 16 bits samples with rounding and saturation
+ * @param   output: 16 bits samples, it can be same with input
+ */
+void pcm_s32_to_s16(const int32_t *input, int16_t *output, uint32_t samples);
+
+/**
+ * @brief   Compute one FIR filter output
+ * @param   input: first sample under the filter
+ * @param   taps: filter coefficients
+ * @param   ntaps: number of coefficients
+ * @param   stride: distance between two samples of the channel, i.e. number of channels
+ * @return  sum of input[i * stride] * taps[i]
+ */
+int32_t pcm_fir(const int16_t *input, const int16_t *taps, uint32_t ntaps, uint32_t stride);
+
+/**
+ * @brief   Resample frames by linear interpolation
+ * @details Output frame n is interpolated at the 16.16 fixed point position
+ *          index + n * step of the input.
+ * @param   input: input frames, with one more frame than the last position used
+ * @param   channels: number of channels
+ * @param   output: output frames
+ * @param   frames: number of output frames
+ * @param   index: 16.16 fixed point position of the first output frame
+ * @param   step: 16.16 fixed point distance between two output frames
+ * @return  16.16 fixed point position of the next output frame
+ */
+uint32_t pcm_interpolate(const int16_t *input, uint32_t channels, int16_t *output, uint32_t frames, uint32_t index, uint32_t step);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif
+#endif
+/** @} */ // end of MEDIA group
@@ -101,7 +101,9 @@ int messaging_send_sync(const char *port_name, msg_send_data_t *send_data, msg_r
 /**
  * @brief Send(unicast) message with async mode.
  * @details @b #include <messaging/messaging.h>\n
- * Sender registers the reply callback and send the message.
+ * Sender registers the reply callback and send the message.\n
+ * The reply port is removed after the callback has run for the reply. If the\n
+ * reply never comes, messaging_cleanup(port_name) must be called to remove it.
  * @param[in] port_name The message port name to send.
  * @param[in] send_data\n
  *		  msg          : The message to be sent.\n
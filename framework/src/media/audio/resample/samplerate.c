@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <media/pcm_kernels.h>
 #include "samplerate.h"
 #include "../../utils/remix.h"
 
@@ -55,9 +56,6 @@
 // Fraction part value: 0.16 fixed point
 #define FRACPART_VALUE(x)   ((x) & 0xffff)
 
-// Calculate new sample data
-#define CALC_NEW_SAMPLE(s1, s2, part) ((s1) + INTPART_VALUE(((s2) - (s1)) * (int32_t)(part)))
-
 // Convert sample width in bytes
 #define BYTES_PER_SAMPLE(bits_per_sample)   ((bits_per_sample) >> 3)
 
@@ -114,7 +112,7 @@ struct src_context_s {
 	int new_sample_rate;    // memorize new sample rate
 	int old_sample_width;   // memorize old sample width(format)
 	int new_sample_width;   // memorize new sample width(format)
-	const int *filter_coeff;// pointer to filter coefficient array
+	const int16_t *filter_coeff;// pointer to filter coefficient array
 	int overlap_frames;     // number of overlap frames reserved in internal buffer
 	float ratio;            // (float)new_sample_rate / (float)old_sample_rate
 	float inverse_ratio;    // (float)old_sample_rate / (float)new_sample_rate
@@ -132,15 +130,19 @@ struct src_context_s {
 typedef struct src_context_s src_context_t;
 
 /**
- * 16.16 fixed point FIR filter coefficients for conversion 44100 -> 22050.
+ * FIR filter coefficients for conversion 44100 -> 22050.
  * (Works equivalently for 22010 -> 11025 or any other halving, of course.)
+ * These are the integer parts of the 16.16 fixed point coefficients
+ * 2089257, 2898328, -5820678, -10484531, 19038724, 30542725, -50469415,
+ * -81505260, 152544464, 478517512, ... (symmetric), so that they can be
+ * used by the 16 bits multiply-accumulate of pcm_fir().
  */
-static const int32_t filter_22khz_coeff[] = {
-	2089257, 2898328, -5820678, -10484531,
-	19038724, 30542725, -50469415, -81505260,
-	152544464, 478517512, 478517512, 152544464,
-	-81505260, -50469415, 30542725, 19038724,
-	-10484531, -5820678, 2898328, 2089257,
+static const int16_t filter_22khz_coeff[] = {
+	31, 44, -89, -160,
+	290, 466, -771, -1244,
+	2327, 7301, 7301, 2327,
+	-1244, -771, 466, 290,
+	-160, -89, 44, 31,
 };
 
 
@@ -157,33 +159,13 @@ static const int32_t filter_22khz_coeff[] = {
  * @return  value of convolution result.
  * @see
  */
-static int32_t fir_convolve(const int16_t *input, const int32_t *coeff, int32_t num_samples, int32_t channels_num)
+static int32_t fir_convolve(const int16_t *input, const int16_t *coeff, int32_t num_samples, int32_t channels_num)
 {
 	int32_t sum = 1 << 13;
-	int32_t i;
-	for (i = 0; i < num_samples; ++i) {
-		sum += input[i * channels_num] * (coeff[i] >> 16);
-	}
+	sum += pcm_fir(input, coeff, num_samples, channels_num);
 	return sum >> 14;
 }
 
-/**
- * @brief   Clip an integer value (32 bits) to a signed short type value(16 bits)
- * @remarks int16_t value in range [INT16_MIN, INT16_MAX], which is defined in <stdint.h>
- * @param   x: input 32 bits integer value.
- * @return  output 16 bits signed short value.
- */
-static int16_t clip(int32_t x)
-{
-	if (x < INT16_MIN) {
-		return INT16_MIN;
-	} else if (x > INT16_MAX) {
-		return INT16_MAX;
-	}
-
-	return x;
-}
-
 /**
  * It handles sample rate up scaling in all ratio cases (i.e. inverse ratio 0.*)
  * and sample rate down scaling cases in inverse ratio 1.* and 2.* with fraction.
@@ -196,18 +178,9 @@ static int32_t resample_frac(src_context_t *src, int32_t *num_frames_in)
 	int32_t channels_num = src->new_channel_num;
 	uint32_t step = TO_16_16_FIXED(src->inverse_ratio);
 	uint32_t fp_index = src->fp_frac;
-	uint32_t whole, frac;
-	int32_t i, j, s1, s2;
 
-	for (i = 0; i < num_frames_out; ++i, fp_index += step) {
-		whole = INTPART_VALUE(fp_index);
-		frac = FRACPART_VALUE(fp_index);
-		for (j = 0; j < channels_num; j++) {
-			s1 = input[whole * channels_num + j];
-			s2 = input[(whole + 1) * channels_num + j];
-			*output++ = clip(CALC_NEW_SAMPLE(s1, s2, frac));
-		}
-	}
+	// Linear interpolation between the two input frames around fp_index
+	fp_index = pcm_interpolate(input, channels_num, output, num_frames_out, fp_index, step);
 
 	*num_frames_in = INTPART_VALUE(fp_index);
 	src->fp_frac = FRACPART_VALUE(fp_index);;
@@ -0,0 +1,425 @@
+/******************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include <media/pcm_kernels.h>
+
+/*
+ * Each kernel has a portable C loop. On ARM the loop may be preceded by a
+ * NEON (PCM_NEON) or SIMD32 (PCM_SIMD32) block which handles as many samples
+ * as it can and leaves the remainder to the C loop. Both give the same
+ * results as the C loop alone.
+ *
+ * NEON and SIMD32: pcm_stereo_to_mono, pcm_mix_center, pcm_mix_quad,
+ *                  pcm_gain, pcm_fir (stride 1 and 2)
+ * NEON only:       pcm_mono_to_stereo, pcm_mix_front, pcm_u8_to_s16,
+ *                  pcm_s16_to_s32, pcm_s32_to_s16
+ * C only:          pcm_mix_surround, pcm_interpolate
+ */
+#if defined(__ARM_NEON) && !defined(__aarch64__) && !defined(__ARMEB__)
+#define PCM_NEON
+#include <arm_neon.h>
+#elif defined(__ARM_FEATURE_SIMD32) && !defined(__ARMEB__)
+#define PCM_SIMD32
+#endif
+
+// 0.7071 as used by the 5.x downmix, see pcm_mix_surround()
+#define MIX_COEFF_NUM   7071
+#define MIX_COEFF_DEN   10000
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+// Saturate a 32 bits value to the int16_t range
+static inline int32_t sat16(int32_t x)
+{
+#if defined(PCM_SIMD32) || defined(PCM_NEON)
+	int32_t r;
+	__asm__("ssat %0, #16, %1" : "=r"(r) : "r"(x));
+	return r;
+#else
+	if (x < INT16_MIN) {
+		return INT16_MIN;
+	} else if (x > INT16_MAX) {
+		return INT16_MAX;
+	}
+
+	return x;
+#endif
+}
+
+#ifdef PCM_SIMD32
+// Unaligned load/store of two samples
+static inline uint32_t ld2(const int16_t *p)
+{
+	uint32_t w;
+	memcpy(&w, p, sizeof(w));
+	return w;
+}
+
+static inline void st2(int16_t *p, uint32_t w)
+{
+	memcpy(p, &w, sizeof(w));
+}
+
+// Saturating add of two pairs of halfwords
+static inline uint32_t qadd16(uint32_t a, uint32_t b)
+{
+	uint32_t r;
+	__asm__("qadd16 %0, %1, %2" : "=r"(r) : "r"(a), "r"(b));
+	return r;
+}
+
+// Halving add of two pairs of halfwords
+static inline uint32_t shadd16(uint32_t a, uint32_t b)
+{
+	uint32_t r;
+	__asm__("shadd16 %0, %1, %2" : "=r"(r) : "r"(a), "r"(b));
+	return r;
+}
+
+// Bottom halfword of a, bottom halfword of b in the top halfword
+static inline uint32_t pkhbt(uint32_t a, uint32_t b)
+{
+	uint32_t r;
+	__asm__("pkhbt %0, %1, %2, lsl #16" : "=r"(r) : "r"(a), "r"(b));
+	return r;
+}
+
+// Top halfword of a in the bottom halfword, top halfword of b
+static inline uint32_t pkhtb(uint32_t b, uint32_t a)
+{
+	uint32_t r;
+	__asm__("pkhtb %0, %1, %2, asr #16" : "=r"(r) : "r"(b), "r"(a));
+	return r;
+}
+
+// Dual 16 bits multiply with 32 bits accumulate
+static inline int32_t smlad(uint32_t a, uint32_t b, int32_t acc)
+{
+	int32_t r;
+	__asm__("smlad %0, %1, %2, %3" : "=r"(r) : "r"(a), "r"(b), "r"(acc));
+	return r;
+}
+
+// (bottom halfword of a * gain) >> 12, saturated
+static inline int32_t gain_lo(uint32_t a, int32_t gain)
+{
+	int32_t r;
+	__asm__("smulbb %0, %1, %2\n\tssat %0, #16, %0, asr #12" : "=&r"(r) : "r"(a), "r"(gain));
+	return r;
+}
+
+// (top halfword of a * gain) >> 12, saturated
+static inline int32_t gain_hi(uint32_t a, int32_t gain)
+{
+	int32_t r;
+	__asm__("smultb %0, %1, %2\n\tssat %0, #16, %0, asr #12" : "=&r"(r) : "r"(a), "r"(gain));
+	return r;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+void pcm_mono_to_stereo(const int16_t *input, int16_t *output, uint32_t frames)
+{
+	uint32_t n = frames;
+
+	// Maybe input == output, so go backward.
+#ifdef PCM_NEON
+	while (n >= 8) {
+		int16x8x2_t v;
+		n -= 8;
+		v.val[0] = vld1q_s16(&input[n]);
+		v.val[1] = v.val[0];
+		vst2q_s16(&output[2 * n], v);
+	}
+#endif
+	while (n > 0) {
+		int16_t s;
+		n--;
+		s = input[n];
+		output[2 * n] = s;
+		output[2 * n + 1] = s;
+	}
+}
+
+void pcm_stereo_to_mono(const int16_t *input, int16_t *output, uint32_t frames)
+{
+	uint32_t n = 0;
+
+#if defined(PCM_NEON)
+	for (; n + 8 <= frames; n += 8) {
+		int16x8x2_t v = vld2q_s16(&input[2 * n]);
+		vst1q_s16(&output[n], vhaddq_s16(v.val[0], v.val[1]));
+	}
+#elif defined(PCM_SIMD32)
+	for (; n + 2 <= frames; n += 2) {
+		uint32_t f0 = ld2(&input[2 * n]);      // L0 R0
+		uint32_t f1 = ld2(&input[2 * n + 2]);  // L1 R1
+		st2(&output[n], shadd16(pkhbt(f0, f1), pkhtb(f1, f0)));
+	}
+#endif
+	for (; n < frames; n++) {
+		output[n] = ((int32_t)input[2 * n] + input[2 * n + 1]) >> 1;
+	}
+}
+
+void pcm_mix_front(const int16_t *input, uint32_t in_ch, int16_t *output, uint32_t frames)
+{
+	uint32_t n = 0;
+
+#ifdef PCM_NEON
+	if (in_ch == 3) {
+		for (; n + 8 <= frames; n += 8) {
+			int16x8x3_t v = vld3q_s16(&input[3 * n]);
+			int16x8x2_t o = { { v.val[0], v.val[1] } };
+			vst2q_s16(&output[2 * n], o);
+		}
+	} else if (in_ch == 4) {
+		for (; n + 8 <= frames; n += 8) {
+			int16x8x4_t v = vld4q_s16(&input[4 * n]);
+			int16x8x2_t o = { { v.val[0], v.val[1] } };
+			vst2q_s16(&output[2 * n], o);
+		}
+	}
+#endif
+	for (; n < frames; n++) {
+		output[2 * n] = input[n * in_ch];
+		output[2 * n + 1] = input[n * in_ch + 1];
+	}
+}
+
+void pcm_mix_center(const int16_t *input, uint32_t in_ch, int16_t *output, uint32_t frames)
+{
+	uint32_t n = 0;
+
+#if defined(PCM_NEON)
+	if (in_ch == 3 || in_ch == 4) {
+		for (; n + 8 <= frames; n += 8) {
+			int16x8_t fl, fr, fc, half;
+			int16x8x2_t o;
+			if (in_ch == 3) {
+				int16x8x3_t v = vld3q_s16(&input[3 * n]);
+				fl = v.val[0];
+				fr = v.val[1];
+				fc = v.val[2];
+			} else {
+				int16x8x4_t v = vld4q_s16(&input[4 * n]);
+				fl = v.val[0];
+				fr = v.val[1];
+				fc = v.val[2];
+			}
+			// fc / 2 rounded toward zero: add 1 to negative values first
+			half = vshrq_n_s16(vaddq_s16(fc, vreinterpretq_s16_u16(vshrq_n_u16(vreinterpretq_u16_s16(fc), 15))), 1);
+			o.val[0] = vqaddq_s16(fl, half);
+			o.val[1] = vqaddq_s16(fr, half);
+			vst2q_s16(&output[2 * n], o);
+		}
+	}
+#elif defined(PCM_SIMD32)
+	for (; n < frames; n++) {
+		const int16_t *in = &input[n * in_ch];
+		int32_t half = in[2] / 2;
+		st2(&output[2 * n], qadd16(ld2(in), pkhbt(half, half)));
+	}
+#endif
+	for (; n < frames; n++) {
+		const int16_t *in = &input[n * in_ch];
+		int32_t half = in[2] / 2;
+		output[2 * n] = sat16(in[0] + half);
+		output[2 * n + 1] = sat16(in[1] + half);
+	}
+}
+
+void pcm_mix_quad(const int16_t *input, int16_t *output, uint32_t frames)
+{
+	uint32_t n = 0;
+
+#if defined(PCM_NEON)
+	for (; n + 8 <= frames; n += 8) {
+		int16x8x4_t v = vld4q_s16(&input[4 * n]);
+		int16x8x2_t o;
+		o.val[0] = vhaddq_s16(v.val[0], v.val[2]);
+		o.val[1] = vhaddq_s16(v.val[1], v.val[3]);
+		vst2q_s16(&output[2 * n], o);
+	}
+#elif defined(PCM_SIMD32)
+	for (; n < frames; n++) {
+		st2(&output[2 * n], shadd16(ld2(&input[4 * n]), ld2(&input[4 * n + 2])));
+	}
+#endif
+	for (; n < frames; n++) {
+		const int16_t *in = &input[4 * n];
+		output[2 * n] = ((int32_t)in[0] + in[2]) >> 1;
+		output[2 * n + 1] = ((int32_t)in[1] + in[3]) >> 1;
+	}
+}
+
+void pcm_mix_surround(const int16_t *input, uint32_t in_ch, uint32_t back, int16_t *output, uint32_t frames)
+{
+	uint32_t n;
+
+	for (n = 0; n < frames; n++) {
+		const int16_t *in = &input[n * in_ch];
+		int32_t fc = in[2];
+		output[2 * n] = sat16(in[0] + (fc + in[back]) * MIX_COEFF_NUM / MIX_COEFF_DEN);
+		output[2 * n + 1] = sat16(in[1] + (fc + in[back + 1]) * MIX_COEFF_NUM / MIX_COEFF_DEN);
+	}
+}
+
+void pcm_gain(const int16_t *input, int16_t *output, uint32_t samples, int16_t gain)
+{
+	uint32_t n = 0;
+
+#if defined(PCM_NEON)
+	int16x4_t g = vdup_n_s16(gain);
+	for (; n + 8 <= samples; n += 8) {
+		int16x8_t x = vld1q_s16(&input[n]);
+		int32x4_t lo = vmull_s16(vget_low_s16(x), g);
+		int32x4_t hi = vmull_s16(vget_high_s16(x), g);
+		vst1q_s16(&output[n], vcombine_s16(vqshrn_n_s32(lo, 12), vqshrn_n_s32(hi, 12)));
+	}
+#elif defined(PCM_SIMD32)
+	for (; n + 2 <= samples; n += 2) {
+		uint32_t x = ld2(&input[n]);
+		st2(&output[n], pkhbt(gain_lo(x, gain), gain_hi(x, gain)));
+	}
+#endif
+	for (; n < samples; n++) {
+		output[n] = sat16(((int32_t)input[n] * gain) >> 12);
+	}
+}
+
+void pcm_u8_to_s16(const uint8_t *input, int16_t *output, uint32_t samples)
+{
+	uint32_t n = 0;
+
+#ifdef PCM_NEON
+	for (; n + 8 <= samples; n += 8) {
+		uint16x8_t x = vshll_n_u8(vld1_u8(&input[n]), 8);
+		vst1q_s16(&output[n], vreinterpretq_s16_u16(veorq_u16(x, vdupq_n_u16(0x8000))));
+	}
+#endif
+	for (; n < samples; n++) {
+		output[n] = (int16_t)(((int32_t)input[n] - 128) << 8);
+	}
+}
+
+void pcm_s16_to_s32(const int16_t *input, int32_t *output, uint32_t samples)
+{
+	uint32_t n = 0;
+
+#ifdef PCM_NEON
+	for (; n + 4 <= samples; n += 4) {
+		vst1q_s32(&output[n], vshll_n_s16(vld1_s16(&input[n]), 16));
+	}
+#endif
+	for (; n < samples; n++) {
+		output[n] = (int32_t)input[n] << 16;
+	}
+}
+
+void pcm_s32_to_s16(const int32_t *input, int16_t *output, uint32_t samples)
+{
+	uint32_t n = 0;
+
+#ifdef PCM_NEON
+	for (; n + 4 <= samples; n += 4) {
+		vst1_s16(&output[n], vqrshrn_n_s32(vld1q_s32(&input[n]), 16));
+	}
+#endif
+	for (; n < samples; n++) {
+		// (x + 0x8000) >> 16 without overflowing
+		output[n] = sat16(((input[n] >> 15) + 1) >> 1);
+	}
+}
+
+int32_t pcm_fir(const int16_t *input, const int16_t *taps, uint32_t ntaps, uint32_t stride)
+{
+	int32_t sum = 0;
+	uint32_t i = 0;
+
+#if defined(PCM_NEON)
+	int32x4_t acc = vdupq_n_s32(0);
+	if (stride == 1) {
+		for (; i + 4 <= ntaps; i += 4) {
+			acc = vmlal_s16(acc, vld1_s16(&input[i]), vld1_s16(&taps[i]));
+		}
+	} else if (stride == 2) {
+		// vld2 reads 8 samples for 4 taps: keep one tap for the C loop so
+		// that it does not read past the last sample used
+		for (; i + 5 <= ntaps; i += 4) {
+			int16x4x2_t v = vld2_s16(&input[2 * i]);
+			acc = vmlal_s16(acc, v.val[0], vld1_s16(&taps[i]));
+		}
+	}
+	sum = vgetq_lane_s32(acc, 0) + vgetq_lane_s32(acc, 1) + vgetq_lane_s32(acc, 2) + vgetq_lane_s32(acc, 3);
+#elif defined(PCM_SIMD32)
+	if (stride == 1) {
+		for (; i + 2 <= ntaps; i += 2) {
+			sum = smlad(ld2(&input[i]), ld2(&taps[i]), sum);
+		}
+	} else if (stride == 2) {
+		// Pack input[2i] and input[2i + 2]; the second one is loaded alone
+		// so as not to read past the last sample used
+		for (; i + 2 <= ntaps; i += 2) {
+			sum = smlad(pkhbt(ld2(&input[2 * i]), (uint16_t)input[2 * i + 2]), ld2(&taps[i]), sum);
+		}
+	}
+#endif
+	for (; i < ntaps; i++) {
+		sum += input[i * stride] * taps[i];
+	}
+
+	return sum;
+}
+
+uint32_t pcm_interpolate(const int16_t *input, uint32_t channels, int16_t *output, uint32_t frames, uint32_t index, uint32_t step)
+{
+	uint32_t n;
+	uint32_t j;
+
+	// The fraction is taken in 0.15 so that the product stays within 32 bits
+	if (channels == 1) {
+		for (n = 0; n < frames; n++, index += step) {
+			const int16_t *in = &input[index >> 16];
+			int32_t frac = (index & 0xffff) >> 1;
+			*output++ = in[0] + (((in[1] - in[0]) * frac) >> 15);
+		}
+	} else if (channels == 2) {
+		for (n = 0; n < frames; n++, index += step) {
+			const int16_t *in = &input[(index >> 16) * 2];
+			int32_t frac = (index & 0xffff) >> 1;
+			*output++ = in[0] + (((in[2] - in[0]) * frac) >> 15);
+			*output++ = in[1] + (((in[3] - in[1]) * frac) >> 15);
+		}
+	} else {
+		for (n = 0; n < frames; n++, index += step) {
+			const int16_t *in = &input[(index >> 16) * channels];
+			int32_t frac = (index & 0xffff) >> 1;
+			for (j = 0; j < channels; j++) {
+				*output++ = in[j] + (((in[j + channels] - in[j]) * frac) >> 15);
+			}
+		}
+	}
+
+	return index;
+}
@@ -19,6 +19,7 @@
 #include <string.h>
 #include <debug.h>
 #include <media/MediaTypes.h>
+#include <media/pcm_kernels.h>
 #include "internal_defs.h"
 #include "remix.h"
 
@@ -84,11 +85,6 @@ using namespace media;
                                 output[1] = input[1] + coeff * (input[2] + input[5])
 */
 
-/****************************************************************************
- * Pre-processor Definitions
- ****************************************************************************/
-#define MIX_COEFF   7071 / 1000 // 0.7071, DONOT (7071 / 1000)
-
 /****************************************************************************
  * Private Declarations
  ****************************************************************************/
@@ -142,18 +138,6 @@ uint32_t ch2layout(uint32_t nb_chs)
 	}
 }
 
-// Clip an integer value (32 bits) to a signed short type value(16 bits)
-static int16_t clip(int32_t x)
-{
-	if (x < INT16_MIN) {
-		return INT16_MIN;
-	} else if (x > INT16_MAX) {
-		return INT16_MAX;
-	}
-
-	return x;
-}
-
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -186,130 +170,45 @@ int32_t rechannel(uint32_t in_layout, uint32_t out_layout, const int16_t *input,
 
 	// Now consider scenarios:
 	// stereo -> mono, mono -> stereo, multi -> stereo.
+	// The sample loops are in the PCM kernels, see media/pcm_kernels.h.
 
-	const int16_t *in_fl, *in_fr, *in_fc, /* *in_lfe, */ *in_bl, *in_br;
 	uint32_t in_ch = layout2ch(in_layout);
-	uint32_t out_ch = layout2ch(out_layout);
-	uint32_t out_samples = out_frames * out_ch;
-	int16_t *out_end = &output[out_samples];
-	int16_t *out_fl = &output[0];
-	int16_t *out_fr = &output[1];
-	int16_t *out_fc;
 
 	switch (in_layout) {
-	case CH_LAYOUT_MONO: { // out_layout: CH_LAYOUT_STEREO
-		// Maybe input == output, upmix backward.
-		in_fc = &input[out_frames * in_ch - 1];
-		out_fl = &output[out_samples - 2];
-		out_fr = &output[out_samples - 1];
+	case CH_LAYOUT_MONO: // out_layout: CH_LAYOUT_STEREO
+		// Maybe input == output, the kernel upmixes backward.
+		pcm_mono_to_stereo(input, output, out_frames);
+		break;
 
-		while (output <= out_fl) {
-			*out_fr = *in_fc;
-			*out_fl = *in_fc;
-
-			out_fr -= out_ch;
-			out_fl -= out_ch;
-			in_fc -= in_ch;
-		}
-	} break;
-
-	case CH_LAYOUT_STEREO: { // out_layout: CH_LAYOUT_MONO
-		in_fl = &input[0];
-		in_fr = &input[1];
-		out_fc = &output[0];
-
-		while (out_fc < out_end) {
-			*out_fc = ((int32_t)*in_fl + *in_fr) / 2;
-
-			out_fc += out_ch;
-			in_fl += in_ch;
-			in_fr += in_ch;
-		}
-	} break;
+	case CH_LAYOUT_STEREO: // out_layout: CH_LAYOUT_MONO
+		pcm_stereo_to_mono(input, output, out_frames);
+		break;
 
 	// Below cases process: multi -> stereo
 
-	case CH_LAYOUT_2POINT1: {
-		in_fl = &input[0];
-		in_fr = &input[1];
+	case CH_LAYOUT_2POINT1:
 		// in_lfe at &input[2]
-
-		while (out_fl < out_end) {
-			*out_fl = *in_fl;
-			*out_fr = *in_fr;
-
-			out_fl += out_ch;
-			out_fr += out_ch;
-			in_fl += in_ch;
-			in_fr += in_ch;
-		}
-	} break;
+		pcm_mix_front(input, in_ch, output, out_frames);
+		break;
 
 	case CH_LAYOUT_3POINT1:  // fall through
-	case CH_LAYOUT_SURROUND: {
-		in_fl = &input[0];
-		in_fr = &input[1];
-		in_fc = &input[2];
+	case CH_LAYOUT_SURROUND:
 		// in_lfe at &input[3]
+		pcm_mix_center(input, in_ch, output, out_frames);
+		break;
 
-		while (out_fl < out_end) {
-			*out_fl = clip((int32_t)*in_fl + *in_fc / 2);
-			*out_fr = clip((int32_t)*in_fr + *in_fc / 2);
-
-			out_fl += out_ch;
-			out_fr += out_ch;
-			in_fl += in_ch;
-			in_fr += in_ch;
-			in_fc += in_ch;
-		}
-	} break;
-
-	case CH_LAYOUT_QUAD: {
-		in_fl = &input[0];
-		in_fr = &input[1];
-		in_bl = &input[2];
-		in_br = &input[3];
-
-		while (out_fl < out_end) {
-			*out_fl = ((int32_t)*in_fl + *in_bl) / 2;
-			*out_fr = ((int32_t)*in_fr + *in_br) / 2;
-
-			out_fl += out_ch;
-			out_fr += out_ch;
-			in_fl += in_ch;
-			in_fr += in_ch;
-			in_bl += in_ch;
-			in_br += in_ch;
-		}
-	} break;
-
-	case CH_LAYOUT_5POINT1_BACK: // fall through
-	case CH_LAYOUT_5POINT0_BACK: {
-		in_fl = &input[0];
-		in_fr = &input[1];
-		in_fc = &input[2];
-		if (in_layout == CH_LAYOUT_5POINT1_BACK) {
-			// in_lfe at &input[3]
-			in_bl = &input[4];
-			in_br = &input[5];
-		} else {
-			in_bl = &input[3];
-			in_br = &input[4];
-		}
+	case CH_LAYOUT_QUAD:
+		pcm_mix_quad(input, output, out_frames);
+		break;
 
-		while (out_fl < out_end) {
-			*out_fl = clip(*in_fl + ((int32_t)*in_fc + *in_bl) * MIX_COEFF);
-			*out_fr = clip(*in_fr + ((int32_t)*in_fc + *in_br) * MIX_COEFF);
+	case CH_LAYOUT_5POINT1_BACK:
+		// in_lfe at &input[3]
+		pcm_mix_surround(input, in_ch, 4, output, out_frames);
+		break;
 
-			out_fl += out_ch;
-			out_fr += out_ch;
-			in_fl += in_ch;
-			in_fr += in_ch;
-			in_fc += in_ch;
-			in_bl += in_ch;
-			in_br += in_ch;
-		}
-	} break;
+	case CH_LAYOUT_5POINT0_BACK:
+		pcm_mix_surround(input, in_ch, 3, output, out_frames);
+		break;
 
 	default:
 		// unsupported in_layout
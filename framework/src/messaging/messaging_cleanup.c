@@ -18,6 +18,7 @@
 /****************************************************************************
  * Included Files
  ****************************************************************************/
+#include <tinyara/config.h>
 #include <debug.h>
 #include <errno.h>
 #include <mqueue.h>
@@ -30,6 +31,20 @@
 
 #define INVALID_PID (-1)
 
+#ifdef CONFIG_MESSAGING_SHM
+static int messaging_unlink_internalport(const char *port_name, int pid)
+{
+	int ret;
+
+	ret = messaging_shm_unlink(port_name, pid, false);
+	if (ret != OK && errno != ENOENT) {
+		msgdbg("[Messaging] unregister fail : unlink error, errno %d.\n", errno);
+		return ERROR;
+	}
+
+	return OK;
+}
+#else
 static int messaging_unlink_internalport(const char *port_name, int pid)
 {
 	int ret;
@@ -51,6 +66,7 @@ static int messaging_unlink_internalport(const char *port_name, int pid)
 
 	return OK;
 }
+#endif
 /****************************************************************************
  * Name : messaging_cleanup
  * 
@@ -83,6 +99,11 @@ int messaging_cleanup(const char *port_name)
 		return ERROR;
 	}
 
+#ifdef CONFIG_MESSAGING_SHM
+	/* Remove the reply port of an async send whose reply never came. */
+	(void)messaging_shm_unlink(port_name, getpid(), true);
+#endif
+
 	/* Remove the receiver information by port_name from the info list. */
 	port_info_list_ptr = messaging_get_port_info_list();
 	port_info = (msg_port_info_t *)sq_peek(port_info_list_ptr);
@@ -95,7 +116,11 @@ int messaging_cleanup(const char *port_name)
 	do {
 		if ((strncmp(port_info->name, port_name, strlen(port_name) + 1) == 0) && (my_pid == port_info->pid)) {
 			cleanup_pid = port_info->pid;
+#ifdef CONFIG_MESSAGING_SHM
+			messaging_shm_close(port_info->port);
+#else
 			mq_close(port_info->mqdes);
+#endif
 			sq_rem((FAR sq_entry_t *)port_info, port_info_list_ptr);
 			MSG_FREE(port_info->data);
 			MSG_FREE(port_info);
@@ -18,6 +18,7 @@
 /****************************************************************************
  * Included Files
  ****************************************************************************/
+#include <tinyara/config.h>
 #include <debug.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -181,6 +182,43 @@ int messaging_set_notification(int signo, msg_recv_info_t *data)
  * Description:
  *  This function is wrapper callback function for waiting until receiving the message.
  ****************************************************************************/
+#ifdef CONFIG_MESSAGING_SHM
+void messaging_run_callback(int signo, siginfo_t *data)
+{
+	msg_recv_info_t *recv_info;
+	int msg_type;
+
+	if (data == NULL) {
+		msgdbg("[Messaging] recv fail : wrong param for wrapper callback(data).\n");
+		return;
+	}
+
+	/* recv_info is passed through signal. It has the port and callback information. */
+	recv_info = (msg_recv_info_t *)data->si_value.sival_ptr;
+	if (recv_info == NULL) {
+		msgdbg("[Messaging] recv fail : wrong param for wrapper callback(info).\n");
+		return;
+	}
+
+	while (messaging_shm_recv(recv_info->port, recv_info->msg, &msg_type, false) == OK) {
+		/* Call user callback */
+		(*recv_info->user_cb)(msg_type, recv_info->msg, recv_info->cb_data);
+		if (msg_type == MSG_SEND_REPLY) {
+			/* This is only for async-reply msg. The callback registration
+			 * and the reply port are removed after one-time use.
+			 */
+			messaging_shm_close_reply(recv_info->port);
+			MSG_FREE(recv_info);
+			return;
+		}
+	}
+
+	/* All requests are handled. Register notification again. */
+	if (messaging_shm_notify(recv_info->port, SIGMSG_MESSAGING, recv_info) != OK) {
+		msgdbg("[Messaging] set notification fail.\n");
+	}
+}
+#else
 void messaging_run_callback(int signo, siginfo_t *data)
 {
 	int ret;
@@ -265,3 +303,4 @@ errout_with_mq_close:
 errout_with_recv_info:
 	MSG_FREE(recv_info);
 }
+#endif
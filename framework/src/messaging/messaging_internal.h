@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <queue.h>
+#include <stdbool.h>
 #include <messaging/messaging.h>
 
 
@@ -82,11 +83,22 @@ enum msg_send_type_e {
 };
 typedef enum msg_send_type_e msg_send_type_t;
 
+#ifdef CONFIG_MESSAGING_SHM
+/**
+ * @brief The message port of the shared-memory transport
+ */
+struct msg_shm_port_s;
+typedef struct msg_shm_port_s msg_shm_port_t;
+#endif
+
 /**
  * @brief The internal structure for callback information and mq descriptor
  */
 struct msg_recv_info_s {
 	mqd_t mqdes;
+#ifdef CONFIG_MESSAGING_SHM
+	msg_shm_port_t *port;
+#endif
 	msg_recv_buf_t *msg;
 	msg_callback_t user_cb;
 	char *cb_data;
@@ -101,6 +113,9 @@ struct msg_port_info_s {
 	struct msg_port_info_s *flink;
 	char name[MAX_PORT_NAME_SIZE];
 	mqd_t mqdes;
+#ifdef CONFIG_MESSAGING_SHM
+	msg_shm_port_t *port;
+#endif
 	void *data;
 	pid_t pid;
 };
@@ -142,6 +157,22 @@ int messaging_parse_packet(char *packet, char *buf, int buflen, pid_t *sender_pi
  * @brief Internal function for getting g_port_info_list
  */
 sq_queue_t *messaging_get_port_info_list(void);
+/**
+ * @brief Internal function for getting the type carried by a packet
+ */
+uint32_t messaging_get_packet_type(msg_send_type_t msg_type);
+#ifdef CONFIG_MESSAGING_SHM
+/**
+ * @brief Internal functions of the shared-memory transport
+ */
+msg_shm_port_t *messaging_shm_open(const char *port_name, pid_t pid, bool reply, bool create);
+void messaging_shm_close(msg_shm_port_t *port);
+void messaging_shm_close_reply(msg_shm_port_t *port);
+int messaging_shm_unlink(const char *port_name, pid_t pid, bool reply);
+int messaging_shm_send(msg_shm_port_t **ports, int nports, msg_send_data_t *send_data, uint32_t send_type);
+int messaging_shm_recv(msg_shm_port_t *port, msg_recv_buf_t *recv_buf, int *msg_type, bool block);
+int messaging_shm_notify(msg_shm_port_t *port, int signo, void *data);
+#endif
 /*
  *@endcond
  */
@@ -40,6 +40,134 @@ sq_queue_t *messaging_get_port_info_list(void)
 {
 	return &g_port_info_list;
 }
+#ifdef CONFIG_MESSAGING_SHM
+/****************************************************************************
+ * Name : messaging_rcv_nonblock
+ *
+ * Description:
+ *  This function is for non-blocking receive on a shared-memory port.
+ * It calls the callback for the messages already in the port, then requests
+ * a notification for the next one.
+ ****************************************************************************/
+static int messaging_rcv_nonblock(msg_shm_port_t *port, const char *port_name, msg_recv_buf_t *recv_buf, msg_callback_info_t *cb_info)
+{
+	int ret;
+	msg_recv_info_t *nonblock_data;
+	msg_port_info_t *port_info;
+	int msg_type;
+
+	/* Check there were messages already before setting notification */
+	while (messaging_shm_recv(port, recv_buf, &msg_type, false) == OK) {
+		(*cb_info->cb_func)(msg_type, recv_buf, cb_info->cb_data);
+	}
+
+	ret = messaging_set_notify_signal(SIGMSG_MESSAGING, (_sa_sigaction_t)messaging_run_callback);
+	if (ret != OK) {
+		goto errout_with_port;
+	}
+
+	/* nonblock_data will be passed to callback through signal. */
+	nonblock_data = (msg_recv_info_t *)MSG_ALLOC(sizeof(msg_recv_info_t));
+	if (nonblock_data == NULL) {
+		msgdbg("[Messaging] recv fail : out of memory.\n");
+		goto errout_with_port;
+	}
+	nonblock_data->port = port;
+	nonblock_data->msg = recv_buf;
+	nonblock_data->user_cb = cb_info->cb_func;
+	nonblock_data->cb_data = cb_info->cb_data;
+	strncpy(nonblock_data->port_name, port_name, strlen(port_name) + 1);
+
+	/* Add a new message port into the list. */
+	port_info = (msg_port_info_t *)MSG_ALLOC(sizeof(msg_port_info_t));
+	if (port_info == NULL) {
+		msgdbg("[Messaging] recv fail : out of memory for port_info.\n");
+		MSG_FREE(nonblock_data);
+		goto errout_with_port;
+	}
+
+	port_info->port = port;
+	port_info->data = nonblock_data;
+	port_info->pid = getpid();
+	strncpy(port_info->name, port_name, strlen(port_name) + 1);
+	sq_addlast((FAR sq_entry_t *)port_info, &g_port_info_list);
+
+	ret = messaging_shm_notify(port, SIGMSG_MESSAGING, nonblock_data);
+	if (ret != OK) {
+		sq_rem((FAR sq_entry_t *)port_info, &g_port_info_list);
+		MSG_FREE(port_info);
+		MSG_FREE(nonblock_data);
+		goto errout_with_port;
+	}
+
+	return OK;
+
+errout_with_port:
+	messaging_shm_close(port);
+	messaging_shm_unlink(port_name, getpid(), false);
+	return ERROR;
+}
+
+/****************************************************************************
+ * Name : messaging_rcv_block
+ *
+ * Description:
+ *  This function waits for a message on a shared-memory port.
+ *
+ * Return Value:
+ *  On success, the message type is returned.; On failure, -1 (ERROR) is returned.
+ ****************************************************************************/
+static int messaging_rcv_block(msg_shm_port_t *port, const char *port_name, msg_recv_buf_t *recv_buf)
+{
+	int msg_type;
+
+	if (messaging_shm_recv(port, recv_buf, &msg_type, true) != OK) {
+		msg_type = ERROR;
+	}
+
+	messaging_shm_close(port);
+	messaging_shm_unlink(port_name, getpid(), false);
+	return msg_type;
+}
+
+/****************************************************************************
+ * Name : messaging_recv_internal
+ *
+ * Description:
+ *  This function opens the port of the calling task and receives from it
+ *  based on receive type.
+ *
+ * Return Value:
+ *  On success, 0 (OK) is returned.; On failure, -1 (ERROR) is returned.
+ ****************************************************************************/
+int messaging_recv_internal(const char *port_name, msg_recv_buf_t *recv_buf, msg_callback_info_t *cb_info)
+{
+	int ret;
+	msg_shm_port_t *port;
+
+	port = messaging_shm_open(port_name, getpid(), false, true);
+	if (port == NULL) {
+		msgdbg("[Messaging] recv fail : open fail, errno %d.\n", errno);
+		return ERROR;
+	}
+
+	/* Save the receivers information. It will be used by sender to check the receivers. */
+	ret = SAVE_MSG_RECEIVER(port_name);
+	if (ret != OK) {
+		messaging_shm_close(port);
+		messaging_shm_unlink(port_name, getpid(), false);
+		return ERROR;
+	}
+
+	if (cb_info == NULL) {
+		ret = messaging_rcv_block(port, port_name, recv_buf);
+	} else {
+		ret = messaging_rcv_nonblock(port, port_name, recv_buf, cb_info);
+	}
+
+	return ret;
+}
+#else
 /****************************************************************************
  * Name : messaging_recv_nonblock
  * 
@@ -264,4 +392,4 @@ int messaging_recv_internal(const char *port_name, msg_recv_buf_t *recv_buf, msg
 	MSG_FREE(internal_portname);
 	return ret;
 }
-
+#endif
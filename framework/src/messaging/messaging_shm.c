@@ -0,0 +1,608 @@
+/****************************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * Shared-memory transport
+ *
+ * The tasks using messaging share one address space, so a message port is
+ * a plain structure in a table rather than a message queue.  A port holds
+ * a ring of pointers to payload buffers, sorted by message priority.  A
+ * payload buffer is reference counted: a multicast message is copied once
+ * and queued to all the receivers.  Released buffers are kept in a small
+ * cache and reused, so that the steady state does not allocate memory.
+ *
+ * When a receiver already waits on an empty port, the sender copies the
+ * message straight into the buffer of the receiver: the message is copied
+ * once and no payload buffer is needed.  This is the usual case of a
+ * synchronous request to a server and of its reply.
+ *
+ * The tables are also used by messaging_run_callback(), a signal handler
+ * which may interrupt the task in any place, so they are guarded by
+ * disabling preemption rather than by a semaphore: while a section runs no
+ * other task can signal this one.  A section never blocks nor allocates
+ * memory, and a task signals itself only once the section is left.
+ *
+ * The reply port of a client to a server port lives while a reply is
+ * awaited on it: the last of messaging_send_sync() and of the callbacks of
+ * messaging_send_async() waiting on it removes it.  messaging_cleanup()
+ * removes one whose reply never came.
+ ****************************************************************************/
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <tinyara/config.h>
+#include <assert.h>
+#include <debug.h>
+#include <errno.h>
+#include <queue.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <messaging/messaging.h>
+#include "messaging_internal.h"
+
+#ifdef CONFIG_MESSAGING_SHM
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+/* A payload buffer, shared by all the receivers of the message */
+struct msg_shm_buf_s {
+	struct msg_shm_buf_s *flink;	/* Link in the buffer cache */
+	int refs;						/* Number of ports holding the buffer */
+	int size;						/* Capacity of data[] */
+	int msglen;						/* Length of the message */
+	pid_t sender_pid;
+	uint32_t msg_type;
+	int priority;
+	char data[1];
+};
+typedef struct msg_shm_buf_s msg_shm_buf_t;
+
+struct msg_shm_port_s {
+	struct msg_shm_port_s *flink;	/* Link in the port table */
+	char name[MAX_PORT_NAME_SIZE];
+	pid_t pid;						/* Receiving task */
+	bool reply;						/* Reply port of the task to port 'name' */
+	bool unlinked;					/* Removed from the table */
+	int refs;						/* Number of users of the port */
+	int owners;						/* Users which opened it with 'create' */
+	sem_t items;					/* Messages (or hand-offs) to receive */
+	sem_t slots;					/* Free entries of the ring */
+	int head;						/* Ring of messages */
+	int count;
+	msg_shm_buf_t *ring[CONFIG_MESSAGING_MAXMSG];
+	msg_recv_buf_t *waiter;			/* Receiver waiting on the empty port */
+	bool handed;					/* A message was copied to the waiter */
+	uint32_t handed_type;
+	int notify_signo;				/* One-shot notification, 0 if none */
+	pid_t notify_pid;
+	void *notify_data;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+static sq_queue_t g_msg_shm_ports;
+static sq_queue_t g_msg_shm_freeports;
+static sq_queue_t g_msg_shm_bufs;
+static int g_msg_shm_nbufs;
+static sq_queue_t g_msg_shm_garbage;	/* Memory to free once unlocked */
+
+/****************************************************************************
+ * private functions
+ ****************************************************************************/
+static void messaging_shm_lock(void)
+{
+	sched_lock();
+}
+
+static void messaging_shm_unlock(void)
+{
+	sq_queue_t garbage;
+	FAR sq_entry_t *entry;
+
+	garbage = g_msg_shm_garbage;
+	sq_init(&g_msg_shm_garbage);
+	sched_unlock();
+
+	while ((entry = sq_remfirst(&garbage)) != NULL) {
+		MSG_FREE(entry);
+	}
+}
+
+/****************************************************************************
+ * Name : messaging_shm_getbuf
+ *
+ * Description:
+ *  Get a payload buffer of at least 'len' bytes, from the cache if possible.
+ *  The caller does not hold the lock.
+ ****************************************************************************/
+static msg_shm_buf_t *messaging_shm_getbuf(int len)
+{
+	msg_shm_buf_t *buf;
+	msg_shm_buf_t *prev = NULL;
+
+	messaging_shm_lock();
+	for (buf = (msg_shm_buf_t *)sq_peek(&g_msg_shm_bufs); buf != NULL; buf = buf->flink) {
+		if (buf->size >= len) {
+			if (prev == NULL) {
+				sq_remfirst(&g_msg_shm_bufs);
+			} else {
+				sq_remafter((FAR sq_entry_t *)prev, &g_msg_shm_bufs);
+			}
+			g_msg_shm_nbufs--;
+			messaging_shm_unlock();
+			return buf;
+		}
+		prev = buf;
+	}
+	messaging_shm_unlock();
+
+	buf = (msg_shm_buf_t *)MSG_ALLOC(sizeof(msg_shm_buf_t) + len);
+	if (buf != NULL) {
+		buf->size = len;
+	}
+	return buf;
+}
+
+/****************************************************************************
+ * Name : messaging_shm_putbuf
+ *
+ * Description:
+ *  Drop a reference to a payload buffer.  The caller holds the lock.
+ ****************************************************************************/
+static void messaging_shm_putbuf(msg_shm_buf_t *buf)
+{
+	if (--buf->refs > 0) {
+		return;
+	}
+
+	if (g_msg_shm_nbufs < CONFIG_MESSAGING_SHM_NBUFS) {
+		sq_addfirst((FAR sq_entry_t *)buf, &g_msg_shm_bufs);
+		g_msg_shm_nbufs++;
+	} else {
+		sq_addlast((FAR sq_entry_t *)buf, &g_msg_shm_garbage);
+	}
+}
+
+static int messaging_shm_signal(pid_t pid, int signo, void *data)
+{
+#ifdef CONFIG_CAN_PASS_STRUCTS
+	union sigval value;
+
+	value.sival_ptr = data;
+	return sigqueue(pid, signo, value);
+#else
+	return sigqueue(pid, signo, data);
+#endif
+}
+
+static int messaging_shm_copyout(msg_recv_buf_t *recv_buf, const char *msg, int msglen, pid_t sender_pid)
+{
+	if (msglen > recv_buf->buflen) {
+		msgdbg("[Messaging] recv fail : message of %d bytes, buffer of %d.\n", msglen, recv_buf->buflen);
+		set_errno(EMSGSIZE);
+		return ERROR;
+	}
+
+	memcpy(recv_buf->buf, msg, msglen);
+	recv_buf->sender_pid = sender_pid;
+	return OK;
+}
+
+/* A message goes straight to a receiver waiting with a buffer large enough */
+static bool messaging_shm_canhand(msg_shm_port_t *port, msg_send_data_t *send_data)
+{
+	return port->waiter != NULL && send_data->msglen <= port->waiter->buflen;
+}
+
+/****************************************************************************
+ * Name : messaging_shm_find
+ *
+ * Description:
+ *  Look up a port in the table.  The caller holds the lock.
+ ****************************************************************************/
+static msg_shm_port_t *messaging_shm_find(const char *port_name, pid_t pid, bool reply)
+{
+	msg_shm_port_t *port;
+
+	for (port = (msg_shm_port_t *)sq_peek(&g_msg_shm_ports); port != NULL; port = port->flink) {
+		if (port->pid == pid && port->reply == reply && strncmp(port->name, port_name, MAX_PORT_NAME_SIZE) == 0) {
+			return port;
+		}
+	}
+	return NULL;
+}
+
+static void messaging_shm_release(msg_shm_port_t *port)
+{
+	if (--port->refs > 0 || !port->unlinked) {
+		return;
+	}
+
+	/* Drop the messages nobody will receive */
+	while (port->count > 0) {
+		messaging_shm_putbuf(port->ring[port->head]);
+		port->head = (port->head + 1) % CONFIG_MESSAGING_MAXMSG;
+		port->count--;
+	}
+
+	sem_destroy(&port->items);
+	sem_destroy(&port->slots);
+	sq_addfirst((FAR sq_entry_t *)port, &g_msg_shm_freeports);
+}
+
+/****************************************************************************
+ * Name : messaging_shm_remove
+ *
+ * Description:
+ *  Remove a port from the table and drop the reference of the table.  The
+ *  senders waiting for room in it fail.  The caller holds the lock.
+ ****************************************************************************/
+static void messaging_shm_remove(msg_shm_port_t *port)
+{
+	int i;
+
+	sq_rem((FAR sq_entry_t *)port, &g_msg_shm_ports);
+	port->unlinked = true;
+	for (i = 1; i < port->refs; i++) {
+		sem_post(&port->slots);
+	}
+	messaging_shm_release(port);
+}
+
+/****************************************************************************
+ * Name : messaging_shm_enqueue
+ *
+ * Description:
+ *  Deliver a message to a port which has a free slot: to the waiting
+ *  receiver if it can take it, else into the ring.  The caller holds the
+ *  lock and sends the notification of the port, if any, once unlocked.
+ *  Returns true if 'buf' was queued (and referenced).
+ ****************************************************************************/
+static bool messaging_shm_enqueue(msg_shm_port_t *port, msg_shm_buf_t *buf, msg_send_data_t *send_data, uint32_t send_type)
+{
+	int pos;
+	int next;
+	int i;
+	bool queued = false;
+
+	if (messaging_shm_canhand(port, send_data)) {
+		(void)messaging_shm_copyout(port->waiter, send_data->msg, send_data->msglen, getpid());
+		port->waiter = NULL;
+		port->handed = true;
+		port->handed_type = send_type;
+		sem_post(&port->slots);
+	} else {
+		/* The waiting receiver, if any, takes it from the ring */
+		port->waiter = NULL;
+
+		/* Keep the ring sorted by priority, FIFO among equal priorities */
+		pos = port->count;
+		while (pos > 0) {
+			i = (port->head + pos - 1) % CONFIG_MESSAGING_MAXMSG;
+			if (port->ring[i]->priority >= buf->priority) {
+				break;
+			}
+			next = (i + 1) % CONFIG_MESSAGING_MAXMSG;
+			port->ring[next] = port->ring[i];
+			pos--;
+		}
+		port->ring[(port->head + pos) % CONFIG_MESSAGING_MAXMSG] = buf;
+		port->count++;
+		buf->refs++;
+		queued = true;
+	}
+
+	sem_post(&port->items);
+	return queued;
+}
+
+/****************************************************************************
+ * public functions
+ ****************************************************************************/
+/****************************************************************************
+ * Name : messaging_shm_open
+ *
+ * Description:
+ *  Get a port by name and task, the reply port of the task if 'reply' is
+ *  true, creating it if 'create' is true.  The port must be released with
+ *  messaging_shm_close(), or with messaging_shm_close_reply() for a reply
+ *  port opened with 'create'.
+ *
+ * Return Value:
+ *  The port on success; NULL with errno set on failure.
+ ****************************************************************************/
+msg_shm_port_t *messaging_shm_open(const char *port_name, pid_t pid, bool reply, bool create)
+{
+	msg_shm_port_t *port;
+
+	if (strlen(port_name) >= MAX_PORT_NAME_SIZE) {
+		set_errno(ENAMETOOLONG);
+		return NULL;
+	}
+
+	messaging_shm_lock();
+	while ((port = messaging_shm_find(port_name, pid, reply)) == NULL) {
+		if (!create) {
+			messaging_shm_unlock();
+			set_errno(ENOENT);
+			return NULL;
+		}
+
+		port = (msg_shm_port_t *)sq_remfirst(&g_msg_shm_freeports);
+		if (port == NULL) {
+			/* Allocate a free port unlocked, then look again */
+			messaging_shm_unlock();
+			port = (msg_shm_port_t *)MSG_ALLOC(sizeof(msg_shm_port_t));
+			if (port == NULL) {
+				set_errno(ENOMEM);
+				return NULL;
+			}
+			messaging_shm_lock();
+			sq_addfirst((FAR sq_entry_t *)port, &g_msg_shm_freeports);
+			continue;
+		}
+
+		memset(port, 0, sizeof(msg_shm_port_t));
+		strncpy(port->name, port_name, MAX_PORT_NAME_SIZE);
+		port->pid = pid;
+		port->reply = reply;
+		sem_init(&port->items, 0, 0);
+		sem_init(&port->slots, 0, CONFIG_MESSAGING_MAXMSG);
+		sem_setprotocol(&port->items, SEM_PRIO_NONE);
+		sem_setprotocol(&port->slots, SEM_PRIO_NONE);
+
+		/* The table holds a reference until the port is unlinked */
+		port->refs = 1;
+		sq_addlast((FAR sq_entry_t *)port, &g_msg_shm_ports);
+		break;
+	}
+
+	port->refs++;
+	if (create) {
+		port->owners++;
+	}
+	messaging_shm_unlock();
+	return port;
+}
+
+/****************************************************************************
+ * Name : messaging_shm_close
+ ****************************************************************************/
+void messaging_shm_close(msg_shm_port_t *port)
+{
+	messaging_shm_lock();
+	messaging_shm_release(port);
+	messaging_shm_unlock();
+}
+
+/****************************************************************************
+ * Name : messaging_shm_close_reply
+ *
+ * Description:
+ *  Release a reply port opened with 'create' once its reply was received
+ *  or will not come.  The last such user removes it from the table.
+ ****************************************************************************/
+void messaging_shm_close_reply(msg_shm_port_t *port)
+{
+	messaging_shm_lock();
+	if (--port->owners == 0 && !port->unlinked) {
+		messaging_shm_remove(port);
+	}
+	messaging_shm_release(port);
+	messaging_shm_unlock();
+}
+
+/****************************************************************************
+ * Name : messaging_shm_unlink
+ *
+ * Description:
+ *  Remove a port from the table.  It is freed when its last user closes it;
+ *  the senders waiting for room in it fail.
+ ****************************************************************************/
+int messaging_shm_unlink(const char *port_name, pid_t pid, bool reply)
+{
+	msg_shm_port_t *port;
+
+	messaging_shm_lock();
+	port = messaging_shm_find(port_name, pid, reply);
+	if (port == NULL) {
+		messaging_shm_unlock();
+		set_errno(ENOENT);
+		return ERROR;
+	}
+
+	messaging_shm_remove(port);
+	messaging_shm_unlock();
+	return OK;
+}
+
+/****************************************************************************
+ * Name : messaging_shm_send
+ *
+ * Description:
+ *  Send a message to one or more ports.  The message is copied once into a
+ *  payload buffer shared by all the ports, or straight into the buffer of
+ *  a waiting receiver.  The sender waits while a port is full.
+ *
+ * Return Value:
+ *  On success, 0 (OK) is returned.; On failure, -1 (ERROR) is returned.
+ ****************************************************************************/
+int messaging_shm_send(msg_shm_port_t **ports, int nports, msg_send_data_t *send_data, uint32_t send_type)
+{
+	msg_shm_buf_t *buf;
+	bool filled = false;
+	int notify_signo;
+	pid_t notify_pid;
+	void *notify_data;
+	int ret = OK;
+	int i;
+
+	/* The buffer is taken before the locked sections, which cannot allocate,
+	 * and filled only if a port cannot take the message straight away.
+	 */
+	buf = messaging_shm_getbuf(send_data->msglen);
+	if (buf != NULL) {
+		/* The sender holds a reference until all the ports have it */
+		buf->refs = 1;
+	}
+
+	for (i = 0; i < nports; i++) {
+		while (sem_wait(&ports[i]->slots) != OK) {
+		}
+
+		messaging_shm_lock();
+		if (ports[i]->unlinked) {
+			messaging_shm_unlock();
+			msgdbg("[Messaging] send fail : receiver is gone.\n");
+			ret = ERROR;
+			continue;
+		}
+
+		if (!filled && !messaging_shm_canhand(ports[i], send_data)) {
+			if (buf == NULL) {
+				messaging_shm_unlock();
+				sem_post(&ports[i]->slots);
+				msgdbg("[Messaging] send fail : out of memory for payload.\n");
+				ret = ERROR;
+				continue;
+			}
+
+			memcpy(buf->data, send_data->msg, send_data->msglen);
+			buf->msglen = send_data->msglen;
+			buf->sender_pid = getpid();
+			buf->msg_type = send_type;
+			buf->priority = send_data->priority;
+			filled = true;
+		}
+
+		(void)messaging_shm_enqueue(ports[i], buf, send_data, send_type);
+
+		notify_signo = ports[i]->notify_signo;
+		notify_pid = ports[i]->notify_pid;
+		notify_data = ports[i]->notify_data;
+		ports[i]->notify_signo = 0;
+		messaging_shm_unlock();
+
+		if (notify_signo != 0) {
+			(void)messaging_shm_signal(notify_pid, notify_signo, notify_data);
+		}
+	}
+
+	if (buf != NULL) {
+		messaging_shm_lock();
+		messaging_shm_putbuf(buf);
+		messaging_shm_unlock();
+	}
+
+	return ret;
+}
+
+/****************************************************************************
+ * Name : messaging_shm_recv
+ *
+ * Description:
+ *  Receive the message of highest priority of a port into 'recv_buf'.
+ *  If the port is empty, wait if 'block' is true, else fail with EAGAIN.
+ *  A message longer than the buffer is dropped and fails with EMSGSIZE.
+ *
+ * Return Value:
+ *  On success, 0 (OK) is returned and *msg_type is set.
+ *  On failure, -1 (ERROR) is returned.
+ ****************************************************************************/
+int messaging_shm_recv(msg_shm_port_t *port, msg_recv_buf_t *recv_buf, int *msg_type, bool block)
+{
+	msg_shm_buf_t *buf;
+	int ret;
+
+	if (!block) {
+		if (sem_trywait(&port->items) != OK) {
+			return ERROR;
+		}
+	} else {
+		messaging_shm_lock();
+		if (port->count == 0) {
+			/* Let the next sender copy the message straight to us */
+			port->waiter = recv_buf;
+			port->handed = false;
+		}
+		messaging_shm_unlock();
+
+		while (sem_wait(&port->items) != OK) {
+		}
+	}
+
+	messaging_shm_lock();
+	if (port->handed) {
+		port->handed = false;
+		*msg_type = port->handed_type;
+		messaging_shm_unlock();
+		return OK;
+	}
+
+	DEBUGASSERT(port->count > 0);
+	buf = port->ring[port->head];
+	port->head = (port->head + 1) % CONFIG_MESSAGING_MAXMSG;
+	port->count--;
+	messaging_shm_unlock();
+
+	sem_post(&port->slots);
+
+	/* A message too large for the buffer is dropped */
+	ret = messaging_shm_copyout(recv_buf, buf->data, buf->msglen, buf->sender_pid);
+	*msg_type = buf->msg_type;
+
+	messaging_shm_lock();
+	messaging_shm_putbuf(buf);
+	messaging_shm_unlock();
+	return ret;
+}
+
+/****************************************************************************
+ * Name : messaging_shm_notify
+ *
+ * Description:
+ *  Queue 'signo' with 'data' to the calling task when a message arrives in
+ *  the port, once.  If the port is not empty, the signal is queued now.
+ ****************************************************************************/
+int messaging_shm_notify(msg_shm_port_t *port, int signo, void *data)
+{
+	bool pending;
+
+	messaging_shm_lock();
+	pending = port->count > 0;
+	if (!pending) {
+		port->notify_signo = signo;
+		port->notify_pid = getpid();
+		port->notify_data = data;
+	}
+	messaging_shm_unlock();
+
+	/* The handler may run right away: signal only once unlocked */
+	if (pending) {
+		return messaging_shm_signal(getpid(), signo, data);
+	}
+	return OK;
+}
+#endif
@@ -40,16 +40,47 @@ static int messaging_set_async_callback(const char *port_name, msg_recv_buf_t *r
 {
 	int ret;
 	msg_recv_info_t *data;
+#ifndef CONFIG_MESSAGING_SHM
 	struct mq_attr internal_attr;
 	int recv_size;
 	char *reply_portname;
 	mqd_t mqdes;
+#endif
 
 	ret = messaging_set_notify_signal(SIGMSG_MESSAGING, (_sa_sigaction_t)messaging_run_callback);
 	if (ret != OK) {
 		return ERROR;
 	}
 
+#ifdef CONFIG_MESSAGING_SHM
+	/* The reply comes to the reply port of this task, which the callback
+	 * wrapper removes after the reply is delivered.
+	 */
+	data = (msg_recv_info_t *)MSG_ALLOC(sizeof(msg_recv_info_t));
+	if (data == NULL) {
+		msgdbg("[Messaging] send fail : out of memory for recv info.\n");
+		return ERROR;
+	}
+
+	data->port = messaging_shm_open(port_name, getpid(), true, true);
+	if (data->port == NULL) {
+		msgdbg("[Messaging] send fail : open fail, errno %d.\n", errno);
+		MSG_FREE(data);
+		return ERROR;
+	}
+	data->msg = recv_data;
+	data->user_cb = param->cb_func;
+	data->cb_data = param->cb_data;
+	data->port_name[0] = '\0';
+
+	ret = messaging_shm_notify(data->port, SIGMSG_MESSAGING, data);
+	if (ret != OK) {
+		messaging_shm_close_reply(data->port);
+		MSG_FREE(data);
+		return ERROR;
+	}
+	return OK;
+#else
 	recv_size = MSG_HEADER_SIZE + recv_data->buflen;
 
 	internal_attr.mq_maxmsg = CONFIG_MESSAGING_MAXMSG;
@@ -88,7 +119,25 @@ static int messaging_set_async_callback(const char *port_name, msg_recv_buf_t *r
 		return ERROR;
 	}
 	return OK;
+#endif
 }
+/****************************************************************************
+ * Name : messaging_get_packet_type
+ *
+ * Description:
+ *  This function returns the message type carried by the packet, which the
+ *  receiver gets.
+ ****************************************************************************/
+uint32_t messaging_get_packet_type(msg_send_type_t msg_type)
+{
+	if (msg_type == MSG_SEND_NOREPLY || msg_type == MSG_SEND_MULTI) {
+		return MSG_REPLY_NO_REQUIRED;
+	} else if (msg_type == MSG_SEND_REPLY) {
+		return MSG_SEND_REPLY;
+	}
+	return MSG_REPLY_REQUIRED;
+}
+
 /****************************************************************************
  * Name : messaging_send_packet
  * 
@@ -155,13 +204,7 @@ int messaging_send_packet(const char *port_name, msg_send_type_t msg_type, msg_s
 	((messaging_packet_t *)send_packet)->sender_pid = getpid();
 
 	/* Add data header for send type. */
-	if (msg_type == MSG_SEND_NOREPLY || msg_type == MSG_SEND_MULTI) {
-		send_type = MSG_REPLY_NO_REQUIRED;
-	} else if (msg_type == MSG_SEND_REPLY) {
-		send_type = MSG_SEND_REPLY;
-	} else {
-		send_type = MSG_REPLY_REQUIRED;
-	}
+	send_type = messaging_get_packet_type(msg_type);
 	((messaging_packet_t *)send_packet)->msg_type = send_type;
 
 	/* Copy the real send message. */
@@ -181,6 +224,46 @@ int messaging_send_packet(const char *port_name, msg_send_type_t msg_type, msg_s
 	return ret;
 }
 
+#ifdef CONFIG_MESSAGING_SHM
+/****************************************************************************
+ * Name : messaging_send_shm
+ *
+ * Description:
+ *  This function sends the message to the ports of the receivers in
+ *  'recv_arr' at once: a multicast message is shared by reference.
+ ****************************************************************************/
+static int messaging_send_shm(const char *port_name, msg_send_type_t msg_type, msg_send_data_t *send_data, int *recv_arr, int recv_cnt)
+{
+	msg_shm_port_t *ports[CONFIG_MESSAGING_RECV_LIST_SIZE];
+	int nports = 0;
+	int recv_idx;
+	int ret;
+
+	for (recv_idx = 0; recv_idx < recv_cnt; recv_idx++) {
+		if (recv_arr[recv_idx] == MSG_RECV_NOT_INIT) {
+			continue;
+		}
+		ports[nports] = messaging_shm_open(port_name, recv_arr[recv_idx], false, false);
+		if (ports[nports] == NULL) {
+			msgdbg("[Messaging] send fail : no receiver.\n");
+			continue;
+		}
+		nports++;
+	}
+
+	if (nports == 0) {
+		return ERROR;
+	}
+
+	ret = messaging_shm_send(ports, nports, send_data, messaging_get_packet_type(msg_type));
+
+	while (nports > 0) {
+		messaging_shm_close(ports[--nports]);
+	}
+	return ret;
+}
+#endif
+
 static void messaging_init_recv_arr(int *arr)
 {
 	int arr_idx;
@@ -206,12 +289,15 @@ static void messaging_init_recv_arr(int *arr)
  ****************************************************************************/
 int messaging_send_internal(const char *port_name, msg_send_type_t msg_type, msg_send_data_t *send_data, msg_recv_buf_t *recv_data, msg_callback_info_t *cb_info)
 {
-	int recv_idx;
 	int ret = ERROR;
 	int read_status = MSG_READ_YET;
 	int recv_arr[CONFIG_MESSAGING_RECV_LIST_SIZE];
-	char *private_portname;
 	int recv_cnt;
+	int total_cnt = 0;
+#ifndef CONFIG_MESSAGING_SHM
+	int recv_idx;
+	char *private_portname;
+#endif
 
 	/* Check that how many receivers are waiting. */
 	while (read_status != MSG_READ_ALL) {
@@ -220,12 +306,25 @@ int messaging_send_internal(const char *port_name, msg_send_type_t msg_type, msg
 		if (read_status == ERROR) {
 			return ERROR;
 		}
+		total_cnt += recv_cnt;
 
-		if (msg_type != MSG_SEND_MULTI && recv_cnt > 1) {
-			msgdbg("[Messaging] send fail : too many receivers(%d)are waiting.\n", recv_cnt);
+		if (msg_type != MSG_SEND_MULTI && total_cnt > 1) {
+			msgdbg("[Messaging] send fail : too many receivers(%d)are waiting.\n", total_cnt);
 			return ERROR;
 		}
 
+#ifdef CONFIG_MESSAGING_SHM
+		if (recv_cnt == 0) {
+			continue;
+		}
+		if (msg_type == MSG_SEND_ASYNC) {
+			ret = messaging_set_async_callback(port_name, recv_data, cb_info);
+			if (ret != OK) {
+				return ERROR;
+			}
+		}
+		ret = messaging_send_shm(port_name, msg_type, send_data, recv_arr, recv_cnt);
+#else
 		/* Send message to each receivers. */
 		for (recv_idx = 0; recv_idx < recv_cnt; recv_idx++) {
 			if (recv_arr[recv_idx] == MSG_RECV_NOT_INIT) {
@@ -250,9 +349,10 @@ int messaging_send_internal(const char *port_name, msg_send_type_t msg_type, msg
 			}
 			MSG_FREE(private_portname);
 		}
+#endif
 	}
 	if (ret == OK) {
-		return recv_cnt;
+		return total_cnt;
 	}
 	return ret;
 }
@@ -47,6 +47,7 @@ static int messaging_send_param_validation(const char *port_name, msg_send_data_
 
 	return OK;
 }
+#ifndef CONFIG_MESSAGING_SHM
 static int messaging_sync_recv(const char *port_name, msg_recv_buf_t *reply_buf)
 {
 	int ret = OK;
@@ -102,6 +103,7 @@ static int messaging_sync_recv(const char *port_name, msg_recv_buf_t *reply_buf)
 
 	return ret;
 }
+#endif
 
 /****************************************************************************
  * public functions
@@ -112,6 +114,10 @@ static int messaging_sync_recv(const char *port_name, msg_recv_buf_t *reply_buf)
 int messaging_send_sync(const char *port_name, msg_send_data_t *send_data, msg_recv_buf_t *reply_buf)
 {
 	int ret;
+#ifdef CONFIG_MESSAGING_SHM
+	msg_shm_port_t *reply_port;
+	int msg_type;
+#endif
 
 	ret = messaging_send_param_validation(port_name, send_data);
 	if (ret == ERROR) {
@@ -123,6 +129,26 @@ int messaging_send_sync(const char *port_name, msg_send_data_t *send_data, msg_r
 		return ERROR;
 	}
 
+#ifdef CONFIG_MESSAGING_SHM
+	/* The reply port is open before the request is sent so that the reply
+	 * cannot come first, and removed once the reply is received.
+	 */
+	reply_port = messaging_shm_open(port_name, getpid(), true, true);
+	if (reply_port == NULL) {
+		msgdbg("[Messaging] unicast send sync fail : reply port open fail %d.\n", errno);
+		return ERROR;
+	}
+
+	ret = messaging_send_internal(port_name, MSG_SEND_SYNC, send_data, NULL, NULL);
+	if (ret != ERROR) {
+		ret = messaging_shm_recv(reply_port, reply_buf, &msg_type, true);
+	}
+
+	messaging_shm_close_reply(reply_port);
+	if (ret == ERROR) {
+		return ERROR;
+	}
+#else
 	ret = messaging_send_internal(port_name, MSG_SEND_SYNC, send_data, NULL, NULL);
 	if (ret == ERROR) {
 		return ERROR;
@@ -132,6 +158,7 @@ int messaging_send_sync(const char *port_name, msg_send_data_t *send_data, msg_r
 	if (ret != OK) {
 		return ERROR;
 	}
+#endif
 
 	return OK;	
 }
@@ -196,7 +223,11 @@ int messaging_send(const char *port_name, msg_send_data_t *send_data)
 int messaging_reply(const char *port_name, pid_t sender_pid, msg_send_data_t *reply_data)
 {
 	int ret = OK;
+#ifdef CONFIG_MESSAGING_SHM
+	msg_shm_port_t *reply_port;
+#else
 	char *reply_portname;
+#endif
 	msg_send_data_t reply;
 
 	if (port_name == NULL || sender_pid < 0 || reply_data == NULL || reply_data->msg == NULL || reply_data->msglen <= 0) {
@@ -204,6 +235,21 @@ int messaging_reply(const char *port_name, pid_t sender_pid, msg_send_data_t *re
 		return ERROR;
 	}
 
+#ifdef CONFIG_MESSAGING_SHM
+	reply_port = messaging_shm_open(port_name, sender_pid, true, false);
+	if (reply_port == NULL) {
+		msgdbg("[Messaging] unicast reply fail : no reply port.\n");
+		return ERROR;
+	}
+
+	reply.msg = reply_data->msg;
+	reply.msglen = reply_data->msglen;
+	reply.priority = MSG_REPLY_PRIO;
+	ret = messaging_shm_send(&reply_port, 1, &reply, messaging_get_packet_type(MSG_SEND_REPLY));
+	messaging_shm_close(reply_port);
+	return ret;
+#else
+
 	/* Sender waits the reply with "port_name + sender_pid + _r". */
 	MSG_ASPRINTF(&reply_portname, "%s%d%s", port_name, sender_pid, "_r");
 	if (reply_portname == NULL) {
@@ -217,4 +263,5 @@ int messaging_reply(const char *port_name, pid_t sender_pid, msg_send_data_t *re
 	ret = messaging_send_packet(reply_portname, MSG_SEND_REPLY, &reply, NULL);
 	MSG_FREE(reply_portname);
 	return ret;
+#endif
 }
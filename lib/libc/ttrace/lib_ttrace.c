@@ -68,6 +68,7 @@ int fd = -1;
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
+#ifndef CONFIG_TTRACE_BINARY
 static int is_fd_available(void)
 {
 	if (fd < 0) {
@@ -344,3 +345,50 @@ int trace_end_uid(int tag)
 	return trace_end(tag);
 }
 
+#else							/* CONFIG_TTRACE_BINARY */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* In binary mode, the events go straight to the buffer of the kernel, which
+ * checks the selected tags and takes the timestamp.  trace_sched() is
+ * provided by the kernel.
+ */
+
+int trace_begin(int tag, char *str, ...)
+{
+	char message[TTRACE_MSG_BYTES];
+	va_list ap;
+
+	/* Format the string only if it has to be */
+
+	if (strchr(str, '%') != NULL) {
+		va_start(ap, str);
+		vsnprintf(message, TTRACE_MSG_BYTES, str, ap);
+		va_end(ap);
+		str = message;
+	}
+
+	ttrace_event(tag, TTRACE_EVENT_BEGIN, ttrace_intern(str), 0);
+	return TTRACE_VALID;
+}
+
+int trace_begin_uid(int tag, int8_t uniqueid)
+{
+	ttrace_event(tag, TTRACE_EVENT_BEGIN_UID, (uint8_t)uniqueid, 0);
+	return TTRACE_VALID;
+}
+
+int trace_end(int tag)
+{
+	ttrace_event(tag, TTRACE_EVENT_END, 0, 0);
+	return TTRACE_VALID;
+}
+
+int trace_end_uid(int tag)
+{
+	ttrace_event(tag, TTRACE_EVENT_END_UID, 0, 0);
+	return TTRACE_VALID;
+}
+#endif							/* CONFIG_TTRACE_BINARY */
@@ -61,6 +61,7 @@
 #include <debug.h>
 
 #include <tinyara/arch.h>
+#include <tinyara/ttrace.h>
 
 #include "sched/sched.h"
 #include "up_internal.h"
@@ -154,6 +155,9 @@ void up_block_task(struct tcb_s *tcb, tstate_t task_state)
 			 */
 
 			up_savestate(rtcb->xcp.regs);
+#ifdef CONFIG_TTRACE_BINARY
+			trace_sched(rtcb, this_task());
+#endif
 
 			/* Restore the exception context of the rtcb at the (new) head
 			 * of the g_readytorun task list.
@@ -191,6 +195,9 @@ void up_block_task(struct tcb_s *tcb, tstate_t task_state)
 #ifdef CONFIG_TASK_SCHED_HISTORY
 			/* Save the task name which will be scheduled */
 			save_task_scheduling_status(nexttcb);
+#endif
+#ifdef CONFIG_TTRACE_BINARY
+			trace_sched(rtcb, nexttcb);
 #endif
 			up_switchcontext(rtcb->xcp.regs, nexttcb->xcp.regs);
 
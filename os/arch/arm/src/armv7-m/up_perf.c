@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/arm/src/armv7-m/up_perf.c
+ *
+ * Free-running cycle counter based on the DWT cycle counter.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <time.h>
+
+#include <tinyara/arch.h>
+
+#include "up_arch.h"
+#include "nvic.h"
+#include "dwt.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_perf_init
+ ****************************************************************************/
+
+void up_perf_init(void)
+{
+	modifyreg32(NVIC_DEMCR, 0, NVIC_DEMCR_TRCENA);
+	putreg32(0, DWT_CYCCNT);
+	modifyreg32(DWT_CTRL, 0, DWT_CTRL_CYCCNTENA_Msk);
+}
+
+/****************************************************************************
+ * Name: up_perf_gettime
+ ****************************************************************************/
+
+uint32_t up_perf_gettime(void)
+{
+	return getreg32(DWT_CYCCNT);
+}
+
+/****************************************************************************
+ * Name: up_perf_getfreq
+ *
+ * Description:
+ *   The counter runs at the core clock.  SysTick counts the same clock
+ *   when it drives the system timer, which gives the core clock frequency
+ *   without knowing the board.  Zero is returned if SysTick is stopped
+ *   (e.g. another timer drives the system timer) or counts another clock.
+ *
+ ****************************************************************************/
+
+uint32_t up_perf_getfreq(void)
+{
+	uint32_t ctrl = getreg32(NVIC_SYSTICK_CTRL);
+
+	if ((ctrl & NVIC_SYSTICK_CTRL_ENABLE) == 0 || (ctrl & NVIC_SYSTICK_CTRL_CLKSOURCE) == 0) {
+		return 0;
+	}
+
+	return ((getreg32(NVIC_SYSTICK_RELOAD) & NVIC_SYSTICK_RELOAD_MASK) + 1) * CLK_TCK;
+}
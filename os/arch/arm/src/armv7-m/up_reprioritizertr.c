@@ -61,6 +61,7 @@
 #include <sched.h>
 #include <debug.h>
 #include <tinyara/arch.h>
+#include <tinyara/ttrace.h>
 
 #include "sched/sched.h"
 #include "up_internal.h"
@@ -169,6 +170,9 @@ void up_reprioritize_rtr(struct tcb_s *tcb, uint8_t priority)
 				 */
 
 				up_savestate(rtcb->xcp.regs);
+#ifdef CONFIG_TTRACE_BINARY
+				trace_sched(rtcb, this_task());
+#endif
 
 				/* Restore the exception context of the rtcb at the (new) head
 				 * of the g_readytorun task list.
@@ -205,6 +209,9 @@ void up_reprioritize_rtr(struct tcb_s *tcb, uint8_t priority)
 #ifdef CONFIG_TASK_SCHED_HISTORY
 				/* Save the task name which will be scheduled */
 				save_task_scheduling_status(nexttcb);
+#endif
+#ifdef CONFIG_TTRACE_BINARY
+				trace_sched(rtcb, nexttcb);
 #endif
 				up_switchcontext(rtcb->xcp.regs, nexttcb->xcp.regs);
 
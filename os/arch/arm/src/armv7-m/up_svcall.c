@@ -64,6 +64,7 @@
 #include <arch/irq.h>
 #include <tinyara/sched.h>
 #include <tinyara/userspace.h>
+#include <tinyara/ttrace.h>
 
 #ifdef CONFIG_LIB_SYSCALL
 #include <syscall.h>
@@ -348,6 +349,7 @@ int up_svcall(int irq, FAR void *context, FAR void *arg)
 		 */
 
 		regs[REG_R0] = regs[REG_R2];
+		trace_event(TTRACE_TAG_SYSCALL, TTRACE_EVENT_SYSCALL_LEAVE, regs[REG_R0], 0);
 	}
 	break;
 #endif
@@ -561,6 +563,7 @@ int up_svcall(int irq, FAR void *context, FAR void *arg)
 		rtcb->xcp.syscall[index].excreturn = regs[REG_EXC_RETURN];
 #endif
 		rtcb->xcp.nsyscalls = index + 1;
+		trace_event(TTRACE_TAG_SYSCALL, TTRACE_EVENT_SYSCALL_ENTER, cmd, 0);
 
 		regs[REG_PC] = (uint32_t)dispatch_syscall;
 #if defined(CONFIG_BUILD_PROTECTED)
@@ -59,6 +59,7 @@
 #include <sched.h>
 #include <debug.h>
 #include <tinyara/arch.h>
+#include <tinyara/ttrace.h>
 
 #include "sched/sched.h"
 #include "clock/clock.h"
@@ -140,6 +141,9 @@ void up_unblock_task(struct tcb_s *tcb)
 			 */
 
 			up_savestate(rtcb->xcp.regs);
+#ifdef CONFIG_TTRACE_BINARY
+			trace_sched(rtcb, this_task());
+#endif
 
 			/* Restore the exception context of the rtcb at the (new) head
 			 * of the g_readytorun task list.
@@ -177,6 +181,9 @@ void up_unblock_task(struct tcb_s *tcb)
 #ifdef CONFIG_TASK_SCHED_HISTORY
 			/* Save the task name which will be scheduled */
 			save_task_scheduling_status(nexttcb);
+#endif
+#ifdef CONFIG_TTRACE_BINARY
+			trace_sched(rtcb, nexttcb);
 #endif
 			up_switchcontext(rtcb->xcp.regs, nexttcb->xcp.regs);
 
@@ -71,6 +71,10 @@
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
 #include <tinyara/mm/mm.h>
 #endif
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+#include <tinyara/clock.h>
+#include <tinyara/binary_manager.h>
+#endif
 
 #include "sched/sched.h"
 #include "binfmt.h"
@@ -115,6 +119,9 @@ static void exec_ctors(FAR void *arg)
 {
 	FAR const struct binary_s *binp = (FAR const struct binary_s *)arg;
 	binfmt_ctor_t *ctor = binp->ctors;
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+	clock_t start = clock_systimer();
+#endif
 	int i;
 
 	/* Execute each constructor */
@@ -125,6 +132,12 @@ static void exec_ctors(FAR void *arg)
 		(*ctor)();
 		ctor++;
 	}
+
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+	if (binp->loadtime != NULL) {
+		binp->loadtime->ctors = clock_systimer() - start;
+	}
+#endif
 }
 #endif
 
@@ -123,6 +123,9 @@ int load_binary(int binary_idx, FAR const char *filename, load_attr_t *load_attr
 	bin->uheap_size = size;
 #endif
 	bin->compression_type = load_attr->compression_type;
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+	bin->loadtime = &BIN_LOADTIME(binary_idx);
+#endif
 
 	/* Load the module into memory */
 
@@ -65,6 +65,10 @@
 #include <tinyara/arch.h>
 #include <tinyara/binfmt/binfmt.h>
 #include <tinyara/binfmt/elf.h>
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+#include <tinyara/clock.h>
+#include <tinyara/binary_manager.h>
+#endif
 
 #include "libelf/libelf.h"
 
@@ -232,6 +236,10 @@ static void elf_dumpentrypt(FAR struct binary_s *binp, FAR struct elf_loadinfo_s
 static int elf_loadbinary(FAR struct binary_s *binp)
 {
 	struct elf_loadinfo_s loadinfo;	/* Contains globals for libelf */
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+	clock_t start = clock_systimer();
+	clock_t loaded;
+#endif
 	int ret;
 
 	binfo("Loading file: %s\n", binp->filename);
@@ -265,6 +273,10 @@ static int elf_loadbinary(FAR struct binary_s *binp)
 		goto errout_with_init;
 	}
 
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+	loaded = clock_systimer();
+#endif
+
 	/* Bind the program to the exported symbol table */
 
 	ret = elf_bind(&loadinfo, binp->exports, binp->nexports);
@@ -273,6 +285,21 @@ static int elf_loadbinary(FAR struct binary_s *binp)
 		goto errout_with_load;
 	}
 
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+	if (binp->loadtime != NULL) {
+		if (loadinfo.compression_type > COMPRESS_TYPE_NONE) {
+			binp->loadtime->read = 0;
+			binp->loadtime->decompress = loaded - start;
+		} else {
+			binp->loadtime->read = loaded - start;
+			binp->loadtime->decompress = 0;
+		}
+
+		binp->loadtime->relocate = clock_systimer() - loaded;
+		binp->loadtime->ctors = 0;
+	}
+#endif
+
 	/* Return the load information */
 
 	binp->entrypt = (main_t)(loadinfo.textalloc + loadinfo.ehdr.e_entry);
@@ -57,6 +57,7 @@
 #include <tinyara/config.h>
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <assert.h>
@@ -95,6 +96,30 @@
  * Private Data
  ****************************************************************************/
 
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#ifdef CONFIG_ELF_BATCH_RELOC
+/* Resolution state of a symbol of the ELF symbol table */
+
+enum elf_symstate_e {
+	ELF_SYM_UNRESOLVED = 0,		/* st_value not updated yet */
+	ELF_SYM_RESOLVED,			/* st_value holds the value of the symbol */
+	ELF_SYM_NONAME				/* Undefined symbol without a name */
+};
+
+/* Scratch memory of elf_bind(), allocated at once */
+
+struct elf_scratch_s {
+	FAR void *arena;			/* The allocation holding the arrays below */
+	FAR const struct symtab_s *exports;	/* Exports, sorted by name */
+	FAR Elf32_Rel *rels;		/* CONFIG_ELF_RELOC_CHUNKSIZE relocations */
+	FAR uint8_t *symstate;		/* enum elf_symstate_e of each ELF symbol */
+	int nsyms;					/* Number of ELF symbols */
+};
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -117,6 +142,11 @@ static inline void elf_readreltab(FAR struct elf_loadinfo_s *loadinfo, FAR const
 
 	if (elf_read(loadinfo, (FAR uint8_t *)loadinfo->reltab, relsec->sh_size, relsec->sh_offset) < 0) {
 		berr("ERROR: Failed to read relocation table into memory\n");
+
+		/* Fall back on reading the entries from the file */
+
+		kmm_free((FAR void *)loadinfo->reltab);
+		loadinfo->reltab = 0;
 	}
 }
 
@@ -263,6 +293,213 @@ ret_err:
 	return ret;
 }
 
+#ifdef CONFIG_ELF_BATCH_RELOC
+/****************************************************************************
+ * Name: elf_cmpexports
+ *
+ * Description:
+ *   qsort() comparison of exported symbols by name.
+ *
+ ****************************************************************************/
+
+static int elf_cmpexports(FAR const void *a, FAR const void *b)
+{
+	return strcmp(((FAR const struct symtab_s *)a)->sym_name, ((FAR const struct symtab_s *)b)->sym_name);
+}
+
+/****************************************************************************
+ * Name: elf_allocscratch
+ *
+ * Description:
+ *   Allocate the scratch memory of the batched relocation and sort a copy
+ *   of the exported symbols in it, unless they already are.  The symbol
+ *   table must have been read into memory.
+ *
+ * Returned Value:
+ *   0 (OK) is returned on success and a negated errno is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+static int elf_allocscratch(FAR struct elf_loadinfo_s *loadinfo, FAR struct elf_scratch_s *scratch, FAR const struct symtab_s *exports, int nexports)
+{
+	FAR struct symtab_s *sorted;
+	size_t expsize = 0;
+	size_t relsize;
+	FAR uint8_t *arena;
+
+	scratch->nsyms = loadinfo->shdr[loadinfo->symtabidx].sh_size / sizeof(Elf32_Sym);
+
+#ifndef CONFIG_SYMTAB_ORDEREDBYNAME
+	expsize = nexports * sizeof(struct symtab_s);
+#endif
+	relsize = CONFIG_ELF_RELOC_CHUNKSIZE * sizeof(Elf32_Rel);
+
+	/* The exports and the relocations come first to keep them aligned */
+
+	arena = (FAR uint8_t *)kmm_malloc(expsize + relsize + scratch->nsyms);
+	if (arena == NULL) {
+		return -ENOMEM;
+	}
+
+	scratch->arena = arena;
+	scratch->rels = (FAR Elf32_Rel *)(arena + expsize);
+	scratch->symstate = arena + expsize + relsize;
+	memset(scratch->symstate, ELF_SYM_UNRESOLVED, scratch->nsyms);
+
+	if (expsize > 0) {
+		sorted = (FAR struct symtab_s *)arena;
+		memcpy(sorted, exports, expsize);
+		qsort(sorted, nexports, sizeof(struct symtab_s), elf_cmpexports);
+		scratch->exports = sorted;
+	} else {
+		scratch->exports = exports;
+	}
+
+	loadinfo->exportsorted = true;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: elf_freescratch
+ ****************************************************************************/
+
+static void elf_freescratch(FAR struct elf_loadinfo_s *loadinfo, FAR struct elf_scratch_s *scratch)
+{
+	if (scratch->arena != NULL) {
+		kmm_free(scratch->arena);
+		scratch->arena = NULL;
+	}
+
+	loadinfo->exportsorted = false;
+}
+
+/****************************************************************************
+ * Name: elf_getsym
+ *
+ * Description:
+ *   Return the symbol at 'index' of the in-memory symbol table, resolving
+ *   its value on the first call only.  A NULL symbol is returned for an
+ *   undefined symbol without a name, as expected by up_relocate().
+ *
+ * Returned Value:
+ *   0 (OK) is returned on success and a negated errno is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+static int elf_getsym(FAR struct elf_loadinfo_s *loadinfo, FAR struct elf_scratch_s *scratch, int index, int nexports, FAR Elf32_Sym **psym)
+{
+	FAR Elf32_Sym *sym;
+	int ret;
+
+	if (index < 0 || index >= scratch->nsyms) {
+		berr("Bad relocation symbol index: %d\n", index);
+		return -EINVAL;
+	}
+
+	sym = (FAR Elf32_Sym *)loadinfo->symtab + index;
+
+	switch (scratch->symstate[index]) {
+	case ELF_SYM_RESOLVED:
+		*psym = sym;
+		return OK;
+
+	case ELF_SYM_NONAME:
+		*psym = NULL;
+		return OK;
+
+	default:
+		break;
+	}
+
+	/* elf_symvalue() updates st_value in place, hence only once */
+
+	ret = elf_symvalue(loadinfo, sym, scratch->exports, nexports);
+	if (ret == -ESRCH) {
+		/* See elf_relocate() about the relocations without symbol name */
+
+		berr("Undefined symbol[%d] has no name\n", index);
+		scratch->symstate[index] = ELF_SYM_NONAME;
+		*psym = NULL;
+		return OK;
+	} else if (ret < 0) {
+		berr("Failed to get value of symbol[%d]: %d\n", index, ret);
+		return ret;
+	}
+
+	scratch->symstate[index] = ELF_SYM_RESOLVED;
+	*psym = sym;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: elf_relocatebatch
+ *
+ * Description:
+ *   Perform all relocations associated with a section as elf_relocate()
+ *   does, but reading CONFIG_ELF_RELOC_CHUNKSIZE relocation entries at a
+ *   time into the scratch memory and using the memoized symbol values.
+ *
+ * Returned Value:
+ *   0 (OK) is returned on success and a negated errno is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+static int elf_relocatebatch(FAR struct elf_loadinfo_s *loadinfo, FAR struct elf_scratch_s *scratch, int relidx, int nexports)
+{
+	FAR Elf32_Shdr *relsec = &loadinfo->shdr[relidx];
+	FAR Elf32_Shdr *dstsec = &loadinfo->shdr[relsec->sh_info];
+	FAR Elf32_Rel *rel;
+	FAR Elf32_Sym *psym;
+	uintptr_t addr;
+	int nrels = relsec->sh_size / sizeof(Elf32_Rel);
+	int first;
+	int count;
+	int ret;
+	int i;
+
+	for (first = 0; first < nrels; first += count) {
+		count = nrels - first;
+		if (count > CONFIG_ELF_RELOC_CHUNKSIZE) {
+			count = CONFIG_ELF_RELOC_CHUNKSIZE;
+		}
+
+		ret = elf_read(loadinfo, (FAR uint8_t *)scratch->rels, count * sizeof(Elf32_Rel), relsec->sh_offset + first * sizeof(Elf32_Rel));
+		if (ret < 0) {
+			berr("Section %d reloc %d: Failed to read relocation entries: %d\n", relidx, first, ret);
+			return ret;
+		}
+
+		for (i = 0; i < count; i++) {
+			rel = &scratch->rels[i];
+
+			ret = elf_getsym(loadinfo, scratch, ELF32_R_SYM(rel->r_info), nexports, &psym);
+			if (ret < 0) {
+				berr("Section %d reloc %d: Failed to get symbol: %d\n", relidx, first + i, ret);
+				return ret;
+			}
+
+			if (rel->r_offset > dstsec->sh_size - sizeof(uint32_t)) {
+				berr("Section %d reloc %d: Relocation address out of range, offset %d size %d\n", relidx, first + i, rel->r_offset, dstsec->sh_size);
+				return -EINVAL;
+			}
+
+			addr = dstsec->sh_addr + rel->r_offset;
+
+			ret = up_relocate(rel, psym, addr);
+			if (ret < 0) {
+				berr("ERROR: Section %d reloc %d: Relocation failed: %d\n", relidx, first + i, ret);
+				return ret;
+			}
+		}
+	}
+
+	return OK;
+}
+#endif
+
 static int elf_relocateadd(FAR struct elf_loadinfo_s *loadinfo, int relidx, FAR const struct symtab_s *exports, int nexports)
 {
 	berr("Not implemented\n");
@@ -290,6 +527,9 @@ int elf_bind(FAR struct elf_loadinfo_s *loadinfo, FAR const struct symtab_s *exp
 {
 #ifdef CONFIG_ARCH_ADDRENV
 	int status;
+#endif
+#ifdef CONFIG_ELF_BATCH_RELOC
+	struct elf_scratch_s scratch;
 #endif
 	int ret;
 	int i;
@@ -304,6 +544,17 @@ int elf_bind(FAR struct elf_loadinfo_s *loadinfo, FAR const struct symtab_s *exp
 	/* Read the symbol table into memory */
 	elf_readsymtab(loadinfo);
 
+#ifdef CONFIG_ELF_BATCH_RELOC
+	/* Relocate by batches if the symbol table could be read into memory and
+	 * the scratch memory allocated, entry by entry otherwise.
+	 */
+
+	memset(&scratch, 0, sizeof(struct elf_scratch_s));
+	if (loadinfo->symtab != 0 && elf_allocscratch(loadinfo, &scratch, exports, nexports) < 0) {
+		bwarn("WARNING: No memory for batched relocation\n");
+	}
+#endif
+
 	/* Allocate an I/O buffer.  This buffer is used by elf_symname() to
 	 * accumulate the variable length symbol name.
 	 */
@@ -347,7 +598,14 @@ int elf_bind(FAR struct elf_loadinfo_s *loadinfo, FAR const struct symtab_s *exp
 		/* Process the relocations by type */
 
 		if (loadinfo->shdr[i].sh_type == SHT_REL) {
-			ret = elf_relocate(loadinfo, i, exports, nexports);
+#ifdef CONFIG_ELF_BATCH_RELOC
+			if (scratch.arena != NULL) {
+				ret = elf_relocatebatch(loadinfo, &scratch, i, nexports);
+			} else
+#endif
+			{
+				ret = elf_relocate(loadinfo, i, exports, nexports);
+			}
 		} else if (loadinfo->shdr[i].sh_type == SHT_RELA) {
 			ret = elf_relocateadd(loadinfo, i, exports, nexports);
 		}
@@ -391,6 +649,10 @@ int elf_bind(FAR struct elf_loadinfo_s *loadinfo, FAR const struct symtab_s *exp
 #endif
 
 ret_err:
-	kmm_free(loadinfo->symtab);
+#ifdef CONFIG_ELF_BATCH_RELOC
+	elf_freescratch(loadinfo, &scratch);
+#endif
+	kmm_free((FAR void *)loadinfo->symtab);
+	loadinfo->symtab = 0;
 	return ret;
 }
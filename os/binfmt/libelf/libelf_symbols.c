@@ -225,8 +225,13 @@ void elf_readsymtab(FAR struct elf_loadinfo_s *loadinfo)
 		return;
 	}
 
-	if (elf_read(loadinfo, loadinfo->symtab, symtab->sh_size, symtab->sh_offset) < 0) {
+	if (elf_read(loadinfo, (FAR uint8_t *)loadinfo->symtab, symtab->sh_size, symtab->sh_offset) < 0) {
 		berr("ERROR: Failed to load symbol table into memory\n");
+
+		/* Fall back on reading the entries from the file */
+
+		kmm_free((FAR void *)loadinfo->symtab);
+		loadinfo->symtab = 0;
 	}
 }
 
@@ -341,8 +346,14 @@ int elf_symvalue(FAR struct elf_loadinfo_s *loadinfo, FAR Elf32_Sym *sym, FAR co
 
 		/* Check if the base code exports a symbol of this name */
 
-#ifdef CONFIG_SYMTAB_ORDEREDBYNAME
+#if defined(CONFIG_SYMTAB_ORDEREDBYNAME)
 		symbol = symtab_findorderedbyname(exports, (FAR char *)loadinfo->iobuffer, nexports);
+#elif defined(CONFIG_ELF_BATCH_RELOC)
+		if (loadinfo->exportsorted) {
+			symbol = nexports > 0 ? symtab_findorderedbyname(exports, (FAR char *)loadinfo->iobuffer, nexports) : NULL;
+		} else {
+			symbol = symtab_findbyname(exports, (FAR char *)loadinfo->iobuffer, nexports);
+		}
 #else
 		symbol = symtab_findbyname(exports, (FAR char *)loadinfo->iobuffer, nexports);
 #endif
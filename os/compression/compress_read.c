@@ -37,12 +37,48 @@
 #include <tinyara/miniz/miniz.h>
 #endif
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Read-ahead needs a second cache block to decompress into */
+
+#if defined(CONFIG_COMPRESSION_READAHEAD) && CONFIG_COMPRESSION_CACHE_BLOCKS > 1
+#define COMPRESSION_READAHEAD_BLOCKS 2
+#else
+#define COMPRESSION_READAHEAD_BLOCKS 1
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* A decompressed block held in out_buffer */
+struct s_cacheblock {
+	int block;					/* Block number, -1 if unused */
+	uint32_t stamp;				/* Time of last use, for LRU replacement */
+	unsigned char *data;		/* Decompressed data */
+};
+
+/* Statistics of the decompressed block cache for the current binary,
+ * reported by compress_uninit
+ */
+struct compress_cachestats_s {
+	uint32_t hits;				/* Blocks found in the cache */
+	uint32_t misses;			/* Blocks read and decompressed */
+	uint32_t readaheads;		/* Blocks decompressed ahead of a read */
+};
+
 /****************************************************************************
  * Private Declarations
  ****************************************************************************/
 
 static struct s_header *compression_header;
 static struct s_buffer buffers;
+static struct s_cacheblock cache[CONFIG_COMPRESSION_CACHE_BLOCKS];
+static uint32_t cache_clock;
+static int cache_lastblock;
+static struct compress_cachestats_s cachestats;
 
 /****************************************************************************
  * Private Functions
@@ -228,13 +264,14 @@ static off_t compress_lseek_block(int filfd, uint16_t binary_header_size, int bl
  * Name: compress_read_block
  *
  * Description:
- *   Read 'block_number' block from compressed blocks section into read_buffer
+ *   Read 'no_blocks' consecutive blocks from 'block_number' in compressed
+ *   blocks section into read_buffer with a single read
  *
  * Returned Value:
  *   Number of bytes read into read_buffer on Success
  *   Negative value on Failure
  ****************************************************************************/
-static off_t compress_read_block(int filfd, uint16_t binary_header_size, FAR uint8_t *buf, int block_number)
+static off_t compress_read_block(int filfd, uint16_t binary_header_size, FAR uint8_t *buf, int block_number, int no_blocks)
 {
 	off_t rpos;
 	size_t readsize;
@@ -242,10 +279,10 @@ static off_t compress_read_block(int filfd, uint16_t binary_header_size, FAR uin
 	off_t current_block_offset;
 	off_t next_block_offset;
 
-	/* Find out size of 'block_number' block in compressed file. Assign to readsize */
-	next_block_offset = compress_offset_block(filfd, binary_header_size, block_number + 1);
+	/* Find out size of the blocks in compressed file. Assign to readsize */
+	next_block_offset = compress_offset_block(filfd, binary_header_size, block_number + no_blocks);
 	if (next_block_offset < 0) {
-		bcmpdbg("Incorrect offset for block number %d\n", block_number + 1);
+		bcmpdbg("Incorrect offset for block number %d\n", block_number + no_blocks);
 		return ERROR;
 	}
 
@@ -278,6 +315,147 @@ static off_t compress_read_block(int filfd, uint16_t binary_header_size, FAR uin
 	return nbytes;
 }
 
+/****************************************************************************
+ * Name: compress_cache_lookup
+ *
+ * Description:
+ *   Find 'block_number' block among the decompressed blocks in cache
+ *
+ * Returned Value:
+ *   Cache entry of the block, or NULL if it is not cached
+ ****************************************************************************/
+static struct s_cacheblock *compress_cache_lookup(int block_number)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_COMPRESSION_CACHE_BLOCKS; i++) {
+		if (cache[i].block == block_number) {
+			return &cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+/****************************************************************************
+ * Name: compress_cache_victim
+ *
+ * Description:
+ *   Choose the cache entry to decompress a new block into: an unused entry
+ *   if there is one, otherwise the least recently used one
+ *
+ * Returned Value:
+ *   Cache entry to be replaced
+ ****************************************************************************/
+static struct s_cacheblock *compress_cache_victim(void)
+{
+	struct s_cacheblock *victim = &cache[0];
+	int i;
+
+	for (i = 0; i < CONFIG_COMPRESSION_CACHE_BLOCKS; i++) {
+		if (cache[i].block < 0) {
+			return &cache[i];
+		}
+		if (cache[i].stamp < victim->stamp) {
+			victim = &cache[i];
+		}
+	}
+
+	return victim;
+}
+
+/****************************************************************************
+ * Name: compress_get_block
+ *
+ * Description:
+ *   Return the decompressed data of 'block_number' block, from the cache if
+ *   possible.  Otherwise the block is read and decompressed into the least
+ *   recently used cache entry.  When blocks are read in sequence and
+ *   CONFIG_COMPRESSION_READAHEAD is enabled, the next block is read with
+ *   the same read and decompressed into the cache as well.
+ *
+ * Returned Value:
+ *   Decompressed data of the block on Success
+ *   NULL on Failure
+ ****************************************************************************/
+static unsigned char *compress_get_block(int filfd, uint16_t binary_header_size, int block_number, int last_block)
+{
+	struct s_cacheblock *entry;
+	int no_blocks = 1;
+	int index;
+	int ret;
+	off_t nbytes;
+	unsigned char *read_buffer;
+#if CONFIG_COMPRESSION_TYPE == LZMA
+	unsigned int writesize;
+	unsigned int size;
+#elif CONFIG_COMPRESSION_TYPE == MINIZ
+	long unsigned int writesize;
+	long unsigned int size;
+#endif
+
+	entry = compress_cache_lookup(block_number);
+	if (entry) {
+		cachestats.hits++;
+		entry->stamp = ++cache_clock;
+		cache_lastblock = block_number;
+		return entry->data;
+	}
+
+	cachestats.misses++;
+
+#if COMPRESSION_READAHEAD_BLOCKS > 1
+	/* Read ahead if the reader moves on to the next block, or the next block
+	 * is part of this request too.  Both blocks must fit in read_buffer.
+	 */
+	if (block_number + 1 < compression_header->sections && !compress_cache_lookup(block_number + 1) && (block_number == cache_lastblock + 1 || block_number < last_block)) {
+		if (compression_header->secoff[block_number + 2] - compression_header->secoff[block_number] <= buffers.read_size) {
+			no_blocks = 2;
+		}
+	}
+#endif
+
+	/* Read compressed blocks into read_buffer */
+	nbytes = compress_read_block(filfd, binary_header_size, buffers.read_buffer, block_number, no_blocks);
+	if (nbytes < 0) {
+		bcmpdbg("Read for compressed block %d failed\n", block_number);
+		return NULL;
+	}
+
+	/* Decompress each block in read_buffer into a cache entry */
+	read_buffer = buffers.read_buffer;
+	for (index = block_number; index < block_number + no_blocks; index++) {
+		size = compression_header->secoff[index + 1] - compression_header->secoff[index];
+
+		entry = compress_cache_victim();
+		entry->block = -1;
+		ret = compress_decompress_block(entry->data, &writesize, read_buffer, &size, index);
+		if (ret == ERROR) {
+			bcmpdbg("Failed to decompress %d block of this binary\n", index);
+			if (index == block_number) {
+				return NULL;
+			}
+			break;
+		}
+
+		entry->block = index;
+		entry->stamp = ++cache_clock;
+		read_buffer += compression_header->secoff[index + 1] - compression_header->secoff[index];
+		if (index != block_number) {
+			cachestats.readaheads++;
+		}
+	}
+
+	/* The read-ahead block is the most recently used one; make sure the
+	 * requested block is not evicted before it.
+	 */
+	entry = compress_cache_lookup(block_number);
+	entry->stamp = ++cache_clock;
+	cache_lastblock = block_number;
+
+	return entry->data;
+}
+
 /****************************************************************************
  * Name: compress_read
  *
@@ -302,13 +480,7 @@ int compress_read(int filfd, uint16_t binary_header_size, FAR uint8_t *buffer, s
 	int block_size_to_write;	/* Size to write into buffer from decompressed block */
 	int buffer_index;
 	int blocksize;
-#if CONFIG_COMPRESSION_TYPE == LZMA
-	unsigned int writesize;
-	unsigned int size;
-#elif CONFIG_COMPRESSION_TYPE == MINIZ
-	long unsigned int writesize;
-	long unsigned int size;
-#endif
+	unsigned char *out_buffer;
 
 	/* Setting first block, end block and number of blocks to read and decompressed */
 	blocksize = compression_header->blocksize;
@@ -326,19 +498,11 @@ int compress_read(int filfd, uint16_t binary_header_size, FAR uint8_t *buffer, s
 
 	/* Reading and decompressing blocks from first_block to last_block. Then writing to buffer. */
 	for (; index < first_block + no_blocks; index++) {
-		/* Read compressed 'index' block into read_buffer */
-		size = compress_read_block(filfd, binary_header_size, buffers.read_buffer, index);
-		if (size < 0) {
-			bcmpdbg("Read for compressed block %d failed\n", index);
-			buffer_index = size;
-			goto error_compress_read;
-		}
-
-		/* Decompress block in read_buffer to out_buffer */
-		ret = compress_decompress_block(buffers.out_buffer, &writesize, buffers.read_buffer, &size, index);
-		if (ret == ERROR) {
-			bcmpdbg("Failed to decompress %d block of this binary\n", index);
-			buffer_index = ret;
+		/* Get decompressed 'index' block, reading and decompressing it if it is not cached */
+		out_buffer = compress_get_block(filfd, binary_header_size, index, last_block);
+		if (out_buffer == NULL) {
+			bcmpdbg("Failed to get %d block of this binary\n", index);
+			buffer_index = ERROR;
 			goto error_compress_read;
 		}
 
@@ -349,7 +513,7 @@ int compress_read(int filfd, uint16_t binary_header_size, FAR uint8_t *buffer, s
 			 * Otherwise, write from start_offset to end_offset into buffer.
 			 */
 			block_size_to_write = ((index + 1) * blocksize - 1 > actual_offset + readsize - 1 ? readsize : (index + 1) * blocksize - actual_offset);
-			memcpy(&buffer[buffer_index], &buffers.out_buffer[actual_offset - (index * blocksize)], block_size_to_write);
+			memcpy(&buffer[buffer_index], &out_buffer[actual_offset - (index * blocksize)], block_size_to_write);
 			buffer_index += block_size_to_write;
 		} else if (index == last_block) {
 			/*
@@ -358,7 +522,7 @@ int compress_read(int filfd, uint16_t binary_header_size, FAR uint8_t *buffer, s
 			 * Write from start_offset to end_offset from this block into buffer.
 			 */
 			block_size_to_write = actual_offset + readsize - (index * blocksize);
-			memcpy(&buffer[buffer_index], &buffers.out_buffer[0], block_size_to_write);
+			memcpy(&buffer[buffer_index], &out_buffer[0], block_size_to_write);
 			buffer_index += block_size_to_write;
 		} else {
 			/*
@@ -366,7 +530,7 @@ int compress_read(int filfd, uint16_t binary_header_size, FAR uint8_t *buffer, s
 			 * So, write entire block into buffer.
 			 */
 			block_size_to_write = blocksize;
-			memcpy(&buffer[buffer_index], &buffers.out_buffer[0], block_size_to_write);
+			memcpy(&buffer[buffer_index], &out_buffer[0], block_size_to_write);
 			buffer_index += block_size_to_write;
 		}
 	}
@@ -388,6 +552,7 @@ error_compress_read:
 int compress_init(int filfd, uint16_t offset, off_t *filelen)
 {
 	int ret;
+	int i;
 
 	/* Parsing compression header for compressed file */
 	ret = compress_parse_header(filfd, offset);
@@ -402,17 +567,42 @@ int compress_init(int filfd, uint16_t offset, off_t *filelen)
 #if CONFIG_COMPRESSION_TYPE == LZMA
 	/* Allocating memory for read and out buffer to be used for LZMA decompression */
 	if (compression_header->compression_format == COMPRESSION_TYPE_LZMA) {
-		buffers.read_buffer = (unsigned char *)kmm_malloc(compression_header->blocksize + 5);
-		buffers.out_buffer = (unsigned char *)kmm_malloc(compression_header->blocksize);
+		buffers.read_size = (compression_header->blocksize + 5) * COMPRESSION_READAHEAD_BLOCKS;
+		buffers.read_buffer = (unsigned char *)kmm_malloc(buffers.read_size);
+		buffers.out_buffer = (unsigned char *)kmm_malloc(compression_header->blocksize * CONFIG_COMPRESSION_CACHE_BLOCKS);
 	}
 #elif CONFIG_COMPRESSION_TYPE == MINIZ
 	/* Allocating memory for read and out buffer to be used for Miniz decompression */
 	if (compression_header->compression_format == COMPRESSION_TYPE_MINIZ) {
-		buffers.read_buffer = (unsigned char *)kmm_malloc(compression_header->blocksize);
-		buffers.out_buffer = (unsigned char *)kmm_malloc(compression_header->blocksize);
+		buffers.read_size = compression_header->blocksize * COMPRESSION_READAHEAD_BLOCKS;
+		buffers.read_buffer = (unsigned char *)kmm_malloc(buffers.read_size);
+		buffers.out_buffer = (unsigned char *)kmm_malloc(compression_header->blocksize * CONFIG_COMPRESSION_CACHE_BLOCKS);
 	}
 #endif
 
+	if (!buffers.read_buffer || !buffers.out_buffer) {
+		bcmpdbg("Failed kmm_malloc for read and out buffers\n");
+		if (buffers.read_buffer) {
+			kmm_free(buffers.read_buffer);
+			buffers.read_buffer = NULL;
+		}
+		if (buffers.out_buffer) {
+			kmm_free(buffers.out_buffer);
+			buffers.out_buffer = NULL;
+		}
+		return -ENOMEM;
+	}
+
+	/* out_buffer holds the cache of decompressed blocks, which starts empty */
+	for (i = 0; i < CONFIG_COMPRESSION_CACHE_BLOCKS; i++) {
+		cache[i].block = -1;
+		cache[i].stamp = 0;
+		cache[i].data = &buffers.out_buffer[i * compression_header->blocksize];
+	}
+	cache_clock = 0;
+	cache_lastblock = -1;
+	memset(&cachestats, 0, sizeof(cachestats));
+
 error_compress_init:
 	return ret;
 }
@@ -428,6 +618,8 @@ error_compress_init:
  ****************************************************************************/
 void compress_uninit(void)
 {
+	bcmpvdbg("Decompressed block cache: %u hits, %u misses, %u blocks read ahead\n", (unsigned int)cachestats.hits, (unsigned int)cachestats.misses, (unsigned int)cachestats.readaheads);
+
 #if CONFIG_COMPRESSION_TYPE == LZMA || CONFIG_COMPRESSION_TYPE == MINIZ
 	/* Freeing memory allocated to read_buffer and out_buffer for file decompression */
 	if (compression_header->compression_format == COMPRESSION_TYPE_LZMA || compression_header->compression_format == COMPRESSION_TYPE_MINIZ) {
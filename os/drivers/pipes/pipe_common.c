@@ -66,6 +66,7 @@
 #include <sched.h>
 #include <semaphore.h>
 #include <fcntl.h>
+#include <unistd.h>
 #include <errno.h>
 #include <assert.h>
 #include <debug.h>
@@ -77,6 +78,9 @@
 #include <tinyara/semaphore.h>
 #include <tinyara/fs/fs.h>
 #include <tinyara/fs/ioctl.h>
+#ifdef CONFIG_DEV_PIPE_SPLICE
+#include <tinyara/pipe.h>
+#endif
 
 #include "pipe_common.h"
 
@@ -153,6 +157,317 @@ static void pipecommon_pollnotify(FAR struct pipe_dev_s *dev, pollevent_t events
 #define pipecommon_pollnotify(dev, event)
 #endif
 
+/****************************************************************************
+ * Name: pipecommon_rdspan
+ *
+ * Description:
+ *   Return the number of bytes that can be read in one block at d_rdndx,
+ *   i.e. up to the write index or to the end of the buffer.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_rdspan(FAR struct pipe_dev_s *dev)
+{
+	if (dev->d_wrndx >= dev->d_rdndx) {
+		return dev->d_wrndx - dev->d_rdndx;
+	}
+
+	return CONFIG_DEV_PIPE_SIZE - dev->d_rdndx;
+}
+
+/****************************************************************************
+ * Name: pipecommon_wrspan
+ *
+ * Description:
+ *   Return the number of bytes that can be written in one block at d_wrndx,
+ *   i.e. up to the end of the buffer or to the byte before the read index:
+ *   one byte is always left free so that a full buffer can be told from an
+ *   empty one.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_wrspan(FAR struct pipe_dev_s *dev)
+{
+	if (dev->d_wrndx < dev->d_rdndx) {
+		return dev->d_rdndx - dev->d_wrndx - 1;
+	}
+
+	if (dev->d_rdndx == 0) {
+		return CONFIG_DEV_PIPE_SIZE - dev->d_wrndx - 1;
+	}
+
+	return CONFIG_DEV_PIPE_SIZE - dev->d_wrndx;
+}
+
+/****************************************************************************
+ * Name: pipecommon_rdadvance / pipecommon_wradvance
+ ****************************************************************************/
+
+static inline void pipecommon_rdadvance(FAR struct pipe_dev_s *dev, size_t nbytes)
+{
+	nbytes += dev->d_rdndx;
+	dev->d_rdndx = nbytes >= CONFIG_DEV_PIPE_SIZE ? 0 : nbytes;
+}
+
+static inline void pipecommon_wradvance(FAR struct pipe_dev_s *dev, size_t nbytes)
+{
+	nbytes += dev->d_wrndx;
+	dev->d_wrndx = nbytes >= CONFIG_DEV_PIPE_SIZE ? 0 : nbytes;
+}
+
+/****************************************************************************
+ * Name: pipecommon_rdwait
+ *
+ * Description:
+ *   Wait until the pipe holds data.  Called and returns with d_bfsem held
+ *   if the returned value is positive; d_bfsem is released otherwise.
+ *
+ * Returned Value:
+ *   1 if there is data to read, 0 at end of file, -EAGAIN if the pipe is
+ *   empty and non-blocking, -EINTR if a wait was interrupted.
+ *
+ ****************************************************************************/
+
+static int pipecommon_rdwait(FAR struct file *filep, FAR struct pipe_dev_s *dev)
+{
+	int ret;
+
+	/* If the pipe is empty, then wait for something to be written to it */
+
+	while (dev->d_wrndx == dev->d_rdndx) {
+		/* If O_NONBLOCK was set, then return EGAIN */
+
+		if (filep->f_oflags & O_NONBLOCK) {
+			sem_post(&dev->d_bfsem);
+			return -EAGAIN;
+		}
+
+		/* If there are no writers on the pipe, then return end of file */
+
+		if (dev->d_nwriters <= 0) {
+			sem_post(&dev->d_bfsem);
+			return 0;
+		}
+
+		/* Otherwise, wait for something to be written to the pipe */
+
+		sched_lock();
+		sem_post(&dev->d_bfsem);
+		ret = sem_wait(&dev->d_rdsem);
+		sched_unlock();
+
+		if (ret < 0 || sem_wait(&dev->d_bfsem) < 0) {
+			return -EINTR;
+		}
+	}
+
+	return 1;
+}
+
+/****************************************************************************
+ * Name: pipecommon_rdnotify / pipecommon_wrnotify
+ *
+ * Description:
+ *   Notify the waiting readers and poll/select waiters that data has been
+ *   added to the buffer, or the waiting writers and poll/select waiters
+ *   that data has been removed from the buffer.
+ *
+ ****************************************************************************/
+
+static void pipecommon_rdnotify(FAR struct pipe_dev_s *dev)
+{
+	int sval;
+
+	while (sem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0) {
+		sem_post(&dev->d_rdsem);
+	}
+
+	pipecommon_pollnotify(dev, POLLIN);
+}
+
+static void pipecommon_wrnotify(FAR struct pipe_dev_s *dev)
+{
+	int sval;
+
+	while (sem_getvalue(&dev->d_wrsem, &sval) == 0 && sval < 0) {
+		sem_post(&dev->d_wrsem);
+	}
+
+	pipecommon_pollnotify(dev, POLLOUT);
+}
+
+#ifdef CONFIG_DEV_PIPE_SPLICE
+/****************************************************************************
+ * Name: pipecommon_splicecheck
+ *
+ * Description:
+ *   Refuse to splice a pipe with itself: the transfer would wait on the
+ *   pipe that it holds locked.
+ *
+ ****************************************************************************/
+
+static int pipecommon_splicecheck(FAR struct file *filep, int fd)
+{
+	FAR struct file *other;
+
+	if (fd >= 0 && fd < CONFIG_NFILE_DESCRIPTORS) {
+		if (fs_getfilep(fd, &other) < 0) {
+			return -EBADF;
+		}
+
+		if (other->f_inode == filep->f_inode) {
+			return -EINVAL;
+		}
+	}
+
+	return OK;
+}
+
+/****************************************************************************
+ * Name: pipecommon_spliceout
+ *
+ * Description:
+ *   Write data from the pipe buffer to another descriptor, see
+ *   PIPEIOC_SPLICEOUT.
+ *
+ ****************************************************************************/
+
+static int pipecommon_spliceout(FAR struct file *filep, FAR struct pipe_splice_s *splice)
+{
+	FAR struct pipe_dev_s *dev = filep->f_inode->i_private;
+	size_t nmoved = 0;
+	size_t nbytes;
+	ssize_t nwritten;
+	int ret;
+
+	ret = pipecommon_splicecheck(filep, splice->fd);
+	if (ret < 0 || splice->len == 0) {
+		return ret;
+	}
+
+	if (sem_wait(&dev->d_bfsem) < 0) {
+		return -get_errno();
+	}
+
+	ret = pipecommon_rdwait(filep, dev);
+	if (ret <= 0) {
+		return ret;
+	}
+
+	ret = 0;
+
+	/* Write at most the two blocks on each side of the end of the buffer */
+
+	while (nmoved < splice->len && dev->d_wrndx != dev->d_rdndx) {
+		nbytes = pipecommon_rdspan(dev);
+		if (nbytes > splice->len - nmoved) {
+			nbytes = splice->len - nmoved;
+		}
+
+		nwritten = write(splice->fd, &dev->d_buffer[dev->d_rdndx], nbytes);
+		if (nwritten <= 0) {
+			if (nwritten < 0 && nmoved == 0) {
+				ret = -get_errno();
+			}
+
+			break;
+		}
+
+		pipecommon_rdadvance(dev, nwritten);
+		nmoved += nwritten;
+		if ((size_t)nwritten < nbytes) {
+			break;
+		}
+	}
+
+	if (nmoved > 0) {
+		pipecommon_wrnotify(dev);
+		ret = (int)nmoved;
+	}
+
+	sem_post(&dev->d_bfsem);
+	return ret;
+}
+
+/****************************************************************************
+ * Name: pipecommon_splicein
+ *
+ * Description:
+ *   Read data from another descriptor into the pipe buffer, see
+ *   PIPEIOC_SPLICEIN.
+ *
+ ****************************************************************************/
+
+static int pipecommon_splicein(FAR struct file *filep, FAR struct pipe_splice_s *splice)
+{
+	FAR struct pipe_dev_s *dev = filep->f_inode->i_private;
+	size_t nmoved = 0;
+	size_t nbytes;
+	ssize_t nread;
+	int ret;
+
+	ret = pipecommon_splicecheck(filep, splice->fd);
+	if (ret < 0 || splice->len == 0) {
+		return ret;
+	}
+
+	if (sem_wait(&dev->d_bfsem) < 0) {
+		return -get_errno();
+	}
+
+	/* Wait for room in the pipe */
+
+	while (pipecommon_wrspan(dev) == 0) {
+		if (filep->f_oflags & O_NONBLOCK) {
+			sem_post(&dev->d_bfsem);
+			return -EAGAIN;
+		}
+
+		sched_lock();
+		sem_post(&dev->d_bfsem);
+		ret = sem_wait(&dev->d_wrsem);
+		sched_unlock();
+
+		if (ret < 0 || sem_wait(&dev->d_bfsem) < 0) {
+			return -EINTR;
+		}
+	}
+
+	ret = 0;
+
+	/* Read at most the two blocks on each side of the end of the buffer */
+
+	while (nmoved < splice->len && (nbytes = pipecommon_wrspan(dev)) > 0) {
+		if (nbytes > splice->len - nmoved) {
+			nbytes = splice->len - nmoved;
+		}
+
+		nread = read(splice->fd, &dev->d_buffer[dev->d_wrndx], nbytes);
+		if (nread <= 0) {
+			if (nread < 0 && nmoved == 0) {
+				ret = -get_errno();
+			}
+
+			break;
+		}
+
+		pipecommon_wradvance(dev, nread);
+		nmoved += nread;
+		if ((size_t)nread < nbytes) {
+			break;
+		}
+	}
+
+	if (nmoved > 0) {
+		pipecommon_rdnotify(dev);
+		ret = (int)nmoved;
+	}
+
+	sem_post(&dev->d_bfsem);
+	return ret;
+}
+#endif							/* CONFIG_DEV_PIPE_SPLICE */
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -401,7 +716,7 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
 	FAR uint8_t *start = (uint8_t *)buffer;
 #endif
 	ssize_t nread = 0;
-	int sval;
+	size_t nbytes;
 	int ret;
 
 	DEBUGASSERT(dev);
@@ -418,53 +733,34 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
 
 	/* If the pipe is empty, then wait for something to be written to it */
 
-	while (dev->d_wrndx == dev->d_rdndx) {
-		/* If O_NONBLOCK was set, then return EGAIN */
-
-		if (filep->f_oflags & O_NONBLOCK) {
-			sem_post(&dev->d_bfsem);
-			return -EAGAIN;
-		}
-
-		/* If there are no writers on the pipe, then return end of file */
-
-		if (dev->d_nwriters <= 0) {
-			sem_post(&dev->d_bfsem);
-			return 0;
-		}
-
-		/* Otherwise, wait for something to be written to the pipe */
-
-		sched_lock();
-		sem_post(&dev->d_bfsem);
-		ret = sem_wait(&dev->d_rdsem);
-		sched_unlock();
-
-		if (ret < 0 || sem_wait(&dev->d_bfsem) < 0) {
-			return ERROR;
-		}
+	ret = pipecommon_rdwait(filep, dev);
+	if (ret <= 0) {
+		return ret == -EINTR ? ERROR : ret;
 	}
 
-	/* Then return whatever is available in the pipe (which is at least one byte) */
+	/* Then return whatever is available in the pipe (which is at least one
+	 * byte).  The data may wrap around the end of the buffer, so it is
+	 * copied in at most two blocks.
+	 */
 
 	nread = 0;
 	while (nread < len && dev->d_wrndx != dev->d_rdndx) {
-		*buffer++ = dev->d_buffer[dev->d_rdndx];
-		if (++dev->d_rdndx >= CONFIG_DEV_PIPE_SIZE) {
-			dev->d_rdndx = 0;
+		nbytes = pipecommon_rdspan(dev);
+		if (nbytes > len - nread) {
+			nbytes = len - nread;
 		}
-		nread++;
-	}
-
-	/* Notify all waiting writers that bytes have been removed from the buffer */
 
-	while (sem_getvalue(&dev->d_wrsem, &sval) == 0 && sval < 0) {
-		sem_post(&dev->d_wrsem);
+		memcpy(buffer, &dev->d_buffer[dev->d_rdndx], nbytes);
+		pipecommon_rdadvance(dev, nbytes);
+		buffer += nbytes;
+		nread += nbytes;
 	}
 
-	/* Notify all poll/select waiters that they can write to the FIFO */
+	/* Notify all waiting writers and poll/select waiters that bytes have been
+	 * removed from the buffer
+	 */
 
-	pipecommon_pollnotify(dev, POLLOUT);
+	pipecommon_wrnotify(dev);
 
 	sem_post(&dev->d_bfsem);
 	pipe_dumpbuffer("From PIPE:", start, nread);
@@ -481,7 +777,7 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer, size_t
 	struct pipe_dev_s *dev = inode->i_private;
 	ssize_t nwritten = 0;
 	ssize_t last;
-	int nxtwrndx;
+	size_t nbytes;
 	int sval;
 
 	DEBUGASSERT(dev);
@@ -514,33 +810,31 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer, size_t
 
 	last = 0;
 	for (;;) {
-		/* Calculate the write index AFTER the next byte is written */
-
-		nxtwrndx = dev->d_wrndx + 1;
-		if (nxtwrndx >= CONFIG_DEV_PIPE_SIZE) {
-			nxtwrndx = 0;
-		}
+		/* How much can be written before the end of the buffer or the
+		 * read index?
+		 */
 
-		/* Would the next write overflow the circular buffer? */
+		nbytes = pipecommon_wrspan(dev);
+		if (nbytes > 0) {
+			/* Copy as much as possible in one block */
 
-		if (nxtwrndx != dev->d_rdndx) {
-			/* No... copy the byte */
+			if (nbytes > len - nwritten) {
+				nbytes = len - nwritten;
+			}
 
-			dev->d_buffer[dev->d_wrndx] = *buffer++;
-			dev->d_wrndx = nxtwrndx;
+			memcpy(&dev->d_buffer[dev->d_wrndx], buffer, nbytes);
+			pipecommon_wradvance(dev, nbytes);
+			buffer += nbytes;
+			nwritten += nbytes;
 
 			/* Is the write complete? */
 
-			if (++nwritten >= len) {
-				/* Yes.. Notify all of the waiting readers that more data is available */
+			if (nwritten >= len) {
+				/* Yes.. Notify all of the waiting readers and poll/select
+				 * waiters that more data is available
+				 */
 
-				while (sem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0) {
-					sem_post(&dev->d_rdsem);
-				}
-
-				/* Notify all poll/select waiters that they can write to the FIFO */
-
-				pipecommon_pollnotify(dev, POLLIN);
+				pipecommon_rdnotify(dev);
 
 				/* Return the number of bytes written */
 
@@ -684,9 +978,8 @@ int pipecommon_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 	FAR struct inode *inode = filep->f_inode;
 	FAR struct pipe_dev_s *dev = inode->i_private;
 
-	/* Only one command supported */
-
-	if (cmd == PIPEIOC_POLICY) {
+	switch (cmd) {
+	case PIPEIOC_POLICY:
 		if (arg != 0) {
 			PIPE_POLICY_1(dev->d_flags);
 		} else {
@@ -694,9 +987,26 @@ int pipecommon_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 		}
 
 		return OK;
-	}
 
-	return -ENOTTY;
+#ifdef CONFIG_DEV_PIPE_SPLICE
+	case PIPEIOC_SPLICEIN:
+		if (arg == 0) {
+			return -EINVAL;
+		}
+
+		return pipecommon_splicein(filep, (FAR struct pipe_splice_s *)((uintptr_t)arg));
+
+	case PIPEIOC_SPLICEOUT:
+		if (arg == 0) {
+			return -EINVAL;
+		}
+
+		return pipecommon_spliceout(filep, (FAR struct pipe_splice_s *)((uintptr_t)arg));
+#endif
+
+	default:
+		return -ENOTTY;
+	}
 }
 
 /****************************************************************************
@@ -41,6 +41,11 @@
 #include <tinyara/fs/fs.h>
 #include <tinyara/arch.h>
 #include <tinyara/ringbuf.h>
+#ifdef CONFIG_TTRACE_BINARY
+#include <tinyara/sched.h>
+#include <tinyara/clock.h>
+#include <tinyara/ttrace.h>
+#endif
 
 #include <arch/irq.h>
 
@@ -67,6 +72,24 @@
 
 #define NO_HOLDER               ((pid_t)-1)
 
+#ifdef CONFIG_TTRACE_BINARY
+#if CONFIG_TTRACE_NEVENTS & (CONFIG_TTRACE_NEVENTS - 1)
+#error "CONFIG_TTRACE_NEVENTS must be a power of 2"
+#endif
+
+#ifdef CONFIG_ARCH_HAVE_PERF_COUNTER
+#define TTRACE_TIMESTAMP()      up_perf_gettime()
+#else
+#define TTRACE_TIMESTAMP()      ((uint32_t)clock_systimer())
+#endif
+
+/* Offsets of the parts of the binary dump */
+
+#define TTRACE_DUMP_STRINGS     sizeof(struct ttrace_dump_s)
+#define TTRACE_DUMP_TASKS       (TTRACE_DUMP_STRINGS + CONFIG_TTRACE_NSTRINGS * TTRACE_MSG_BYTES)
+#define TTRACE_DUMP_EVENTS      (TTRACE_DUMP_TASKS + g_ntasks * sizeof(struct ttrace_task_s))
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -77,6 +100,13 @@ struct ttrace_dev_s {
 	FAR char *ttrace_packets;  /* Trace packets buffer */
 };
 
+#ifdef CONFIG_TTRACE_BINARY
+struct ttrace_string_s {
+	uint32_t hash;             /* Hash of the string, 0 if the entry is free */
+	char str[TTRACE_MSG_BYTES];
+};
+#endif
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -110,6 +140,31 @@ static struct ringbuf g_ringbuf = {
 static uint32_t g_state = TTRACE_STATE_IDLE;
 static uint32_t g_selected_tag = 0;
 
+#ifdef CONFIG_TTRACE_BINARY
+/* Binary events are written straight into g_events by ttrace_event(), from
+ * any context.  Only the reservation of an entry and the timestamp are done
+ * with interrupts disabled, so that the events stay in time order; there is
+ * one buffer since there is one CPU.  g_nrecorded counts the events since
+ * tracing started, the oldest ones are overwritten.
+ */
+
+static struct ttrace_event_s g_events[CONFIG_TTRACE_NEVENTS];
+static volatile uint32_t g_nrecorded;
+static volatile uint32_t g_tags;	/* Tags recorded, 0 when not tracing */
+
+/* Interned strings, in a hash table with linear probing.  An entry is
+ * filled before its hash is set so that the lookups need no lock.  The id
+ * of a string is its index + 1.
+ */
+
+static struct ttrace_string_s g_strings[CONFIG_TTRACE_NSTRINGS];
+
+/* Tasks alive when tracing finished, for the names in the dump */
+
+static struct ttrace_task_s g_tasks[CONFIG_MAX_TASKS];
+static uint16_t g_ntasks;
+#endif
+
 /* This is the device structure for the T-trace function. It
  * must be statically initialized because the T-trace ttrace_putc function
  * could be called before the driver initialization logic executes.
@@ -125,6 +180,144 @@ static struct ttrace_dev_s g_sysdev = {
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_TTRACE_BINARY
+/****************************************************************************
+ * Name: ttrace_savetask
+ ****************************************************************************/
+
+static void ttrace_savetask(FAR struct tcb_s *tcb, FAR void *arg)
+{
+	FAR struct ttrace_task_s *task;
+
+	if (g_ntasks < CONFIG_MAX_TASKS) {
+		task = &g_tasks[g_ntasks++];
+		task->pid = tcb->pid;
+		task->prio = tcb->sched_priority;
+		task->pad = 0;
+#if CONFIG_TASK_NAME_SIZE > 0
+		strncpy(task->comm, tcb->name, TTRACE_COMM_BYTES - 1);
+		task->comm[TTRACE_COMM_BYTES - 1] = '\0';
+#else
+		snprintf(task->comm, TTRACE_COMM_BYTES, "pid %d", tcb->pid);
+#endif
+	}
+}
+
+/****************************************************************************
+ * Name: ttrace_binary_start
+ ****************************************************************************/
+
+static void ttrace_binary_start(uint32_t tags)
+{
+#ifdef CONFIG_ARCH_HAVE_PERF_COUNTER
+	up_perf_init();
+#endif
+	g_nrecorded = 0;
+	g_tags = tags;
+}
+
+/****************************************************************************
+ * Name: ttrace_binary_finish
+ ****************************************************************************/
+
+static void ttrace_binary_finish(void)
+{
+	g_tags = 0;
+
+	g_ntasks = 0;
+	sched_foreach(ttrace_savetask, NULL);
+}
+
+/****************************************************************************
+ * Name: ttrace_binary_size
+ ****************************************************************************/
+
+static size_t ttrace_binary_size(void)
+{
+	uint32_t nevents = g_nrecorded;
+
+	if (nevents > CONFIG_TTRACE_NEVENTS) {
+		nevents = CONFIG_TTRACE_NEVENTS;
+	}
+
+	return TTRACE_DUMP_EVENTS + nevents * sizeof(struct ttrace_event_s);
+}
+
+/****************************************************************************
+ * Name: ttrace_binary_read
+ *
+ * Description:
+ *   Copy the part of the binary dump starting at 'pos'.  The dump is not
+ *   built in memory: each part is copied from where it is kept.
+ *
+ ****************************************************************************/
+
+static ssize_t ttrace_binary_read(FAR char *buffer, size_t len, off_t pos)
+{
+	struct ttrace_dump_s header;
+	uint32_t nevents = g_nrecorded;
+	uint32_t first = 0;
+	size_t size = ttrace_binary_size();
+	size_t done = 0;
+	size_t offset;
+	size_t chunk;
+	FAR const char *src;
+	int i;
+
+	if (nevents > CONFIG_TTRACE_NEVENTS) {
+		first = nevents - CONFIG_TTRACE_NEVENTS;
+		nevents = CONFIG_TTRACE_NEVENTS;
+	}
+
+	header.magic = TTRACE_DUMP_MAGIC;
+	header.version = TTRACE_DUMP_VERSION;
+	header.evsize = sizeof(struct ttrace_event_s);
+#ifdef CONFIG_ARCH_HAVE_PERF_COUNTER
+	header.freq = up_perf_getfreq();
+#else
+	header.freq = CLK_TCK;
+#endif
+	header.nevents = nevents;
+	header.lost = first;
+	header.nstrings = CONFIG_TTRACE_NSTRINGS;
+	header.ntasks = g_ntasks;
+
+	while (done < len && pos + done < size) {
+		offset = pos + done;
+
+		if (offset < TTRACE_DUMP_STRINGS) {
+			src = (FAR const char *)&header + offset;
+			chunk = TTRACE_DUMP_STRINGS - offset;
+		} else if (offset < TTRACE_DUMP_TASKS) {
+			offset -= TTRACE_DUMP_STRINGS;
+			i = offset / TTRACE_MSG_BYTES;
+			offset -= i * TTRACE_MSG_BYTES;
+			src = g_strings[i].str + offset;
+			chunk = TTRACE_MSG_BYTES - offset;
+		} else if (offset < TTRACE_DUMP_EVENTS) {
+			offset -= TTRACE_DUMP_TASKS;
+			src = (FAR const char *)g_tasks + offset;
+			chunk = TTRACE_DUMP_EVENTS - TTRACE_DUMP_TASKS - offset;
+		} else {
+			offset -= TTRACE_DUMP_EVENTS;
+			i = offset / sizeof(struct ttrace_event_s);
+			offset -= i * sizeof(struct ttrace_event_s);
+			src = (FAR const char *)&g_events[(first + i) & (CONFIG_TTRACE_NEVENTS - 1)] + offset;
+			chunk = sizeof(struct ttrace_event_s) - offset;
+		}
+
+		if (chunk > len - done) {
+			chunk = len - done;
+		}
+
+		memcpy(buffer + done, src, chunk);
+		done += chunk;
+	}
+
+	return (ssize_t)done;
+}
+#endif
+
 /****************************************************************************
  * Name: ttrace_read
  ****************************************************************************/
@@ -139,6 +332,13 @@ static ssize_t ttrace_read(FAR struct file *filep, FAR char *buffer, size_t len)
 	}
 
 	DEBUGASSERT(priv);
+
+#ifdef CONFIG_TTRACE_BINARY
+	len = ttrace_binary_read(buffer, len, filep->f_pos);
+	filep->f_pos += len;
+	return (ssize_t)len;
+#endif
+
 	sched_lock();
 
 	ttdbg("buffer: %p, ringbuf: %p\r\n", buffer, g_ringbuf.buffer);
@@ -192,6 +392,9 @@ static int ttrace_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 	case TTRACE_START:
 		g_state = TTRACE_STATE_RUNNING;
 		priv->ttrace_head = 0;
+#ifdef CONFIG_TTRACE_BINARY
+		ttrace_binary_start(g_selected_tag);
+#endif
 		break;
 	case TTRACE_OVERWRITE:
 		g_ringbuf.is_overwritable = arg;
@@ -199,9 +402,12 @@ static int ttrace_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 	case TTRACE_FINISH:
 		g_selected_tag = 0;
 		g_state = TTRACE_STATE_IDLE;
+#ifdef CONFIG_TTRACE_BINARY
+		ttrace_binary_finish();
+#endif
 		break;
 	case TTRACE_INFO:
-		ttdbg("Available tags: apps libs lock ipc task\r\n");
+		ttdbg("Available tags: apps libs lock ipc task irq sys\r\n");
 		ttdbg("State: %d\r\n", g_state);
 		ttdbg("Selected tags: %d\r\n", g_selected_tag);
 		ttdbg("Buffer index: %d\r\n", g_ringbuf.index);
@@ -220,6 +426,10 @@ static int ttrace_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 		g_ringbuf.bufsize = CONFIG_TTRACE_BUFSIZE - (CONFIG_TTRACE_BUFSIZE % arg);
 		break;
 	case TTRACE_USED_BUFSIZE:
+#ifdef CONFIG_TTRACE_BINARY
+		ret = ttrace_binary_size();
+		break;
+#endif
 		if (g_ringbuf.is_overwritten == 0) {
 			ret = priv->ttrace_head;
 		} else {
@@ -244,6 +454,114 @@ static int ttrace_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
  * Public Functions
  ****************************************************************************/
 
+#ifdef CONFIG_TTRACE_BINARY
+/****************************************************************************
+ * Name: ttrace_event
+ ****************************************************************************/
+
+void ttrace_event(int tag, uint8_t type, uint32_t arg0, uint32_t arg1)
+{
+	FAR struct ttrace_event_s *event;
+	FAR struct tcb_s *tcb;
+	irqstate_t flags;
+	uint32_t index;
+	uint32_t ts;
+
+	if ((g_tags & (uint32_t)tag) == 0) {
+		return;
+	}
+
+	flags = irqsave();
+	index = g_nrecorded++;
+	ts = TTRACE_TIMESTAMP();
+	irqrestore(flags);
+
+	tcb = sched_self();
+	event = &g_events[index & (CONFIG_TTRACE_NEVENTS - 1)];
+	event->ts = ts;
+	event->pid = tcb != NULL ? tcb->pid : -1;
+	event->type = type;
+	event->tag = __builtin_ctz((uint32_t)tag);
+	event->arg0 = arg0;
+	event->arg1 = arg1;
+}
+
+/****************************************************************************
+ * Name: ttrace_intern
+ ****************************************************************************/
+
+uint16_t ttrace_intern(FAR const char *str)
+{
+	FAR struct ttrace_string_s *entry;
+	irqstate_t flags;
+	uint32_t hash = 2166136261u;
+	bool added;
+	int index;
+	int i;
+
+	if (g_tags == 0) {
+		return 0;
+	}
+
+	/* FNV-1a hash of the part of the string that is kept */
+
+	for (i = 0; i < TTRACE_MSG_BYTES - 1 && str[i] != '\0'; i++) {
+		hash = (hash ^ (uint8_t)str[i]) * 16777619u;
+	}
+
+	if (hash == 0) {
+		hash = 1;
+	}
+
+	index = hash % CONFIG_TTRACE_NSTRINGS;
+	for (i = 0; i < CONFIG_TTRACE_NSTRINGS; i++) {
+		entry = &g_strings[index];
+
+		if (entry->hash == 0) {
+			added = false;
+			flags = irqsave();
+			if (entry->hash == 0) {
+				strncpy(entry->str, str, TTRACE_MSG_BYTES - 1);
+				entry->str[TTRACE_MSG_BYTES - 1] = '\0';
+				entry->hash = hash;
+				added = true;
+			}
+			irqrestore(flags);
+
+			if (added) {
+				return index + 1;
+			}
+		}
+
+		if (entry->hash == hash && strncmp(entry->str, str, TTRACE_MSG_BYTES - 1) == 0) {
+			return index + 1;
+		}
+
+		index = (index + 1) % CONFIG_TTRACE_NSTRINGS;
+	}
+
+	return 0;
+}
+
+/****************************************************************************
+ * Name: trace_sched
+ *
+ * Description:
+ *   Record a context switch.  This replaces the version of the library,
+ *   which would go through the T-trace device.
+ *
+ ****************************************************************************/
+
+int trace_sched(FAR struct tcb_s *prev, FAR struct tcb_s *next)
+{
+	uint32_t arg0 = prev ? TTRACE_SCHED_TASK(prev->pid, prev->sched_priority, prev->task_state) : 0;
+	uint32_t arg1 = next ? TTRACE_SCHED_TASK(next->pid, next->sched_priority, next->task_state) : 0;
+
+	ttrace_event(TTRACE_TAG_TASK, TTRACE_EVENT_SCHED, arg0, arg1);
+	return TTRACE_VALID;
+}
+#endif
+
 /****************************************************************************
  * Name: ttrace_init
  *
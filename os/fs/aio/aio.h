@@ -60,11 +60,15 @@
 #include <tinyara/config.h>
 
 #include <sys/types.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
+#include <signal.h>
+#include <semaphore.h>
 #include <aio.h>
 #include <queue.h>
 
-#include <tinyara/wqueue.h>
 #include <tinyara/net/net.h>
 
 #ifdef CONFIG_FS_AIO
@@ -80,6 +84,36 @@
 #define CONFIG_FS_NAIOC 8
 #endif
 
+/* Number of worker threads */
+
+#ifndef CONFIG_FS_AIO_NWORKERS
+#define CONFIG_FS_AIO_NWORKERS 2
+#endif
+
+#ifndef CONFIG_FS_AIO_PRIORITY
+#define CONFIG_FS_AIO_PRIORITY 50
+#endif
+
+#ifndef CONFIG_FS_AIO_STACKSIZE
+#define CONFIG_FS_AIO_STACKSIZE 2048
+#endif
+
+/* Maximum size of a merged transfer, zero disables merging */
+
+#ifndef CONFIG_FS_AIO_MERGE_MAX
+#define CONFIG_FS_AIO_MERGE_MAX 4096
+#endif
+
+/* Maximum number of requests merged into one transfer */
+
+#define AIO_MERGE_NMAX 8
+
+/* Operations of a container */
+
+#define AIO_OP_READ    LIO_READ
+#define AIO_OP_WRITE   LIO_WRITE
+#define AIO_OP_FSYNC   3
+
 #undef AIO_HAVE_FILEP
 
 #if CONFIG_NFILE_DESCRIPTORS > 0
@@ -99,8 +133,13 @@
  */
 
 struct file;
+struct inode;
+struct aio_worker_s;
+struct aio_lio_s;
+
 struct aio_container_s {
 	dq_entry_t aioc_link;		/* Supports a doubly linked list */
+	dq_entry_t aioc_qlink;		/* Link in the queue of a worker */
 	FAR struct aiocb *aioc_aiocbp;	/* The contained AIO control block */
 	union {
 #ifdef AIO_HAVE_FILEP
@@ -108,13 +147,48 @@ struct aio_container_s {
 #endif
 		FAR void *ptr;			/* Generic pointer to FAR data */
 	} u;
-	struct work_s aioc_work;	/* Used to defer I/O to the work thread */
+	FAR struct inode *aioc_inode;	/* Device or mountpoint of the file */
+	FAR struct aio_worker_s *aioc_worker;	/* Queue holding the container,
+						 * NULL once the I/O started */
+	FAR struct aio_lio_s *aioc_lio;	/* lio_listio() batch, if any */
 	pid_t aioc_pid;				/* ID of the waiting task */
+	uint8_t aioc_op;			/* AIO_OP_READ, AIO_OP_WRITE or AIO_OP_FSYNC */
 #ifdef CONFIG_PRIORITY_INHERITANCE
 	uint8_t aioc_prio;			/* Priority of the waiting task */
 #endif
 };
 
+/* Get the container from its aioc_qlink field */
+
+#define AIOC_FROM_QLINK(e) \
+	((FAR struct aio_container_s *)((FAR char *)(e) - offsetof(struct aio_container_s, aioc_qlink)))
+
+/* A worker thread and the queue of the requests it performs */
+
+struct aio_worker_s {
+	dq_queue_t aiow_pending;	/* Queued containers, linked by aioc_qlink */
+	sem_t aiow_sem;				/* Posted once per queued container */
+	FAR struct inode *aiow_active;	/* Device of the I/O in progress */
+	pid_t aiow_pid;				/* ID of the thread, 0 until started */
+	uint8_t aiow_npending;		/* Number of queued containers */
+	bool aiow_busy;				/* True while performing I/O */
+#ifdef CONFIG_PRIORITY_INHERITANCE
+	uint8_t aiow_prio;			/* Current priority of the thread */
+#endif
+};
+
+/* A batch of requests submitted by lio_listio().  The completion of its
+ * last request notifies the caller once for the whole batch.
+ */
+
+struct aio_lio_s {
+	sem_t lio_sem;				/* Posted when done, for LIO_WAIT */
+	struct sigevent lio_sig;	/* Notification, for LIO_NOWAIT */
+	pid_t lio_pid;				/* ID of the task to notify */
+	uint16_t lio_remaining;		/* Requests not completed yet */
+	uint8_t lio_mode;			/* LIO_WAIT or LIO_NOWAIT */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -133,6 +207,10 @@ extern "C" {
 
 EXTERN dq_queue_t g_aio_pending;
 
+/* The worker threads */
+
+EXTERN struct aio_worker_s g_aio_workers[CONFIG_FS_AIO_NWORKERS];
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -250,11 +328,13 @@ FAR struct aiocb *aioc_decant(FAR struct aio_container_s *aioc);
  * Name: aio_queue
  *
  * Description:
- *   Schedule the asynchronous I/O on the low priority work queue
+ *   Queue the asynchronous I/O described by a container to a worker thread:
+ *   the worker already serving the same device if any, so that the
+ *   requests to a file are performed in order, else an idle worker, else
+ *   the least loaded one.  On failure, the container is released.
  *
  * Input Parameters:
- *   arg - Worker argument.  In this case, a pointer to an instance of
- *     struct aiocb cast to void *.
+ *   aioc - The AIO container, with aioc_op set
  *
  * Returned Value:
  *   Zero (OK) on success.  Otherwise, -1 is returned and the errno is set
@@ -262,7 +342,53 @@ FAR struct aiocb *aioc_decant(FAR struct aio_container_s *aioc);
  *
  ****************************************************************************/
 
-int aio_queue(FAR struct aio_container_s *aioc, worker_t worker);
+int aio_queue(FAR struct aio_container_s *aioc);
+
+/****************************************************************************
+ * Name: aio_dequeue
+ *
+ * Description:
+ *   Remove a container from the queue of its worker if the I/O has not
+ *   started yet.  The caller must hold the AIO lock.
+ *
+ * Input Parameters:
+ *   aioc - The AIO container
+ *
+ * Returned Value:
+ *   Zero (OK) if the container was removed, -EBUSY if its I/O already
+ *   started.
+ *
+ ****************************************************************************/
+
+int aio_dequeue(FAR struct aio_container_s *aioc);
+
+/****************************************************************************
+ * Name: aio_worker
+ *
+ * Description:
+ *   Entry point of the AIO worker threads.  argv[1] is the index of the
+ *   worker in g_aio_workers.
+ *
+ ****************************************************************************/
+
+int aio_worker(int argc, FAR char *argv[]);
+
+/****************************************************************************
+ * Name: aio_liodone
+ *
+ * Description:
+ *   Account for the completion of one request of a lio_listio() batch and
+ *   notify the caller if it was the last one.
+ *
+ * Input Parameters:
+ *   lio - The batch
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aio_liodone(FAR struct aio_lio_s *lio);
 
 /****************************************************************************
  * Name: aio_signal
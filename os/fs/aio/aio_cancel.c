@@ -61,8 +61,6 @@
 #include <assert.h>
 #include <errno.h>
 
-#include <tinyara/wqueue.h>
-
 #include "aio/aio.h"
 
 #ifdef CONFIG_FS_AIO
@@ -136,6 +134,7 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
 {
 	FAR struct aio_container_s *aioc;
 	FAR struct aio_container_s *next;
+	FAR struct aio_lio_s *lio;
 	int status;
 	int ret;
 
@@ -163,24 +162,26 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
 
 			if (aioc) {
 				/* Yes... attempt to cancel the I/O.  There are two
-				 * possibilities:* (1) the work has already been started and
-				 * is no longer queued, or (2) the work has not been started
-				 * and is still in the work queue.  Only the second case can
-				 * be cancelled.  work_cancel() will return -ENOENT in the
-				 * first case.
+				 * possibilities:* (1) the I/O has already been started and
+				 * is no longer queued, or (2) the I/O has not been started
+				 * and is still in the queue of a worker.  Only the second
+				 * case can be cancelled.  aio_dequeue() will return -EBUSY
+				 * in the first case.
 				 */
 
-				status = work_cancel(LPWORK, &aioc->aioc_work);
+				status = aio_dequeue(aioc);
 				if (status >= 0) {
+					lio = aioc->aioc_lio;
+					(void)aioc_decant(aioc);
 					aiocbp->aio_result = -ECANCELED;
+					if (lio != NULL) {
+						aio_liodone(lio);
+					}
+
 					ret = AIO_CANCELED;
 				} else {
 					ret = AIO_NOTCANCELED;
 				}
-
-				/* Remove the container from the list of pending transfers */
-
-				(void)aioc_decant(aioc);
 			}
 		}
 	} else {
@@ -198,23 +199,28 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
 
 			if (aioc) {
 				/* Yes... attempt to cancel the I/O.  There are two
-				 * possibilities:* (1) the work has already been started and
-				 * is no longer queued, or (2) the work has not been started
-				 * and is still in the work queue.  Only the second case can
-				 * be cancelled.  work_cancel() will return -ENOENT in the
-				 * first case.
+				 * possibilities:* (1) the I/O has already been started and
+				 * is no longer queued, or (2) the I/O has not been started
+				 * and is still in the queue of a worker.  Only the second
+				 * case can be cancelled.  aio_dequeue() will return -EBUSY
+				 * in the first case.
 				 */
 
-				status = work_cancel(LPWORK, &aioc->aioc_work);
-
-				/* Remove the container from the list of pending transfers */
-
+				status = aio_dequeue(aioc);
 				next = (FAR struct aio_container_s *)aioc->aioc_link.flink;
-				aiocbp = aioc_decant(aioc);
-				DEBUGASSERT(aiocbp);
 
 				if (status >= 0) {
+					/* Remove the container from the list of pending transfers */
+
+					lio = aioc->aioc_lio;
+					aiocbp = aioc_decant(aioc);
+					DEBUGASSERT(aiocbp);
+
 					aiocbp->aio_result = -ECANCELED;
+					if (lio != NULL) {
+						aio_liodone(lio);
+					}
+
 					if (ret != AIO_NOTCANCELED) {
 						ret = AIO_CANCELED;
 					}
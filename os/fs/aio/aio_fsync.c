@@ -85,75 +85,6 @@
  * Public Data
  ****************************************************************************/
 
-/****************************************************************************
- * Private Functions
- ****************************************************************************/
-
-/****************************************************************************
- * Name: aio_fsync_worker
- *
- * Description:
- *   This function executes on the worker thread and performs the
- *   asynchronous I/O operation.
- *
- * Input Parameters:
- *   arg - Worker argument.  In this case, a pointer to an instance of
- *     struct aiocb cast to void *.
- *
- * Returned Value:
- *   None
- *
- ****************************************************************************/
-
-static void aio_fsync_worker(FAR void *arg)
-{
-	FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
-	FAR struct aiocb *aiocbp;
-	pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-	uint8_t prio;
-#endif
-	int ret;
-
-	/* Get the information from the container, decant the AIO control block,
-	 * and free the container before starting any I/O.  That will minimize
-	 * the delays by any other threads waiting for a pre-allocated container.
-	 */
-
-	DEBUGASSERT(aioc && aioc->aioc_aiocbp);
-	pid = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-	prio = aioc->aioc_prio;
-#endif
-	aiocbp = aioc_decant(aioc);
-
-	/* Perform the fsync using u.aioc_filep */
-
-	ret = file_fsync(aioc->u.aioc_filep);
-	if (ret < 0) {
-		int errcode = get_errno();
-		fdbg("ERROR: fsync failed: %d\n", errcode);
-		DEBUGASSERT(errcode > 0);
-		aiocbp->aio_result = -errcode;
-	} else {
-		aiocbp->aio_result = OK;
-	}
-
-	/* Signal the client */
-
-	(void)aio_signal(pid, aiocbp);
-
-#ifdef CONFIG_PRIORITY_INHERITANCE
-	/* Restore the low priority worker thread default priority */
-
-	lpwork_restorepriority(prio);
-#endif
-}
-
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
-
 /****************************************************************************
  * Name: aio_fsync
  *
@@ -257,9 +188,10 @@ int aio_fsync(int op, FAR struct aiocb *aiocbp)
 		return ERROR;
 	}
 
-	/* Defer the work to the worker thread */
+	/* Defer the work to a worker thread */
 
-	ret = aio_queue(aioc, aio_fsync_worker);
+	aioc->aioc_op = AIO_OP_FSYNC;
+	ret = aio_queue(aioc);
 	if (ret < 0) {
 		/* The result and the errno have already been set */
 
@@ -62,6 +62,7 @@
 #include <queue.h>
 
 #include <tinyara/sched.h>
+#include <tinyara/semaphore.h>
 
 #include "aio/aio.h"
 
@@ -109,6 +110,10 @@ static uint16_t g_aio_count;
 
 dq_queue_t g_aio_pending;
 
+/* The worker threads */
+
+struct aio_worker_s g_aio_workers[CONFIG_FS_AIO_NWORKERS];
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -153,6 +158,15 @@ void aio_initialize(void)
 
 		dq_addlast(&g_aioc_alloc[i].aioc_link, &g_aioc_free);
 	}
+
+	/* Initialize the worker queues.  The threads start when first needed. */
+
+	for (i = 0; i < CONFIG_FS_AIO_NWORKERS; i++) {
+		dq_init(&g_aio_workers[i].aiow_pending);
+		(void)sem_init(&g_aio_workers[i].aiow_sem, 0, 0);
+		(void)sem_setprotocol(&g_aio_workers[i].aiow_sem, SEM_PRIO_NONE);
+		g_aio_workers[i].aiow_pid = 0;
+	}
 }
 
 /****************************************************************************
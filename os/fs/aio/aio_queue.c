@@ -57,45 +57,125 @@
 #include <tinyara/config.h>
 
 #include <sched.h>
+#include <stdio.h>
 #include <aio.h>
+#include <queue.h>
 #include <errno.h>
 #include <debug.h>
 
-#include <tinyara/wqueue.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/kthread.h>
 
 #include "aio/aio.h"
 
 #ifdef CONFIG_FS_AIO
 
 /****************************************************************************
- * Pre-processor Definitions
+ * Private Functions
  ****************************************************************************/
 
 /****************************************************************************
- * Private Types
+ * Name: aio_serves
+ *
+ * Description:
+ *   Check if a worker is performing or holds I/O on a device.
+ *
  ****************************************************************************/
 
+static bool aio_serves(FAR struct aio_worker_s *worker, FAR struct inode *inode)
+{
+	FAR dq_entry_t *entry;
+
+	if (worker->aiow_busy && worker->aiow_active == inode) {
+		return true;
+	}
+
+	for (entry = dq_peek(&worker->aiow_pending); entry; entry = dq_next(entry)) {
+		if (AIOC_FROM_QLINK(entry)->aioc_inode == inode) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 /****************************************************************************
- * Private Data
+ * Name: aio_select
+ *
+ * Description:
+ *   Select the worker for the I/O on a device: the one that already serves
+ *   it, so that the requests to a file are performed in order, else an idle
+ *   one, else the least loaded one.  The caller holds the AIO lock.
+ *
  ****************************************************************************/
 
+static FAR struct aio_worker_s *aio_select(FAR struct inode *inode)
+{
+	FAR struct aio_worker_s *worker;
+	FAR struct aio_worker_s *best = NULL;
+	int load;
+	int bestload = 0;
+	int i;
+
+	for (i = 0; i < CONFIG_FS_AIO_NWORKERS; i++) {
+		worker = &g_aio_workers[i];
+		if (aio_serves(worker, inode)) {
+			return worker;
+		}
+
+		load = worker->aiow_npending + (worker->aiow_busy ? 1 : 0);
+		if (best == NULL || load < bestload) {
+			best = worker;
+			bestload = load;
+		}
+	}
+
+	return best;
+}
+
 /****************************************************************************
- * Public Data
+ * Name: aio_start
+ *
+ * Description:
+ *   Start the thread of a worker.  The caller holds the AIO lock.
+ *
  ****************************************************************************/
 
+static int aio_start(FAR struct aio_worker_s *worker, int priority)
+{
+	FAR char *argv[2];
+	char arg[4];
+	pid_t pid;
+
+	snprintf(arg, sizeof(arg), "%d", (int)(worker - g_aio_workers));
+	argv[0] = arg;
+	argv[1] = NULL;
+
+	pid = kernel_thread("aio", priority, CONFIG_FS_AIO_STACKSIZE, (main_t)aio_worker, argv);
+	if (pid < 0) {
+		fdbg("ERROR: kernel_thread failed: %d\n", pid);
+		return pid;
+	}
+
+	worker->aiow_pid = pid;
+#ifdef CONFIG_PRIORITY_INHERITANCE
+	worker->aiow_prio = priority;
+#endif
+	return OK;
+}
+
 /****************************************************************************
- * Private Functions
+ * Public Functions
  ****************************************************************************/
 
 /****************************************************************************
  * Name: aio_queue
  *
  * Description:
- *   Schedule the asynchronous I/O on the low priority work queue
+ *   Queue the asynchronous I/O to a worker thread
  *
  * Input Parameters:
- *   arg - Worker argument.  In this case, a pointer to an instance of
- *     struct aiocb cast to void *.
+ *   aioc - The AIO container, with aioc_op set
  *
  * Returned Value:
  *   Zero (OK) on success.  Otherwise, -1 is returned and the errno is set
@@ -103,39 +183,90 @@
  *
  ****************************************************************************/
 
-int aio_queue(FAR struct aio_container_s *aioc, worker_t worker)
+int aio_queue(FAR struct aio_container_s *aioc)
 {
-	int ret;
+	FAR struct aio_worker_s *worker;
+	FAR struct aiocb *aiocbp;
+	int priority = CONFIG_FS_AIO_PRIORITY;
+	int ret = OK;
+
+	DEBUGASSERT(aioc && aioc->aioc_aiocbp);
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
 	/* Prohibit context switches until we complete the queuing */
 
 	sched_lock();
+	aio_lock();
 
-	/* Make sure that the low-priority worker thread is running at at least
-	 * the priority specified for this action.
+	worker = aio_select(aioc->aioc_inode);
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+	/* Make sure that the worker thread is running at at least the priority
+	 * of the waiting task.
 	 */
 
-	lpwork_boostpriority(aioc->aioc_prio);
+	if (aioc->aioc_prio > priority) {
+		priority = aioc->aioc_prio;
+	}
+
+	if (worker->aiow_pid != 0 && priority > worker->aiow_prio) {
+		struct sched_param param;
+
+		param.sched_priority = priority;
+		if (sched_setparam(worker->aiow_pid, &param) == OK) {
+			worker->aiow_prio = priority;
+		}
+	}
 #endif
 
-	/* Schedule the work on the low priority worker thread */
+	if (worker->aiow_pid == 0) {
+		ret = aio_start(worker, priority);
+	}
 
-	ret = work_queue(LPWORK, &aioc->aioc_work, worker, aioc, 0);
-	if (ret < 0) {
-		FAR struct aiocb *aiocbp = aioc->aioc_aiocbp;
-		DEBUGASSERT(aiocbp);
+	if (ret == OK) {
+		aioc->aioc_worker = worker;
+		dq_addlast(&aioc->aioc_qlink, &worker->aiow_pending);
+		worker->aiow_npending++;
+		sem_post(&worker->aiow_sem);
+	}
+
+	aio_unlock();
 
+	/* Now the worker thread might run at its new priority */
+
+	sched_unlock();
+
+	if (ret < 0) {
+		aiocbp = aioc_decant(aioc);
 		aiocbp->aio_result = ret;
 		set_errno(-ret);
-		ret = ERROR;
+		return ERROR;
 	}
-#ifdef CONFIG_PRIORITY_INHERITANCE
-	/* Now the low-priority work queue might run at its new priority */
 
-	sched_unlock();
-#endif
-	return ret;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: aio_dequeue
+ *
+ * Description:
+ *   Remove a container from the queue of its worker.
+ *
+ ****************************************************************************/
+
+int aio_dequeue(FAR struct aio_container_s *aioc)
+{
+	FAR struct aio_worker_s *worker = aioc->aioc_worker;
+
+	if (worker == NULL) {
+		return -EBUSY;
+	}
+
+	/* The worker will find nothing for the semaphore count left behind */
+
+	dq_rem(&aioc->aioc_qlink, &worker->aiow_pending);
+	worker->aiow_npending--;
+	aioc->aioc_worker = NULL;
+	return OK;
 }
 
 #endif							/* CONFIG_FS_AIO */
@@ -85,88 +85,6 @@
  * Public Data
  ****************************************************************************/
 
-/****************************************************************************
- * Private Functions
- ****************************************************************************/
-
-/****************************************************************************
- * Name: aio_read_worker
- *
- * Description:
- *   This function executes on the worker thread and performs the
- *   asynchronous I/O operation.
- *
- * Input Parameters:
- *   arg - Worker argument.  In this case, a pointer to an instance of
- *     struct aiocb cast to void *.
- *
- * Returned Value:
- *   None
- *
- ****************************************************************************/
-
-static void aio_read_worker(FAR void *arg)
-{
-	FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
-	FAR struct aiocb *aiocbp;
-	pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-	uint8_t prio;
-#endif
-	ssize_t nread = 0;
-
-	/* Get the information from the container, decant the AIO control block,
-	 * and free the container before starting any I/O.  That will minimize
-	 * the delays by any other threads waiting for a pre-allocated container.
-	 */
-
-	DEBUGASSERT(aioc && aioc->aioc_aiocbp);
-	pid = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-	prio = aioc->aioc_prio;
-#endif
-	aiocbp = aioc_decant(aioc);
-
-#ifdef AIO_HAVE_FILEP
-	{
-		/* Perform the file read using:
-		 *
-		 *   u.aioc_filep - File structure pointer
-		 *   aio_buf      - Location of buffer
-		 *   aio_nbytes   - Length of transfer
-		 *   aio_offset   - File offset
-		 */
-
-		nread = file_pread(aioc->u.aioc_filep, (FAR void *)aiocbp->aio_buf, aiocbp->aio_nbytes, aiocbp->aio_offset);
-	}
-#endif
-
-	/* Set the result of the read */
-
-	if (nread < 0) {
-		int errcode = get_errno();
-		fdbg("ERROR: pread failed: %d\n", errcode);
-		DEBUGASSERT(errcode > 0);
-		aiocbp->aio_result = -errcode;
-	} else {
-		aiocbp->aio_result = nread;
-	}
-
-	/* Signal the client */
-
-	(void)aio_signal(pid, aiocbp);
-
-#ifdef CONFIG_PRIORITY_INHERITANCE
-	/* Restore the low priority worker thread default priority */
-
-	lpwork_restorepriority(prio);
-#endif
-}
-
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
-
 /****************************************************************************
  * Name: aio_read
  *
@@ -287,9 +205,10 @@ int aio_read(FAR struct aiocb *aiocbp)
 		return ERROR;
 	}
 
-	/* Defer the work to the worker thread */
+	/* Defer the work to a worker thread */
 
-	ret = aio_queue(aioc, aio_read_worker);
+	aioc->aioc_op = AIO_OP_READ;
+	ret = aio_queue(aioc);
 	if (ret < 0) {
 		/* The result and the errno have already been set */
 
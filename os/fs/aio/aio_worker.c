@@ -0,0 +1,385 @@
+/****************************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * fs/aio/aio_worker.c
+ *
+ * Each AIO worker thread performs the requests queued to it in order.  When
+ * it takes a read or a write, it also takes the following requests of the
+ * same kind to the same file that continue it in the file, and performs
+ * them all with a single transfer: straight from or to the caller buffers
+ * if they are contiguous in memory, else through a bounce buffer.  The
+ * containers are released before the I/O starts.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <aio.h>
+#include <queue.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/fs/fs.h>
+#include <tinyara/kmalloc.h>
+
+#include "aio/aio.h"
+
+#ifdef CONFIG_FS_AIO
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* A request taken from the queue, once its container is released */
+
+struct aio_req_s {
+	FAR struct aiocb *aiocbp;	/* The AIO control block */
+	FAR struct aio_lio_s *lio;	/* lio_listio() batch, if any */
+	pid_t pid;					/* ID of the waiting task */
+};
+
+/* Requests performed with one transfer */
+
+struct aio_batch_s {
+	FAR struct file *filep;		/* The file */
+	uint8_t op;					/* AIO_OP_READ, AIO_OP_WRITE or AIO_OP_FSYNC */
+	uint8_t nreqs;				/* Number of requests */
+	size_t nbytes;				/* Total size of the transfer */
+	struct aio_req_s reqs[AIO_MERGE_NMAX];
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_addreq
+ *
+ * Description:
+ *   Move a container from the queue of the worker to a batch.
+ *
+ ****************************************************************************/
+
+static void aio_addreq(FAR struct aio_worker_s *worker, FAR struct aio_batch_s *batch, FAR struct aio_container_s *aioc)
+{
+	FAR struct aio_req_s *req = &batch->reqs[batch->nreqs++];
+
+	dq_rem(&aioc->aioc_qlink, &worker->aiow_pending);
+	worker->aiow_npending--;
+
+	req->pid = aioc->aioc_pid;
+	req->lio = aioc->aioc_lio;
+	req->aiocbp = aioc_decant(aioc);
+	batch->nbytes += req->aiocbp->aio_nbytes;
+}
+
+/****************************************************************************
+ * Name: aio_take
+ *
+ * Description:
+ *   Take the first queued request and the ones that can be merged with it.
+ *   Merging stops at the first request to the same file that does not
+ *   continue the transfer, so that the requests to a file are still
+ *   performed in order.  The caller holds the AIO lock.
+ *
+ ****************************************************************************/
+
+static void aio_take(FAR struct aio_worker_s *worker, FAR struct aio_batch_s *batch)
+{
+	FAR struct aio_container_s *aioc;
+	FAR dq_entry_t *entry;
+	FAR dq_entry_t *next;
+	FAR struct aiocb *aiocbp;
+	off_t end;
+
+	batch->nreqs = 0;
+	batch->nbytes = 0;
+
+	entry = dq_peek(&worker->aiow_pending);
+	if (entry == NULL) {
+		return;
+	}
+
+	aioc = AIOC_FROM_QLINK(entry);
+	next = dq_next(entry);
+
+	batch->filep = aioc->u.aioc_filep;
+	batch->op = aioc->aioc_op;
+	end = aioc->aioc_aiocbp->aio_offset + aioc->aioc_aiocbp->aio_nbytes;
+
+	worker->aiow_active = aioc->aioc_inode;
+	worker->aiow_busy = true;
+	aio_addreq(worker, batch, aioc);
+
+	if (CONFIG_FS_AIO_MERGE_MAX == 0 || batch->op == AIO_OP_FSYNC || (batch->op == AIO_OP_WRITE && (batch->filep->f_oflags & O_APPEND) != 0)) {
+		return;
+	}
+
+	for (entry = next; entry && batch->nreqs < AIO_MERGE_NMAX; entry = next) {
+		next = dq_next(entry);
+		aioc = AIOC_FROM_QLINK(entry);
+		if (aioc->u.aioc_filep != batch->filep) {
+			continue;
+		}
+
+		aiocbp = aioc->aioc_aiocbp;
+		if (aioc->aioc_op != batch->op || aiocbp->aio_offset != end || batch->nbytes + aiocbp->aio_nbytes > CONFIG_FS_AIO_MERGE_MAX) {
+			break;
+		}
+
+		end += aiocbp->aio_nbytes;
+		aio_addreq(worker, batch, aioc);
+	}
+}
+
+/****************************************************************************
+ * Name: aio_transfer
+ *
+ * Description:
+ *   Perform one read or write to or from a single buffer.
+ *
+ ****************************************************************************/
+
+static ssize_t aio_transfer(FAR struct aio_batch_s *batch, FAR void *buf, size_t nbytes, off_t offset)
+{
+	ssize_t ret;
+
+	if (batch->op == AIO_OP_READ) {
+		ret = file_pread(batch->filep, buf, nbytes, offset);
+	} else if ((batch->filep->f_oflags & O_APPEND) != 0) {
+		/* Append to the current file position */
+
+		ret = file_write(batch->filep, buf, nbytes);
+	} else {
+		ret = file_pwrite(batch->filep, buf, nbytes, offset);
+	}
+
+	if (ret < 0) {
+		ret = -get_errno();
+		fdbg("ERROR: I/O failed: %d\n", (int)ret);
+		DEBUGASSERT(ret < 0);
+	}
+
+	return ret;
+}
+
+/****************************************************************************
+ * Name: aio_complete
+ *
+ * Description:
+ *   Set the result of a request and notify the waiting task.
+ *
+ ****************************************************************************/
+
+static void aio_complete(FAR struct aio_req_s *req, ssize_t result)
+{
+	FAR struct aio_lio_s *lio = req->lio;
+
+	req->aiocbp->aio_result = result;
+	(void)aio_signal(req->pid, req->aiocbp);
+
+	if (lio != NULL) {
+		aio_liodone(lio);
+	}
+}
+
+/****************************************************************************
+ * Name: aio_perform
+ *
+ * Description:
+ *   Perform the requests of a batch and complete them.
+ *
+ ****************************************************************************/
+
+static void aio_perform(FAR struct aio_batch_s *batch)
+{
+	FAR struct aiocb *first = batch->reqs[0].aiocbp;
+	FAR struct aiocb *aiocbp;
+	FAR uint8_t *bounce = NULL;
+	FAR uint8_t *buf;
+	ssize_t ret;
+	size_t n;
+	int i;
+
+	if (batch->op == AIO_OP_FSYNC) {
+		ret = file_fsync(batch->filep);
+		if (ret < 0) {
+			ret = -get_errno();
+			fdbg("ERROR: fsync failed: %d\n", (int)ret);
+		}
+
+		aio_complete(&batch->reqs[0], ret);
+		return;
+	}
+
+	/* The transfer can use the buffers of the callers if they follow each
+	 * other in memory, else it needs a bounce buffer.
+	 */
+
+	buf = (FAR uint8_t *)first->aio_buf;
+	for (i = 1; i < batch->nreqs; i++) {
+		aiocbp = batch->reqs[i - 1].aiocbp;
+		if ((FAR uint8_t *)batch->reqs[i].aiocbp->aio_buf != (FAR uint8_t *)aiocbp->aio_buf + aiocbp->aio_nbytes) {
+			bounce = (FAR uint8_t *)kmm_malloc(batch->nbytes);
+			break;
+		}
+	}
+
+	if (i < batch->nreqs && bounce == NULL) {
+		/* No memory for the bounce buffer: perform the requests one by one */
+
+		for (i = 0; i < batch->nreqs; i++) {
+			aiocbp = batch->reqs[i].aiocbp;
+			ret = aio_transfer(batch, (FAR void *)aiocbp->aio_buf, aiocbp->aio_nbytes, aiocbp->aio_offset);
+			aio_complete(&batch->reqs[i], ret);
+		}
+
+		return;
+	}
+
+	if (bounce != NULL) {
+		buf = bounce;
+		if (batch->op == AIO_OP_WRITE) {
+			for (i = 0; i < batch->nreqs; i++) {
+				aiocbp = batch->reqs[i].aiocbp;
+				memcpy(bounce, (FAR const void *)aiocbp->aio_buf, aiocbp->aio_nbytes);
+				bounce += aiocbp->aio_nbytes;
+			}
+
+			bounce = buf;
+		}
+	}
+
+	ret = aio_transfer(batch, buf, batch->nbytes, first->aio_offset);
+
+	/* Share the bytes transferred among the requests in order.  An error
+	 * fails them all.
+	 */
+
+	for (i = 0; i < batch->nreqs; i++) {
+		aiocbp = batch->reqs[i].aiocbp;
+		if (ret < 0) {
+			aio_complete(&batch->reqs[i], ret);
+			continue;
+		}
+
+		n = (size_t)ret < aiocbp->aio_nbytes ? (size_t)ret : aiocbp->aio_nbytes;
+		if (bounce != NULL && batch->op == AIO_OP_READ) {
+			memcpy((FAR void *)aiocbp->aio_buf, buf, n);
+			buf += n;
+		}
+
+		ret -= n;
+		aio_complete(&batch->reqs[i], n);
+	}
+
+	if (bounce != NULL) {
+		kmm_free(bounce);
+	}
+}
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+/****************************************************************************
+ * Name: aio_restorepriority
+ *
+ * Description:
+ *   Lower the priority of the worker thread to the highest priority of the
+ *   tasks still waiting for it, or to its default priority.  The caller
+ *   holds the AIO lock.
+ *
+ ****************************************************************************/
+
+static void aio_restorepriority(FAR struct aio_worker_s *worker)
+{
+	struct sched_param param;
+	FAR dq_entry_t *entry;
+	int priority = CONFIG_FS_AIO_PRIORITY;
+
+	for (entry = dq_peek(&worker->aiow_pending); entry; entry = dq_next(entry)) {
+		if (AIOC_FROM_QLINK(entry)->aioc_prio > priority) {
+			priority = AIOC_FROM_QLINK(entry)->aioc_prio;
+		}
+	}
+
+	if (priority != worker->aiow_prio) {
+		param.sched_priority = priority;
+		if (sched_setparam(worker->aiow_pid, &param) == OK) {
+			worker->aiow_prio = priority;
+		}
+	}
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_worker
+ ****************************************************************************/
+
+int aio_worker(int argc, FAR char *argv[])
+{
+	FAR struct aio_worker_s *worker;
+	struct aio_batch_s batch;
+
+	DEBUGASSERT(argc > 1);
+	worker = &g_aio_workers[atoi(argv[1])];
+
+	for (;;) {
+		while (sem_wait(&worker->aiow_sem) < 0) {
+			DEBUGASSERT(get_errno() == EINTR);
+		}
+
+		aio_lock();
+		aio_take(worker, &batch);
+		aio_unlock();
+
+		if (batch.nreqs == 0) {
+			/* Merged or cancelled request */
+
+			continue;
+		}
+
+		aio_perform(&batch);
+
+		aio_lock();
+		worker->aiow_busy = false;
+		worker->aiow_active = NULL;
+#ifdef CONFIG_PRIORITY_INHERITANCE
+		aio_restorepriority(worker);
+#endif
+		aio_unlock();
+	}
+
+	return OK;
+}
+
+#endif							/* CONFIG_FS_AIO */
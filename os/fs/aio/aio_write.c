@@ -56,7 +56,6 @@
 
 #include <tinyara/config.h>
 
-#include <stdarg.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sched.h>
@@ -85,130 +84,6 @@
  * Public Data
  ****************************************************************************/
 
-/****************************************************************************
- * Private Functions
- ****************************************************************************/
-
-/****************************************************************************
- * Name: file_fcntl
- ****************************************************************************/
-
-#ifdef AIO_HAVE_FILEP
-static inline int file_fcntl(FAR struct file *filep, int cmd, ...)
-{
-	va_list ap;
-	int ret;
-
-	va_start(ap, cmd);
-	ret = file_vfcntl(filep, cmd, ap);
-	va_end(ap);
-	return ret;
-}
-#endif
-
-/****************************************************************************
- * Name: aio_write_worker
- *
- * Description:
- *   This function executes on the worker thread and performs the
- *   asynchronous I/O operation.
- *
- * Input Parameters:
- *   arg - Worker argument.  In this case, a pointer to an instance of
- *     struct aiocb cast to void *.
- *
- * Returned Value:
- *   None
- *
- ****************************************************************************/
-
-static void aio_write_worker(FAR void *arg)
-{
-	FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
-	FAR struct aiocb *aiocbp;
-	pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-	uint8_t prio;
-#endif
-	ssize_t nwritten = 0;
-#ifdef AIO_HAVE_FILEP
-	int oflags;
-#endif
-
-	/* Get the information from the container, decant the AIO control block,
-	 * and free the container before starting any I/O.  That will minimize
-	 * the delays by any other threads waiting for a pre-allocated container.
-	 */
-
-	DEBUGASSERT(aioc && aioc->aioc_aiocbp);
-	pid = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-	prio = aioc->aioc_prio;
-#endif
-	aiocbp = aioc_decant(aioc);
-
-#ifdef AIO_HAVE_FILEP
-	{
-		/* Call fcntl(F_GETFL) to get the file open mode. */
-
-		oflags = file_fcntl(aioc->u.aioc_filep, F_GETFL);
-		if (oflags < 0) {
-			int errcode = get_errno();
-			fdbg("ERROR: fcntl failed: %d\n", errcode);
-			aiocbp->aio_result = -errcode;
-			goto errout;
-		}
-
-		/* Perform the write using:
-		 *
-		 *   u.aioc_filep - File structure pointer
-		 *   aio_buf      - Location of buffer
-		 *   aio_nbytes   - Length of transfer
-		 *   aio_offset   - File offset
-		 */
-
-		/* Check if O_APPEND is set in the file open flags */
-
-		if ((oflags & O_APPEND) != 0) {
-			/* Append to the current file position */
-
-			nwritten = file_write(aioc->u.aioc_filep, (FAR const void *)aiocbp->aio_buf, aiocbp->aio_nbytes);
-		} else {
-			nwritten = file_pwrite(aioc->u.aioc_filep, (FAR const void *)aiocbp->aio_buf, aiocbp->aio_nbytes, aiocbp->aio_offset);
-		}
-	}
-#endif
-
-	/* Check the result of the write */
-
-	if (nwritten < 0) {
-		int errcode = get_errno();
-		fdbg("ERROR: write/pwrite failed: %d\n", errcode);
-		DEBUGASSERT(errcode > 0);
-		aiocbp->aio_result = -errcode;
-	} else {
-		aiocbp->aio_result = nwritten;
-	}
-
-#ifdef AIO_HAVE_FILEP
-errout:
-#endif
-
-	/* Signal the client */
-
-	(void)aio_signal(pid, aiocbp);
-
-#ifdef CONFIG_PRIORITY_INHERITANCE
-	/* Restore the low priority worker thread default priority */
-
-	lpwork_restorepriority(prio);
-#endif
-}
-
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
-
 /****************************************************************************
  * Name: aio_write
  *
@@ -331,9 +206,10 @@ int aio_write(FAR struct aiocb *aiocbp)
 		return ERROR;
 	}
 
-	/* Defer the work to the worker thread */
+	/* Defer the work to a worker thread */
 
-	ret = aio_queue(aioc, aio_write_worker);
+	aioc->aioc_op = AIO_OP_WRITE;
+	ret = aio_queue(aioc);
 	if (ret < 0) {
 		/* The result and the errno have already been set */
 
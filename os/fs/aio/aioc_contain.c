@@ -146,6 +146,9 @@ FAR struct aio_container_s *aio_contain(FAR struct aiocb *aiocbp)
 	memset(aioc, 0, sizeof(struct aio_container_s));
 	aioc->aioc_aiocbp = aiocbp;
 	aioc->u.ptr = u.ptr;
+#ifdef AIO_HAVE_FILEP
+	aioc->aioc_inode = u.filep->f_inode;
+#endif
 	aioc->aioc_pid = getpid();
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
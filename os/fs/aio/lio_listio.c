@@ -16,7 +16,7 @@
  *
  ****************************************************************************/
 /****************************************************************************
- * libc/aio/lio_listio.c
+ * fs/aio/lio_listio.c
  *
  *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
@@ -57,338 +57,119 @@
 #include <tinyara/config.h>
 
 #include <unistd.h>
+#include <sched.h>
 #include <signal.h>
+#include <semaphore.h>
 #include <aio.h>
 #include <assert.h>
 #include <errno.h>
+#include <debug.h>
+
+#include <tinyara/kmalloc.h>
+#include <tinyara/semaphore.h>
 
-#include "lib_internal.h"
 #include "aio/aio.h"
 
 #ifdef CONFIG_FS_AIO
 
-/****************************************************************************
- * Pre-processor Definitions
- ****************************************************************************/
-/* Configuration ************************************************************/
-
-/****************************************************************************
- * Private Types
- ****************************************************************************/
-
-struct lio_sighand_s {
-	FAR struct aiocb *const *list;	/* List of I/O operations */
-	FAR struct sigevent *sig;		/* Describes how to signal the caller */
-	int nent;						/* Number or elements in list[] */
-	pid_t pid;						/* ID of client */
-	sigset_t oprocmask;				/* sigprocmask to restore */
-	struct sigaction oact;			/* Signal handler to restore */
-};
-
-/****************************************************************************
- * Private Variables
- ****************************************************************************/
-
-/****************************************************************************
- * Public Variables
- ****************************************************************************/
-
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
 /****************************************************************************
- * Name: lio_checkio
+ * Name: lio_submit
  *
  * Description:
- *  Check if all I/O operations in the list are complete.
+ *   Submit one request of the list, as aio_read() or aio_write() do, as a
+ *   member of a batch.
  *
  * Input Parameters:
- *   list - The list of I/O operations to be performed
- *   nent - The number of elements in the list
+ *   aiocbp - The AIO control block
+ *   lio    - The batch, NULL if the caller is not notified
  *
  * Returned Value:
- *  Zero (OK) is returned if all I/O completed successfully.
- *  -EINPROGRESS is returned if one or more I/Os have not yet completed.
- *  The negated errno value if first error noted in the case where all I/O
- *  completed but one or more I/Os completed with an error.
- *
- * Assumptions:
- *  The scheduler is locked and no I/O can complete asynchronously with
- *  the logic in this function.
+ *   Zero (OK) on success.  Otherwise, -1 is returned and the errno is set
+ *   appropriately.
  *
  ****************************************************************************/
 
-static int lio_checkio(FAR struct aiocb *const *list, int nent)
+static int lio_submit(FAR struct aiocb *aiocbp, FAR struct aio_lio_s *lio)
 {
-	FAR struct aiocb *aiocbp;
+	FAR struct aio_container_s *aioc;
 	int ret;
-	int i;
 
-	ret = OK;					/* Assume success */
-
-	/* Check each entry in the list.  Break out of the loop if any entry
-	 * has not completed.
-	 */
+	/* The result -EINPROGRESS means that the transfer has not yet completed */
 
-	for (i = 0; i < nent; i++) {
-		/* Skip over NULL entries */
+	aiocbp->aio_result = -EINPROGRESS;
+	aiocbp->aio_priv = NULL;
 
-		aiocbp = list[i];
-		if (aiocbp) {
-			/* Check if the I/O has completed */
+	aioc = aio_contain(aiocbp);
+	if (!aioc) {
+		/* The errno has already been set (probably EBADF) */
 
-			if (aiocbp->aio_result == -EINPROGRESS) {
-				/* No.. return -EINPROGRESS */
+		aiocbp->aio_result = -get_errno();
+		return ERROR;
+	}
 
-				return -EINPROGRESS;
-			}
+	/* Account for the request before it can complete */
 
-			/* Check for an I/O error */
+	if (lio != NULL) {
+		aio_lock();
+		lio->lio_remaining++;
+		aio_unlock();
+	}
 
-			else if (aiocbp->aio_result < 0 && ret == OK) {
-				/* Some other error other than -EINPROGRESS */
+	aioc->aioc_op = aiocbp->aio_lio_opcode;
+	aioc->aioc_lio = lio;
+	ret = aio_queue(aioc);
+	if (ret < 0 && lio != NULL) {
+		/* The request was released without completing */
 
-				ret = aiocbp->aio_result;
-			}
-		}
+		aio_lock();
+		lio->lio_remaining--;
+		aio_unlock();
 	}
 
-	/* All of the I/Os have completed */
-
 	return ret;
 }
 
 /****************************************************************************
- * Name: lio_sighandler
- *
- * Description:
- *   Handle the SIGPOLL signal.
- *
- * Input Parameters:
- *   signo   - The number of the signal that we caught (SIGPOLL)
- *   info    - Information accompanying the signal
- *   context - Not used in TinyAra
- *
- * Returned Value:
- *  None
- *
+ * Public Functions
  ****************************************************************************/
 
-static void lio_sighandler(int signo, siginfo_t *info, void *ucontext)
-{
-	FAR struct aiocb *aiocbp;
-	FAR struct lio_sighand_s *sighand;
-	int ret;
-
-	DEBUGASSERT(signo == SIGPOLL && info);
-
-	/* The info structure should contain a pointer to the AIO control block */
-
-	aiocbp = (FAR struct aiocb *)info->si_value.sival_ptr;
-	DEBUGASSERT(aiocbp && aiocbp->aio_result != -EINPROGRESS);
-
-	/* Recover our private data from the AIO control block */
-
-	sighand = (FAR struct lio_sighand_s *)aiocbp->aio_priv;
-	DEBUGASSERT(sighand && sighand->list);
-	aiocbp->aio_priv = NULL;
-
-	/* Prevent any asynchronous I/O completions while the signal handler runs */
-
-	sched_lock();
-
-	/* Check if all of the pending I/O has completed */
-
-	ret = lio_checkio(sighand->list, sighand->nent);
-	if (ret != -EINPROGRESS) {
-		/* All pending I/O has completed */
-		/* Restore the signal handler */
-
-		(void)sigaction(SIGPOLL, &sighand->oact, NULL);
-
-		/* Restore the sigprocmask */
-
-		(void)sigprocmask(SIG_SETMASK, &sighand->oprocmask, NULL);
-
-		/* Signal the client */
-
-		if (sighand->sig->sigev_notify == SIGEV_SIGNAL) {
-#ifdef CONFIG_CAN_PASS_STRUCTS
-			(void)sigqueue(sighand->pid, sighand->sig->sigev_signo, sighand->sig->sigev_value);
-#else
-			(void)sigqueue(sighand->pid, sighand->sig->sigev_signo, sighand->sig->sigev_value.sival_ptr);
-#endif
-		}
-
-		/* And free the container */
-
-		lib_free(sighand);
-	}
-
-	sched_unlock();
-}
-
 /****************************************************************************
- * Name: lio_sigsetup
- *
- * Description:
- *   Setup a signal handler to detect when until all I/O completes.
- *
- * Input Parameters:
- *   list - The list of I/O operations to be performed
- *   nent - The number of elements in the list
- *
- * Returned Value:
- *  Zero (OK) is returned if all I/O completed successfully; Otherwise, a
- *  negated errno value is returned corresponding to the first error
- *  detected.
- *
- * Assumptions:
- *  The scheduler is locked and no I/O can complete asynchronously with
- *  the logic in this function.
- *
+ * Name: aio_liodone
  ****************************************************************************/
 
-static int lio_sigsetup(FAR struct aiocb *const *list, int nent, FAR struct sigevent *sig)
+void aio_liodone(FAR struct aio_lio_s *lio)
 {
-	FAR struct aiocb *aiocbp;
-	FAR struct lio_sighand_s *sighand;
-	sigset_t sigset;
-	struct sigaction act;
-	int status;
-	int i;
-
-	/* Allocate a structure to pass data to the signal handler */
-
-	sighand = (FAR struct lio_sighand_s *)lib_zalloc(sizeof(struct lio_sighand_s));
-	if (!sighand) {
-		fdbg("ERROR: lib_zalloc failed\n");
-		return -ENOMEM;
-	}
-
-	/* Initialize the allocated structure */
-
-	sighand->list = list;
-	sighand->sig = sig;
-	sighand->nent = nent;
-	sighand->pid = getpid();
-
-	/* Save this structure as the private data attached to each aiocb */
-
-	for (i = 0; i < nent; i++) {
-		/* Skip over NULL entries in the list */
+	bool done;
 
-		aiocbp = list[i];
-		if (aiocbp) {
-			FAR void *priv = NULL;
-
-			/* Check if I/O is pending for  this entry */
-
-			if (aiocbp->aio_result == -EINPROGRESS) {
-				priv = (FAR void *)sighand;
-			}
-
-			aiocbp->aio_priv = priv;
-		}
-	}
-
-	/* Make sure that SIGPOLL is not blocked */
-
-	(void)sigemptyset(&sigset);
-	(void)sigaddset(&sigset, SIGPOLL);
-	status = sigprocmask(SIG_UNBLOCK, &sigset, &sighand->oprocmask);
-	if (status != OK) {
-		int errcode = get_errno();
-		fdbg("ERROR sigprocmask failed: %d\n", errcode);
-		DEBUGASSERT(errcode > 0);
-		return -errcode;
-	}
-
-	/* Attach our signal handler */
+	aio_lock();
+	DEBUGASSERT(lio->lio_remaining > 0);
+	done = (--lio->lio_remaining == 0);
+	aio_unlock();
 
-	printf("waiter_main: Registering signal handler\n");
-	act.sa_sigaction = lio_sighandler;
-	act.sa_flags = SA_SIGINFO;
-
-	(void)sigfillset(&act.sa_mask);
-	(void)sigdelset(&act.sa_mask, SIGPOLL);
-
-	status = sigaction(SIGPOLL, &act, &sighand->oact);
-	if (status != OK) {
-		int errcode = get_errno();
-		fdbg("ERROR sigaction failed: %d\n", errcode);
-		DEBUGASSERT(errcode > 0);
-		return -errcode;
+	if (!done) {
+		return;
 	}
 
-	return OK;
-}
-
-/****************************************************************************
- * Name: lio_waitall
- *
- * Description:
- *  Wait for all I/O operations in the list to be complete.
- *
- * Input Parameters:
- *   list - The list of I/O operations to be performed
- *   nent - The number of elements in the list
- *
- * Returned Value:
- *  Zero (OK) is returned if all I/O completed successfully; Otherwise, a
- *  negated errno value is returned corresponding to the first error
- *  detected.
- *
- * Assumptions:
- *  The scheduler is locked and no I/O can complete asynchronously with
- *  the logic in this function.
- *
- ****************************************************************************/
-
-static int lio_waitall(FAR struct aiocb *const *list, int nent)
-{
-	sigset_t set;
-	int ret;
-
-	/* Loop until all I/O completes */
-
-	for (;;) {
-		/* Check if all I/O has completed */
-
-		ret = lio_checkio(list, nent);
-		if (ret != -EINPROGRESS) {
-			/* All I/O has completed.. We are finished.  */
-
-			return ret;
-		}
-
-		/* Then wait for SIGPOLL -- indefinitely.
-		 *
-		 * NOTE: If completion of the I/O causes other signals to be generated
-		 * first, then this will wake up and return EINTR instead of success.
+	if (lio->lio_mode == LIO_WAIT) {
+		/* The batch lives on the stack of the caller, which may return as
+		 * soon as the semaphore is posted.
 		 */
 
-		sigemptyset(&set);
-		sigaddset(&set, SIGPOLL);
-
-		ret = sigwaitinfo(&set, NULL);
-		if (ret < 0) {
-			/* The most likely reason that we would get here is because some
-			 * unrelated signal has been received.
-			 */
-
-			int errcode = get_errno();
-			fdbg("ERROR: sigwaitinfo failed: %d\n", errcode);
-			DEBUGASSERT(errcode > 0);
-			return -errcode;
-		}
+		sem_post(&lio->lio_sem);
+		return;
 	}
-}
 
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
+#ifdef CONFIG_CAN_PASS_STRUCTS
+	(void)sigqueue(lio->lio_pid, lio->lio_sig.sigev_signo, lio->lio_sig.sigev_value);
+#else
+	(void)sigqueue(lio->lio_pid, lio->lio_sig.sigev_signo, lio->lio_sig.sigev_value.sival_ptr);
+#endif
+	kmm_free(lio);
+}
 
 /****************************************************************************
  * Name: lio_listio
@@ -410,8 +191,8 @@ static int lio_waitall(FAR struct aiocb *const *list, int nent)
  *   asynchronous notification occurs when all the requests in 'list' have
  *   completed.
  *
- *   The I/O requests enumerated by 'list' are submitted in an unspecified
- *   order.
+ *   The I/O requests enumerated by 'list' are submitted in order.  The
+ *   caller is notified once, when the last of them completes.
  *
  *   The 'list' argument is an array of pointers to aiocb structures. The
  *   array contains 'nent 'elements. The array may contain NULL elements,
@@ -533,166 +314,118 @@ static int lio_waitall(FAR struct aiocb *const *list, int nent)
 
 int lio_listio(int mode, FAR struct aiocb *const list[], int nent, FAR struct sigevent *sig)
 {
+	FAR struct aio_lio_s *lio = NULL;
 	FAR struct aiocb *aiocbp;
-	int nqueued;
+	struct aio_lio_s waiter;
 	int errcode;
-	int retcode;
-	int status;
 	int ret;
 	int i;
 
-	DEBUGASSERT(mode == LIO_WAIT || mode == LIO_NOWAIT);
 	DEBUGASSERT(list);
 
-	nqueued = 0;				/* No I/O operations yet queued */
+	if (mode != LIO_WAIT && mode != LIO_NOWAIT) {
+		set_errno(EINVAL);
+		return ERROR;
+	}
+
 	ret = OK;					/* Assume success */
 
-	/* Lock the scheduler so that no I/O events can complete on the worker
-	 * thread until we set our wait set up.  Pre-emption will, of course, be
-	 * re-enabled while we are waiting for the signal.
+	/* Set up the batch that notifies the caller when all its requests are
+	 * done.  It counts one extra request until all are submitted, so that
+	 * it cannot complete early.
 	 */
 
-	sched_lock();
+	if (mode == LIO_WAIT) {
+		lio = &waiter;
+		(void)sem_init(&lio->lio_sem, 0, 0);
+		(void)sem_setprotocol(&lio->lio_sem, SEM_PRIO_NONE);
+	} else if (sig && sig->sigev_notify == SIGEV_SIGNAL) {
+		lio = (FAR struct aio_lio_s *)kmm_malloc(sizeof(struct aio_lio_s));
+		if (!lio) {
+			fdbg("ERROR: kmm_malloc failed\n");
+			set_errno(EAGAIN);
+			return ERROR;
+		}
+
+		lio->lio_sig = *sig;
+	}
+
+	if (lio != NULL) {
+		lio->lio_pid = getpid();
+		lio->lio_remaining = 1;
+		lio->lio_mode = mode;
+	}
 
 	/* Submit each asynchronous I/O operation in the list, skipping over NULL
 	 * entries.
 	 */
 
 	for (i = 0; i < nent; i++) {
-		/* Skip over NULL entries */
-
 		aiocbp = list[i];
-		if (aiocbp) {
-			/* Submit the operation according to its opcode */
+		if (!aiocbp) {
+			continue;
+		}
 
-			status = OK;
-			switch (aiocbp->aio_lio_opcode) {
-			case LIO_NOP: {
-				/* Mark the do-nothing operation complete */
+		switch (aiocbp->aio_lio_opcode) {
+		case LIO_NOP:
+			/* Mark the do-nothing operation complete */
 
-				aiocbp->aio_result = OK;
-			}
+			aiocbp->aio_result = OK;
 			break;
 
-			case LIO_READ:
-			case LIO_WRITE: {
-				if (aiocbp->aio_lio_opcode == LIO_READ) {
-					/* Submit the asynchronous read operation */
-
-					status = aio_read(aiocbp);
-				} else {
-					/* Submit the asynchronous write operation */
+		case LIO_READ:
+		case LIO_WRITE:
+			if (lio_submit(aiocbp, lio) < 0) {
+				/* Failed to queue the I/O.  The result is already set. */
 
-					status = aio_write(aiocbp);
-				}
-
-				if (status < 0) {
-					/* Failed to queue the I/O.  Set up the error return. */
-
-					errcode = get_errno();
-					fdbg("ERROR: aio_read/write failed: %d\n", errcode);
-					DEBUGASSERT(errcode > 0);
-					aiocbp->aio_result = -errcode;
-					ret = ERROR;
-				} else {
-					/* Increment the count of successfully queue operations */
-
-					nqueued++;
-				}
+				errcode = get_errno();
+				fdbg("ERROR: aio_read/write failed: %d\n", errcode);
+				ret = ERROR;
 			}
 			break;
 
-			default: {
-				/* Make the invalid operation complete with an error */
+		default:
+			/* Make the invalid operation complete with an error */
 
-				fdbg("ERROR: Unrecognized opcode: %d\n", aiocbp->aio_lio_opcode);
-				aiocbp->aio_result = -EINVAL;
-				ret = ERROR;
-			}
+			fdbg("ERROR: Unrecognized opcode: %d\n", aiocbp->aio_lio_opcode);
+			aiocbp->aio_result = -EINVAL;
+			ret = ERROR;
 			break;
-			}
 		}
 	}
 
-	/* If there was any failure in queuing the I/O, EIO will be returned */
-
-	retcode = EIO;
-
-	/* Now what? Three possibilities:
-	 *
-	 * Case 1: mode == LIO_WAIT
-	 *
-	 *   Ignore the sig argument; Do no return until all I/O completes.
+	/* Drop the extra request: this notifies the caller now if all the
+	 * requests are already done, or if none was queued.
 	 */
 
-	if (mode == LIO_WAIT) {
-		/* Don't wait if all if no I/O was queue */
-
-		if (nqueued > 0) {
-			/* Wait until all I/O completes.  The scheduler will be unlocked
-			 * while we are waiting.
-			 */
-
-			status = lio_waitall(list, nent);
-			if (status < 0 && ret != OK) {
-				/* Something bad happened while waiting and this is the first
-				 * error to be reported.
-				 */
-
-				retcode = -status;
-				ret = ERROR;
-			}
-		}
+	if (lio != NULL) {
+		aio_liodone(lio);
 	}
 
-	/* Case 2: mode == LIO_NOWAIT and sig != NULL
-	 *
-	 *   If any I/O was queued, then setup to signal the caller when all of
-	 *   the transfers complete.
-	 *
-	 *   If no I/O was queue, then we I suppose that we need to signal the
-	 *   caller ourself?
-	 */
-
-	else if (sig && sig->sigev_notify == SIGEV_SIGNAL) {
-		if (nqueued > 0) {
-			/* Setup a signal handler to detect when until all I/O completes. */
-
-			status = lio_sigsetup(list, nent, sig);
-			if (status < 0 && ret != OK) {
-				/* Something bad happened while setting up the signal and this
-				 * is the first error to be reported.
-				 */
+	if (mode == LIO_WAIT) {
+		/* Wait until all I/O completes.  The SIGPOLL sent for each request
+		 * may interrupt the wait.
+		 */
 
-				retcode = -status;
-				ret = ERROR;
-			}
-		} else {
-#ifdef CONFIG_CAN_PASS_STRUCTS
-			status = sigqueue(getpid(), sig->sigev_signo, sig->sigev_value);
-#else
-			status = sigqueue(getpid(), sig->sigev_signo, sig->sigev_value.sival_ptr);
-#endif
+		while (sem_wait(&waiter.lio_sem) < 0) {
+			DEBUGASSERT(get_errno() == EINTR);
+		}
 
-			if (status < 0 && ret != OK) {
-				/* Something bad happened while signalling ourself and this is
-				 * the first error to be reported.
-				 */
+		(void)sem_destroy(&waiter.lio_sem);
 
-				retcode = get_errno();
+		for (i = 0; i < nent; i++) {
+			if (list[i] && list[i]->aio_result < 0) {
 				ret = ERROR;
 			}
 		}
 	}
 
-	/* Case 3: mode == LIO_NOWAIT and sig == NULL
-	 *
-	 *   Just return now.
+	/* If there was any failure in queuing or performing the I/O, EIO is
+	 * returned.
 	 */
 
-	sched_unlock();
 	if (ret < 0) {
-		set_errno(retcode);
+		set_errno(EIO);
 		return ERROR;
 	}
 
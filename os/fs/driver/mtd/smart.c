@@ -68,6 +68,9 @@
 #include <string.h>
 #include <debug.h>
 #include <errno.h>
+#ifdef CONFIG_MTD_SMART_BGGC
+#include <semaphore.h>
+#endif
 
 #include <crc8.h>
 #include <crc16.h>
@@ -79,6 +82,10 @@
 #include <tinyara/fs/mtd.h>
 #include <tinyara/fs/smart_procfs.h>
 #include <tinyara/fs/smart.h>
+#ifdef CONFIG_MTD_SMART_BGGC
+#include <tinyara/clock.h>
+#include <tinyara/wqueue.h>
+#endif
 
 /****************************************************************************
  * Private Definitions
@@ -141,6 +148,12 @@
 #define SMART_BAD_SECTOR_NUMBER         11
 #define SMART_GOOD_SECTOR_RETRY     8
 
+/* Free sectors kept back from allocation: one erase block that garbage
+ * collection can relocate a block into, plus a few for its metadata.
+ */
+
+#define SMART_GC_RESERVE(dev)       ((dev)->sectorsPerBlk + 4)
+
 #if defined(CONFIG_MTD_SMART_READAHEAD) || (defined(CONFIG_DRVR_WRITABLE) && \
 	defined(CONFIG_MTD_SMART_WRITEBUFFER))
 #define SMART_HAVE_RWBUFFER 1
@@ -314,10 +327,29 @@ struct smart_struct_s {
 	uint16_t cache_lastlog;	/* Keep track of the last sector accessed */
 	uint16_t cache_lastphys;	/* Keep the physical sector number also */
 	uint16_t cache_nextbirth;	/* Sector cache aging value */
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	FAR uint8_t *sPackMap;		/* Packed virtual to physical sector map */
+	uint8_t mapbits;			/* Number of bits per sPackMap entry */
+#endif
 #endif
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
 	FAR uint8_t *erasecounts;	/* Number of erases for each erase block */
 #endif
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+	uint16_t cpblock;			/* First erase block of the checkpoint area */
+	uint16_t cpslotblocks;		/* Erase blocks per checkpoint slot */
+	uint32_t cpgeneration;		/* Generation of the newest checkpoint */
+	uint8_t cpslot;				/* Checkpoint slot holding that generation */
+	bool cpvalid;				/* The newest checkpoint matches the volume */
+#endif
+#ifdef CONFIG_MTD_SMART_BGGC
+	sem_t exclsem;				/* Serializes driver calls and the GC worker */
+	struct work_s gcwork;		/* Background garbage collection work */
+	uint16_t gcblock;			/* Erase block being collected, or 0xFFFF */
+	uint16_t gcsector;			/* Next physical sector of gcblock to move */
+	uint16_t gcfreecount;		/* Free sectors of gcblock when it was chosen */
+	uint16_t gcmoved;			/* Sectors moved out of gcblock so far */
+#endif
 #ifdef CONFIG_MTD_SMART_ALLOC_DEBUG
 	size_t bytesalloc;
 	struct smart_alloc_s
@@ -328,6 +360,46 @@ struct smart_struct_s {
 #define SMART_WEARFLAGS_FORCE_REORG    0x01
 #define SMART_WEARFLAGS_WRITE_NEEDED   0x02
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+/* Mount checkpoint.  CONFIG_MTD_SMART_CHECKPOINT_SLOTS slots are kept at the
+ * end of the MTD device, outside the volume, and written in turn so that
+ * their erases are spread.  A slot holds this header followed by the sector
+ * map, the free and release counts and the wear status, exactly as they
+ * are kept in RAM.  The 'valid' byte is left erased when the checkpoint is
+ * written and is programmed before the volume is first changed after that.
+ */
+
+#define SMART_CP_MAGIC      "SMCP"
+#define SMART_CP_NSEGS      3
+
+#define SMART_CP_SLOTBLOCK(dev, slot)  ((dev)->cpblock + (slot) * (dev)->cpslotblocks)
+#define SMART_CP_SLOTSIZE(dev)         ((uint32_t)(dev)->cpslotblocks * (dev)->geo.erasesize)
+
+struct smart_checkpoint_s {
+	uint8_t magic[4];			/* SMART_CP_MAGIC */
+	uint32_t generation;		/* Incremented by every checkpoint written */
+	uint32_t crc;				/* CRC-32 from sectorsize to the end of the data */
+	uint16_t sectorsize;		/* Volume geometry the checkpoint applies to */
+	uint16_t totalsectors;
+	uint16_t neraseblocks;
+	uint16_t freesectors;		/* Volume state at the time of the checkpoint */
+	uint16_t releasesectors;
+	uint8_t formatstatus;
+	uint8_t namesize;
+	uint8_t formatversion;
+	uint8_t wearflags;
+	uint16_t reserved;
+	uint32_t uneven_wearcount;
+	uint8_t valid;				/* Erased state while the checkpoint is valid */
+	uint8_t pad[3];
+};
+
+struct smart_cpseg_s {
+	FAR uint8_t *data;
+	uint32_t len;
+};
+#endif
+
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
 struct smart_multiroot_device_s {
 	FAR struct smart_struct_s *dev;
@@ -429,6 +501,13 @@ static void smart_erase_block_if_empty(FAR struct smart_struct_s *dev, uint16_t
 static int smart_relocate_sector(FAR struct smart_struct_s *dev, uint16_t oldsector, uint16_t newsector);
 static int smart_validate_crc(FAR struct smart_struct_s *dev);
 static crc_t smart_calc_sector_crc(FAR struct smart_struct_s *dev);
+#ifdef CONFIG_MTD_SMART_BGGC
+static void smart_gc_release(FAR struct smart_struct_s *dev, bool undomoves);
+#endif
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_checkpoint_write(FAR struct smart_struct_s *dev);
+static void smart_checkpoint_invalidate(FAR struct smart_struct_s *dev);
+#endif
 
 /****************************************************************************
  * Private Data
@@ -518,6 +597,35 @@ static void smart_free(FAR struct smart_struct_s *dev, FAR void *ptr)
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: smart_semtake / smart_semgive
+ *
+ * Description: Get / release exclusive access to the SMART device.  This
+ *              serializes the block driver interfaces with the background
+ *              garbage collection worker.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_BGGC
+static void smart_semtake(FAR struct smart_struct_s *dev)
+{
+	/* Take the semaphore (perhaps waiting) */
+
+	while (sem_wait(&dev->exclsem) != 0) {
+		/* The only case that an error should occur here is if
+		 * the wait was awakened by a signal.
+		 */
+
+		DEBUGASSERT(get_errno() == EINTR);
+	}
+}
+
+static inline void smart_semgive(FAR struct smart_struct_s *dev)
+{
+	sem_post(&dev->exclsem);
+}
+#endif
+
 /****************************************************************************
  * Name: smart_open
  *
@@ -540,7 +648,27 @@ static int smart_open(FAR struct inode *inode)
 
 static int smart_close(FAR struct inode *inode)
 {
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+	FAR struct smart_struct_s *dev;
+#endif
+
 	fvdbg("Entry\n");
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+	DEBUGASSERT(inode && inode->i_private);
+	dev = (FAR struct smart_struct_s *)inode->i_private;
+
+	/* Save a checkpoint so that the next mount doesn't need a full scan. */
+
+#ifdef CONFIG_MTD_SMART_BGGC
+	smart_semtake(dev);
+#endif
+	(void)smart_checkpoint_write(dev);
+#ifdef CONFIG_MTD_SMART_BGGC
+	smart_semgive(dev);
+#endif
+#endif
+
 	return OK;
 }
 
@@ -821,6 +949,10 @@ static ssize_t smart_write(FAR struct inode *inode, FAR const unsigned char *buf
 
 	/* I think maybe we need to lock on a mutex here. */
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+	smart_checkpoint_invalidate(dev);
+#endif
+
 	/* Get the aligned block.  Here is is assumed: (1) The number of R/W blocks
 	 * per erase block is a power of 2, and (2) the erase begins with that same
 	 * alignment.
@@ -1009,12 +1141,24 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 		smart_free(dev, dev->sBitMap);
 		dev->sBitMap = NULL;
 	}
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	if (dev->sPackMap != NULL) {
+		smart_free(dev, dev->sPackMap);
+		dev->sPackMap = NULL;
+	}
+#endif
 
 	dev->cache_entries = 0;
 	dev->cache_lastlog = 0xFFFF;
 	dev->cache_nextbirth = 0;
 #endif
 
+#ifdef CONFIG_MTD_SMART_BGGC
+	/* The sector counts are about to be rebuilt. */
+
+	dev->gcblock = 0xFFFF;
+#endif
+
 	if (dev->rwbuffer != NULL) {
 		smart_free(dev, dev->rwbuffer);
 		dev->rwbuffer = NULL;
@@ -1098,6 +1242,28 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 		goto errexit;
 	}
 
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	/* Allocate the packed sector map.  Each entry is just wide enough to
+	 * hold any physical sector number plus an all-ones "unmapped" value.
+	 * Two extra bytes let every entry be accessed with a 3-byte window.
+	 * If the map does not fit in the configured budget, we fall back to
+	 * the sector cache.
+	 */
+
+	for (dev->mapbits = 1; (1UL << dev->mapbits) <= totalsectors; dev->mapbits++) ;
+
+	allocsize = ((totalsectors * dev->mapbits + 7) >> 3) + 2;
+	if (allocsize <= CONFIG_MTD_SMART_PACKED_MAP_MAXSIZE) {
+		dev->sPackMap = (FAR uint8_t *)smart_malloc(dev, allocsize, "Packed map");
+	}
+
+	if (dev->sPackMap != NULL) {
+		memset(dev->sPackMap, 0xFF, allocsize);
+	} else {
+		fdbg("SMART packed map (%ld bytes) not available, using sector cache\n", allocsize);
+	}
+#endif
+
 	/* Calculate the alloc size of the freesector and release sector arrays. */
 
 #ifdef CONFIG_MTD_SMART_PACK_COUNTS
@@ -1209,6 +1375,11 @@ errexit:
 	if (dev->sBitMap) {
 		smart_free(dev, dev->sBitMap);
 	}
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	if (dev->sPackMap) {
+		smart_free(dev, dev->sPackMap);
+	}
+#endif
 
 	if (dev->sCache) {
 		smart_free(dev, dev->sCache);
@@ -1292,6 +1463,65 @@ errout:
 	return ret;
 }
 
+/****************************************************************************
+ * Name: smart_packmap_get
+ *
+ * Description: Return the physical sector mapped to a logical sector in the
+ *              packed sector map, or 0xFFFF if the logical sector is not
+ *              mapped.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+static uint16_t smart_packmap_get(FAR struct smart_struct_s *dev, uint16_t logical)
+{
+	FAR uint8_t *entry;
+	uint32_t bitpos;
+	uint32_t mask;
+	uint32_t value;
+
+	bitpos = (uint32_t)logical * dev->mapbits;
+	entry = &dev->sPackMap[bitpos >> 3];
+	mask = (1UL << dev->mapbits) - 1;
+
+	value = (uint32_t)entry[0] | ((uint32_t)entry[1] << 8) | ((uint32_t)entry[2] << 16);
+	value = (value >> (bitpos & 0x07)) & mask;
+
+	return value == mask ? 0xFFFF : (uint16_t)value;
+}
+
+/****************************************************************************
+ * Name: smart_packmap_set
+ *
+ * Description: Set the physical sector mapped to a logical sector in the
+ *              packed sector map.  A physical sector of 0xFFFF unmaps the
+ *              logical sector.
+ *
+ ****************************************************************************/
+
+static void smart_packmap_set(FAR struct smart_struct_s *dev, uint16_t logical, uint16_t physical)
+{
+	FAR uint8_t *entry;
+	uint32_t bitpos;
+	uint32_t mask;
+	uint32_t value;
+	int shift;
+
+	bitpos = (uint32_t)logical * dev->mapbits;
+	entry = &dev->sPackMap[bitpos >> 3];
+	shift = bitpos & 0x07;
+	mask = (1UL << dev->mapbits) - 1;
+
+	value = (uint32_t)entry[0] | ((uint32_t)entry[1] << 8) | ((uint32_t)entry[2] << 16);
+	value &= ~(mask << shift);
+	value |= (physical == 0xFFFF ? mask : (uint32_t)physical) << shift;
+
+	entry[0] = (uint8_t)value;
+	entry[1] = (uint8_t)(value >> 8);
+	entry[2] = (uint8_t)(value >> 16);
+}
+#endif
+
 /****************************************************************************
  * Name: smart_add_sector_to_cache
  *
@@ -1311,6 +1541,15 @@ static int smart_add_sector_to_cache(FAR struct smart_struct_s *dev, uint16_t lo
 	uint16_t index, x;
 	uint16_t oldest;
 
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	/* With a packed map every sector is mapped, so there is nothing to cache. */
+
+	if (dev->sPackMap != NULL) {
+		smart_packmap_set(dev, logical, physical);
+		return 0;
+	}
+#endif
+
 	/* If we aren't full yet, just add the sector to the end of the list. */
 
 	index = 1;
@@ -1381,6 +1620,12 @@ static uint16_t smart_cache_lookup(FAR struct smart_struct_s *dev, uint16_t logi
 	struct smart_sect_header_s header;
 	size_t readaddress;
 
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	if (dev->sPackMap != NULL) {
+		return smart_packmap_get(dev, logical);
+	}
+#endif
+
 	physical = 0xFFFF;
 
 	/* Test if searching for the last sector used. */
@@ -1444,7 +1689,7 @@ static uint16_t smart_cache_lookup(FAR struct smart_struct_s *dev, uint16_t logi
 
 				/* Test if this sector has been release and skip it if it has. */
 
-				if (SECOR_IS_RELEASED(header)) {
+				if (SECTOR_IS_RELEASED(header)) {
 					continue;
 				}
 
@@ -1489,6 +1734,13 @@ static void smart_update_cache(FAR struct smart_struct_s *dev, uint16_t logical,
 {
 	uint16_t x;
 
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	if (dev->sPackMap != NULL) {
+		smart_packmap_set(dev, logical, physical);
+		return;
+	}
+#endif
+
 	/* Scan through all cache entries and find the logical sector entry */
 
 	for (x = 0; x < dev->cache_entries; x++) {
@@ -1686,6 +1938,366 @@ static int smart_set_wear_level(FAR struct smart_struct_s *dev, uint16_t block,
 	return 0;
 }
 #endif
+
+/****************************************************************************
+ * Name: smart_checkpoint_segments
+ *
+ * Description: Describe the data saved in a checkpoint: the header, the
+ *              sector map with the release and free counts that follow it
+ *              in the same allocation, and the wear status.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_checkpoint_segments(FAR struct smart_struct_s *dev, FAR struct smart_checkpoint_s *cp, FAR struct smart_cpseg_s *segs)
+{
+	int nsegs = 0;
+
+	segs[nsegs].data = (FAR uint8_t *)cp;
+	segs[nsegs++].len = sizeof(struct smart_checkpoint_s);
+	segs[nsegs].data = (FAR uint8_t *)dev->sMap;
+	segs[nsegs++].len = dev->totalsectors * sizeof(uint16_t) + (dev->neraseblocks << 1);
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+	segs[nsegs].data = dev->wearstatus;
+	segs[nsegs++].len = dev->neraseblocks >> SMART_WEAR_BIT_DIVIDE;
+#endif
+
+	return nsegs;
+}
+
+/****************************************************************************
+ * Name: smart_checkpoint_size
+ *
+ * Description: Return the number of bytes of a checkpoint of the volume.
+ *
+ ****************************************************************************/
+
+static uint32_t smart_checkpoint_size(FAR struct smart_struct_s *dev)
+{
+	struct smart_cpseg_s segs[SMART_CP_NSEGS];
+	uint32_t size = 0;
+	int nsegs;
+	int x;
+
+	nsegs = smart_checkpoint_segments(dev, NULL, segs);
+	for (x = 0; x < nsegs; x++) {
+		size += segs[x].len;
+	}
+
+	return size;
+}
+
+/****************************************************************************
+ * Name: smart_checkpoint_crc
+ *
+ * Description: Calculate the CRC of a checkpoint.  The magic, generation
+ *              and crc fields and the valid byte are not covered.
+ *
+ ****************************************************************************/
+
+static uint32_t smart_checkpoint_crc(FAR struct smart_cpseg_s *segs, int nsegs)
+{
+	uint32_t crc;
+	int x;
+
+	crc = crc32part(segs[0].data + offsetof(struct smart_checkpoint_s, sectorsize), offsetof(struct smart_checkpoint_s, valid) - offsetof(struct smart_checkpoint_s, sectorsize), 0);
+	for (x = 1; x < nsegs; x++) {
+		crc = crc32part(segs[x].data, segs[x].len, crc);
+	}
+
+	return crc;
+}
+
+/****************************************************************************
+ * Name: smart_checkpoint_transfer
+ *
+ * Description: Read or write the checkpoint segments sequentially from / to
+ *              a checkpoint slot, one sector at a time through rwbuffer.
+ *
+ ****************************************************************************/
+
+static int smart_checkpoint_transfer(FAR struct smart_struct_s *dev, uint8_t slot, FAR struct smart_cpseg_s *segs, int nsegs, bool write)
+{
+	size_t block;
+	size_t pos;
+	uint32_t offset;
+	uint32_t len;
+	int ret;
+	int x;
+
+	block = SMART_CP_SLOTBLOCK(dev, slot) * (dev->geo.erasesize / dev->geo.blocksize);
+	pos = 0;
+
+	for (x = 0; x < nsegs; x++) {
+		for (offset = 0; offset < segs[x].len; offset += len) {
+			if (pos == 0 && !write) {
+				ret = MTD_BREAD(dev->mtd, block, dev->mtdBlksPerSector, (FAR uint8_t *)dev->rwbuffer);
+				if (ret != dev->mtdBlksPerSector) {
+					return -EIO;
+				}
+			}
+
+			len = segs[x].len - offset;
+			if (len > dev->sectorsize - pos) {
+				len = dev->sectorsize - pos;
+			}
+
+			if (write) {
+				memcpy(&dev->rwbuffer[pos], &segs[x].data[offset], len);
+			} else {
+				memcpy(&segs[x].data[offset], &dev->rwbuffer[pos], len);
+			}
+
+			pos += len;
+			if (pos == dev->sectorsize) {
+				if (write) {
+					ret = MTD_BWRITE(dev->mtd, block, dev->mtdBlksPerSector, (FAR uint8_t *)dev->rwbuffer);
+					if (ret != dev->mtdBlksPerSector) {
+						return -EIO;
+					}
+				}
+
+				block += dev->mtdBlksPerSector;
+				pos = 0;
+			}
+		}
+	}
+
+	if (write && pos > 0) {
+		memset(&dev->rwbuffer[pos], CONFIG_SMARTFS_ERASEDSTATE, dev->sectorsize - pos);
+		ret = MTD_BWRITE(dev->mtd, block, dev->mtdBlksPerSector, (FAR uint8_t *)dev->rwbuffer);
+		if (ret != dev->mtdBlksPerSector) {
+			return -EIO;
+		}
+	}
+
+	return OK;
+}
+
+/****************************************************************************
+ * Name: smart_checkpoint_write
+ *
+ * Description: Write a checkpoint of the volume state to the slot after
+ *              the one of the newest checkpoint.  Nothing is written if the
+ *              newest checkpoint still matches the volume.
+ *
+ ****************************************************************************/
+
+static int smart_checkpoint_write(FAR struct smart_struct_s *dev)
+{
+	struct smart_checkpoint_s cp;
+	struct smart_cpseg_s segs[SMART_CP_NSEGS];
+	uint32_t size;
+	uint8_t slot;
+	int nsegs;
+	int ret;
+
+	if (dev->cpvalid || dev->formatstatus != SMART_FMT_STAT_FORMATTED || dev->sMap == NULL) {
+		return OK;
+	}
+#ifdef CONFIG_MTD_SMART_ENABLE_CRC
+	/* Sectors allocated but not yet written only exist in RAM. */
+
+	if (dev->allocsector != NULL) {
+		return -EBUSY;
+	}
+#endif
+#ifdef CONFIG_MTD_SMART_BGGC
+	/* The counts of a block being collected are not consistent. */
+
+	if (dev->gcblock != 0xFFFF) {
+		return -EBUSY;
+	}
+#endif
+
+	memset(&cp, 0, sizeof(struct smart_checkpoint_s));
+	memcpy(cp.magic, SMART_CP_MAGIC, sizeof(cp.magic));
+	cp.generation = dev->cpgeneration + 1;
+	cp.sectorsize = dev->sectorsize;
+	cp.totalsectors = dev->totalsectors;
+	cp.neraseblocks = dev->neraseblocks;
+	cp.freesectors = dev->freesectors;
+	cp.releasesectors = dev->releasesectors;
+	cp.formatstatus = dev->formatstatus;
+	cp.namesize = dev->namesize;
+	cp.formatversion = dev->formatversion;
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+	cp.wearflags = dev->wearflags;
+	cp.uneven_wearcount = dev->uneven_wearcount;
+#endif
+	cp.valid = CONFIG_SMARTFS_ERASEDSTATE;
+	memset(cp.pad, CONFIG_SMARTFS_ERASEDSTATE, sizeof(cp.pad));
+
+	size = smart_checkpoint_size(dev);
+	if (size > SMART_CP_SLOTSIZE(dev)) {
+		fdbg("Checkpoint needs %d bytes, slot has %d\n", size, SMART_CP_SLOTSIZE(dev));
+		return -ENOSPC;
+	}
+
+	nsegs = smart_checkpoint_segments(dev, &cp, segs);
+	cp.crc = smart_checkpoint_crc(segs, nsegs);
+
+	/* Never overwrite the newest checkpoint, so that a power loss while
+	 * writing leaves at worst a stale slot and an invalid one.
+	 */
+
+	slot = dev->cpgeneration == 0 ? 0 : (dev->cpslot + 1) % CONFIG_MTD_SMART_CHECKPOINT_SLOTS;
+
+	ret = MTD_ERASE(dev->mtd, SMART_CP_SLOTBLOCK(dev, slot), dev->cpslotblocks);
+	if (ret < 0) {
+		fdbg("Error %d erasing checkpoint slot %d\n", ret, slot);
+		return ret;
+	}
+
+	ret = smart_checkpoint_transfer(dev, slot, segs, nsegs, true);
+	if (ret < 0) {
+		fdbg("Error %d writing checkpoint slot %d\n", ret, slot);
+		return ret;
+	}
+
+	dev->cpgeneration = cp.generation;
+	dev->cpslot = slot;
+	dev->cpvalid = true;
+
+	fvdbg("Wrote checkpoint %d to slot %d\n", cp.generation, slot);
+	return OK;
+}
+
+/****************************************************************************
+ * Name: smart_checkpoint_invalidate
+ *
+ * Description: Mark the newest checkpoint as stale.  Must be called before
+ *              anything on the volume is changed.
+ *
+ ****************************************************************************/
+
+static void smart_checkpoint_invalidate(FAR struct smart_struct_s *dev)
+{
+	uint8_t stale;
+	int ret;
+
+	if (!dev->cpvalid) {
+		return;
+	}
+
+	stale = (uint8_t)~CONFIG_SMARTFS_ERASEDSTATE;
+	ret = smart_bytewrite(dev, SMART_CP_SLOTBLOCK(dev, dev->cpslot) * dev->geo.erasesize + offsetof(struct smart_checkpoint_s, valid), 1, &stale);
+	if (ret < 0) {
+		fdbg("Error %d invalidating checkpoint\n", ret);
+	}
+
+	dev->cpvalid = false;
+}
+
+/****************************************************************************
+ * Name: smart_checkpoint_load
+ *
+ * Description: Restore the volume state from the newest valid checkpoint.
+ *              Called by smart_scan() after the sector size is known.  On
+ *              failure the RAM state is left for smart_scan() to rebuild.
+ *
+ ****************************************************************************/
+
+static int smart_checkpoint_load(FAR struct smart_struct_s *dev)
+{
+	struct smart_checkpoint_s cp[CONFIG_MTD_SMART_CHECKPOINT_SLOTS];
+	struct smart_cpseg_s segs[SMART_CP_NSEGS];
+	bool candidate[CONFIG_MTD_SMART_CHECKPOINT_SLOTS];
+	uint32_t size;
+	int slot;
+	int nsegs;
+	int ret;
+	int x;
+
+	dev->cpvalid = false;
+
+	/* The slots are sized for the default sector size.  A volume formatted
+	 * with smaller sectors may have a sector map that does not fit.
+	 */
+
+	size = smart_checkpoint_size(dev);
+	if (size > SMART_CP_SLOTSIZE(dev)) {
+		fwdbg("Checkpoint needs %d bytes, slot has %d: mount always scans\n", size, SMART_CP_SLOTSIZE(dev));
+		return -ENOSPC;
+	}
+
+	/* Read the slot headers and check which could be used. */
+
+	for (x = 0; x < CONFIG_MTD_SMART_CHECKPOINT_SLOTS; x++) {
+		candidate[x] = false;
+		ret = MTD_READ(dev->mtd, SMART_CP_SLOTBLOCK(dev, x) * dev->geo.erasesize, sizeof(struct smart_checkpoint_s), (FAR uint8_t *)&cp[x]);
+		if (ret != sizeof(struct smart_checkpoint_s)) {
+			continue;
+		}
+
+		if (memcmp(cp[x].magic, SMART_CP_MAGIC, sizeof(cp[x].magic)) != 0) {
+			continue;
+		}
+
+		/* Remember the newest generation even if it is stale, so that the
+		 * next checkpoint goes to the slot after it.
+		 */
+
+		if (cp[x].generation > dev->cpgeneration) {
+			dev->cpgeneration = cp[x].generation;
+			dev->cpslot = x;
+		}
+
+		candidate[x] = cp[x].valid == CONFIG_SMARTFS_ERASEDSTATE && cp[x].sectorsize == dev->sectorsize && cp[x].totalsectors == dev->totalsectors && cp[x].neraseblocks == dev->neraseblocks;
+	}
+
+	/* Try the valid checkpoints from the newest one, in case the newest
+	 * one is corrupted.
+	 */
+
+	for (;;) {
+		slot = -1;
+		for (x = 0; x < CONFIG_MTD_SMART_CHECKPOINT_SLOTS; x++) {
+			if (candidate[x] && (slot < 0 || cp[x].generation > cp[slot].generation)) {
+				slot = x;
+			}
+		}
+
+		if (slot < 0) {
+			break;
+		}
+
+		candidate[slot] = false;
+		nsegs = smart_checkpoint_segments(dev, &cp[slot], segs);
+		ret = smart_checkpoint_transfer(dev, slot, segs, nsegs, false);
+		if (ret < 0 || smart_checkpoint_crc(segs, nsegs) != cp[slot].crc) {
+			fdbg("Checkpoint %d in slot %d is corrupted\n", cp[slot].generation, slot);
+			continue;
+		}
+
+		dev->freesectors = cp[slot].freesectors;
+		dev->releasesectors = cp[slot].releasesectors;
+		dev->formatstatus = cp[slot].formatstatus;
+		dev->namesize = cp[slot].namesize;
+		dev->formatversion = cp[slot].formatversion;
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+		dev->wearflags = cp[slot].wearflags;
+		dev->uneven_wearcount = cp[slot].uneven_wearcount;
+		smart_find_wear_minmax(dev);
+#endif
+
+		/* Whichever slot was used must be invalidated on the first change. */
+
+		dev->cpslot = slot;
+		dev->cpvalid = true;
+		return OK;
+	}
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+	/* The wear status may have been partly overwritten. */
+
+	memset(dev->wearstatus, CONFIG_SMARTFS_ERASEDSTATE, dev->neraseblocks >> SMART_WEAR_BIT_DIVIDE);
+#endif
+
+	return -ENOENT;
+}
+#endif							/* CONFIG_MTD_SMART_CHECKPOINT */
+
 /****************************************************************************
  * Name: smart_scan
  *
@@ -1779,6 +2391,15 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 	}
 #endif
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+	/* A valid checkpoint holds everything the scan below rebuilds. */
+
+	if (smart_checkpoint_load(dev) == OK) {
+		fvdbg("Loaded checkpoint %d\n", dev->cpgeneration);
+		return OK;
+	}
+#endif
+
 	dev->formatstatus = SMART_FMT_STAT_NOFMT;
 	dev->freesectors = dev->availSectPerBlk * dev->geo.neraseblocks;
 	dev->releasesectors = 0;
@@ -1811,6 +2432,11 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 	/* Clear all logical sector used bits. */
 
 	memset(dev->sBitMap, 0, (dev->totalsectors + 7) >> 3);
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	if (dev->sPackMap != NULL) {
+		memset(dev->sPackMap, 0xFF, ((dev->totalsectors * dev->mapbits + 7) >> 3) + 2);
+	}
+#endif
 #endif
 
 	/* Now scan the MTD device. */
@@ -2089,50 +2715,58 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 			readaddress = dev->sMap[logicalsector] * dev->mtdBlksPerSector * dev->geo.blocksize;
 #else
 			/* For minimize RAM, we have to rescan to find the 1st sector claiming to
-			 * be this logical sector.
+			 * be this logical sector, unless the packed map already holds it.
 			 */
 
-			for (dupsector = 0; dupsector < sector; dupsector++) {
-				/* Calculate the read address for this sector. */
-
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+			if (dev->sPackMap != NULL) {
+				dupsector = smart_packmap_get(dev, logicalsector);
 				readaddress = dupsector * dev->mtdBlksPerSector * dev->geo.blocksize;
+			} else
+#endif
+			{
+				for (dupsector = 0; dupsector < sector; dupsector++) {
+					/* Calculate the read address for this sector. */
 
-				/* Read the header for this sector. */
+					readaddress = dupsector * dev->mtdBlksPerSector * dev->geo.blocksize;
 
-				ret = MTD_READ(dev->mtd, readaddress, sizeof(struct smart_sect_header_s), (FAR uint8_t *)&header);
-				if (ret != sizeof(struct smart_sect_header_s)) {
-					goto err_out;
-				}
+					/* Read the header for this sector. */
 
-				/* Get the logical sector number for this physical sector. */
+					ret = MTD_READ(dev->mtd, readaddress, sizeof(struct smart_sect_header_s), (FAR uint8_t *)&header);
+					if (ret != sizeof(struct smart_sect_header_s)) {
+						goto err_out;
+					}
 
-				duplogsector = *((FAR uint16_t *)header.logicalsector);
+					/* Get the logical sector number for this physical sector. */
+
+					duplogsector = *((FAR uint16_t *)header.logicalsector);
 #if CONFIG_SMARTFS_ERASEDSTATE == 0x00
-				if (duplogsector == 0) {
-					duplogsector = -1;
-				}
+					if (duplogsector == 0) {
+						duplogsector = -1;
+					}
 #endif
 
-				/* Test if this sector has been committed. */
+					/* Test if this sector has been committed. */
 
-				if (!SECTOR_IS_COMMITTED(header)) {
-					continue;
-				}
+					if (!SECTOR_IS_COMMITTED(header)) {
+						continue;
+					}
 
-				/* Test if this sector has been release and skip it if it has. */
+					/* Test if this sector has been release and skip it if it has. */
 
-				if (SECTOR_IS_RELEASED(header)) {
-					continue;
-				}
+					if (SECTOR_IS_RELEASED(header)) {
+						continue;
+					}
 
-				if ((header.status & SMART_STATUS_VERBITS) != SMART_STATUS_VERSION) {
-					continue;
-				}
+					if ((header.status & SMART_STATUS_VERBITS) != SMART_STATUS_VERSION) {
+						continue;
+					}
 
-				/* Now compare if this logical sector matches the current sector. */
+					/* Now compare if this logical sector matches the current sector. */
 
-				if (duplogsector == logicalsector) {
-					break;
+					if (duplogsector == logicalsector) {
+						break;
+					}
 				}
 			}
 #endif
@@ -2204,6 +2838,11 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 		if (logicalsector < dev->reservedsector) {
 			smart_add_sector_to_cache(dev, logicalsector, winner, __LINE__);
 		}
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+		else if (dev->sPackMap != NULL) {
+			smart_packmap_set(dev, logicalsector, winner);
+		}
+#endif
 #endif
 	}
 
@@ -2388,6 +3027,21 @@ static void smart_erase_block_if_empty(FAR struct smart_struct_s *dev, uint16_t
 #endif
 
 	if ((freecount + releasecount == dev->availSectPerBlk && freecount < 1) || forceerase) {
+#ifdef CONFIG_MTD_SMART_BGGC
+		/* If the background collector was part way through this block, the
+		 * sectors it moved out are erased here too.
+		 */
+
+		if (block == dev->gcblock) {
+			smart_gc_release(dev, false);
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+			freecount = smart_get_count(dev, dev->freecount, block);
+#else
+			freecount = dev->freecount[block];
+#endif
+		}
+#endif
+
 		/* Erase the block */
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
 		dev->unusedsectors += freecount;
@@ -2965,6 +3619,10 @@ static inline int smart_llformat(FAR struct smart_struct_s *dev, unsigned long a
 
 		dev->sMap[x] = -1;
 	}
+#elif defined(CONFIG_MTD_SMART_PACKED_MAP)
+	if (dev->sPackMap != NULL) {
+		smart_packmap_set(dev, 0, 0);
+	}
 #endif
 
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
@@ -3128,6 +3786,16 @@ static int smart_relocate_block(FAR struct smart_struct_s *dev, uint16_t block)
 
 	fvdbg("Entry\n");
 
+#ifdef CONFIG_MTD_SMART_BGGC
+	/* If the background collector was part way through this block, give the
+	 * block back and finish the job here.
+	 */
+
+	if (block == dev->gcblock) {
+		smart_gc_release(dev, true);
+	}
+#endif
+
 	/* Perform collection on block with the most released sectors.
 	 * First mark the block as having no free sectors so we don't
 	 * try to move sectors into the block we are trying to erase.
@@ -3651,7 +4319,7 @@ static int smart_garbagecollect(FAR struct smart_struct_s *dev)
 
 		/* Test if we have more reached our reserved free sector limit. */
 
-		if (dev->freesectors <= (dev->sectorsPerBlk << 0) + 4) {
+		if (dev->freesectors <= SMART_GC_RESERVE(dev)) {
 			collect = TRUE;
 		}
 
@@ -3727,6 +4395,275 @@ errout:
 }
 #endif							/* CONFIG_FS_WRITABLE */
 
+/****************************************************************************
+ * Name: smart_gc_release
+ *
+ * Description:  Stop the background collection of the current victim block
+ *               and restore its free sector count.  If 'undomoves' is set,
+ *               the sectors already moved out of the block are given back
+ *               to the free sector total, as smart_relocate_block() expects
+ *               when it completes the collection.  Otherwise the caller is
+ *               about to erase the block and counts them itself.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_BGGC
+static void smart_gc_release(FAR struct smart_struct_s *dev, bool undomoves)
+{
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+	smart_set_count(dev, dev->freecount, dev->gcblock, dev->gcfreecount);
+#else
+	dev->freecount[dev->gcblock] = dev->gcfreecount;
+#endif
+
+	if (undomoves) {
+		dev->freesectors += dev->gcmoved;
+	}
+
+	dev->gcblock = 0xFFFF;
+}
+
+/****************************************************************************
+ * Name: smart_gc_selectvictim
+ *
+ * Description:  Select the erase block for background collection using a
+ *               cost-benefit policy: the number of released sectors that
+ *               would be reclaimed, divided by the number of live sectors
+ *               that must be copied, and weighted towards less worn blocks.
+ *               Blocks with fewer than a quarter of their sectors released
+ *               are left to the foreground collector.
+ *
+ ****************************************************************************/
+
+static uint16_t smart_gc_selectvictim(FAR struct smart_struct_s *dev)
+{
+	uint16_t victim;
+	uint16_t freecount;
+	uint16_t releasecount;
+	uint16_t minrelease;
+	uint16_t live;
+	uint32_t score;
+	uint32_t maxscore;
+	int x;
+
+	victim = 0xFFFF;
+	maxscore = 0;
+	minrelease = dev->availSectPerBlk >> 2;
+	if (minrelease == 0) {
+		minrelease = 1;
+	}
+
+	for (x = 0; x < dev->neraseblocks; x++) {
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+		releasecount = smart_get_count(dev, dev->releasecount, x);
+		freecount = smart_get_count(dev, dev->freecount, x);
+#else
+		releasecount = dev->releasecount[x];
+		freecount = dev->freecount[x];
+#endif
+
+		if (releasecount < minrelease) {
+			continue;
+		}
+
+		live = dev->availSectPerBlk - freecount - releasecount;
+		score = ((uint32_t)releasecount << 8) / (live + 1);
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+		/* Don't collect blocks that have been worn completely. */
+
+		if (smart_get_wear_level(dev, x) >= SMART_WEAR_REORG_THRESHOLD) {
+			continue;
+		}
+
+		score *= SMART_WEAR_REORG_THRESHOLD - smart_get_wear_level(dev, x);
+#endif
+
+		if (score > maxscore) {
+			maxscore = score;
+			victim = x;
+		}
+	}
+
+	return victim;
+}
+
+/****************************************************************************
+ * Name: smart_gc_step
+ *
+ * Description:  Perform one bounded step of background garbage collection:
+ *               choose a victim block if there is none, then move at most
+ *               CONFIG_MTD_SMART_BGGC_STEP live sectors out of it.  Once
+ *               the block holds no live data it is erased.
+ *
+ * Returned Value:
+ *   true if more collection is needed.
+ *
+ ****************************************************************************/
+
+static bool smart_gc_step(FAR struct smart_struct_s *dev)
+{
+	FAR struct smart_sect_header_s *header;
+	uint16_t highwater;
+	uint16_t lastsector;
+	uint16_t newsector;
+	uint16_t block;
+	int moved;
+	int ret;
+
+	highwater = (uint16_t)(((uint32_t)dev->totalsectors * CONFIG_MTD_SMART_BGGC_HIGH_WATERMARK) / 100);
+
+	if (dev->gcblock == 0xFFFF) {
+		if (dev->freesectors >= highwater) {
+			return false;
+		}
+
+		block = smart_gc_selectvictim(dev);
+		if (block == 0xFFFF) {
+			return false;
+		}
+
+		/* Take the block's free sectors out of use so that nothing is
+		 * moved into the block while it is being emptied.
+		 */
+
+		dev->gcblock = block;
+		dev->gcsector = block * dev->sectorsPerBlk;
+		dev->gcmoved = 0;
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+		dev->gcfreecount = smart_get_count(dev, dev->freecount, block);
+		smart_set_count(dev, dev->freecount, block, 0);
+#else
+		dev->gcfreecount = dev->freecount[block];
+		dev->freecount[block] = 0;
+#endif
+
+		/* Leave the foreground its reserve of free sectors. */
+
+		if (dev->freesectors - dev->gcfreecount <= dev->availSectPerBlk + SMART_GC_RESERVE(dev)) {
+			smart_gc_release(dev, true);
+			return false;
+		}
+
+		fvdbg("Collecting block %d in the background\n", block);
+	}
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+	smart_checkpoint_invalidate(dev);
+#endif
+
+	block = dev->gcblock;
+	lastsector = block * dev->sectorsPerBlk + dev->availSectPerBlk;
+	header = (FAR struct smart_sect_header_s *)dev->rwbuffer;
+
+	for (moved = 0; dev->gcsector < lastsector && moved < CONFIG_MTD_SMART_BGGC_STEP; dev->gcsector++) {
+		ret = MTD_BREAD(dev->mtd, dev->gcsector * dev->mtdBlksPerSector, dev->mtdBlksPerSector, (FAR uint8_t *)dev->rwbuffer);
+		if (ret != dev->mtdBlksPerSector) {
+			fdbg("Error reading sector %d\n", dev->gcsector);
+			goto errout;
+		}
+
+		if (((header->status & SMART_STATUS_COMMITTED) == (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED)) || ((header->status & SMART_STATUS_RELEASED) != (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED))) {
+			/* No live data (free, released or a pending CRC allocation
+			 * that smart_relocate_block() will take care of).
+			 */
+
+			continue;
+		}
+
+		newsector = smart_findfreephyssector(dev, FALSE);
+		if (newsector == 0xFFFF) {
+			goto errout;
+		}
+
+		if (smart_relocate_sector(dev, dev->gcsector, newsector) < 0) {
+			goto errout;
+		}
+
+#ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
+		dev->sMap[UINT8TOUINT16(header->logicalsector)] = newsector;
+#else
+		smart_update_cache(dev, *((FAR uint16_t *)header->logicalsector), newsector);
+#endif
+
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+		smart_add_count(dev, dev->freecount, newsector / dev->sectorsPerBlk, -1);
+#else
+		dev->freecount[newsector / dev->sectorsPerBlk]--;
+#endif
+		dev->freesectors--;
+		dev->gcmoved++;
+		moved++;
+	}
+
+	if (dev->gcsector >= lastsector) {
+		/* Nothing live is left.  smart_relocate_block() erases the block
+		 * and rebuilds its counts.
+		 */
+
+		ret = smart_relocate_block(dev, block);
+		if (ret < 0) {
+			fdbg("Error %d collecting block %d\n", ret, block);
+			return false;
+		}
+
+		return dev->freesectors < highwater;
+	}
+
+	return true;
+
+errout:
+	smart_gc_release(dev, true);
+	return false;
+}
+
+/****************************************************************************
+ * Name: smart_gc_worker
+ *
+ * Description:  Background garbage collection work, run on the low priority
+ *               work queue.  Each run performs one step and reschedules
+ *               itself after CONFIG_MTD_SMART_BGGC_INTERVAL milliseconds so
+ *               that pending reads and writes get the device in between.
+ *
+ ****************************************************************************/
+
+static void smart_gc_worker(FAR void *arg)
+{
+	FAR struct smart_struct_s *dev = (FAR struct smart_struct_s *)arg;
+
+	smart_semtake(dev);
+
+	if (smart_gc_step(dev)) {
+		work_queue_class(LPWORK, &dev->gcwork, smart_gc_worker, dev, MSEC2TICK(CONFIG_MTD_SMART_BGGC_INTERVAL), WORK_CLASS_BULK);
+	}
+
+	smart_semgive(dev);
+}
+
+/****************************************************************************
+ * Name: smart_gc_kick
+ *
+ * Description:  Schedule background garbage collection if the free sectors
+ *               dropped below the low watermark.  Called with exclusive
+ *               access to the device.
+ *
+ ****************************************************************************/
+
+static void smart_gc_kick(FAR struct smart_struct_s *dev)
+{
+	uint16_t lowwater;
+
+	if (dev->rwbuffer == NULL || !work_available(&dev->gcwork)) {
+		return;
+	}
+
+	lowwater = (uint16_t)(((uint32_t)dev->totalsectors * CONFIG_MTD_SMART_BGGC_LOW_WATERMARK) / 100);
+	if (dev->freesectors < lowwater) {
+		work_queue_class(LPWORK, &dev->gcwork, smart_gc_worker, dev, 0, WORK_CLASS_BULK);
+	}
+}
+#endif							/* CONFIG_MTD_SMART_BGGC */
+
 /****************************************************************************
  * Name: smart_write_wearstatus
  *
@@ -4702,7 +5639,7 @@ static inline int smart_allocsector(FAR struct smart_struct_s *dev, unsigned lon
 	 * allocation.  We have to ensure we keep enough reserved sectors
 	 * on hand to do released sector garbage collection. */
 
-	if (dev->freesectors <= (dev->sectorsPerBlk << 0) + 4) {
+	if (dev->freesectors <= SMART_GC_RESERVE(dev)) {
 		/* Do a garbage collect and then test freesectors again. */
 
 		if (dev->releasesectors + dev->freesectors > dev->availSectPerBlk + 4) {
@@ -5000,7 +5937,11 @@ errout:
  *
  ****************************************************************************/
 
+#ifdef CONFIG_MTD_SMART_BGGC
+static int smart_doioctl(FAR struct inode *inode, int cmd, unsigned long arg)
+#else
 static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
+#endif
 {
 	FAR struct smart_struct_s *dev;
 	int ret;
@@ -5017,6 +5958,14 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 	dev = (FAR struct smart_struct_s *)inode->i_private;
 #endif
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+	/* Any change to the volume makes the checkpoint stale. */
+
+	if (cmd == BIOC_LLFORMAT || cmd == BIOC_ALLOCSECT || cmd == BIOC_FREESECT || cmd == BIOC_WRITESECT) {
+		smart_checkpoint_invalidate(dev);
+	}
+#endif
+
 	/* Process the ioctl's we care about first, pass any we don't respond
 	 * to directly to the underlying MTD device.
 	 */
@@ -5096,6 +6045,15 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 		goto ok_out;
 #endif							/* CONFIG_FS_WRITABLE */
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+	case BIOC_FLUSH:
+
+		/* Save a checkpoint of the volume state. */
+
+		ret = smart_checkpoint_write(dev);
+		goto ok_out;
+#endif
+
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
 	case BIOC_GETPROCFSD:
 
@@ -5166,6 +6124,38 @@ ok_out:
 	return ret;
 }
 
+/****************************************************************************
+ * Name: smart_ioctl
+ *
+ * Description: Perform an ioctl with exclusive access to the device, then
+ *              wake up the background garbage collector if the ioctl left
+ *              the device short of free sectors.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_BGGC
+static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
+{
+	FAR struct smart_struct_s *dev;
+	int ret;
+
+	DEBUGASSERT(inode && inode->i_private);
+
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+	dev = ((FAR struct smart_multiroot_device_s *)inode->i_private)->dev;
+#else
+	dev = (FAR struct smart_struct_s *)inode->i_private;
+#endif
+
+	smart_semtake(dev);
+	ret = smart_doioctl(inode, cmd, arg);
+	smart_gc_kick(dev);
+	smart_semgive(dev);
+
+	return ret;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -5188,6 +6178,9 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, FAR const char *partn
 	FAR struct smart_struct_s *dev;
 	int ret = -ENOMEM;
 	uint32_t totalsectors;
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+	uint32_t cpsize;
+#endif
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
 	FAR struct smart_multiroot_device_s *rootdirdev = NULL;
 #endif
@@ -5213,6 +6206,11 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, FAR const char *partn
 		/* Initialize the SMART device structure. */
 
 		dev->mtd = mtd;
+#ifdef CONFIG_MTD_SMART_BGGC
+		sem_init(&dev->exclsem, 0, 1);
+		memset(&dev->gcwork, 0, sizeof(struct work_s));
+		dev->gcblock = 0xFFFF;
+#endif
 #ifdef CONFIG_MTD_SMART_ALLOC_DEBUG
 		dev->bytesalloc = 0;
 		for (totalsectors = 0; totalsectors < SMART_MAX_ALLOCS; totalsectors++) {
@@ -5233,6 +6231,33 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, FAR const char *partn
 			goto errout;
 		}
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+		/* Size the checkpoint slots for the sector map of the whole device
+		 * with the default sector size, and keep them at the end of the
+		 * device out of the volume.
+		 */
+
+		cpsize = (uint32_t)dev->geo.neraseblocks * (dev->geo.erasesize / CONFIG_MTD_SMART_SECTOR_SIZE);
+		if (cpsize > 65534) {
+			cpsize = 65534;
+		}
+
+		cpsize = sizeof(struct smart_checkpoint_s) + cpsize * sizeof(uint16_t) + (dev->geo.neraseblocks << 1) + (dev->geo.neraseblocks >> SMART_WEAR_BIT_DIVIDE);
+		dev->cpslotblocks = (cpsize + dev->geo.erasesize - 1) / dev->geo.erasesize;
+
+		if (dev->geo.neraseblocks <= CONFIG_MTD_SMART_CHECKPOINT_SLOTS * dev->cpslotblocks) {
+			fdbg("Device too small for the checkpoint area\n");
+			ret = -EINVAL;
+			goto errout;
+		}
+
+		dev->geo.neraseblocks -= CONFIG_MTD_SMART_CHECKPOINT_SLOTS * dev->cpslotblocks;
+		dev->cpblock = dev->geo.neraseblocks;
+		dev->cpgeneration = 0;
+		dev->cpslot = 0;
+		dev->cpvalid = false;
+#endif
+
 		/* Set the sector size to the default for now. */
 
 #ifdef CONFIG_SMARTFS_BAD_SECTOR
@@ -5245,6 +6270,9 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, FAR const char *partn
 #else
 		dev->sCache = NULL;
 		dev->sBitMap = NULL;
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+		dev->sPackMap = NULL;
+#endif
 #endif
 		dev->rwbuffer = NULL;
 		dev->bytebuffer = NULL;
@@ -5354,6 +6382,11 @@ errout:
 #else
 	smart_free(dev, dev->sBitMap);
 	smart_free(dev, dev->sCache);
+#ifdef CONFIG_MTD_SMART_PACKED_MAP
+	if (dev->sPackMap != NULL) {
+		smart_free(dev, dev->sPackMap);
+	}
+#endif
 #endif
 	if (dev->rwbuffer != NULL) {
 		smart_free(dev, dev->rwbuffer);
@@ -5437,6 +6470,13 @@ int smart_recoversectors(FAR struct inode *inode, char *validsectors, int *nobso
 	dev = (FAR struct smart_struct_s *)inode->i_private;
 #endif
 
+#ifdef CONFIG_MTD_SMART_BGGC
+	smart_semtake(dev);
+#endif
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+	smart_checkpoint_invalidate(dev);
+#endif
+
 	totalsectors = dev->totalsectors;
 
 	/* Mark the reserved sectors as valid. */
@@ -5513,6 +6553,9 @@ int smart_recoversectors(FAR struct inode *inode, char *validsectors, int *nobso
 
 	ret = OK;
 err_out:
+#ifdef CONFIG_MTD_SMART_BGGC
+	smart_semgive(dev);
+#endif
 	return ret;
 }
 #endif
@@ -0,0 +1,296 @@
+/****************************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/kmalloc.h>
+#include <tinyara/clock.h>
+#include <tinyara/binary_manager.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#if defined(CONFIG_BINMGR_LOAD_PROFILE) && !defined(CONFIG_FS_PROCFS_EXCLUDE_BINMGR)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+/* Size of the buffer holding the whole file: a header line and one line per
+ * binary.
+ */
+
+#define BINMGR_BUFSIZE (64 * (USER_BIN_COUNT + 1))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct binmgr_file_s {
+	struct procfs_file_s base;	/* Base open file structure */
+	unsigned int size;			/* Number of valid characters in buf[] */
+	char buf[BINMGR_BUFSIZE];	/* Formatted load times */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int binmgr_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode);
+static int binmgr_close(FAR struct file *filep);
+static ssize_t binmgr_read(FAR struct file *filep, FAR char *buffer, size_t buflen);
+
+static int binmgr_dup(FAR const struct file *oldp, FAR struct file *newp);
+
+static int binmgr_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+const struct procfs_operations binmgr_operations = {
+	binmgr_open,				/* open */
+	binmgr_close,				/* close */
+	binmgr_read,				/* read */
+	NULL,						/* write */
+
+	binmgr_dup,					/* dup */
+
+	NULL,						/* opendir */
+	NULL,						/* closedir */
+	NULL,						/* readdir */
+	NULL,						/* rewinddir */
+
+	binmgr_stat					/* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: binmgr_format
+ *
+ * Description:
+ *   Format the load times of the user binaries in milliseconds, one line
+ *   per binary.
+ *
+ ****************************************************************************/
+
+static size_t binmgr_format(FAR char *buf, size_t len)
+{
+	binmgr_loadtime_t loadtime;
+	char name[BIN_NAME_MAX + 1];
+	size_t pos;
+	int bin_idx;
+
+	pos = snprintf(buf, len, "%-16s %7s %7s %7s %7s %7s\n", "binary", "header", "read", "decomp", "reloc", "ctors");
+	name[BIN_NAME_MAX] = '\0';
+
+	for (bin_idx = 1; pos < len && binary_manager_get_loadtime(bin_idx, name, &loadtime) == OK; bin_idx++) {
+		pos += snprintf(&buf[pos], len - pos, "%-16s %7lu %7lu %7lu %7lu %7lu\n", name,
+						(unsigned long)TICK2MSEC(loadtime.header), (unsigned long)TICK2MSEC(loadtime.read),
+						(unsigned long)TICK2MSEC(loadtime.decompress), (unsigned long)TICK2MSEC(loadtime.relocate),
+						(unsigned long)TICK2MSEC(loadtime.ctors));
+	}
+
+	return pos < len ? pos : len;
+}
+
+/****************************************************************************
+ * Name: binmgr_open
+ ****************************************************************************/
+
+static int binmgr_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode)
+{
+	FAR struct binmgr_file_s *attr;
+
+	fvdbg("Open '%s'\n", relpath);
+
+	/* PROCFS is read-only.  Any attempt to open with any kind of write
+	 * access is not permitted.
+	 */
+
+	if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0) {
+		fdbg("ERROR: Only O_RDONLY supported\n");
+		return -EACCES;
+	}
+
+	/* "binmgr" is the only acceptable value for the relpath */
+
+	if (strcmp(relpath, "binmgr") != 0) {
+		fdbg("ERROR: relpath is '%s'\n", relpath);
+		return -ENOENT;
+	}
+
+	/* Allocate a container to hold the file attributes */
+
+	attr = (FAR struct binmgr_file_s *)kmm_zalloc(sizeof(struct binmgr_file_s));
+	if (!attr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* Save the attributes as the open-specific state in filep->f_priv */
+
+	filep->f_priv = (FAR void *)attr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: binmgr_close
+ ****************************************************************************/
+
+static int binmgr_close(FAR struct file *filep)
+{
+	FAR struct binmgr_file_s *attr;
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct binmgr_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Release the file attributes structure */
+
+	kmm_free(attr);
+	filep->f_priv = NULL;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: binmgr_read
+ ****************************************************************************/
+
+static ssize_t binmgr_read(FAR struct file *filep, FAR char *buffer, size_t buflen)
+{
+	FAR struct binmgr_file_s *attr;
+	off_t offset;
+	ssize_t ret;
+
+	fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct binmgr_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Take a snapshot of the load times when the file is read from the
+	 * beginning so that they remain stable across partial reads.
+	 */
+
+	if (filep->f_pos == 0) {
+		attr->size = binmgr_format(attr->buf, BINMGR_BUFSIZE);
+	}
+
+	/* Transfer the load times to user receive buffer */
+
+	offset = filep->f_pos;
+	ret = procfs_memcpy(attr->buf, attr->size, buffer, buflen, &offset);
+
+	/* Update the file offset */
+
+	if (ret > 0) {
+		filep->f_pos += ret;
+	}
+
+	return ret;
+}
+
+/****************************************************************************
+ * Name: binmgr_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int binmgr_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+	FAR struct binmgr_file_s *oldattr;
+	FAR struct binmgr_file_s *newattr;
+
+	fvdbg("Dup %p->%p\n", oldp, newp);
+
+	/* Recover our private data from the old struct file instance */
+
+	oldattr = (FAR struct binmgr_file_s *)oldp->f_priv;
+	DEBUGASSERT(oldattr);
+
+	/* Allocate a new container to hold the task and attribute selection */
+
+	newattr = (FAR struct binmgr_file_s *)kmm_malloc(sizeof(struct binmgr_file_s));
+	if (!newattr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* The copy the file attributes from the old attributes to the new */
+
+	memcpy(newattr, oldattr, sizeof(struct binmgr_file_s));
+
+	/* Save the new attributes in the new file structure */
+
+	newp->f_priv = (FAR void *)newattr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: binmgr_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int binmgr_stat(const char *relpath, struct stat *buf)
+{
+	/* "binmgr" is the only acceptable value for the relpath */
+
+	if (strcmp(relpath, "binmgr") != 0) {
+		fdbg("ERROR: relpath is '%s'\n", relpath);
+		return -ENOENT;
+	}
+
+	/* "binmgr" is the name for a read-only file */
+
+	buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+	buf->st_size = 0;
+	buf->st_blksize = 0;
+	buf->st_blocks = 0;
+	return OK;
+}
+
+#endif							/* CONFIG_BINMGR_LOAD_PROFILE && !CONFIG_FS_PROCFS_EXCLUDE_BINMGR */
+#endif							/* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
@@ -66,6 +66,10 @@
 
 #include <tinyara/fs/mtd.h>
 #include <tinyara/fs/smart.h>
+#ifdef CONFIG_SMARTFS_WRITEBACK
+#include <tinyara/clock.h>
+#include <tinyara/wqueue.h>
+#endif
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -239,6 +243,15 @@
 #define SMARTFS_BSM_LOG_SECTOR_NUMBER   11
 #endif
 
+/* Appended data is held in a per-file write-back buffer and flushed when
+ * the buffer reaches CONFIG_SMARTFS_WRITEBACK_THRESHOLD bytes, on sync, or
+ * by a timer on the low priority work queue.
+ */
+
+#if defined(CONFIG_SMARTFS_WRITEBACK) && defined(CONFIG_SCHED_LPWORK) && CONFIG_SMARTFS_WRITEBACK_INTERVAL > 0
+#define SMARTFS_WRITEBACK_TIMER 1
+#endif
+
 #define USED_ARRAY_SIZE                 2
 
 #if !defined(CONFIG_SMARTFS_DYNAMIC_HEADER) || !defined(CONFIG_MTD_SMART_SECTOR_SIZE)
@@ -335,6 +348,23 @@ struct smartfs_chain_header_s {
 };
 #endif
 
+#ifdef CONFIG_SMARTFS_DCACHE
+/* This structure is one slot of the directory entry cache */
+
+struct smartfs_dcache_entry_s {
+	uint16_t parent;			/* 1st sector of the parent directory,
+								 * 0xFFFF if the slot is unused */
+	uint16_t firstsector;		/* Sector number of the name */
+	uint16_t dsector;			/* Sector number of the directory entry */
+	uint16_t doffset;			/* Offset of the directory entry */
+	uint16_t flags;				/* Flags, including mode */
+	bool lenvalid;				/* true: datlen is up to date */
+	uint32_t utc;				/* Time stamp */
+	uint32_t datlen;			/* Length of inode data */
+	FAR char *name;				/* inode name */
+};
+#endif
+
 /* This structure describes the state of one open file.  This structure
  * is protected by the volume semaphore.
  */
@@ -357,6 +387,11 @@ struct smartfs_ofile_s {
 								 * used field until the file is closed,
 								 * a seek, or more data is written that
 								 * causes the sector to change. */
+#ifdef CONFIG_SMARTFS_WRITEBACK
+	uint8_t *wbuffer;			/* Appended data not yet written */
+	uint16_t wblen;				/* Number of bytes in wbuffer.  They end
+								 * at curroffset in currsector. */
+#endif
 };
 
 /* This structure represents the overall mountpoint state.  An instance of this
@@ -381,6 +416,15 @@ struct smartfs_mountpt_s {
 #endif
 #ifdef CONFIG_SMARTFS_JOURNALING
 	struct journal_transaction_manager_s *journal;
+#endif
+#ifdef SMARTFS_WRITEBACK_TIMER
+	struct work_s fs_wbwork;	/* Flushes write-back buffers */
+	bool fs_wbstop;				/* true: Unbinding, do not queue fs_wbwork */
+	uint8_t fs_wbpending;		/* fs_wbwork instances queued or running */
+	sem_t fs_wbdone;			/* Posted when the last one ends, once stopped */
+#endif
+#ifdef CONFIG_SMARTFS_DCACHE
+	FAR struct smartfs_dcache_entry_s *fs_dcache;	/* Directory entry cache */
 #endif
 	uint8_t fs_rootsector;		/* Root directory sector num */
 };
@@ -545,6 +589,15 @@ struct fs_dirent_s;
 struct statfs;
 struct stat;
 
+#ifdef CONFIG_SMARTFS_DCACHE
+int smartfs_dcache_init(struct smartfs_mountpt_s *fs);
+void smartfs_dcache_uninit(struct smartfs_mountpt_s *fs);
+FAR struct smartfs_dcache_entry_s *smartfs_dcache_lookup(struct smartfs_mountpt_s *fs, uint16_t parent, FAR const char *name);
+void smartfs_dcache_add(struct smartfs_mountpt_s *fs, FAR const struct smartfs_entry_s *entry, FAR const char *name, bool lenvalid);
+void smartfs_dcache_remove(struct smartfs_mountpt_s *fs, uint16_t dsector, uint16_t doffset);
+void smartfs_dcache_invalidatelen(struct smartfs_mountpt_s *fs, uint16_t firstsector);
+#endif
+
 #ifdef CONFIG_SMARTFS_JOURNALING
 int smartfs_journal_init(struct smartfs_mountpt_s *fs);
 int smartfs_create_journalentry(struct smartfs_mountpt_s *fs, enum logging_transaction_type_e type, uint16_t curr_sector, uint16_t offset, uint16_t datalen, uint16_t genericdata, uint8_t needsync, const uint8_t *data, uint16_t *t_sector, uint16_t *t_offset);
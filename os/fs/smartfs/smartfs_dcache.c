@@ -0,0 +1,238 @@
+/****************************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * fs/smartfs/smartfs_dcache.c
+ *
+ * A per-mount cache of directory entries, used by smartfs_finddirentry()
+ * to resolve path segments without reading the directory sectors.  The
+ * cache is a direct-mapped hash table of CONFIG_SMARTFS_DCACHE_SIZE slots
+ * keyed by the first sector of the parent directory and the entry name.
+ * Only active entries are cached; a colliding entry simply replaces the
+ * one in its slot.
+ *
+ * The cache is kept in sync by smartfs_createentry(), smartfs_deleteentry()
+ * and rename.  The length of a file is cached too and is dropped whenever
+ * the used bytes of one of its sectors change.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/kmalloc.h>
+
+#include "smartfs.h"
+
+#ifdef CONFIG_SMARTFS_DCACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SMARTFS_DCACHE_UNUSED   0xFFFF
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: smartfs_dcache_hash
+ *
+ * Description: Return the slot of the entry 'name' in directory 'parent'.
+ *              Only the first namesize characters are significant, as in
+ *              the directory sectors.
+ *
+ ****************************************************************************/
+
+static uint16_t smartfs_dcache_hash(struct smartfs_mountpt_s *fs, uint16_t parent, FAR const char *name)
+{
+	uint32_t hash = 2166136261u ^ parent;
+	uint16_t x;
+
+	for (x = 0; x < fs->fs_llformat.namesize && name[x] != '\0'; x++) {
+		hash ^= (uint8_t)name[x];
+		hash *= 16777619u;
+	}
+
+	return (uint16_t)(hash % CONFIG_SMARTFS_DCACHE_SIZE);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: smartfs_dcache_init
+ *
+ * Description: Allocate an empty cache for a mounted volume.  The slots and
+ *              their names are allocated together.  If there is not enough
+ *              memory the volume works without a cache.
+ *
+ ****************************************************************************/
+
+int smartfs_dcache_init(struct smartfs_mountpt_s *fs)
+{
+	FAR struct smartfs_dcache_entry_s *dc;
+	FAR char *names;
+	uint16_t x;
+
+	fs->fs_dcache = (FAR struct smartfs_dcache_entry_s *)kmm_malloc(CONFIG_SMARTFS_DCACHE_SIZE * (sizeof(struct smartfs_dcache_entry_s) + fs->fs_llformat.namesize + 1));
+	if (fs->fs_dcache == NULL) {
+		fdbg("No memory for the directory cache\n");
+		return -ENOMEM;
+	}
+
+	names = (FAR char *)&fs->fs_dcache[CONFIG_SMARTFS_DCACHE_SIZE];
+	for (x = 0; x < CONFIG_SMARTFS_DCACHE_SIZE; x++) {
+		dc = &fs->fs_dcache[x];
+		dc->parent = SMARTFS_DCACHE_UNUSED;
+		dc->name = &names[x * (fs->fs_llformat.namesize + 1)];
+	}
+
+	return OK;
+}
+
+/****************************************************************************
+ * Name: smartfs_dcache_uninit
+ *
+ * Description: Free the cache of a volume being unmounted.
+ *
+ ****************************************************************************/
+
+void smartfs_dcache_uninit(struct smartfs_mountpt_s *fs)
+{
+	if (fs->fs_dcache != NULL) {
+		kmm_free(fs->fs_dcache);
+		fs->fs_dcache = NULL;
+	}
+}
+
+/****************************************************************************
+ * Name: smartfs_dcache_lookup
+ *
+ * Description: Find the entry 'name' of the directory starting at sector
+ *              'parent'.
+ *
+ * Returned Value:
+ *   The cached entry, or NULL if it is not in the cache.
+ *
+ ****************************************************************************/
+
+FAR struct smartfs_dcache_entry_s *smartfs_dcache_lookup(struct smartfs_mountpt_s *fs, uint16_t parent, FAR const char *name)
+{
+	FAR struct smartfs_dcache_entry_s *dc;
+
+	if (fs->fs_dcache == NULL) {
+		return NULL;
+	}
+
+	dc = &fs->fs_dcache[smartfs_dcache_hash(fs, parent, name)];
+	if (dc->parent == parent && strncmp(dc->name, name, fs->fs_llformat.namesize) == 0) {
+		return dc;
+	}
+
+	return NULL;
+}
+
+/****************************************************************************
+ * Name: smartfs_dcache_add
+ *
+ * Description: Cache an active directory entry.  entry->dfirst must hold
+ *              the first sector of the parent directory.  If 'lenvalid' is
+ *              false, the length of the file is scanned on the next lookup.
+ *
+ ****************************************************************************/
+
+void smartfs_dcache_add(struct smartfs_mountpt_s *fs, FAR const struct smartfs_entry_s *entry, FAR const char *name, bool lenvalid)
+{
+	FAR struct smartfs_dcache_entry_s *dc;
+
+	if (fs->fs_dcache == NULL) {
+		return;
+	}
+
+	dc = &fs->fs_dcache[smartfs_dcache_hash(fs, entry->dfirst, name)];
+	dc->parent = entry->dfirst;
+	dc->firstsector = entry->firstsector;
+	dc->dsector = entry->dsector;
+	dc->doffset = entry->doffset;
+	dc->flags = entry->flags;
+	dc->utc = entry->utc;
+	dc->datlen = entry->datlen;
+	dc->lenvalid = lenvalid;
+
+	memset(dc->name, 0, fs->fs_llformat.namesize + 1);
+	strncpy(dc->name, name, fs->fs_llformat.namesize);
+}
+
+/****************************************************************************
+ * Name: smartfs_dcache_remove
+ *
+ * Description: Drop the entry stored at offset 'doffset' of directory
+ *              sector 'dsector', if it is cached.
+ *
+ ****************************************************************************/
+
+void smartfs_dcache_remove(struct smartfs_mountpt_s *fs, uint16_t dsector, uint16_t doffset)
+{
+	FAR struct smartfs_dcache_entry_s *dc;
+	uint16_t x;
+
+	if (fs->fs_dcache == NULL) {
+		return;
+	}
+
+	for (x = 0; x < CONFIG_SMARTFS_DCACHE_SIZE; x++) {
+		dc = &fs->fs_dcache[x];
+		if (dc->parent != SMARTFS_DCACHE_UNUSED && dc->dsector == dsector && dc->doffset == doffset) {
+			dc->parent = SMARTFS_DCACHE_UNUSED;
+		}
+	}
+}
+
+/****************************************************************************
+ * Name: smartfs_dcache_invalidatelen
+ *
+ * Description: Forget the cached length of the file starting at sector
+ *              'firstsector'.
+ *
+ ****************************************************************************/
+
+void smartfs_dcache_invalidatelen(struct smartfs_mountpt_s *fs, uint16_t firstsector)
+{
+	uint16_t x;
+
+	if (fs->fs_dcache == NULL) {
+		return;
+	}
+
+	for (x = 0; x < CONFIG_SMARTFS_DCACHE_SIZE; x++) {
+		if (fs->fs_dcache[x].firstsector == firstsector) {
+			fs->fs_dcache[x].lenvalid = false;
+		}
+	}
+}
+
+#endif							/* CONFIG_SMARTFS_DCACHE */
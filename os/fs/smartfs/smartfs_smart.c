@@ -117,6 +117,13 @@ static void smartfs_stat_common(FAR struct smartfs_mountpt_s *fs, FAR struct sma
 static int smartfs_stat(struct inode *mountpt, const char *relpath, struct stat *buf);
 
 static off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s *sf, off_t offset, int whence);
+#ifdef CONFIG_SMARTFS_WRITEBACK
+static int smartfs_writeback_flush(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s *sf);
+static int smartfs_writeback_sync(struct smartfs_mountpt_s *fs, uint16_t firstsector);
+#endif
+#ifdef SMARTFS_WRITEBACK_TIMER
+static void smartfs_writeback_worker(FAR void *arg);
+#endif
 
 /****************************************************************************
  * Private Variables
@@ -224,6 +231,21 @@ static int smartfs_open(FAR struct file *filep, const char *relpath, int oflags,
 	sf->bflags = 0;
 #endif							/* CONFIG_SMARTFS_USE_SECTOR_BUFFER */
 
+	/* Allocate a write-back buffer if the file may be written */
+
+#ifdef CONFIG_SMARTFS_WRITEBACK
+	sf->wbuffer = NULL;
+	sf->wblen = 0;
+	if (oflags & O_WROK) {
+		sf->wbuffer = (uint8_t *)kmm_malloc(fs->fs_llformat.availbytes);
+		if (sf->wbuffer == NULL) {
+			kmm_free(sf);
+			ret = -ENOMEM;
+			goto errout_with_semaphore;
+		}
+	}
+#endif
+
 	sf->entry.name = NULL;
 	ret = smartfs_finddirentry(fs, &sf->entry, relpath, &parentdirsector, &filename);
 
@@ -353,6 +375,12 @@ errout_with_buffer:
 		kmm_free(sf->buffer);
 		sf->buffer = NULL;
 	}
+#endif
+#ifdef CONFIG_SMARTFS_WRITEBACK
+	if (sf->wbuffer != NULL) {
+		kmm_free(sf->wbuffer);
+		sf->wbuffer = NULL;
+	}
 #endif
 	if (sf->entry.name != NULL) {
 		/* Free the space for the name too */
@@ -452,6 +480,11 @@ static int smartfs_close(FAR struct file *filep)
 		kmm_free(sf->buffer);
 	}
 #endif
+#ifdef CONFIG_SMARTFS_WRITEBACK
+	if (sf->wbuffer) {
+		kmm_free(sf->wbuffer);
+	}
+#endif
 
 	kmm_free(sf);
 	filep->f_priv = NULL;
@@ -493,6 +526,15 @@ static ssize_t smartfs_read(FAR struct file *filep, char *buffer, size_t buflen)
 
 	smartfs_semtake(fs);
 
+#ifdef CONFIG_SMARTFS_WRITEBACK
+	/* Write out the data still buffered for the file so that it is read */
+
+	ret = smartfs_writeback_sync(fs, sf->entry.firstsector);
+	if (ret < 0) {
+		goto errout_with_semaphore;
+	}
+#endif
+
 	/* Loop until all byte read or error */
 
 	bytesread = 0;
@@ -603,6 +645,12 @@ static int smartfs_sync_internal(struct smartfs_mountpt_s *fs, struct smartfs_of
 	uint16_t t_sector, t_offset;
 #endif
 
+#ifdef CONFIG_SMARTFS_DCACHE
+	/* The file length changes with the used bytes below */
+
+	smartfs_dcache_invalidatelen(fs, sf->entry.firstsector);
+#endif
+
 #ifdef CONFIG_SMARTFS_USE_SECTOR_BUFFER
 	if (sf->bflags & SMARTFS_BFLAG_DIRTY) {
 		/* Update the header with the number of bytes written */
@@ -642,6 +690,15 @@ static int smartfs_sync_internal(struct smartfs_mountpt_s *fs, struct smartfs_of
 	}
 #else							/* CONFIG_SMARTFS_USE_SECTOR_BUFFER */
 
+#ifdef CONFIG_SMARTFS_WRITEBACK
+	/* The appended data must be on FLASH before the used bytes count */
+
+	ret = smartfs_writeback_flush(fs, sf);
+	if (ret != OK) {
+		goto errout;
+	}
+#endif
+
 	/* Test if we have written bytes to the current sector that
 	 * need to be recorded in the chain header's used bytes field. */
 
@@ -712,6 +769,116 @@ errout:
 	return ret;
 }
 
+/****************************************************************************
+ * Name: smartfs_writeback_flush
+ *
+ * Description: Write the data held in the write-back buffer of a file to
+ *   the current sector.  With journaling, the whole buffer is logged as a
+ *   single write transaction.  The used bytes field is still updated by
+ *   smartfs_sync_internal().
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMARTFS_WRITEBACK
+static int smartfs_writeback_flush(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s *sf)
+{
+	struct smart_read_write_s readwrite;
+	int ret;
+#ifdef CONFIG_SMARTFS_JOURNALING
+	uint16_t t_sector, t_offset;
+#endif
+
+	if (sf->wblen == 0) {
+		return OK;
+	}
+
+	readwrite.logsector = sf->currsector;
+	readwrite.offset = sf->curroffset - sf->wblen;
+	readwrite.buffer = sf->wbuffer;
+	readwrite.count = sf->wblen;
+
+#ifdef CONFIG_SMARTFS_JOURNALING
+	ret = smartfs_create_journalentry(fs, T_WRITE, readwrite.logsector, readwrite.offset, readwrite.count, sf->curroffset - sizeof(struct smartfs_chain_header_s), 1, readwrite.buffer, &t_sector, &t_offset);
+	if (ret != OK) {
+		fdbg("Journal entry creation failed.\n");
+		return ret;
+	}
+#endif
+
+	ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long)&readwrite);
+	if (ret < 0) {
+		fdbg("Error %d writing sector %d data\n", ret, sf->currsector);
+		return ret;
+	}
+
+	sf->wblen = 0;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: smartfs_writeback_sync
+ *
+ * Description: Sync every open file of the entry starting at firstsector
+ *   that still holds data in its write-back buffer, so that a read through
+ *   any of them sees what was written.  Called with the semaphore held.
+ *
+ ****************************************************************************/
+
+static int smartfs_writeback_sync(struct smartfs_mountpt_s *fs, uint16_t firstsector)
+{
+	struct smartfs_ofile_s *sf;
+	int ret;
+
+	for (sf = fs->fs_head; sf != NULL; sf = sf->fnext) {
+		if (sf->entry.firstsector == firstsector && sf->wblen > 0) {
+			ret = smartfs_sync_internal(fs, sf);
+			if (ret != OK) {
+				return ret;
+			}
+		}
+	}
+
+	return OK;
+}
+#endif							/* CONFIG_SMARTFS_WRITEBACK */
+
+/****************************************************************************
+ * Name: smartfs_writeback_worker
+ *
+ * Description: Sync every open file of a volume that has buffered data.
+ *   Runs on the low priority work queue CONFIG_SMARTFS_WRITEBACK_INTERVAL
+ *   msec after the first buffered write.
+ *
+ ****************************************************************************/
+
+#ifdef SMARTFS_WRITEBACK_TIMER
+static void smartfs_writeback_worker(FAR void *arg)
+{
+	struct smartfs_mountpt_s *fs = (struct smartfs_mountpt_s *)arg;
+	struct smartfs_ofile_s *sf;
+
+	smartfs_semtake(fs);
+
+	if (!fs->fs_wbstop) {
+		for (sf = fs->fs_head; sf != NULL; sf = sf->fnext) {
+			if (sf->wblen > 0 && smartfs_sync_internal(fs, sf) != OK) {
+				fdbg("Error flushing sector %d\n", sf->currsector);
+			}
+		}
+	}
+
+	/* smartfs_unbind() waits for the last worker, and frees fs only once
+	 * it has the semaphore back.
+	 */
+
+	fs->fs_wbpending--;
+	if (fs->fs_wbstop && fs->fs_wbpending == 0) {
+		sem_post(&fs->fs_wbdone);
+	}
+	smartfs_semgive(fs);
+}
+#endif
+
 /****************************************************************************
  * Name: smartfs_write
  ****************************************************************************/
@@ -882,6 +1049,12 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 			readwrite.count = buflen;
 		}
 
+#ifdef CONFIG_SMARTFS_WRITEBACK
+		/* Hold the data until the buffer is flushed */
+
+		memcpy(&sf->wbuffer[sf->wblen], readwrite.buffer, readwrite.count);
+		sf->wblen += readwrite.count;
+#else
 		/* Perform the write */
 
 		if (readwrite.count > 0) {
@@ -899,6 +1072,7 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 				goto errout_with_semaphore;
 			}
 		}
+#endif							/* CONFIG_SMARTFS_WRITEBACK */
 #endif							/* CONFIG_SMARTFS_USE_SECTOR_BUFFER */
 
 		/* Update our control variables */
@@ -910,6 +1084,19 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 		buflen -= readwrite.count;
 		byteswritten += readwrite.count;
 
+#ifdef CONFIG_SMARTFS_WRITEBACK
+		/* Flush the buffer once it holds enough data.  A full sector is
+		 * flushed by the sync below instead.
+		 */
+
+		if (sf->wblen >= CONFIG_SMARTFS_WRITEBACK_THRESHOLD && sf->curroffset != fs->fs_llformat.availbytes) {
+			ret = smartfs_writeback_flush(fs, sf);
+			if (ret != OK) {
+				goto errout_with_semaphore;
+			}
+		}
+#endif
+
 		/* Test if we wrote a full sector of data */
 
 #ifdef CONFIG_SMARTFS_USE_SECTOR_BUFFER
@@ -1021,6 +1208,17 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 
 	ret = byteswritten;
 
+#ifdef SMARTFS_WRITEBACK_TIMER
+	/* Make sure the buffered data reaches FLASH even if the file is left
+	 * open.
+	 */
+
+	if (sf->wblen > 0 && !fs->fs_wbstop && work_available(&fs->fs_wbwork)) {
+		fs->fs_wbpending++;
+		work_queue_class(LPWORK, &fs->fs_wbwork, smartfs_writeback_worker, fs, MSEC2TICK(CONFIG_SMARTFS_WRITEBACK_INTERVAL), WORK_CLASS_BULK);
+	}
+#endif
+
 errout_with_semaphore:
 	smartfs_semgive(fs);
 	return ret;
@@ -1591,6 +1789,16 @@ static int smartfs_bind(FAR struct inode *blkdriver, const void *data, void **ha
 	}
 #endif
 
+#ifdef CONFIG_SMARTFS_DCACHE
+	/* The volume is usable without the cache */
+
+	(void)smartfs_dcache_init(fs);
+#endif
+#ifdef SMARTFS_WRITEBACK_TIMER
+	sem_init(&fs->fs_wbdone, 0, 0);
+	sem_setprotocol(&fs->fs_wbdone, SEM_PRIO_NONE);
+#endif
+
 	smartfs_semgive(fs);
 	return ret;
 
@@ -1627,12 +1835,37 @@ static int smartfs_unbind(void *handle, FAR struct inode **blkdriver)
 		smartfs_semgive(fs);
 		return -EBUSY;
 	}
+#ifdef SMARTFS_WRITEBACK_TIMER
+	/* Keep the write-back worker from being queued again and drop it if it
+	 * has not started yet.  If it has, it is either running or blocked on
+	 * the semaphore and is waited for below.  There are no open files, so
+	 * it has nothing left to flush.
+	 */
+
+	fs->fs_wbstop = true;
+	if (work_cancel(LPWORK, &fs->fs_wbwork) == OK) {
+		fs->fs_wbpending--;
+	}
+#endif
 	/* Unmount ... close the block driver */
 	ret = smartfs_unmount(fs);
 #ifdef CONFIG_SMARTFS_JOURNALING
 	if (fs->journal) {
 		kmm_free(fs->journal);
 	}
+#endif
+#ifdef CONFIG_SMARTFS_DCACHE
+	smartfs_dcache_uninit(fs);
+#endif
+#ifdef SMARTFS_WRITEBACK_TIMER
+	if (fs->fs_wbpending > 0) {
+		smartfs_semgive(fs);
+		while (sem_wait(&fs->fs_wbdone) != OK) {
+			ASSERT(*get_errno_ptr() == EINTR);
+		}
+		smartfs_semtake(fs);
+	}
+	sem_destroy(&fs->fs_wbdone);
 #endif
 	smartfs_semgive(fs);
 	kmm_free(fs);
@@ -2101,6 +2334,9 @@ int smartfs_rename(struct inode *mountpt, const char *oldrelpath, const char *ne
 
 		/* Now mark the old entry as inactive */
 
+#ifdef CONFIG_SMARTFS_DCACHE
+		smartfs_dcache_remove(fs, oldentry.dsector, oldentry.doffset);
+#endif
 		readwrite.logsector = oldentry.dsector;
 		readwrite.offset = 0;
 		readwrite.count = fs->fs_llformat.availbytes;
@@ -750,6 +750,70 @@ int smartfs_unmount(struct smartfs_mountpt_s *fs)
 	return ret;
 }
 
+/****************************************************************************
+ * Name: smartfs_filelength
+ *
+ * Description: Scan the sector chain of a file to calculate its length.
+ *              Uses fs_rwbuffer.
+ *
+ ****************************************************************************/
+
+static uint32_t smartfs_filelength(struct smartfs_mountpt_s *fs, uint16_t firstsector)
+{
+	struct smart_read_write_s readwrite;
+	struct smartfs_chain_header_s *header;
+	uint16_t dirsector;
+	uint32_t datlen;
+	int ret;
+#ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
+	int used_value;
+#endif
+
+	datlen = 0;
+	dirsector = firstsector;
+	header = (struct smartfs_chain_header_s *)fs->fs_rwbuffer;
+	readwrite.count = sizeof(struct smartfs_chain_header_s);
+	readwrite.buffer = (uint8_t *)fs->fs_rwbuffer;
+	readwrite.offset = 0;
+
+	while (dirsector != SMARTFS_ERASEDSTATE_16BIT) {
+		/* Read the next sector of the file */
+
+		readwrite.logsector = dirsector;
+		ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long)&readwrite);
+		if (ret < 0) {
+			fdbg("Error in sector chain at %d!\n", dirsector);
+			break;
+		}
+#ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
+		if (SMARTFS_NEXTSECTOR(header) == SMARTFS_ERASEDSTATE_16BIT) {
+
+			readwrite.count = fs->fs_llformat.availbytes;
+			readwrite.buffer = (uint8_t *)fs->fs_chunk_buffer;
+
+			ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long)&readwrite);
+			if (ret < 0) {
+				fdbg("Error %d reading sector %d header\n", ret, dirsector);
+				break;
+			}
+			used_value = get_leftover_used_byte_count((uint8_t *)readwrite.buffer, get_used_byte_count((uint8_t *)header->used));
+			datlen += used_value;
+		} else {
+			datlen += (fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s));
+		}
+		readwrite.buffer = (uint8_t *)fs->fs_rwbuffer;
+#else
+		/* Add used bytes to the total and point to next sector */
+		if (SMARTFS_USED(header) != SMARTFS_ERASEDSTATE_16BIT) {
+			datlen += SMARTFS_USED(header);
+		}
+#endif
+		dirsector = SMARTFS_NEXTSECTOR(header);
+	}
+
+	return datlen;
+}
+
 /****************************************************************************
  * Name: smartfs_finddirentry
  *
@@ -780,8 +844,9 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *d
 	struct smartfs_chain_header_s *header;
 	struct smart_read_write_s readwrite;
 	struct smartfs_entry_header_s *entry;
-#ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
-	int used_value;
+#ifdef CONFIG_SMARTFS_DCACHE
+	FAR struct smartfs_dcache_entry_s *dc;
+	struct smartfs_entry_s dcentry;
 #endif
 
 	/* Initialize directory level zero as the root sector */
@@ -851,6 +916,67 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *d
 			segment = ptr;
 			continue;
 		} else {
+#ifdef CONFIG_SMARTFS_DCACHE
+			/* Try the directory entry cache first */
+
+			dc = smartfs_dcache_lookup(fs, dirstack[depth], fs->fs_workbuffer);
+			if (dc != NULL) {
+				if (*ptr == '\0') {
+					/* We are at the last segment.  Report the entry */
+
+					direntry->firstsector = dc->firstsector;
+					direntry->flags = dc->flags;
+					direntry->utc = dc->utc;
+					direntry->dsector = dc->dsector;
+					direntry->doffset = dc->doffset;
+					direntry->dfirst = dirstack[depth];
+					if (direntry->name == NULL) {
+						direntry->name = (char *)kmm_malloc(fs->fs_llformat.namesize + 1);
+						if (direntry->name == NULL) {
+							ret = ERROR;
+							goto errout;
+						}
+					}
+
+					memset(direntry->name, 0, fs->fs_llformat.namesize + 1);
+					strncpy(direntry->name, dc->name, fs->fs_llformat.namesize);
+
+					direntry->datlen = 0;
+					if ((dc->flags & SMARTFS_DIRENT_TYPE) == SMARTFS_DIRENT_TYPE_FILE) {
+						if (!dc->lenvalid) {
+							dc->datlen = smartfs_filelength(fs, dc->firstsector);
+							dc->lenvalid = true;
+						}
+
+						direntry->datlen = dc->datlen;
+					}
+
+					*parentdirsector = dirstack[depth];
+					*filename = segment;
+					ret = OK;
+					goto errout;
+				}
+
+				/* Validate it's a directory */
+
+				if ((dc->flags & SMARTFS_DIRENT_TYPE) != SMARTFS_DIRENT_TYPE_DIR) {
+					ret = -ENOTDIR;
+					goto errout;
+				}
+
+				/* "Push" the directory and continue searching */
+
+				if (depth >= CONFIG_SMARTFS_DIRDEPTH - 1) {
+					ret = -ENAMETOOLONG;
+					goto errout;
+				}
+
+				dirstack[++depth] = dc->firstsector;
+				segment = ptr + 1;
+				continue;
+			}
+#endif
+
 			/* Search for the entry in the current directory */
 
 			dirsector = dirstack[depth];
@@ -940,52 +1066,12 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *d
 							 * a rudimentary check.
 							 */
 
-#ifdef CONFIG_SMARTFS_ALIGNED_ACCESS
-							if ((smartfs_rdle16(&entry->flags) & SMARTFS_DIRENT_TYPE) == SMARTFS_DIRENT_TYPE_FILE) {
-								dirsector = smartfs_rdle16(&entry->firstsector);
-#else
-							if ((entry->flags & SMARTFS_DIRENT_TYPE) == SMARTFS_DIRENT_TYPE_FILE) {
-								dirsector = entry->firstsector;
-#endif
-								readwrite.count = sizeof(struct smartfs_chain_header_s);
-								readwrite.buffer = (uint8_t *)fs->fs_rwbuffer;
-								readwrite.offset = 0;
-
-								while (dirsector != SMARTFS_ERASEDSTATE_16BIT) {
-									/* Read the next sector of the file */
-
-									readwrite.logsector = dirsector;
-									ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long)&readwrite);
-									if (ret < 0) {
-										fdbg("Error in sector chain at %d!\n", dirsector);
-										break;
-									}
-#ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
-									if (SMARTFS_NEXTSECTOR(header) == SMARTFS_ERASEDSTATE_16BIT) {
-
-										readwrite.count = fs->fs_llformat.availbytes;
-										readwrite.buffer = (uint8_t *)fs->fs_chunk_buffer;
-
-										ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long)&readwrite);
-										if (ret < 0) {
-											fdbg("Error %d reading sector %d header\n", ret, sf->currsector);
-											break;
-										}
-										used_value = get_leftover_used_byte_count((uint8_t *)readwrite.buffer, get_used_byte_count((uint8_t *)header->used));
-										direntry->datlen += used_value;
-									} else {
-										direntry->datlen += (fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s));
-									}
-									readwrite.buffer = (uint8_t *)fs->fs_rwbuffer;
-#else
-									/* Add used bytes to the total and point to next sector */
-									if (SMARTFS_USED(header) != SMARTFS_ERASEDSTATE_16BIT) {
-										direntry->datlen += SMARTFS_USED(header);
-									}
-#endif
-									dirsector = SMARTFS_NEXTSECTOR(header);
-								}
+							if ((direntry->flags & SMARTFS_DIRENT_TYPE) == SMARTFS_DIRENT_TYPE_FILE) {
+								direntry->datlen = smartfs_filelength(fs, direntry->firstsector);
 							}
+#ifdef CONFIG_SMARTFS_DCACHE
+							smartfs_dcache_add(fs, direntry, direntry->name, true);
+#endif
 
 							*parentdirsector = dirstack[depth];
 							*filename = segment;
@@ -1014,6 +1100,22 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *d
 								ret = -ENAMETOOLONG;
 								goto errout;
 							}
+#ifdef CONFIG_SMARTFS_DCACHE
+							dcentry.dsector = readwrite.logsector;
+							dcentry.doffset = offset;
+							dcentry.dfirst = dirstack[depth];
+#ifdef CONFIG_SMARTFS_ALIGNED_ACCESS
+							dcentry.firstsector = smartfs_rdle16(&entry->firstsector);
+							dcentry.flags = smartfs_rdle16(&entry->flags);
+							dcentry.utc = smartfs_rdle32(&entry->utc);
+#else
+							dcentry.firstsector = entry->firstsector;
+							dcentry.flags = entry->flags;
+							dcentry.utc = entry->utc;
+#endif
+							dcentry.datlen = 0;
+							smartfs_dcache_add(fs, &dcentry, fs->fs_workbuffer, true);
+#endif
 #ifdef CONFIG_SMARTFS_ALIGNED_ACCESS
 							dirstack[++depth] = smartfs_rdle16(&entry->firstsector);
 #else
@@ -1306,6 +1408,13 @@ int smartfs_createentry(struct smartfs_mountpt_s *fs, uint16_t parentdirsector,
 
 	memset(direntry->name, 0, fs->fs_llformat.namesize + 1);
 	strncpy(direntry->name, filename, fs->fs_llformat.namesize);
+	direntry->dfirst = parentdirsector;
+
+#ifdef CONFIG_SMARTFS_DCACHE
+	/* An existing sector (rename) keeps its data, so its length is unknown */
+
+	smartfs_dcache_add(fs, direntry, filename, sectorno == 0xFFFF);
+#endif
 
 	ret = OK;
 
@@ -1336,6 +1445,10 @@ int smartfs_deleteentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *en
 	struct smartfs_chain_header_s *header;
 	struct smart_read_write_s readwrite;
 
+#ifdef CONFIG_SMARTFS_DCACHE
+	smartfs_dcache_remove(fs, entry->dsector, entry->doffset);
+#endif
+
 	/* Okay, delete the file.  Loop through each sector and release them
 
 	 * TODO:  We really should walk the list backward to avoid lost
@@ -1594,6 +1707,10 @@ int smartfs_truncatefile(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *e
 	struct smartfs_chain_header_s *header;
 	struct smart_read_write_s readwrite;
 
+#ifdef CONFIG_SMARTFS_DCACHE
+	smartfs_dcache_invalidatelen(fs, entry->firstsector);
+#endif
+
 	/* Walk through the directory's sectors and count entries */
 
 	nextsector = entry->firstsector;
@@ -3021,6 +3138,32 @@ static int smartfs_write_transaction(struct smartfs_mountpt_s *fs, struct journa
 	req.offset = *offset;
 	req.count = sizeof(struct smartfs_logging_entry_s);
 	req.buffer = j_mgr->buffer;
+
+#ifdef CONFIG_SMARTFS_JOURNAL_GROUP_COMMIT
+	/* If the entry and its data fit in this sector, write them together
+	 * with the STARTED mark in one program.  The mark is not covered by the
+	 * entry CRC, and a torn write is caught by the CRCs during restore.
+	 */
+
+	if (GET_TRANS_TYPE(entry->trans_info) != T_DELETE) {
+		req.count += entry->datalen;
+	}
+
+	if (req.offset + req.count <= j_mgr->availbytes) {
+		T_SET_TRANSACTION(entry->trans_info, TRANS_STARTED);
+		ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long)&req);
+		if (ret != OK) {
+			fdbg("write entry failed ret : %d\n", ret);
+			return ret;
+		}
+
+		j_mgr->offset += req.count;
+		return OK;
+	}
+
+	req.count = sizeof(struct smartfs_logging_entry_s);
+#endif
+
 	/* Write the entry */
 	ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long)&req);
 	if (ret != OK) {
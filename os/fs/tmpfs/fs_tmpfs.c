@@ -83,8 +83,8 @@
 #  warning CONFIG_FS_TMPFS_DIRECTORY_FREEGUARD needs to be > ALLOCGUARD
 #endif
 
-#if CONFIG_FS_TMPFS_FILE_FREEGUARD <= CONFIG_FS_TMPFS_FILE_ALLOCGUARD
-#  warning CONFIG_FS_TMPFS_FILE_FREEGUARD needs to be > ALLOCGUARD
+#if CONFIG_FS_TMPFS_CHUNKSIZE <= 0
+#  error CONFIG_FS_TMPFS_CHUNKSIZE must be positive
 #endif
 
 #define tmpfs_lock_file(tfo) \
@@ -109,8 +109,15 @@ static void tmpfs_lock_object(FAR struct tmpfs_object_s *to);
 static void tmpfs_unlock_object(FAR struct tmpfs_object_s *to);
 static int  tmpfs_realloc_directory(FAR struct tmpfs_directory_s **tdo,
 		unsigned int nentries);
-static int  tmpfs_realloc_file(FAR struct tmpfs_file_s **tfo,
+static FAR struct tmpfs_chunk_s *tmpfs_find_chunk(FAR struct tmpfs_file_s *tfo,
+		size_t pos, FAR size_t *chunkpos);
+static void tmpfs_read_chunks(FAR struct tmpfs_file_s *tfo, size_t pos,
+		FAR char *buffer, size_t len);
+static void tmpfs_write_chunks(FAR struct tmpfs_file_s *tfo, size_t pos,
+		FAR const char *buffer, size_t len);
+static int  tmpfs_resize_file(FAR struct tmpfs_file_s *tfo,
 		size_t newsize);
+static int  tmpfs_flatten_file(FAR struct tmpfs_file_s *tfo);
 static void tmpfs_release_lockedobject(FAR struct tmpfs_object_s *to);
 static void tmpfs_release_lockedfile(FAR struct tmpfs_file_s *tfo);
 static int  tmpfs_find_dirent(FAR struct tmpfs_directory_s *tdo,
@@ -369,64 +376,250 @@ static int tmpfs_realloc_directory(FAR struct tmpfs_directory_s **tdo,
 }
 
 /****************************************************************************
- * Name: tmpfs_realloc_file
+ * Name: tmpfs_find_chunk
+ *
+ * Description:
+ *   Return the chunk holding the byte at offset 'pos' of the file, which
+ *   must be below tfo_capacity, and the file offset of this chunk.
+ *   Appends go straight to the last chunk and sequential accesses start
+ *   from the chunk last accessed, so only random accesses walk the list.
+ *
  ****************************************************************************/
 
-static int tmpfs_realloc_file(FAR struct tmpfs_file_s **tfo,
-		size_t newsize)
+static FAR struct tmpfs_chunk_s *tmpfs_find_chunk(FAR struct tmpfs_file_s *tfo,
+		size_t pos, FAR size_t *chunkpos)
 {
-	FAR struct tmpfs_file_s *oldtfo = *tfo;
-	FAR struct tmpfs_file_s *newtfo;
-	size_t objsize;
-	size_t allocsize;
+	FAR struct tmpfs_chunk_s *chunk;
+	size_t start;
 
-	/* Check if the current allocation is sufficent */
+	DEBUGASSERT(pos < tfo->tfo_capacity);
 
-	objsize = SIZEOF_TMPFS_FILE(newsize);
+	if (pos >= tfo->tfo_tailpos) {
+		*chunkpos = tfo->tfo_tailpos;
+		return tfo->tfo_tail;
+	}
 
-	/* Are we growing or shrinking the object? */
+	if (tfo->tfo_cache != NULL && pos >= tfo->tfo_cachepos) {
+		chunk = tfo->tfo_cache;
+		start = tfo->tfo_cachepos;
+	} else {
+		chunk = tfo->tfo_head;
+		start = 0;
+	}
 
-	if (objsize <= oldtfo->tfo_alloc) {
-		/* Shrinking ... Shrink unconditionally if the size is shrinking to
-		 * zero.
-		 */
+	while (pos >= start + chunk->tch_size) {
+		start += chunk->tch_size;
+		chunk  = chunk->tch_next;
+	}
 
-		if (newsize > 0) {
-			/* Otherwise, don't realloc unless the object has shrunk by a
-			 * lot.
-			 */
+	*chunkpos = start;
+	return chunk;
+}
 
-			if (oldtfo->tfo_alloc - objsize <= CONFIG_FS_TMPFS_FILE_FREEGUARD) {
-				/* Hasn't shrunk enough.. Return doing nothing for now */
+/****************************************************************************
+ * Name: tmpfs_read_chunks
+ ****************************************************************************/
 
-				oldtfo->tfo_size = newsize;
-				return OK;
-			}
+static void tmpfs_read_chunks(FAR struct tmpfs_file_s *tfo, size_t pos,
+		FAR char *buffer, size_t len)
+{
+	FAR struct tmpfs_chunk_s *chunk;
+	size_t chunkpos;
+	size_t offset;
+	size_t ncopy;
+
+	if (len == 0) {
+		return;
+	}
+
+	chunk = tmpfs_find_chunk(tfo, pos, &chunkpos);
+	for (;;) {
+		offset = pos - chunkpos;
+		ncopy  = chunk->tch_size - offset;
+		if (ncopy > len) {
+			ncopy = len;
 		}
+
+		memcpy(buffer, &chunk->tch_data[offset], ncopy);
+		buffer += ncopy;
+		pos    += ncopy;
+		len    -= ncopy;
+
+		if (len == 0) {
+			break;
+		}
+
+		chunkpos += chunk->tch_size;
+		chunk     = chunk->tch_next;
 	}
 
-	/* Added some additional amount to the new size to account frequent
-	 * reallocations.
+	tfo->tfo_cache    = chunk;
+	tfo->tfo_cachepos = chunkpos;
+}
+
+/****************************************************************************
+ * Name: tmpfs_write_chunks
+ *
+ * Description:
+ *   Copy data into the chunks of a file, or fill them with zeroes if
+ *   'buffer' is NULL.
+ *
+ ****************************************************************************/
+
+static void tmpfs_write_chunks(FAR struct tmpfs_file_s *tfo, size_t pos,
+		FAR const char *buffer, size_t len)
+{
+	FAR struct tmpfs_chunk_s *chunk;
+	size_t chunkpos;
+	size_t offset;
+	size_t ncopy;
+
+	if (len == 0) {
+		return;
+	}
+
+	chunk = tmpfs_find_chunk(tfo, pos, &chunkpos);
+	for (;;) {
+		offset = pos - chunkpos;
+		ncopy  = chunk->tch_size - offset;
+		if (ncopy > len) {
+			ncopy = len;
+		}
+
+		if (buffer != NULL) {
+			memcpy(&chunk->tch_data[offset], buffer, ncopy);
+			buffer += ncopy;
+		} else {
+			memset(&chunk->tch_data[offset], 0, ncopy);
+		}
+
+		pos += ncopy;
+		len -= ncopy;
+
+		if (len == 0) {
+			break;
+		}
+
+		chunkpos += chunk->tch_size;
+		chunk     = chunk->tch_next;
+	}
+
+	tfo->tfo_cache    = chunk;
+	tfo->tfo_cachepos = chunkpos;
+}
+
+/****************************************************************************
+ * Name: tmpfs_resize_file
+ *
+ * Description:
+ *   Set the size of a file.  Chunks are appended to the file as needed to
+ *   hold the new size; the chunks lying wholly past the new size are
+ *   freed.  The data of a chunk never moves, so growing a file does not
+ *   copy it and does not need a contiguous block the size of the file.
+ *
+ ****************************************************************************/
+
+static int tmpfs_resize_file(FAR struct tmpfs_file_s *tfo,
+		size_t newsize)
+{
+	FAR struct tmpfs_chunk_s *chunk;
+	FAR struct tmpfs_chunk_s *next;
+	size_t chunkpos;
+
+	/* Growing ... Append chunks until the file fits */
+
+	while (newsize > tfo->tfo_capacity) {
+		chunk = (FAR struct tmpfs_chunk_s *)
+			kmm_malloc(SIZEOF_TMPFS_CHUNK(CONFIG_FS_TMPFS_CHUNKSIZE));
+		if (chunk == NULL) {
+			return -ENOMEM;
+		}
+
+		chunk->tch_next = NULL;
+		chunk->tch_size = CONFIG_FS_TMPFS_CHUNKSIZE;
+
+		if (tfo->tfo_tail == NULL) {
+			tfo->tfo_head = chunk;
+		} else {
+			tfo->tfo_tail->tch_next = chunk;
+		}
+
+		tfo->tfo_tail      = chunk;
+		tfo->tfo_tailpos   = tfo->tfo_capacity;
+		tfo->tfo_capacity += CONFIG_FS_TMPFS_CHUNKSIZE;
+		tfo->tfo_alloc    += SIZEOF_TMPFS_CHUNK(CONFIG_FS_TMPFS_CHUNKSIZE);
+	}
+
+	/* Shrinking ... Free the chunks past the new end of file, including
+	 * those left over by a failed extension.
 	 */
 
-	allocsize = objsize + CONFIG_FS_TMPFS_FILE_ALLOCGUARD;
+	if (tfo->tfo_head != NULL && (newsize == 0 || tfo->tfo_tailpos >= newsize)) {
+		if (newsize == 0) {
+			next             = tfo->tfo_head;
+			tfo->tfo_head    = NULL;
+			tfo->tfo_tail    = NULL;
+			tfo->tfo_tailpos = 0;
+			tfo->tfo_capacity = 0;
+		} else {
+			chunk            = tmpfs_find_chunk(tfo, newsize - 1, &chunkpos);
+			next             = chunk->tch_next;
+			chunk->tch_next  = NULL;
+			tfo->tfo_tail    = chunk;
+			tfo->tfo_tailpos = chunkpos;
+			tfo->tfo_capacity = chunkpos + chunk->tch_size;
+		}
+
+		for (; next != NULL; next = chunk) {
+			chunk           = next->tch_next;
+			tfo->tfo_alloc -= SIZEOF_TMPFS_CHUNK(next->tch_size);
+			kmm_free(next);
+		}
 
-	/* Realloc the file object */
+		tfo->tfo_cache = NULL;
+	}
 
-	newtfo = (FAR struct tmpfs_file_s *)kmm_realloc(oldtfo, allocsize);
-	if (newtfo == NULL) {
+	tfo->tfo_size = newsize;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: tmpfs_flatten_file
+ *
+ * Description:
+ *   Gather the data of a file in a single chunk so that it can be accessed
+ *   directly.
+ *
+ ****************************************************************************/
+
+static int tmpfs_flatten_file(FAR struct tmpfs_file_s *tfo)
+{
+	FAR struct tmpfs_chunk_s *chunk;
+	size_t size = tfo->tfo_size;
+
+	if (tfo->tfo_head == NULL || tfo->tfo_head->tch_next == NULL) {
+		return OK;
+	}
+
+	chunk = (FAR struct tmpfs_chunk_s *)kmm_malloc(SIZEOF_TMPFS_CHUNK(size));
+	if (chunk == NULL) {
 		return -ENOMEM;
 	}
-	/* Adjust the reference in the parent directory entry */
 
-	DEBUGASSERT(newtfo->tfo_dirent);
-	newtfo->tfo_dirent->tde_object = (FAR struct tmpfs_object_s *)newtfo;
+	tmpfs_read_chunks(tfo, 0, (FAR char *)chunk->tch_data, size);
+	chunk->tch_next = NULL;
+	chunk->tch_size = size;
+
+	/* Replace the old chunks with the new one */
 
-	/* Return the new address of the reallocated file object */
+	(void)tmpfs_resize_file(tfo, 0);
 
-	newtfo->tfo_alloc = allocsize;
-	newtfo->tfo_size  = newsize;
-	*tfo              = newtfo;
+	tfo->tfo_head     = chunk;
+	tfo->tfo_tail     = chunk;
+	tfo->tfo_tailpos  = 0;
+	tfo->tfo_capacity = size;
+	tfo->tfo_alloc   += SIZEOF_TMPFS_CHUNK(size);
+	tfo->tfo_size     = size;
 	return OK;
 }
 
@@ -461,6 +654,7 @@ static void tmpfs_release_lockedfile(FAR struct tmpfs_file_s *tfo)
 	 */
 
 	if (tfo->tfo_refs == 1 && (tfo->tfo_flags & TFO_FLAG_UNLINKED) != 0) {
+		(void)tmpfs_resize_file(tfo, 0);
 		sem_destroy(&tfo->tfo_exclsem.ts_sem);
 		kmm_free(tfo);
 	}
@@ -601,9 +795,11 @@ static FAR struct tmpfs_file_s *tmpfs_alloc_file(void)
 	FAR struct tmpfs_file_s *tfo;
 	size_t allocsize;
 
-	/* Create a new zero length file object */
+	/* Create a new zero length file object.  The data chunks are allocated
+	 * as the file grows.
+	 */
 
-	allocsize = SIZEOF_TMPFS_FILE(CONFIG_FS_TMPFS_FILE_ALLOCGUARD);
+	allocsize = sizeof(struct tmpfs_file_s);
 	tfo = (FAR struct tmpfs_file_s *)kmm_malloc(allocsize);
 	if (tfo == NULL) {
 		return NULL;
@@ -618,6 +814,13 @@ static FAR struct tmpfs_file_s *tmpfs_alloc_file(void)
 	tfo->tfo_flags = 0;
 	tfo->tfo_size  = 0;
 
+	tfo->tfo_capacity = 0;
+	tfo->tfo_head     = NULL;
+	tfo->tfo_tail     = NULL;
+	tfo->tfo_tailpos  = 0;
+	tfo->tfo_cache    = NULL;
+	tfo->tfo_cachepos = 0;
+
 	tfo->tfo_exclsem.ts_holder = getpid();
 	tfo->tfo_exclsem.ts_count  = 1;
 	sem_init(&tfo->tfo_exclsem.ts_sem, 0, 0);
@@ -1203,6 +1406,10 @@ static int tmpfs_free_callout(FAR struct tmpfs_directory_s *tdo,
 
 	/* Free the object now */
 
+	if (to->to_type == TMPFS_REGULAR) {
+		(void)tmpfs_resize_file((FAR struct tmpfs_file_s *)to, 0);
+	}
+
 	sem_destroy(&to->to_exclsem.ts_sem);
 	kmm_free(to);
 	return TMPFS_DELETED;
@@ -1344,7 +1551,7 @@ static int tmpfs_open(FAR struct file *filep, FAR const char *relpath,
 			 */
 
 			if (tfo->tfo_size > 0) {
-				ret = tmpfs_realloc_file(&tfo, 0);
+				ret = tmpfs_resize_file(tfo, 0);
 				if (ret < 0)
 					goto errout_with_filelock;
 			}
@@ -1448,6 +1655,7 @@ static int tmpfs_close(FAR struct file *filep)
 		 * have any other references.
 		 */
 
+		(void)tmpfs_resize_file(tfo, 0);
 		kmm_free(tfo);
 		return OK;
 	}
@@ -1488,14 +1696,16 @@ static ssize_t tmpfs_read(FAR struct file *filep, FAR char *buffer,
 	nread    = buflen;
 	endpos   = startpos + buflen;
 
-	if (endpos > tfo->tfo_size) {
+	if (startpos >= tfo->tfo_size) {
+		nread  = 0;
+	} else if (endpos > tfo->tfo_size) {
 		endpos = tfo->tfo_size;
 		nread  = endpos - startpos;
 	}
 
 	/* Copy data from the memory object to the user buffer */
 
-	memcpy(buffer, &tfo->tfo_data[startpos], nread);
+	tmpfs_read_chunks(tfo, (size_t)startpos, buffer, nread);
 	filep->f_pos += nread;
 
 	/* Release the lock on the file */
@@ -1513,6 +1723,7 @@ static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
 {
 	FAR struct tmpfs_file_s *tfo;
 	ssize_t nwritten;
+	size_t oldsize;
 	off_t startpos;
 	off_t endpos;
 	int ret;
@@ -1536,18 +1747,24 @@ static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
 	endpos   = startpos + buflen;
 
 	if (endpos > tfo->tfo_size) {
-		/* Reallocate the file to handle the write past the end of the file. */
+		/* Extend the file to handle the write past the end of the file. */
 
-		ret = tmpfs_realloc_file(&tfo, (size_t)endpos);
+		oldsize = tfo->tfo_size;
+		ret = tmpfs_resize_file(tfo, (size_t)endpos);
 		if (ret < 0) {
 			goto errout_with_lock;
 		}
-		filep->f_priv = tfo;
+
+		/* Zero the gap left by a seek past the old end of the file */
+
+		if (startpos > oldsize) {
+			tmpfs_write_chunks(tfo, oldsize, NULL, (size_t)startpos - oldsize);
+		}
 	}
 
-	/* Copy data from the memory object to the user buffer */
+	/* Copy data from the user buffer to the memory object */
 
-	memcpy(&tfo->tfo_data[startpos], buffer, nwritten);
+	tmpfs_write_chunks(tfo, (size_t)startpos, buffer, nwritten);
 	filep->f_pos += nwritten;
 
 	/* Release the lock on the file */
@@ -1626,6 +1843,7 @@ static int tmpfs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 {
 	FAR struct tmpfs_file_s *tfo;
 	FAR void **ppv = (FAR void**)arg;
+	int ret;
 
 	fvdbg("filep: %p cmd: %d arg: %08lx\n", filep, cmd, arg);
 	DEBUGASSERT(filep->f_priv != NULL && filep->f_inode != NULL);
@@ -1639,12 +1857,28 @@ static int tmpfs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 	/* Only one ioctl command is supported */
 
 	if (cmd == FIOC_MMAP && ppv != NULL) {
-		/* Return the address on the media corresponding to the start of
-		 * the file.
+		/* Direct access is only given to read-only opens: the data must be
+		 * moved to a single chunk first and would not stay contiguous as
+		 * the file grows.  The address remains valid until the file is
+		 * truncated or deleted.
 		 */
 
-		*ppv = (FAR void *)tfo->tfo_data;
-		return OK;
+		if ((filep->f_oflags & O_WROK) != 0) {
+			return -EACCES;
+		}
+
+		tmpfs_lock_file(tfo);
+		ret = tmpfs_flatten_file(tfo);
+		if (ret >= 0) {
+			/* Return the address on the media corresponding to the start
+			 * of the file.
+			 */
+
+			*ppv = tfo->tfo_head ? (FAR void *)tfo->tfo_head->tch_data : NULL;
+		}
+
+		tmpfs_unlock_file(tfo);
+		return ret;
 	}
 
 	fdbg("ERROR: Invalid cmd: %d\n", cmd);
@@ -2093,6 +2327,7 @@ static int tmpfs_unlink(FAR struct inode *mountpt, FAR const char *relpath)
 	/* Otherwise we can free the object now */
 
 	else {
+		(void)tmpfs_resize_file(tfo, 0);
 		sem_destroy(&tfo->tfo_exclsem.ts_sem);
 		kmm_free(tfo);
 	}
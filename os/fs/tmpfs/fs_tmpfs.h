@@ -152,6 +152,19 @@ struct tmpfs_directory_s {
 #define SIZEOF_TMPFS_DIRECTORY(n) \
 	(sizeof(struct tmpfs_directory_s) + ((n) - 1) * sizeof(struct tmpfs_dirent_s))
 
+/* The data of a regular file is stored in a list of chunks.  The chunks
+ * are normally CONFIG_FS_TMPFS_CHUNKSIZE bytes but the chunk built by
+ * FIOC_MMAP holds the whole file.
+ */
+
+struct tmpfs_chunk_s {
+	FAR struct tmpfs_chunk_s *tch_next; /* Next chunk of the file */
+	size_t   tch_size;     /* Size of the chunk data */
+	uint8_t  tch_data[1];  /* Chunk data starts here */
+};
+
+#define SIZEOF_TMPFS_CHUNK(n) (sizeof(struct tmpfs_chunk_s) + (n) - 1)
+
 /* The form of a regular file memory object
  *
  * NOTE that in this very simplified implementation, there is no per-open
@@ -174,11 +187,14 @@ struct tmpfs_file_s {
 
 	uint8_t  tfo_flags;    /* See TFO_FLAG_* definitions */
 	size_t   tfo_size;     /* Valid file size */
-	uint8_t  tfo_data[1];  /* File data starts here */
+	size_t   tfo_capacity; /* Size of all chunks */
+	FAR struct tmpfs_chunk_s *tfo_head;  /* First chunk of data */
+	FAR struct tmpfs_chunk_s *tfo_tail;  /* Last chunk of data */
+	size_t   tfo_tailpos;  /* File offset of the last chunk */
+	FAR struct tmpfs_chunk_s *tfo_cache; /* Chunk last accessed (or NULL) */
+	size_t   tfo_cachepos; /* File offset of the chunk last accessed */
 };
 
-#define SIZEOF_TMPFS_FILE(n) (sizeof(struct tmpfs_file_s) + (n) - 1)
-
 /* This structure represents one instance of a TMPFS file system */
 
 struct tmpfs_s {
@@ -0,0 +1,168 @@
+/****************************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * include/sys/epoll.h
+ *
+ ****************************************************************************/
+/**
+ * @defgroup EPOLL_KERNEL EPOLL
+ * @brief Provides APIs for socket readiness notification
+ * @ingroup KERNEL
+ *
+ * @{
+ */
+
+/// @file sys/epoll.h
+/// @brief socket readiness notification APIs
+
+#ifndef __INCLUDE_SYS_EPOLL_H
+#define __INCLUDE_SYS_EPOLL_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <poll.h>
+
+#ifdef CONFIG_NET_SOCKET_EPOLL
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/* Events, as in poll() */
+
+#define EPOLLIN       POLLIN
+#define EPOLLOUT      POLLOUT
+#define EPOLLERR      POLLERR
+#define EPOLLHUP      POLLHUP
+
+/* Report a socket once each time it becomes ready (edge-triggered) rather
+ * than as long as it is ready (level-triggered, the default).
+ */
+
+#define EPOLLET       (1u << 31)
+
+/* Operations of epoll_ctl() */
+
+#define EPOLL_CTL_ADD 1			/* Add a socket to the interest list */
+#define EPOLL_CTL_DEL 2			/* Remove a socket from the interest list */
+#define EPOLL_CTL_MOD 3			/* Change the events of a socket */
+
+/****************************************************************************
+ * Type Definitions
+ ****************************************************************************/
+
+typedef union epoll_data {
+	void *ptr;
+	int fd;
+	uint32_t u32;
+	uint64_t u64;
+} epoll_data_t;
+
+struct epoll_event {
+	uint32_t events;			/* Requested events, or events returned */
+	epoll_data_t data;			/* User data returned with the events */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C" {
+#else
+#define EXTERN extern
+#endif
+
+/**
+ * @ingroup EPOLL_KERNEL
+ * @brief create an epoll instance
+ * @details @b #include <sys/epoll.h> \n
+ * The instance is not a file descriptor: it is only usable with the
+ * epoll functions and released with epoll_close().
+ * @param[in] size ignored, must be positive
+ * @return an epoll instance on success, -1 on error with errno set
+ * @since TizenRT v3.0
+ */
+EXTERN int epoll_create(int size);
+
+/**
+ * @ingroup EPOLL_KERNEL
+ * @brief create an epoll instance
+ * @details @b #include <sys/epoll.h> \n
+ * Same as epoll_create(); no flag is supported.
+ * @since TizenRT v3.0
+ */
+EXTERN int epoll_create1(int flags);
+
+/**
+ * @ingroup EPOLL_KERNEL
+ * @brief add, modify or remove a socket in the interest list of an epoll
+ * instance
+ * @details @b #include <sys/epoll.h> \n
+ * Only socket descriptors can be watched.  A socket is removed from the
+ * interest lists when it is closed.
+ * @param[in] epfd epoll instance
+ * @param[in] op EPOLL_CTL_ADD, EPOLL_CTL_MOD or EPOLL_CTL_DEL
+ * @param[in] fd socket descriptor
+ * @param[in] event events to watch and user data, unused by EPOLL_CTL_DEL
+ * @return 0 on success, -1 on error with errno set
+ * @since TizenRT v3.0
+ */
+EXTERN int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event);
+
+/**
+ * @ingroup EPOLL_KERNEL
+ * @brief wait for events on an epoll instance
+ * @details @b #include <sys/epoll.h> \n
+ * EPOLLERR is reported even when it is not requested.
+ * @param[in] epfd epoll instance
+ * @param[out] events array receiving the ready sockets
+ * @param[in] maxevents size of the array
+ * @param[in] timeout maximum time to wait in milliseconds, -1 to wait
+ * forever, 0 to return immediately
+ * @return number of ready sockets, 0 on timeout, -1 on error with errno set
+ * @since TizenRT v3.0
+ */
+EXTERN int epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout);
+
+/**
+ * @ingroup EPOLL_KERNEL
+ * @brief release an epoll instance
+ * @details @b #include <sys/epoll.h> \n
+ * No task may be waiting on the instance.
+ * @return 0 on success, -1 on error with errno set
+ * @since TizenRT v3.0
+ */
+EXTERN int epoll_close(int epfd);
+
+#undef EXTERN
+#if defined(__cplusplus)
+}
+#endif
+
+#endif							/* CONFIG_NET_SOCKET_EPOLL */
+#endif							/* __INCLUDE_SYS_EPOLL_H */
+/**
+ * @} */
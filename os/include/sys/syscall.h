@@ -282,7 +282,8 @@
 #define SYS_aio_write                  (__SYS_descriptors + 7)
 #define SYS_aio_fsync                  (__SYS_descriptors + 8)
 #define SYS_aio_cancel                 (__SYS_descriptors + 9)
-#define __SYS_poll                     (__SYS_descriptors + 10)
+#define SYS_lio_listio                 (__SYS_descriptors + 10)
+#define __SYS_poll                     (__SYS_descriptors + 11)
 #else
 #define __SYS_poll                     (__SYS_descriptors + 6)
 #endif
@@ -471,7 +472,20 @@
 #define SYS_setsockopt                 (__SYS_network + 12)
 #define SYS_shutdown                   (__SYS_network + 13)
 #define SYS_socket                     (__SYS_network + 14)
-#define SYS_nnetsocket                 (__SYS_network + 15)
+#define __SYS_epoll                    (__SYS_network + 15)
+
+/* The following are defined only if the epoll socket API is enabled */
+
+#ifdef CONFIG_NET_SOCKET_EPOLL
+#define SYS_epoll_close                (__SYS_epoll + 0)
+#define SYS_epoll_create               (__SYS_epoll + 1)
+#define SYS_epoll_create1              (__SYS_epoll + 2)
+#define SYS_epoll_ctl                  (__SYS_epoll + 3)
+#define SYS_epoll_wait                 (__SYS_epoll + 4)
+#define SYS_nnetsocket                 (__SYS_epoll + 5)
+#else
+#define SYS_nnetsocket                 __SYS_epoll
+#endif
 #else
 #define SYS_nnetsocket                 __SYS_network
 #endif
@@ -480,9 +494,19 @@
 
 #if CONFIG_TASK_NAME_SIZE > 0
 #define SYS_prctl                      (SYS_nnetsocket + 0)
-#define SYS_maxsyscall                 (SYS_nnetsocket + 1)
+#define __SYS_ttrace                   (SYS_nnetsocket + 1)
+#else
+#define __SYS_ttrace                   SYS_nnetsocket
+#endif
+
+/* The following are defined only if binary T-trace events are enabled */
+
+#ifdef CONFIG_TTRACE_BINARY
+#define SYS_ttrace_event               (__SYS_ttrace + 0)
+#define SYS_ttrace_intern              (__SYS_ttrace + 1)
+#define SYS_maxsyscall                 (__SYS_ttrace + 2)
 #else
-#define SYS_maxsyscall                 SYS_nnetsocket
+#define SYS_maxsyscall                 __SYS_ttrace
 #endif
 
 /* Note that the reported number of system calls does *NOT* include the
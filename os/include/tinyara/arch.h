@@ -1675,6 +1675,22 @@ char up_romgetc(FAR const char *ptr);
 void up_mdelay(unsigned int milliseconds);
 void up_udelay(useconds_t microseconds);
 
+/****************************************************************************
+ * Name: up_perf_init, up_perf_gettime and up_perf_getfreq
+ *
+ * Description:
+ *   Start and read a free-running 32-bit counter meant for timestamping
+ *   events finer than the system timer, and return its frequency in Hz, or
+ *   zero if it is not known.
+ *
+ ***************************************************************************/
+
+#ifdef CONFIG_ARCH_HAVE_PERF_COUNTER
+void up_perf_init(void);
+uint32_t up_perf_gettime(void);
+uint32_t up_perf_getfreq(void);
+#endif
+
 /****************************************************************************
  * Name: up_cxxinitialize
  *
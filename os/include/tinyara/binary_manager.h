@@ -24,6 +24,7 @@
  ****************************************************************************/
 
 #include <tinyara/config.h>
+#include <sys/types.h>
 #include <stdint.h>
 
 #ifdef CONFIG_BINARY_MANAGER
@@ -188,6 +189,21 @@ struct binmgr_getinfo_all_response_s {
 };
 typedef struct binmgr_getinfo_all_response_s binmgr_getinfo_all_response_t;
 
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+/* Time spent in each phase of the last load of a binary, in clock ticks.
+ * For a compressed binary, the loading of the sections from flash is
+ * accounted in 'decompress' rather than in 'read'.
+ */
+struct binmgr_loadtime_s {
+	clock_t header;             /* Reading and verifying the partition headers */
+	clock_t read;               /* Reading the ELF headers and sections */
+	clock_t decompress;         /* Reading the sections of a compressed binary */
+	clock_t relocate;           /* Binding the symbols */
+	clock_t ctors;              /* Running the static constructors */
+};
+typedef struct binmgr_loadtime_s binmgr_loadtime_t;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -200,6 +216,21 @@ extern "C" {
 #define EXTERN extern
 #endif
 
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+/****************************************************************************
+ * Name: binary_manager_get_loadtime
+ *
+ * Description:
+ *   Return the name of the user binary at 'bin_idx' (1 for the first one)
+ *   and the time spent in each phase of its last load.
+ *
+ * Returned Value:
+ *   Zero on success, -ENOENT if there is no binary at 'bin_idx'
+ *
+ ****************************************************************************/
+EXTERN int binary_manager_get_loadtime(int bin_idx, FAR char *bin_name, FAR binmgr_loadtime_t *loadtime);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -150,6 +150,10 @@ struct binary_s {
 	size_t offset;                  /* Offset of binary from partition start*/
 	uint8_t compression_type;		/* Binary Compression type */
 
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+	FAR struct binmgr_loadtime_s *loadtime;	/* Where to account the load phases, may be NULL */
+#endif
+
 	/* Unload module callback */
 
 	CODE int (*unload)(FAR struct binary_s *bin);
@@ -22,6 +22,7 @@
 /****************************************************************************
  * Included Files
  ****************************************************************************/
+#include <stdint.h>
 #include <tinyara/binfmt/compression/compression.h>
 
 /****************************************************************************
@@ -36,6 +37,7 @@
 struct s_buffer {
 	unsigned char *read_buffer;
 	unsigned char *out_buffer;
+	int read_size;				/* Size of read_buffer */
 };
 
 /****************************************************************************
@@ -169,6 +169,9 @@ struct elf_loadinfo_s {
 	uint8_t compression_type;		/* Binary Compression type */
 	uintptr_t symtab;			/* Copy of symbol table */
 	uintptr_t reltab;			/* Copy of relocation table */
+#ifdef CONFIG_ELF_BATCH_RELOC
+	bool exportsorted;			/* Exports given to elf_symvalue() are sorted by name */
+#endif
 };
 
 /****************************************************************************
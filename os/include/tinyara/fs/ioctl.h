@@ -242,6 +242,11 @@
 										 *      the block with specific debug
 										 *      command and data.
 										 * OUT: None.  */
+#define BIOC_FLUSH      _BIOC(0x000C)	/* Flush any cached state of the block
+										 * device to the media.
+										 * IN:  None
+										 * OUT: None (ioctl return value provides
+										 *      success/failure indication). */
 
 /* TinyAra MTD driver ioctl definitions ***************************************/
 
@@ -344,6 +349,14 @@
 											 *       (default)
 											 *     1=fre when empty
 											 * OUT: None */
+#define PIPEIOC_SPLICEIN   _PIPEIOC(0x0002)	/* Fill the pipe from a descriptor
+											 * IN: struct pipe_splice_s *
+											 *     (see tinyara/pipe.h)
+											 * OUT: Number of bytes moved */
+#define PIPEIOC_SPLICEOUT  _PIPEIOC(0x0003)	/* Drain the pipe to a descriptor
+											 * IN: struct pipe_splice_s *
+											 *     (see tinyara/pipe.h)
+											 * OUT: Number of bytes moved */
 /* RTC driver ioctl definitions *********************************************/
 /* (see include/tinyara/rtc.h */
 
@@ -58,8 +58,9 @@ enum logm_logflag_e {
 
 /* Log index means where messages are from */
 enum logm_logindex_e {
-	LOGM_UNKNOWN
+	LOGM_UNKNOWN,
 	/* Not supported yet. This would be updated later */
+	LOGM_INDEX_MAX	/* Number of log indexes */
 };
 
 #undef EXTERN
@@ -191,6 +191,21 @@
 #define MM_MAX_CHUNK     (1 << MM_MAX_SHIFT)
 #define MM_NNODES        (MM_MAX_SHIFT - MM_MIN_SHIFT + 1)
 
+/* With CONFIG_MM_ALLOC_TLSF, each of the MM_NNODES power-of-two classes is
+ * split into MM_SLI_COUNT linear second-level classes, and every class has
+ * its own free list in mm_nodelist[].
+ */
+
+#ifdef CONFIG_MM_ALLOC_TLSF
+#define MM_SLI_SHIFT     CONFIG_MM_TLSF_SLI_SHIFT
+#define MM_SLI_COUNT     (1 << MM_SLI_SHIFT)
+#define MM_NFREELISTS    (MM_NNODES * MM_SLI_COUNT)
+#define MM_NDX2NODE(ndx) ((ndx) >> MM_SLI_SHIFT)
+#else
+#define MM_NFREELISTS    MM_NNODES
+#define MM_NDX2NODE(ndx) (ndx)
+#endif
+
 #define MM_GRAN_MASK     (MM_MIN_CHUNK-1)
 #define MM_ALIGN_UP(a)   (((a) + MM_GRAN_MASK) & ~MM_GRAN_MASK)
 #define MM_ALIGN_DOWN(a) ((a) & ~MM_GRAN_MASK)
@@ -219,6 +234,7 @@
 #define HEAPINFO_PID_ALL -1
 
 #define HEAPINFO_INIT_INFO -1
+#define HEAPINFO_CACHED    (INT16_MAX - 2)	/* Owner of the chunks kept in the small-object cache */
 #define HEAPINFO_ADD_INFO 1
 #define HEAPINFO_DEL_INFO 2
 
@@ -363,6 +379,26 @@ struct heapinfo_group_s {
 };
 #endif
 #endif
+#ifdef CONFIG_MM_SMALLCACHE
+/* The small-object cache keeps recently freed chunks of a few fixed sizes
+ * so that small requests can be served without the MM semaphore.  Class n
+ * holds chunks for requests of up to MM_SMALLCACHE_MINSIZE << n bytes.
+ */
+
+#define MM_SMALLCACHE_NCLASSES 4
+#define MM_SMALLCACHE_MINSIZE  16
+#define MM_SMALLCACHE_MAXSIZE  (MM_SMALLCACHE_MINSIZE << (MM_SMALLCACHE_NCLASSES - 1))
+#define MM_SMALLCACHE_CHUNK(n) MM_ALIGN_UP((MM_SMALLCACHE_MINSIZE << (n)) + SIZEOF_MM_ALLOCNODE)
+
+struct mm_smallcache_s {
+	FAR void *head;				/* Cached chunks, linked through their payload */
+	uint16_t count;				/* Number of chunks in the list */
+	uint32_t hits;				/* Requests served from the list */
+	uint32_t misses;			/* Requests that had to refill the list */
+	uint32_t drains;			/* Batches returned to the heap */
+};
+#endif
+
 /* This describes one heap (possibly with multiple regions) */
 
 struct mm_heap_s {
@@ -405,7 +441,21 @@ struct mm_heap_s {
 	 * speed searches for free nodes.
 	 */
 
-	struct mm_freenode_s mm_nodelist[MM_NNODES + 1];
+	struct mm_freenode_s mm_nodelist[MM_NFREELISTS + 1];
+
+#ifdef CONFIG_MM_ALLOC_TLSF
+	/* Bit n of mm_flbitmap is set if any list of first-level class n is
+	 * non-empty.  Bit m of mm_slbitmap[n] is set if mm_nodelist[n *
+	 * MM_SLI_COUNT + m] is non-empty.
+	 */
+
+	uint32_t mm_flbitmap;
+	uint32_t mm_slbitmap[MM_NNODES];
+#endif
+
+#ifdef CONFIG_MM_SMALLCACHE
+	struct mm_smallcache_s mm_smallcache[MM_SMALLCACHE_NCLASSES];
+#endif
 };
 
 /****************************************************************************
@@ -517,6 +567,8 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size, mmaddress_t caller_
 FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size);
 #endif
 
+FAR struct mm_allocnode_s *mm_allocchunk(FAR struct mm_heap_s *heap, size_t size);
+
 /* Functions contained in kmm_malloc.c **************************************/
 
 #ifdef CONFIG_MM_KERNEL_HEAP
@@ -526,6 +578,7 @@ FAR void *kmm_malloc(size_t size);
 /* Functions contained in mm_free.c *****************************************/
 
 void mm_free(FAR struct mm_heap_s *heap, FAR void *mem);
+void mm_freechunk(FAR struct mm_heap_s *heap, FAR struct mm_allocnode_s *chunk);
 
 /* Functions contained in kmm_free.c ****************************************/
 
@@ -681,10 +734,28 @@ void mm_shrinkchunk(FAR struct mm_heap_s *heap, FAR struct mm_allocnode_s *node,
 /* Functions contained in mm_addfreechunk.c *********************************/
 
 void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node);
+#ifdef CONFIG_MM_ALLOC_TLSF
+void mm_removefreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node);
+#endif
 
 /* Functions contained in mm_size2ndx.c.c ***********************************/
 
 int mm_size2ndx(size_t size);
+#ifdef CONFIG_MM_ALLOC_TLSF
+int mm_size2ndx_ceil(size_t size);
+#endif
+
+/* Functions contained in mm_smallcache.c ***********************************/
+
+#ifdef CONFIG_MM_SMALLCACHE
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+FAR void *mm_smallcache_alloc(FAR struct mm_heap_s *heap, size_t size, mmaddress_t caller_retaddr);
+#else
+FAR void *mm_smallcache_alloc(FAR struct mm_heap_s *heap, size_t size);
+#endif
+bool mm_smallcache_free(FAR struct mm_heap_s *heap, FAR void *mem);
+int mm_smallcache_flush(FAR struct mm_heap_s *heap);
+#endif
 
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
 /* Functions contained in kmm_mallinfo.c . Used to display memory allocation details */
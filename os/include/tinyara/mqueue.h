@@ -74,6 +74,12 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* The number of message lists of each message queue */
+
+#ifndef CONFIG_MQ_NPRIOLISTS
+#define CONFIG_MQ_NPRIOLISTS 8
+#endif
+
 /****************************************************************************
  * Global Type Declarations
  ****************************************************************************/
@@ -84,7 +90,11 @@ struct mq_des;					/* forward reference */
 
 struct mqueue_inode_s {
 	FAR struct inode *inode;	/* Containing inode */
-	sq_queue_t msglist;			/* Prioritized message list */
+	sq_queue_t msglist[CONFIG_MQ_NPRIOLISTS];	/* Message lists by ascending priority */
+	uint32_t msgmap;			/* Bit n set if msglist[n] is not empty */
+#ifdef CONFIG_MQ_QUEUE_SLAB
+	sq_queue_t msgfree;			/* Free messages allocated with the queue */
+#endif
 	int16_t maxmsgs;			/* Maximum number of messages in the queue */
 	int16_t nmsgs;				/* Number of message in the queue */
 	int16_t nwaitnotfull;		/* Number tasks waiting for not full */
@@ -0,0 +1,59 @@
+/****************************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_TINYARA_PIPE_H
+#define __INCLUDE_TINYARA_PIPE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+
+#include <tinyara/fs/ioctl.h>
+
+#ifdef CONFIG_DEV_PIPE_SPLICE
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Argument of the PIPEIOC_SPLICEIN and PIPEIOC_SPLICEOUT ioctl commands.
+ *
+ * PIPEIOC_SPLICEOUT writes up to 'len' bytes of the pipe to 'fd' straight
+ * from the pipe buffer, PIPEIOC_SPLICEIN reads up to 'len' bytes from 'fd'
+ * straight into the pipe buffer.  'fd' may be a file, a device, a socket
+ * or another pipe, but not the pipe itself.  Both wait as read() and
+ * write() on the pipe do, unless it was opened with O_NONBLOCK, and then
+ * return the number of bytes moved: zero means that the pipe has no more
+ * writer (PIPEIOC_SPLICEOUT) or that the end of 'fd' was reached
+ * (PIPEIOC_SPLICEIN).
+ *
+ * The pipe stays locked while 'fd' is accessed, so a blocking 'fd' also
+ * blocks the other users of the pipe.
+ */
+
+struct pipe_splice_s {
+	int fd;						/* The other end of the transfer */
+	size_t len;					/* Maximum number of bytes to move */
+};
+
+#endif							/* CONFIG_DEV_PIPE_SPLICE */
+#endif							/* __INCLUDE_TINYARA_PIPE_H */
@@ -75,6 +75,40 @@
 #define TTRACE_TAG_LOCK            (1 << 2)
 #define TTRACE_TAG_TASK            (1 << 3)
 #define TTRACE_TAG_IPC             (1 << 4)
+#define TTRACE_TAG_IRQ             (1 << 5)
+#define TTRACE_TAG_SYSCALL         (1 << 6)
+
+#ifdef CONFIG_TTRACE_BINARY
+/* Types of the binary events and meaning of their arguments */
+
+#define TTRACE_EVENT_BEGIN          1	/* arg0: string id */
+#define TTRACE_EVENT_END            2	/* none */
+#define TTRACE_EVENT_BEGIN_UID      3	/* arg0: unique id */
+#define TTRACE_EVENT_END_UID        4	/* none */
+#define TTRACE_EVENT_SCHED          5	/* arg0: previous task, arg1: next task, see TTRACE_SCHED_TASK */
+#define TTRACE_EVENT_IRQ_ENTER      6	/* arg0: IRQ number */
+#define TTRACE_EVENT_IRQ_LEAVE      7	/* arg0: IRQ number */
+#define TTRACE_EVENT_SEM_WAIT       8	/* arg0: semaphore, arg1: count before waiting */
+#define TTRACE_EVENT_SEM_POST       9	/* arg0: semaphore, arg1: count before posting */
+#define TTRACE_EVENT_MQ_SEND        10	/* arg0: message queue, arg1: see TTRACE_MQ_MSG */
+#define TTRACE_EVENT_MQ_RECEIVE     11	/* arg0: message queue, arg1: see TTRACE_MQ_MSG */
+#define TTRACE_EVENT_SYSCALL_ENTER  12	/* arg0: system call number */
+#define TTRACE_EVENT_SYSCALL_LEAVE  13	/* arg0: return value */
+
+#define TTRACE_SCHED_TASK(pid, prio, state) \
+	((uint32_t)(uint16_t)(pid) | ((uint32_t)(prio) << 16) | ((uint32_t)(state) << 24))
+#define TTRACE_MQ_MSG(len, prio) \
+	((uint32_t)(uint16_t)(len) | ((uint32_t)(prio) << 16))
+
+/* Reading the T-trace device in binary mode returns a struct ttrace_dump_s,
+ * then 'nstrings' interned strings of TTRACE_MSG_BYTES bytes (string id 1
+ * first), 'ntasks' struct ttrace_task_s and 'nevents' struct ttrace_event_s,
+ * oldest first.  All fields are in the byte order of the target.
+ */
+
+#define TTRACE_DUMP_MAGIC          0x42525454	/* "TTRB" */
+#define TTRACE_DUMP_VERSION        1
+#endif
 
 /****************************************************************************
  * Public Variables
@@ -103,6 +137,35 @@ struct trace_packet {        // total 44 byte(message), 12byte(uid)
 	union trace_message msg;   // 32B
 };
 
+#ifdef CONFIG_TTRACE_BINARY
+struct ttrace_event_s {      // total 16B
+	uint32_t ts;               // 4B, timestamp in 1/freq seconds, wraps around
+	int16_t pid;               // 2B, task running when the event was recorded
+	uint8_t type;              // 1B, TTRACE_EVENT_*
+	uint8_t tag;               // 1B, bit number of the TTRACE_TAG_*
+	uint32_t arg0;             // 4B
+	uint32_t arg1;             // 4B
+};
+
+struct ttrace_task_s {       // total 16B
+	int16_t pid;               // 2B
+	uint8_t prio;              // 1B
+	uint8_t pad;               // 1B
+	char comm[TTRACE_COMM_BYTES];  // 12B
+};
+
+struct ttrace_dump_s {       // total 24B
+	uint32_t magic;            // 4B, TTRACE_DUMP_MAGIC
+	uint16_t version;          // 2B, TTRACE_DUMP_VERSION
+	uint16_t evsize;           // 2B, size of struct ttrace_event_s
+	uint32_t freq;             // 4B, timestamp frequency in Hz
+	uint32_t nevents;          // 4B, number of events
+	uint32_t lost;             // 4B, number of events overwritten
+	uint16_t nstrings;         // 2B, number of interned strings
+	uint16_t ntasks;           // 2B, number of tasks
+};
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -162,12 +225,47 @@ int trace_end_uid(int tag);
  * @since TizenRT v1.1
  */
 int trace_sched(struct tcb_s *prev, struct tcb_s *next);
+
+#ifdef CONFIG_TTRACE_BINARY
+/**
+ * @ingroup TTRACE_LIBC
+ * @brief records a binary trace event
+ * @details @b #include <tinyara/ttrace.h> \n
+ * The event is stored in the trace buffer of the kernel without going
+ * through the T-trace device, if tracing is running and the tag selected.
+ * It may be called from interrupt handlers.
+ * @param[in] tag TTRACE_TAG_* of the event
+ * @param[in] type TTRACE_EVENT_* type of the event
+ * @param[in] arg0 first argument, depending on the type
+ * @param[in] arg1 second argument, depending on the type
+ * @since TizenRT v3.0
+ */
+void ttrace_event(int tag, uint8_t type, uint32_t arg0, uint32_t arg1);
+
+/**
+ * @ingroup TTRACE_LIBC
+ * @brief returns the id of a string in the string table of binary traces
+ * @details @b #include <tinyara/ttrace.h> \n
+ * The string is copied (truncated to TTRACE_MSG_BYTES - 1 characters) the
+ * first time it is seen.
+ * @param[in] str string to look up
+ * @return the id of the string, or 0 if the string table is full
+ * @since TizenRT v3.0
+ */
+uint16_t ttrace_intern(FAR const char *str);
+
+#define trace_event(tag, type, arg0, arg1) \
+	ttrace_event(tag, type, (uint32_t)(uintptr_t)(arg0), (uint32_t)(uintptr_t)(arg1))
+#else
+#define trace_event(tag, type, arg0, arg1)
+#endif
 #else
 #define trace_begin(a, b, ...)
 #define trace_begin_uid(a, b)
 #define trace_end(a)
 #define trace_end_uid(a)
 #define trace_sched(a, b)
+#define trace_event(tag, type, arg0, arg1)
 
 #if defined(__cplusplus)
 }
@@ -144,15 +144,18 @@ typedef CODE void (*wdentry_t)(int argc, uint32_t arg1, ...);
  */
 
 struct wdog_s {
-	FAR struct wdog_s *next;	/* Support for singly linked lists. */
+	FAR struct wdog_s *next;	/* Free list link, or next sibling in the active heap */
 	wdentry_t func;				/* Function to execute when delay expires */
 #ifdef CONFIG_PIC
 	FAR void *picbase;			/* PIC base address */
 #endif
-	int lag;					/* Timer associated with the delay */
+	clock_t expire;				/* Watchdog time at which the delay expires */
 	uint8_t flags;				/* See WDOGF_* definitions above */
 	uint8_t argc;				/* The number of parameters to pass */
 	uint32_t parm[CONFIG_MAX_WDOGPARMS];
+	FAR struct wdog_s *child;	/* First child in the active heap */
+	FAR struct wdog_s *prev;	/* Previous sibling, or parent of a first child */
+	uint32_t seq;				/* Insertion order, breaks ties on expire */
 };
 
 /* Watchdog 'handle' */
@@ -263,6 +263,26 @@
 
 #endif							/* CONFIG_SCHED_USRWORK && !__KERNEL__ */
 
+/* Priority classes of work.  Ready work of a class is performed before the
+ * ready work of the classes that follow it.  work_queue() uses
+ * WORK_CLASS_NORMAL; long running work such as flash I/O should use
+ * WORK_CLASS_BULK with work_queue_class().  When a queue has several worker
+ * threads, one of them is always kept away from bulk work so that it does
+ * not delay the other classes.
+ */
+
+#define WORK_CLASS_URGENT  0	/* Time critical work, e.g. timer callbacks */
+#define WORK_CLASS_NORMAL  1	/* Default class */
+#define WORK_CLASS_BULK    2	/* Long running work */
+#define WORK_NCLASSES      3
+
+/* Number of buckets of the latency histograms.  Bucket 0 counts the work
+ * started in the tick it was due, bucket n > 0 the work started 2^(n-1) to
+ * 2^n - 1 ticks late and the last bucket all of the work started later.
+ */
+
+#define WORK_LATENCY_BUCKETS 10
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -284,8 +304,19 @@ struct work_s {
 	FAR void *arg;				/* Callback argument */
 	clock_t qtime;			/* Time work queued */
 	clock_t delay;			/* Delay until work performed */
+	FAR struct dq_queue_s *list;	/* List holding the work, NULL if not queued */
+	uint8_t wclass;			/* Priority class, see WORK_CLASS_* */
 };
 
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+/* Latency statistics of one work queue, see work_getstats() */
+
+struct work_stats_s {
+	clock_t maxlatency[WORK_NCLASSES];	/* Worst latency in clock ticks */
+	uint32_t latency[WORK_NCLASSES][WORK_LATENCY_BUCKETS];	/* Histograms */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -389,6 +420,28 @@ int work_lpstart(void);
 
 int work_queue(int qid, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay);
 
+/****************************************************************************
+ * Name: work_queue_class
+ *
+ * Description:
+ *   Queue work like work_queue() in a given priority class.
+ *
+ * Input parameters:
+ *   qid    - The work queue ID
+ *   work   - The work structure to queue
+ *   worker - The worker callback to be invoked.
+ *   arg    - The argument that will be passed to the worker callback.
+ *   delay  - Delay (in clock ticks) from the time queue until the worker
+ *            is invoked. Zero means to perform the work immediately.
+ *   wclass - The priority class of the work, one of WORK_CLASS_*
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno on failure
+ *
+ ****************************************************************************/
+
+int work_queue_class(int qid, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay, uint8_t wclass);
+
 /****************************************************************************
  * Name: work_cancel
  *
@@ -488,6 +541,26 @@ void lpwork_boostpriority(uint8_t reqprio);
 void lpwork_restorepriority(uint8_t reqprio);
 #endif
 
+/****************************************************************************
+ * Name: work_getstats
+ *
+ * Description:
+ *   Return the latency statistics of a kernel work queue.  The latency of
+ *   work is the time from when it is due until its worker is called.
+ *
+ * Input parameters:
+ *   qid   - The work queue ID, HPWORK or LPWORK
+ *   stats - Location to return the statistics
+ *
+ * Returned Value:
+ *   Zero on success, -EINVAL if qid is not a kernel work queue
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_SCHED_WORKQUEUE_STATS) && (!defined(CONFIG_SCHED_USRWORK) || defined(__KERNEL__))
+int work_getstats(int qid, FAR struct work_stats_s *stats);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -54,6 +54,11 @@
 #define CHECKSUM_SIZE              4
 #define CRC_BUFFER_SIZE            512
 
+/* Header verification threads of the loading thread */
+#define VERIFYTHD_NAME             "bm_verifier"               /* Verification thread name */
+#define VERIFYTHD_STACKSIZE        2048                        /* Verification thread stack size */
+#define VERIFYTHD_PRIORITY         LOADINGTHD_PRIORITY         /* Verification thread priority */
+
 /* The number of arguments for loading thread */
 #define LOADTHD_ARGC               2
 
@@ -94,6 +99,9 @@ struct binmgr_bininfo_s {
 	char bin_ver[BIN_VER_MAX];
 	char kernel_ver[KERNEL_VER_MAX];
 	sq_queue_t cb_list; // list node type : statecb_node_t
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+	binmgr_loadtime_t loadtime;
+#endif
 };
 typedef struct binmgr_bininfo_s binmgr_bininfo_t;
 
@@ -114,6 +122,9 @@ binmgr_bininfo_t *binary_manager_get_binary_data(uint32_t bin_idx);
 #define BIN_VER(bin_idx)                                binary_manager_get_binary_data(bin_idx)->bin_ver
 #define BIN_KERNEL_VER(bin_idx)                         binary_manager_get_binary_data(bin_idx)->kernel_ver
 #define BIN_CBLIST(bin_idx)                             binary_manager_get_binary_data(bin_idx)->cb_list
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+#define BIN_LOADTIME(bin_idx)                           binary_manager_get_binary_data(bin_idx)->loadtime
+#endif
 
 #define BIN_LOAD_ATTR(bin_idx)                          binary_manager_get_binary_data(bin_idx)->load_attr
 #define BIN_NAME(bin_idx)                               binary_manager_get_binary_data(bin_idx)->load_attr.bin_name
@@ -158,6 +169,7 @@ int binary_manager_load_binary(int bin_idx);
 int binary_manager_loading(char *loading_data[]);
 uint32_t binary_manager_get_binary_count(void);
 int binary_manager_get_index_with_binid(int bin_id);
+int binary_manager_get_index_with_name(char *bin_name);
 void binary_manager_get_info_with_name(int request_pid, char *bin_name);
 void binary_manager_get_info_all(int request_pid);
 
@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#include <tinyara/irq.h>
 #include <tinyara/binary_manager.h>
 
 #include "binary_manager.h"
@@ -156,3 +157,23 @@ void binary_manager_get_info_all(int requester_pid)
 
 	binary_manager_send_response(q_name, &response_msg, sizeof(binmgr_getinfo_all_response_t));
 }
+
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+/* Get the load time of a user binary with index in binary table */
+int binary_manager_get_loadtime(int bin_idx, FAR char *bin_name, FAR binmgr_loadtime_t *loadtime)
+{
+	irqstate_t flags;
+
+	if (bin_idx <= 0 || bin_idx > binary_manager_get_binary_count()) {
+		return -ENOENT;
+	}
+
+	/* Binaries may be loading, take a consistent snapshot */
+	flags = irqsave();
+	strncpy(bin_name, BIN_NAME(bin_idx), BIN_NAME_MAX);
+	*loadtime = BIN_LOADTIME(bin_idx);
+	irqrestore(flags);
+
+	return OK;
+}
+#endif
@@ -30,11 +30,20 @@
 #include <sched.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdbool.h>
+#include <semaphore.h>
+#include <assert.h>
 #include <sys/types.h>
 
 #include <tinyara/mm/mm.h>
 #include <tinyara/sched.h>
 #include <tinyara/init.h>
+#include <tinyara/kmalloc.h>
+#include <tinyara/kthread.h>
+#include <tinyara/semaphore.h>
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+#include <tinyara/clock.h>
+#endif
 
 #include "task/task.h"
 #include "binary_manager.h"
@@ -57,6 +66,40 @@ struct binary_header_s {
 } __attribute__((__packed__));
 typedef struct binary_header_s binary_header_t;
 
+/* Headers of the partitions of a binary, valid_bin_count of them being valid */
+struct binmgr_verify_s {
+	binary_header_t header_data[PARTS_PER_BIN];
+	int latest_idx;
+	int valid_bin_count;
+};
+typedef struct binmgr_verify_s binmgr_verify_t;
+
+/* Loading of all binaries: one job per binary, in load order */
+struct binmgr_loadall_s {
+	int count;
+	int order[BINARY_COUNT];
+	struct {
+		binmgr_verify_t verify;
+		int result;
+#if CONFIG_BINMGR_LOAD_NVERIFIERS > 0
+		sem_t done;
+#endif
+	} job[BINARY_COUNT];
+#if CONFIG_BINMGR_LOAD_NVERIFIERS > 0
+	int next;                    /* Next job to verify, taken under sched_lock() */
+	sem_t exited;                /* Posted by each verification thread when it exits */
+#endif
+};
+typedef struct binmgr_loadall_s binmgr_loadall_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+#if CONFIG_BINMGR_LOAD_NVERIFIERS > 0
+/* The loading of all binaries in progress, shared with the verification threads */
+static binmgr_loadall_t *g_loadall;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -162,58 +205,64 @@ static int binary_manager_check_update_binary(char *bin_name)
 	return BINMGR_ALREADY_UPDATED;
 }
 
-/* Load binary with index in binary table */
-int binary_manager_load_binary(int bin_idx)
+/* Read and verify the headers of the partitions of a binary */
+static int binary_manager_verify_binary(int bin_idx, binmgr_verify_t *verify)
 {
 	int ret;
-	pid_t bin_pid;
 	int version;
 	int part_idx;
 	int latest_ver;
-	int latest_idx;
-	int retry_count;
-	int valid_bin_count;
-	load_attr_t load_attr;
-	char devname[BINMGR_DEVNAME_LEN];
-	binary_header_t header_data[PARTS_PER_BIN];
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+	clock_t start = clock_systimer();
+#endif
 
 	latest_ver = -1;
-	latest_idx = -1;
-	valid_bin_count = 0;
-
-	if (bin_idx < 0) {
-		bmdbg("Invalid bin idx %d\n", bin_idx);
-		return ERROR;
-	}
-
-	/* Check binary state */
-	if (BIN_STATE(bin_idx) != BINARY_INACTIVE) {
-		bmdbg("Invalid binary state %d\n", BIN_STATE(bin_idx));
-		return ERROR;
-	}
+	verify->latest_idx = -1;
+	verify->valid_bin_count = 0;
 
 	/* Read header data of binary partitions */
 	for (part_idx = 0; part_idx < PARTS_PER_BIN; part_idx++) {
 		if (BIN_PARTNUM(bin_idx, part_idx) < 0) {
 			continue;
 		}
-		ret = binary_manager_read_header(bin_idx, part_idx, &header_data[part_idx]);
+		ret = binary_manager_read_header(bin_idx, part_idx, &verify->header_data[part_idx]);
 		if (ret == OK) {
-			valid_bin_count++;
-			version = (int)atoi(header_data[part_idx].bin_ver);
+			verify->valid_bin_count++;
+			version = (int)atoi(verify->header_data[part_idx].bin_ver);
 			bmvdbg("Found valid header in part %d, version %d\n", part_idx, version);
 			if (version > latest_ver) {
 				latest_ver = version;
-				latest_idx = part_idx;
+				verify->latest_idx = part_idx;
 			}
 		}
 	}
 
-	if (valid_bin_count == 0) {
+#ifdef CONFIG_BINMGR_LOAD_PROFILE
+	BIN_LOADTIME(bin_idx).header = clock_systimer() - start;
+#endif
+
+	if (verify->valid_bin_count == 0) {
 		bmdbg("Failed to find valid header of binary %s\n", BIN_NAME(bin_idx));
 		return ERROR;
 	}
 
+	return OK;
+}
+
+/* Load a binary whose headers were verified, the latest version first */
+static int binary_manager_load_verified(int bin_idx, binmgr_verify_t *verify)
+{
+	int ret;
+	int latest_idx;
+	int retry_count;
+	int valid_bin_count;
+	load_attr_t load_attr;
+	char devname[BINMGR_DEVNAME_LEN];
+	binary_header_t *header_data = verify->header_data;
+
+	latest_idx = verify->latest_idx;
+	valid_bin_count = verify->valid_bin_count;
+
 	/* Load binary */
 	do {
 		strncpy(load_attr.bin_name, header_data[latest_idx].bin_name, BIN_NAME_MAX);
@@ -258,23 +307,187 @@ int binary_manager_load_binary(int bin_idx)
 	return ERROR;
 }
 
-static int binary_manager_load_all(void)
+/* Load binary with index in binary table */
+int binary_manager_load_binary(int bin_idx)
 {
 	int ret;
+	binmgr_verify_t verify;
+
+	if (bin_idx < 0) {
+		bmdbg("Invalid bin idx %d\n", bin_idx);
+		return ERROR;
+	}
+
+	/* Check binary state */
+	if (BIN_STATE(bin_idx) != BINARY_INACTIVE) {
+		bmdbg("Invalid binary state %d\n", BIN_STATE(bin_idx));
+		return ERROR;
+	}
+
+	ret = binary_manager_verify_binary(bin_idx, &verify);
+	if (ret != OK) {
+		return ERROR;
+	}
+
+	return binary_manager_load_verified(bin_idx, &verify);
+}
+
+/* Fill 'order' with the inactive binaries, those of CONFIG_BINMGR_LOAD_ORDER first */
+static int binary_manager_load_order(int *order)
+{
 	int bin_idx;
-	int load_cnt;
+	int count;
 	uint32_t bin_count;
+	char *name;
+	char *saveptr;
+	bool queued[BINARY_COUNT];
+	char names[] = CONFIG_BINMGR_LOAD_ORDER;
 
-	load_cnt = 0;
+	count = 0;
 	bin_count = binary_manager_get_binary_count();
+	memset(queued, 0, sizeof(queued));
+
+	for (name = strtok_r(names, " ,", &saveptr); name != NULL; name = strtok_r(NULL, " ,", &saveptr)) {
+		bin_idx = binary_manager_get_index_with_name(name);
+		if (bin_idx < 0) {
+			bmdbg("binary %s in load order is not registered\n", name);
+			continue;
+		}
+		if (!queued[bin_idx] && BIN_STATE(bin_idx) == BINARY_INACTIVE) {
+			queued[bin_idx] = true;
+			order[count++] = bin_idx;
+		}
+	}
 
 	for (bin_idx = 1; bin_idx <= bin_count; bin_idx++) {
-		ret = binary_manager_load_binary(bin_idx);
+		if (!queued[bin_idx] && BIN_STATE(bin_idx) == BINARY_INACTIVE) {
+			queued[bin_idx] = true;
+			order[count++] = bin_idx;
+		}
+	}
+
+	return count;
+}
+
+#if CONFIG_BINMGR_LOAD_NVERIFIERS > 0
+/* Take the next binary to verify in load order, -1 if there is none */
+static int binary_manager_take_verify(binmgr_loadall_t *loadall)
+{
+	int job = -1;
+
+	sched_lock();
+	if (loadall->next < loadall->count) {
+		job = loadall->next++;
+	}
+	sched_unlock();
+
+	return job;
+}
+
+/* Verification thread: verify binaries ahead of the loading thread */
+static int verifying_thread(int argc, char *argv[])
+{
+	int job;
+	binmgr_loadall_t *loadall = g_loadall;
+
+	while ((job = binary_manager_take_verify(loadall)) >= 0) {
+		loadall->job[job].result = binary_manager_verify_binary(loadall->order[job], &loadall->job[job].verify);
+		sem_post(&loadall->job[job].done);
+	}
+
+	sem_post(&loadall->exited);
+	return OK;
+}
+#endif
+
+static int binary_manager_load_all(void)
+{
+	int ret;
+	int job;
+	int load_cnt;
+	binmgr_loadall_t *loadall;
+#if CONFIG_BINMGR_LOAD_NVERIFIERS > 0
+	int nthreads;
+	bool mine;
+#endif
+
+	load_cnt = 0;
+
+	loadall = (binmgr_loadall_t *)kmm_zalloc(sizeof(binmgr_loadall_t));
+	if (loadall == NULL) {
+		bmdbg("Failed to allocate loading data\n");
+		return BINMGR_OUT_OF_MEMORY;
+	}
+
+	loadall->count = binary_manager_load_order(loadall->order);
+
+#if CONFIG_BINMGR_LOAD_NVERIFIERS > 0
+	/* Start the verification threads.  They take the binaries to verify in
+	 * load order, and so does this thread when none has taken the next
+	 * binary to load yet.
+	 */
+	for (job = 0; job < loadall->count; job++) {
+		sem_init(&loadall->job[job].done, 0, 0);
+		sem_setprotocol(&loadall->job[job].done, SEM_PRIO_NONE);
+	}
+	sem_init(&loadall->exited, 0, 0);
+	sem_setprotocol(&loadall->exited, SEM_PRIO_NONE);
+
+	g_loadall = loadall;
+	for (nthreads = 0; nthreads < CONFIG_BINMGR_LOAD_NVERIFIERS && nthreads < loadall->count - 1; nthreads++) {
+		ret = kernel_thread(VERIFYTHD_NAME, VERIFYTHD_PRIORITY, VERIFYTHD_STACKSIZE, verifying_thread, NULL);
+		if (ret < 0) {
+			bmdbg("Failed to start verification thread, errno %d\n", errno);
+			break;
+		}
+	}
+#endif
+
+	for (job = 0; job < loadall->count; job++) {
+#if CONFIG_BINMGR_LOAD_NVERIFIERS > 0
+		sched_lock();
+		mine = (loadall->next == job);
+		if (mine) {
+			loadall->next++;
+		}
+		sched_unlock();
+
+		if (mine) {
+			loadall->job[job].result = binary_manager_verify_binary(loadall->order[job], &loadall->job[job].verify);
+		} else {
+			while (sem_wait(&loadall->job[job].done) < 0) {
+				DEBUGASSERT(get_errno() == EINTR);
+			}
+		}
+#else
+		loadall->job[job].result = binary_manager_verify_binary(loadall->order[job], &loadall->job[job].verify);
+#endif
+		if (loadall->job[job].result != OK) {
+			continue;
+		}
+
+		ret = binary_manager_load_verified(loadall->order[job], &loadall->job[job].verify);
 		if (ret == OK) {
 			load_cnt++;
 		}
 	}
 
+#if CONFIG_BINMGR_LOAD_NVERIFIERS > 0
+	/* Wait for the verification threads to stop using the loading data */
+	while (nthreads-- > 0) {
+		while (sem_wait(&loadall->exited) < 0) {
+			DEBUGASSERT(get_errno() == EINTR);
+		}
+	}
+	g_loadall = NULL;
+
+	for (job = 0; job < loadall->count; job++) {
+		sem_destroy(&loadall->job[job].done);
+	}
+	sem_destroy(&loadall->exited);
+#endif
+	kmm_free(loadall);
+
 	if (load_cnt > 0) {
 		return load_cnt;
 	}
@@ -108,7 +108,7 @@ static void recovery_exclude_scheduling_each(FAR struct tcb_s *tcb, FAR void *ar
 
 		flags = irqsave();
 		/* Remove the TCB from the task list associated with the state */
-		dq_rem((FAR dq_entry_t *)tcb, (dq_queue_t *)g_tasklisttable[tcb->task_state].list);
+		sched_removeprioritized(tcb, (dq_queue_t *)g_tasklisttable[tcb->task_state].list);
 		sched_addblocked(tcb, TSTATE_TASK_INACTIVE);
 		irqrestore(flags);
 		bmllvdbg("Remove pid %d from task list\n", tcb->pid);
@@ -59,6 +59,7 @@
 #include <debug.h>
 #include <tinyara/arch.h>
 #include <tinyara/irq.h>
+#include <tinyara/ttrace.h>
 
 #include "irq/irq.h"
 
@@ -128,5 +129,7 @@ void irq_dispatch(int irq, FAR void *context)
 
 	/* Then dispatch to the interrupt handler */
 
+	trace_event(TTRACE_TAG_IRQ, TTRACE_EVENT_IRQ_ENTER, irq, 0);
 	vector(irq, context, arg);
+	trace_event(TTRACE_TAG_IRQ, TTRACE_EVENT_IRQ_LEAVE, irq, 0);
 }
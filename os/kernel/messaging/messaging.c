@@ -56,45 +56,57 @@
 
 #include <tinyara/config.h>
 
+#include <stdint.h>
+#include <stdbool.h>
 #include <debug.h>
 #include <errno.h>
+#include <sched.h>
 #include <string.h>
-#include <queue.h>
 #include <semaphore.h>
+#include <unistd.h>
 #include <tinyara/kmalloc.h>
 #include <tinyara/mm/mm.h>
+#include <messaging/messaging.h>
+
+#include "messaging/message_ctrl.h"
 
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
-#define MSG_SENDER_UNDEFINED (-1)
 
 #define MSG_MAX_PORT_NAME 64
 
-#define MSG_RECV_EXIST   0
-#define MSG_RECV_NOEXIST 1
+/* Number of buckets of the port table, a power of two */
+
+#define MSG_PORT_NBUCKETS 16
 
 /****************************************************************************
  * Private Type Declarations
  ****************************************************************************/
-struct msg_port_node_s {
-	struct msg_port_node_s *flink;
-	char port_name[MSG_MAX_PORT_NAME];
-	pid_t sender_pid;
+
+/* The receivers of a port, sorted by decreasing priority.  A set is never
+ * modified once published: a registration replaces it with a new one.
+ */
+
+struct msg_recv_set_s {
 	int nreceiver;
-	sem_t port_sem;
-	sq_queue_t recv_node_list;
+	struct {
+		pid_t pid;
+		int prio;
+	} recv[1];
 };
-typedef struct msg_port_node_s msg_port_node_t;
+typedef struct msg_recv_set_s msg_recv_set_t;
 
-struct msg_recv_node_s {
-	struct msg_recv_node_s *flink;
-	pid_t pid;
-	int prio;
-};
-typedef struct msg_recv_node_s msg_recv_node_t;
+#define SIZEOF_MSG_RECV_SET(n) \
+	(sizeof(msg_recv_set_t) + ((n) - 1) * sizeof(((msg_recv_set_t *)0)->recv[0]))
 
-static sem_t port_list_sem;
+struct msg_port_node_s {
+	struct msg_port_node_s *flink;	/* Next port of the bucket */
+	uint32_t hash;				/* Hash of the port name */
+	msg_recv_set_t *recvs;		/* Current receivers, never empty */
+	char port_name[1];			/* The port name, allocated with the node */
+};
+typedef struct msg_port_node_s msg_port_node_t;
 
 /****************************************************************************
  * Public Variables
@@ -103,69 +115,118 @@ static sem_t port_list_sem;
 /****************************************************************************
  * Private Variables
  ****************************************************************************/
-static sq_queue_t g_port_node_list;
-static int curr_recv_cnt;;
+
+/* The ports, hashed by name.  The senders look them up with the scheduler
+ * locked and never wait.  The registrations are serialized by
+ * port_list_sem; they prepare the new nodes and receiver sets first, then
+ * publish them with the scheduler locked.  Since no reader can be in the
+ * middle of a lookup at that time, what they replace is freed at once.
+ */
+
+static msg_port_node_t *g_port_table[MSG_PORT_NBUCKETS];
+static sem_t port_list_sem;
+
+/* Number of receivers already returned by a multi-part read */
+
+static int curr_recv_cnt;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
-static int messaging_append_receiver(pid_t pid, int prio, sq_queue_t *queue)
+
+static uint32_t messaging_hash(const char *port_name)
 {
-	msg_recv_node_t *recv_node;
-	msg_recv_node_t *prev_node;
-	msg_recv_node_t *next_node;
-	recv_node = (msg_recv_node_t *)kmm_malloc(sizeof(msg_recv_node_t));
-	if (recv_node == NULL) {
-		msgdbg("[Messaging] fail to save receiver info : out of memory.\n");
-		return ERROR;
-	}
-	recv_node->pid = pid;
-	recv_node->prio = prio;
-
-	/* Append recv node by decreasing order. */
-	next_node = (msg_recv_node_t *)sq_peek(queue);
-	prev_node = next_node;
-	if (next_node == NULL) {
-		/* The queue is empty, so add new recv node. */
-		sq_addlast((FAR sq_entry_t *)recv_node, queue);
-		return OK;
+	uint32_t hash = 2166136261u;
+
+	while (*port_name != '\0') {
+		hash = (hash ^ (uint8_t)*port_name++) * 16777619u;
 	}
 
-	while (next_node != NULL) {
-		if (next_node->prio > recv_node->prio) {
-			prev_node = next_node;
-			next_node = (msg_recv_node_t *)sq_next(next_node);
-			continue;
+	return hash;
+}
+
+/****************************************************************************
+ * Name: messaging_find_port
+ *
+ * Description:
+ *   Look up a port.  The caller holds port_list_sem or the scheduler lock.
+ *
+ ****************************************************************************/
+
+static msg_port_node_t *messaging_find_port(const char *port_name, uint32_t hash, msg_port_node_t ***prev)
+{
+	msg_port_node_t **link = &g_port_table[hash & (MSG_PORT_NBUCKETS - 1)];
+	msg_port_node_t *port_node;
+
+	for (port_node = *link; port_node != NULL; link = &port_node->flink, port_node = *link) {
+		if (port_node->hash == hash && strncmp(port_node->port_name, port_name, MSG_MAX_PORT_NAME) == 0) {
+			break;
 		}
-		break;
 	}
 
-	if (next_node == prev_node) {
-		/* In case recv_node's priority higher than queue->head */
-		sq_addfirst((FAR sq_entry_t *)recv_node, (FAR sq_queue_t *)queue);
-	} else if (next_node == NULL) {
-		/* In case recv_node's priority lower than queue->tail */
-		sq_addlast((FAR sq_entry_t *)recv_node, (FAR sq_queue_t *)queue);
-	} else {
-		/* In case recv_node's priority higher than prev_node and lower than next_node */
-		sq_addafter((FAR sq_entry_t *)prev_node, (FAR sq_entry_t *)recv_node, (FAR sq_queue_t *)queue);
+	if (prev != NULL) {
+		*prev = link;
 	}
 
-	return OK;
+	return port_node;
 }
 
-static int messaging_check_recv_exist(int recv_pid, sq_queue_t *queue)
+static int messaging_find_recv(msg_recv_set_t *recvs, pid_t pid)
 {
-	msg_recv_node_t *recv_node;
-	recv_node = (msg_recv_node_t *)sq_peek(queue);
-	while (recv_node != NULL) {
-		if (recv_node->pid == recv_pid) {
-			return MSG_RECV_EXIST;
+	int idx;
+
+	if (recvs != NULL) {
+		for (idx = 0; idx < recvs->nreceiver; idx++) {
+			if (recvs->recv[idx].pid == pid) {
+				return idx;
+			}
 		}
-		recv_node = (msg_recv_node_t *)sq_next(recv_node);
 	}
 
-	return MSG_RECV_NOEXIST;
+	return ERROR;
 }
+
+/****************************************************************************
+ * Name: messaging_add_recv
+ *
+ * Description:
+ *   Return a copy of a receiver set with one more receiver, placed before
+ *   the receivers of the same priority.
+ *
+ ****************************************************************************/
+
+static msg_recv_set_t *messaging_add_recv(msg_recv_set_t *recvs, pid_t pid, int prio)
+{
+	msg_recv_set_t *new_recvs;
+	int nreceiver = recvs ? recvs->nreceiver : 0;
+	int src;
+	int dst = 0;
+	bool added = false;
+
+	new_recvs = (msg_recv_set_t *)kmm_malloc(SIZEOF_MSG_RECV_SET(nreceiver + 1));
+	if (new_recvs == NULL) {
+		msgdbg("[Messaging] fail to save receiver info : out of memory.\n");
+		return NULL;
+	}
+
+	for (src = 0; src < nreceiver; src++) {
+		if (!added && recvs->recv[src].prio <= prio) {
+			new_recvs->recv[dst].pid = pid;
+			new_recvs->recv[dst++].prio = prio;
+			added = true;
+		}
+		new_recvs->recv[dst++] = recvs->recv[src];
+	}
+
+	if (!added) {
+		new_recvs->recv[dst].pid = pid;
+		new_recvs->recv[dst++].prio = prio;
+	}
+
+	new_recvs->nreceiver = dst;
+	return new_recvs;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -189,149 +250,118 @@ static int messaging_check_recv_exist(int recv_pid, sq_queue_t *queue)
  ****************************************************************************/
 int messaging_save_receiver(char *port_name, pid_t recv_pid, int recv_prio)
 {
-	int ret;
+	uint32_t hash = messaging_hash(port_name);
 	msg_port_node_t *port_node;
+	msg_port_node_t **link;
+	msg_recv_set_t *old_recvs;
+	msg_recv_set_t *new_recvs;
+	size_t namelen;
 
-	port_node = (msg_port_node_t *)sq_peek(&g_port_node_list);
-	while (port_node != NULL) {
-		if (strncmp(port_node->port_name, port_name, strlen(port_name) + 1) == 0) {
-			ret = messaging_check_recv_exist(recv_pid, &port_node->recv_node_list);
-			if (ret == MSG_RECV_EXIST) {
-				return OK;
-			}
-			port_node->nreceiver++;
-			/* There was already same port node in the list, append recv node to this list. */
-			sem_wait(&port_node->port_sem);
-			ret = messaging_append_receiver(recv_pid, recv_prio, &port_node->recv_node_list);
-			sem_post(&port_node->port_sem);
-			return ret;
-		}
-		port_node = (msg_port_node_t *)sq_next(port_node);
+	while (sem_wait(&port_list_sem) != OK) {
 	}
 
-	/* Create new port node which has this port name */
-	port_node = (msg_port_node_t *)kmm_malloc(sizeof(msg_port_node_t));
-	if (port_node == NULL) {
-		msgdbg("[Messaging] fail to save receiver info : out of memory.\n");
+	port_node = messaging_find_port(port_name, hash, &link);
+	old_recvs = port_node ? port_node->recvs : NULL;
+	if (messaging_find_recv(old_recvs, recv_pid) >= 0) {
+		sem_post(&port_list_sem);
+		return OK;
+	}
+
+	new_recvs = messaging_add_recv(old_recvs, recv_pid, recv_prio);
+	if (new_recvs == NULL) {
+		sem_post(&port_list_sem);
 		return ERROR;
 	}
 
-	/* Fill the port node information except sender_pid. */
-	strncpy(port_node->port_name, port_name, strlen(port_name) + 1);
-	port_node->sender_pid = MSG_SENDER_UNDEFINED;
-	port_node->nreceiver = 1;
-	sem_init(&port_node->port_sem, 0, 1);
-	sq_init(&port_node->recv_node_list);
-	sem_wait(&port_list_sem);
-	sq_addlast((FAR sq_entry_t *)port_node, &g_port_node_list);
-	sem_post(&port_list_sem);
+	if (port_node == NULL) {
+		/* Create new port node which has this port name */
+		namelen = strnlen(port_name, MSG_MAX_PORT_NAME - 1);
+		port_node = (msg_port_node_t *)kmm_malloc(sizeof(msg_port_node_t) + namelen);
+		if (port_node == NULL) {
+			msgdbg("[Messaging] fail to save receiver info : out of memory.\n");
+			kmm_free(new_recvs);
+			sem_post(&port_list_sem);
+			return ERROR;
+		}
 
-	/* Append recv node to new created port node. */
-	sem_wait(&port_node->port_sem);
-	ret = messaging_append_receiver(recv_pid, recv_prio, &port_node->recv_node_list);
-	sem_post(&port_node->port_sem);
+		memcpy(port_node->port_name, port_name, namelen);
+		port_node->port_name[namelen] = '\0';
+		port_node->hash = hash;
+		port_node->recvs = new_recvs;
+		port_node->flink = NULL;
 
-	return ret;
+		sched_lock();
+		*link = port_node;
+		sched_unlock();
+	} else {
+		sched_lock();
+		port_node->recvs = new_recvs;
+		sched_unlock();
+		kmm_free(old_recvs);
+	}
+
+	sem_post(&port_list_sem);
+	return OK;
 }
 
 /****************************************************************************
  * Name: messaging_read_list
  *
  * Description:
- *   Check that how many receivers are waiting in the list.
+ *   Read the receivers who wait on a port, CONFIG_MESSAGING_RECV_LIST_SIZE
+ *   at most at a time.  A port with more receivers is read by successive
+ *   calls.  This never waits for a registration in progress.
  *
  * Parameters:
  *   port_name - A message port name
+ *   recv_arr  - The pids of the receivers read
+ *   recv_cnt  - The number of receivers read
  *
  * Return Value:
- *   Return the number of receivers who wait the port on success.
- *   Return ERROR on failure.
+ *   MSG_READ_ALL if the last receivers were read, MSG_READ_YET if there are
+ *   more, ERROR if there is no receiver.
  *
  * Assumptions:
  *
  ****************************************************************************/
-int messaging_read_list(char *port_name, int *recv_arr, int *total_cnt)
+int messaging_read_list(char *port_name, int *recv_arr, int *recv_cnt)
 {
-	int recv_idx;
 	msg_port_node_t *port_node;
-	msg_recv_node_t *recv_node;
-	int recv_cnt;
-
-	port_node = (msg_port_node_t *)sq_peek(&g_port_node_list);
-	while (port_node != NULL) {
-		if (strncmp(port_node->port_name, port_name, strlen(port_name) + 1) == 0) {
-			if (port_node->nreceiver > 0) {
-				*total_cnt = port_node->nreceiver;
-
-				recv_node = (msg_recv_node_t *)sq_peek(&port_node->recv_node_list);
-				if (recv_node == NULL) {
-					curr_recv_cnt = 0;
-					msgdbg("[Messaging] fail to read receivers list.\n");
-					return ERROR;
-				}
-
-				/* Ignore already read information. */
-				for (recv_idx = 0; recv_idx < curr_recv_cnt; recv_idx++) {
-					recv_node = (msg_recv_node_t *)sq_next(recv_node);
-				}
-
-				/* Read receivers' information. */
-				for (recv_idx = 0; recv_idx < CONFIG_MESSAGING_RECV_LIST_SIZE; recv_idx++) {
-					recv_arr[recv_idx] = recv_node->pid;
-					curr_recv_cnt++;
-					recv_node = (msg_recv_node_t *)sq_next(recv_node);
-					if (recv_node == NULL) {
-						recv_cnt = curr_recv_cnt;
-						curr_recv_cnt = 0;
-						return recv_cnt;
-					}
-				}
-			}
-			return curr_recv_cnt;
-		}
-		port_node = (msg_port_node_t *)sq_next(port_node);
+	msg_recv_set_t *recvs;
+	int recv_idx;
+	int ret = MSG_READ_ALL;
+
+	sched_lock();
+
+	port_node = messaging_find_port(port_name, messaging_hash(port_name), NULL);
+	if (port_node == NULL) {
+		curr_recv_cnt = 0;
+		sched_unlock();
+		return ERROR;
 	}
 
-	return ERROR;
-}
+	/* Read receivers' information, ignoring already read information. */
+	recvs = port_node->recvs;
+	for (recv_idx = 0; recv_idx < CONFIG_MESSAGING_RECV_LIST_SIZE && curr_recv_cnt < recvs->nreceiver; recv_idx++) {
+		recv_arr[recv_idx] = recvs->recv[curr_recv_cnt++].pid;
+	}
 
-/****************************************************************************
- * Name: messaging_remove_recv_node
- *
- * Description:
- *   Remove the recv_node which this task made
- *
- * Parameters:
- *   recv_node_list - A list which appended to port_node
- *
- * Return Value:
- *   OK on success, ERROR on failure.
- *
- * Assumptions:
- *
- ****************************************************************************/
-static int messaging_remove_recv_node(sq_queue_t *recv_node_list)
-{
-	msg_recv_node_t *recv_node;
-	pid_t my_pid = getpid();
-
-	recv_node = (msg_recv_node_t *)sq_peek(recv_node_list);
-	while (recv_node != NULL) {
-		if (recv_node->pid == my_pid) {
-			sq_rem((sq_entry_t *)recv_node, recv_node_list);
-			kmm_free(recv_node);
-			return OK;
-		}
-		recv_node = (msg_recv_node_t *)sq_next(recv_node);
+	*recv_cnt = recv_idx;
+	if (curr_recv_cnt < recvs->nreceiver) {
+		ret = MSG_READ_YET;
+	} else {
+		curr_recv_cnt = 0;
 	}
-	return ERROR;
+
+	sched_unlock();
+	return ret;
 }
 
 /****************************************************************************
  * Name: messaging_remove_list
  *
  * Description:
- *   Remove the receivers' list
+ *   Remove the receiver of the calling task from a port
  *
  * Parameters:
  *   port_name - A message port name
@@ -344,37 +374,57 @@ static int messaging_remove_recv_node(sq_queue_t *recv_node_list)
  ****************************************************************************/
 int messaging_remove_list(char *port_name)
 {
-	int ret = ERROR;
 	msg_port_node_t *port_node;
+	msg_port_node_t **link;
+	msg_recv_set_t *old_recvs;
+	msg_recv_set_t *new_recvs = NULL;
+	int ret = OK;
+	int idx;
 
-	port_node = (msg_port_node_t *)sq_peek(&g_port_node_list);
-	while (port_node != NULL) {
-		if (strncmp(port_node->port_name, port_name, strlen(port_name) + 1) == 0) {
-			/* Remove the whole recv node which attached to this port node. */
-			sem_wait(&port_node->port_sem);
-			ret = messaging_remove_recv_node(&port_node->recv_node_list);
-			if (ret == OK) {
-				port_node->nreceiver--;
-			}
-			sem_post(&port_node->port_sem);
+	while (sem_wait(&port_list_sem) != OK) {
+	}
 
-			if (port_node->nreceiver == 0) {
-				sem_wait(&port_list_sem);
-				(void)sq_rem((FAR sq_entry_t *)port_node, &g_port_node_list);
-				sem_post(&port_list_sem);
-				kmm_free(port_node);
-			}
-			ret = OK;
-			break;
+	/* If there is no information for removing, there is nothing to do. */
+	port_node = messaging_find_port(port_name, messaging_hash(port_name), &link);
+	if (port_node == NULL) {
+		goto out;
+	}
+
+	old_recvs = port_node->recvs;
+	idx = messaging_find_recv(old_recvs, getpid());
+	if (idx < 0) {
+		goto out;
+	}
+
+	if (old_recvs->nreceiver > 1) {
+		new_recvs = (msg_recv_set_t *)kmm_malloc(SIZEOF_MSG_RECV_SET(old_recvs->nreceiver - 1));
+		if (new_recvs == NULL) {
+			msgdbg("[Messaging] fail to remove receiver info : out of memory.\n");
+			ret = ERROR;
+			goto out;
 		}
-		port_node = (msg_port_node_t *)sq_next(port_node);
+
+		memcpy(new_recvs->recv, old_recvs->recv, idx * sizeof(old_recvs->recv[0]));
+		memcpy(&new_recvs->recv[idx], &old_recvs->recv[idx + 1], (old_recvs->nreceiver - idx - 1) * sizeof(old_recvs->recv[0]));
+		new_recvs->nreceiver = old_recvs->nreceiver - 1;
 	}
 
-	if (port_node == NULL) {
-		/* If port_node is NULL, there is no information for removing. */
-		ret = OK;
+	sched_lock();
+	if (new_recvs != NULL) {
+		port_node->recvs = new_recvs;
+	} else {
+		/* No receiver is left, remove the port node. */
+		*link = port_node->flink;
 	}
+	sched_unlock();
 
+	kmm_free(old_recvs);
+	if (new_recvs == NULL) {
+		kmm_free(port_node);
+	}
+
+out:
+	sem_post(&port_list_sem);
 	return ret;
 }
 
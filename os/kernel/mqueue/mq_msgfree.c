@@ -96,6 +96,7 @@
  *   allocated dynamically it will be deallocated.
  *
  * Inputs:
+ *   msgq  - the message queue the message was allocated for
  *   mqmsg - message to free
  *
  * Return Value:
@@ -103,7 +104,7 @@
  *
  ************************************************************************/
 
-void mq_msgfree(FAR struct mqueue_msg_s *mqmsg)
+void mq_msgfree(FAR struct mqueue_inode_s *msgq, FAR struct mqueue_msg_s *mqmsg)
 {
 	irqstate_t saved_state;
 
@@ -135,6 +136,18 @@ void mq_msgfree(FAR struct mqueue_msg_s *mqmsg)
 		irqrestore(saved_state);
 	}
 
+#ifdef CONFIG_MQ_QUEUE_SLAB
+	/* If this message was allocated with the message queue, then put it
+	 * back in the free list of the queue.
+	 */
+
+	else if (mqmsg->type == MQ_ALLOC_QUEUE) {
+		saved_state = irqsave();
+		sq_addlast((FAR sq_entry_t *)mqmsg, &msgq->msgfree);
+		irqrestore(saved_state);
+	}
+#endif
+
 	/* Otherwise, deallocate it.  Note:  interrupt handlers
 	 * will never deallocate messages because they will not
 	 * received them.
@@ -112,6 +112,13 @@
 FAR struct mqueue_inode_s *mq_msgqalloc(mode_t mode, FAR struct mq_attr *attr)
 {
 	FAR struct mqueue_inode_s *msgq;
+	int16_t maxmsgs = MQ_MAX_MSGS;
+	int16_t maxmsgsize = MQ_MAX_BYTES;
+	int i;
+#ifdef CONFIG_MQ_QUEUE_SLAB
+	FAR struct mqueue_msg_s *mqmsg;
+	FAR uint8_t *slab;
+#endif
 
 	/* Check if the caller is attempting to allocate a message for messages
 	 * larger than the configured maximum message size.
@@ -122,22 +129,41 @@ FAR struct mqueue_inode_s *mq_msgqalloc(mode_t mode, FAR struct mq_attr *attr)
 		return NULL;
 	}
 
-	/* Allocate memory for the new message queue. */
+	if (attr) {
+		maxmsgs    = (int16_t)attr->mq_maxmsg;
+		maxmsgsize = (int16_t)attr->mq_msgsize;
+	}
 
+	/* Allocate memory for the new message queue, followed by one message of
+	 * the size of the queue per message the queue may hold.
+	 */
+
+#ifdef CONFIG_MQ_QUEUE_SLAB
+	msgq = (FAR struct mqueue_inode_s *)kmm_zalloc(sizeof(struct mqueue_inode_s) + maxmsgs * MQ_MSG_SIZE(maxmsgsize));
+#else
 	msgq = (FAR struct mqueue_inode_s *)kmm_zalloc(sizeof(struct mqueue_inode_s));
+#endif
 
 	if (msgq) {
 		/* Initialize the new named message queue */
 
-		sq_init(&msgq->msglist);
-		if (attr) {
-			msgq->maxmsgs    = (int16_t)attr->mq_maxmsg;
-			msgq->maxmsgsize = (int16_t)attr->mq_msgsize;
-		} else {
-			msgq->maxmsgs    = MQ_MAX_MSGS;
-			msgq->maxmsgsize = MQ_MAX_BYTES;
+		for (i = 0; i < CONFIG_MQ_NPRIOLISTS; i++) {
+			sq_init(&msgq->msglist[i]);
 		}
 
+		msgq->maxmsgs    = maxmsgs;
+		msgq->maxmsgsize = maxmsgsize;
+
+#ifdef CONFIG_MQ_QUEUE_SLAB
+		sq_init(&msgq->msgfree);
+		slab = (FAR uint8_t *)(msgq + 1);
+		for (i = 0; i < maxmsgs; i++) {
+			mqmsg = (FAR struct mqueue_msg_s *)(slab + i * MQ_MSG_SIZE(maxmsgsize));
+			mqmsg->type = MQ_ALLOC_QUEUE;
+			sq_addlast((FAR sq_entry_t *)mqmsg, &msgq->msgfree);
+		}
+#endif
+
 #ifndef CONFIG_DISABLE_SIGNALS
 		msgq->ntpid = INVALID_PROCESS_ID;
 #endif
@@ -92,6 +92,62 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: mq_msgremfirst
+ *
+ * Description:
+ *   Remove the first message of the highest priority list of a message
+ *   queue, or return NULL if the queue is empty.
+ *
+ * Assumptions:
+ * - Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+static FAR struct mqueue_msg_s *mq_msgremfirst(FAR struct mqueue_inode_s *msgq)
+{
+	FAR struct mqueue_msg_s *mqmsg;
+	uint32_t map = msgq->msgmap;
+	int index = 0;
+
+	if (map == 0) {
+		return NULL;
+	}
+
+	/* Find the highest bit set in the map */
+
+	if (map & 0xffff0000) {
+		map >>= 16;
+		index += 16;
+	}
+
+	if (map & 0xff00) {
+		map >>= 8;
+		index += 8;
+	}
+
+	if (map & 0xf0) {
+		map >>= 4;
+		index += 4;
+	}
+
+	if (map & 0xc) {
+		map >>= 2;
+		index += 2;
+	}
+
+	if (map & 0x2) {
+		index += 1;
+	}
+
+	mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&msgq->msglist[index]);
+	if (sq_empty(&msgq->msglist[index])) {
+		msgq->msgmap &= ~((uint32_t)1 << index);
+	}
+
+	return mqmsg;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -195,7 +251,7 @@ FAR struct mqueue_msg_s *mq_waitreceive(mqd_t mqdes)
 
 	/* Get the message from the head of the queue */
 
-	while ((rcvmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&msgq->msglist)) == NULL) {
+	while ((rcvmsg = mq_msgremfirst(msgq)) == NULL) {
 		/* The queue is empty!  Should we block until there the above condition
 		 * has been satisfied?
 		 */
@@ -294,11 +350,11 @@ ssize_t mq_doreceive(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR char *ubuf
 
 	/* We are done with the message.  Deallocate it now. */
 
-	mq_msgfree(mqmsg);
+	msgq = mqdes->msgq;
+	trace_event(TTRACE_TAG_IPC, TTRACE_EVENT_MQ_RECEIVE, msgq, TTRACE_MQ_MSG(rcvmsglen, mqmsg->priority));
+	mq_msgfree(msgq, mqmsg);
 
 	/* Check if any tasks are waiting for the MQ not full event. */
-
-	msgq = mqdes->msgq;
 	if (msgq->nwaitnotfull > 0) {
 		/* Find the highest priority task that is waiting for
 		 * this queue to be not-full in g_waitingformqnotfull list.
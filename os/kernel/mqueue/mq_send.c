@@ -171,7 +171,7 @@ int mq_send(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio)
 		/* Allocate the message */
 
 		irqrestore(saved_state);
-		mqmsg = mq_msgalloc();
+		mqmsg = mq_msgalloc(msgq);
 	} else {
 		/* We cannot send the message (and didn't even try to allocate it)
 		 * because:
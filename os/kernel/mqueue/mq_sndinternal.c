@@ -154,8 +154,9 @@ int mq_verifysend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio)
  *
  * Description:
  *   The mq_msgalloc function will get a free message for use by the
- *   operating system.  The message will be allocated from the g_msgfree
- *   list.
+ *   operating system.  The message will be allocated from the messages
+ *   allocated with the message queue if there are any (see
+ *   CONFIG_MQ_QUEUE_SLAB), from the g_msgfree list otherwise.
  *
  *   If the list is empty AND the message is NOT being allocated from the
  *   interrupt level, then the message will be allocated.  If a message
@@ -168,7 +169,7 @@ int mq_verifysend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio)
  *   handler will be notified.
  *
  * Inputs:
- *   None
+ *   msgq - The message queue the message will be sent to
  *
  * Return Value:
  *   A reference to the allocated msg structure.  On a failure to allocate,
@@ -176,11 +177,23 @@ int mq_verifysend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio)
  *
  ****************************************************************************/
 
-FAR struct mqueue_msg_s *mq_msgalloc(void)
+FAR struct mqueue_msg_s *mq_msgalloc(FAR struct mqueue_inode_s *msgq)
 {
 	FAR struct mqueue_msg_s *mqmsg;
 	irqstate_t saved_state;
 
+#ifdef CONFIG_MQ_QUEUE_SLAB
+	/* Use the messages of the queue first */
+
+	saved_state = irqsave();
+	mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&msgq->msgfree);
+	irqrestore(saved_state);
+
+	if (mqmsg) {
+		return mqmsg;
+	}
+#endif
+
 	/* If we were called from an interrupt handler, then try to get the message
 	 * from generally available list of messages. If this fails, then try the
 	 * list of messages reserved for interrupt handlers
@@ -352,7 +365,9 @@ int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const char *msg,
 	FAR struct mqueue_inode_s *msgq;
 	FAR struct mqueue_msg_s *next;
 	FAR struct mqueue_msg_s *prev;
+	FAR sq_queue_t *list;
 	irqstate_t saved_state;
+	int index;
 
 	trace_begin(TTRACE_TAG_IPC, "mq_dosend");
 
@@ -360,6 +375,7 @@ int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const char *msg,
 
 	sched_lock();
 	msgq = mqdes->msgq;
+	trace_event(TTRACE_TAG_IPC, TTRACE_EVENT_MQ_SEND, msgq, TTRACE_MQ_MSG(msglen, prio));
 
 	/* Construct the message header info */
 
@@ -374,20 +390,32 @@ int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const char *msg,
 
 	saved_state = irqsave();
 
-	/* Search the message list to find the location to insert the new
-	 * message. Each is list is maintained in ascending priority order.
+	/* Each list holds the messages of a range of priorities, in descending
+	 * priority order and in FIFO order for the same priority.  In the usual
+	 * case, the last message of the list has the same or a higher priority
+	 * and the new message goes to the end.
 	 */
 
-	for (prev = NULL, next = (FAR struct mqueue_msg_s *)msgq->msglist.head; next && prio <= next->priority; prev = next, next = next->next) ;
-
-	/* Add the message at the right place */
+	index = MQ_PRIO2LIST(prio);
+	list = &msgq->msglist[index];
 
-	if (prev) {
-		sq_addafter((FAR sq_entry_t *)prev, (FAR sq_entry_t *)mqmsg, &msgq->msglist);
+	next = (FAR struct mqueue_msg_s *)list->tail;
+	if (next == NULL || prio <= next->priority) {
+		sq_addlast((FAR sq_entry_t *)mqmsg, list);
 	} else {
-		sq_addfirst((FAR sq_entry_t *)mqmsg, &msgq->msglist);
+		/* Otherwise, search the list for the location to insert it */
+
+		for (prev = NULL, next = (FAR struct mqueue_msg_s *)list->head; next && prio <= next->priority; prev = next, next = next->next) ;
+
+		if (prev) {
+			sq_addafter((FAR sq_entry_t *)prev, (FAR sq_entry_t *)mqmsg, list);
+		} else {
+			sq_addfirst((FAR sq_entry_t *)mqmsg, list);
+		}
 	}
 
+	msgq->msgmap |= (uint32_t)1 << index;
+
 	/* Increment the count of messages in the queue */
 
 	msgq->nmsgs++;
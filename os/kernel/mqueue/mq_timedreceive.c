@@ -254,7 +254,7 @@ ssize_t mq_timedreceive(mqd_t mqdes, FAR char *msg, size_t msglen, FAR int *prio
 	 * will not need to start timer.
 	 */
 
-	if (mqdes->msgq->msglist.head == NULL) {
+	if (mqdes->msgq->msgmap == 0) {
 		int ticks;
 
 		/* Convert the timespec to clock ticks.  We must have interrupts
@@ -61,6 +61,7 @@
 #include <tinyara/compiler.h>
 
 #include <sys/types.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <limits.h>
@@ -92,6 +93,14 @@
 
 #define NUM_INTERRUPT_MSGS   8
 
+/* The message list of a queue holding the messages of priority 'prio' */
+
+#define MQ_PRIO2LIST(prio)  (((prio) * CONFIG_MQ_NPRIOLISTS) / (MQ_PRIO_MAX + 1))
+
+/* The size of a message able to hold 'msgsize' bytes of data */
+
+#define MQ_MSG_SIZE(msgsize) ((offsetof(struct mqueue_msg_s, mail) + (msgsize) + 3) & ~3)
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -99,10 +108,14 @@
 enum mqalloc_e {
 	MQ_ALLOC_FIXED = 0,			/* pre-allocated; never freed */
 	MQ_ALLOC_DYN,				/* dynamically allocated; free when unused */
-	MQ_ALLOC_IRQ				/* Preallocated, reserved for interrupt handling */
+	MQ_ALLOC_IRQ,				/* Preallocated, reserved for interrupt handling */
+	MQ_ALLOC_QUEUE				/* Allocated with its message queue */
 };
 
-/* This structure describes one buffered POSIX message. */
+/* This structure describes one buffered POSIX message.  The messages
+ * allocated with a queue (MQ_ALLOC_QUEUE) are MQ_MSG_SIZE(maxmsgsize) bytes
+ * long: their mail[] only holds the maximum message size of the queue.
+ */
 
 struct mqueue_msg_s {
 	FAR struct mqueue_msg_s *next;	/* Forward link to next message */
@@ -159,7 +172,7 @@ void weak_function mq_initialize(void);
 void mq_desblockalloc(void);
 
 FAR struct mqueue_inode_s *mq_findnamed(FAR const char *mq_name);
-void mq_msgfree(FAR struct mqueue_msg_s *mqmsg);
+void mq_msgfree(FAR struct mqueue_inode_s *msgq, FAR struct mqueue_msg_s *mqmsg);
 
 /* mq_waitirq.c ************************************************************/
 
@@ -174,7 +187,7 @@ ssize_t mq_doreceive(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR char *ubuf
 /* mq_sndinternal.c ********************************************************/
 
 int mq_verifysend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio);
-FAR struct mqueue_msg_s *mq_msgalloc(void);
+FAR struct mqueue_msg_s *mq_msgalloc(FAR struct mqueue_inode_s *msgq);
 int mq_waitsend(mqd_t mqdes);
 int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const char *msg, size_t msglen, int prio);
 
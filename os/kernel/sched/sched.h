@@ -125,6 +125,19 @@ struct tasklist_s {
 	bool prioritized;			/* true if the list is prioritized */
 };
 
+#ifdef CONFIG_SCHED_PRIOBITMAP
+/* This structure indexes a prioritized task list by priority (see
+ * sched_prioindex.c).  'last' is only valid for the priorities set in 'map'.
+ */
+
+#define SCHED_PRIOINDEX_NWORDS ((SCHED_PRIORITY_MAX + 32) >> 5)
+
+struct sched_prioindex_s {
+	uint32_t map[SCHED_PRIOINDEX_NWORDS];	/* Priorities present in the list */
+	FAR struct tcb_s *last[SCHED_PRIORITY_MAX + 1];	/* Last TCB of each priority */
+};
+#endif
+
 /****************************************************************************
  * Global Variables
  ****************************************************************************/
@@ -242,6 +255,14 @@ extern const struct tasklist_s g_tasklisttable[NUM_TASK_STATES];
 bool sched_addreadytorun(FAR struct tcb_s *rtrtcb);
 bool sched_removereadytorun(FAR struct tcb_s *rtrtcb);
 bool sched_addprioritized(FAR struct tcb_s *newTcb, DSEG dq_queue_t *list);
+#ifdef CONFIG_SCHED_PRIOBITMAP
+FAR struct sched_prioindex_s *sched_prioindex(DSEG dq_queue_t *list);
+bool sched_prioindex_add(FAR struct sched_prioindex_s *index, FAR struct tcb_s *tcb, DSEG dq_queue_t *list);
+void sched_removeprioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list);
+#else
+#define sched_removeprioritized(tcb, list) \
+		dq_rem((FAR dq_entry_t *)(tcb), (list))
+#endif
 bool sched_mergepending(void);
 void sched_addblocked(FAR struct tcb_s *btcb, tstate_t task_state);
 void sched_removeblocked(FAR struct tcb_s *btcb);
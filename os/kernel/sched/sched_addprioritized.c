@@ -116,6 +116,9 @@ bool sched_addprioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list)
 {
 	FAR struct tcb_s *next;
 	FAR struct tcb_s *prev;
+#ifdef CONFIG_SCHED_PRIOBITMAP
+	FAR struct sched_prioindex_s *index;
+#endif
 	uint8_t sched_priority = tcb->sched_priority;
 	bool ret = false;
 
@@ -123,6 +126,15 @@ bool sched_addprioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list)
 
 	ASSERT(sched_priority >= SCHED_PRIORITY_MIN);
 
+#ifdef CONFIG_SCHED_PRIOBITMAP
+	/* Indexed lists are not searched */
+
+	index = sched_prioindex(list);
+	if (index != NULL) {
+		return sched_prioindex_add(index, tcb, list);
+	}
+#endif
+
 	/* Search the list to find the location to insert the new Tcb.
 	 * Each is list is maintained in ascending sched_priority order.
 	 */
@@ -112,11 +112,31 @@
 bool sched_mergepending(void)
 {
 	FAR struct tcb_s *pndtcb;
-	FAR struct tcb_s *pndnext;
 	FAR struct tcb_s *rtrtcb;
+#ifndef CONFIG_SCHED_PRIOBITMAP
+	FAR struct tcb_s *pndnext;
 	FAR struct tcb_s *rtrprev;
+#endif
 	bool ret = false;
 
+#ifdef CONFIG_SCHED_PRIOBITMAP
+	/* The insertion point of each TCB is found from the index of the
+	 * g_readytorun list.
+	 */
+
+	while ((pndtcb = (FAR struct tcb_s *)g_pendingtasks.head) != NULL) {
+		sched_removeprioritized(pndtcb, (FAR dq_queue_t *)&g_pendingtasks);
+
+		rtrtcb = this_task();
+		if (sched_addprioritized(pndtcb, (FAR dq_queue_t *)&g_readytorun)) {
+			rtrtcb->task_state = TSTATE_TASK_READYTORUN;
+			pndtcb->task_state = TSTATE_TASK_RUNNING;
+			ret = true;
+		} else {
+			pndtcb->task_state = TSTATE_TASK_READYTORUN;
+		}
+	}
+#else
 	/* Initialize the inner search loop */
 
 	rtrtcb = this_task();
@@ -174,6 +194,7 @@ bool sched_mergepending(void)
 
 	g_pendingtasks.head = NULL;
 	g_pendingtasks.tail = NULL;
+#endif
 
 	return ret;
 }
@@ -0,0 +1,171 @@
+/****************************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * kernel/sched/sched_prioindex.c
+ *
+ * The g_readytorun, g_pendingtasks and g_waitingforsemaphore lists stay
+ * sorted by priority, but each of them is indexed by a bitmap of the
+ * priorities present in the list and by the last TCB of each priority.
+ * A TCB is inserted after the last TCB of the lowest priority present that
+ * is not below its own, found by a bit scan instead of a walk of the list,
+ * so that the TCBs of one priority still form a FIFO (round-robin order)
+ * and the head of the list is still the highest priority TCB.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+#include <assert.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_PRIOBITMAP
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+static struct sched_prioindex_s g_readytorunindex;
+static struct sched_prioindex_s g_pendingindex;
+static struct sched_prioindex_s g_semwaitindex;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_prioindex_after
+ *
+ * Description:
+ *   Return the last TCB of the lowest priority present in the list that is
+ *   greater than or equal to 'priority', or NULL if there is none.
+ *
+ ****************************************************************************/
+
+static FAR struct tcb_s *sched_prioindex_after(FAR struct sched_prioindex_s *index, uint8_t priority)
+{
+	int word = priority >> 5;
+	uint32_t map = index->map[word] & ~(((uint32_t)1 << (priority & 31)) - 1);
+
+	for (;;) {
+		if (map != 0) {
+			return index->last[(word << 5) + __builtin_ctz(map)];
+		}
+
+		if (++word >= SCHED_PRIOINDEX_NWORDS) {
+			return NULL;
+		}
+
+		map = index->map[word];
+	}
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_prioindex
+ *
+ * Description:
+ *   Return the index of a prioritized list, or NULL if the list is not
+ *   indexed.
+ *
+ ****************************************************************************/
+
+FAR struct sched_prioindex_s *sched_prioindex(DSEG dq_queue_t *list)
+{
+	if (list == (FAR dq_queue_t *)&g_readytorun) {
+		return &g_readytorunindex;
+	} else if (list == (FAR dq_queue_t *)&g_pendingtasks) {
+		return &g_pendingindex;
+	} else if (list == (FAR dq_queue_t *)&g_waitingforsemaphore) {
+		return &g_semwaitindex;
+	}
+
+	return NULL;
+}
+
+/****************************************************************************
+ * Name: sched_prioindex_add
+ *
+ * Description:
+ *   Add a TCB to an indexed prioritized list, behind the TCBs of the same
+ *   priority.  The same as sched_addprioritized() otherwise.
+ *
+ ****************************************************************************/
+
+bool sched_prioindex_add(FAR struct sched_prioindex_s *index, FAR struct tcb_s *tcb, DSEG dq_queue_t *list)
+{
+	uint8_t priority = tcb->sched_priority;
+	FAR struct tcb_s *prev;
+	bool ret = false;
+
+	prev = sched_prioindex_after(index, priority);
+	if (prev != NULL) {
+		dq_addafter((FAR dq_entry_t *)prev, (FAR dq_entry_t *)tcb, list);
+	} else {
+		dq_addfirst((FAR dq_entry_t *)tcb, list);
+		ret = true;
+	}
+
+	index->last[priority] = tcb;
+	index->map[priority >> 5] |= (uint32_t)1 << (priority & 31);
+	return ret;
+}
+
+/****************************************************************************
+ * Name: sched_removeprioritized
+ *
+ * Description:
+ *   Remove a TCB from a task list, keeping the index of the list up to
+ *   date if it has one.
+ *
+ * Assumptions:
+ * - The caller has established a critical section.
+ * - The priority of the TCB has not changed since it was added to the list.
+ *
+ ****************************************************************************/
+
+void sched_removeprioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list)
+{
+	FAR struct sched_prioindex_s *index = sched_prioindex(list);
+	uint8_t priority = tcb->sched_priority;
+	FAR struct tcb_s *prev;
+
+	if (index != NULL && index->last[priority] == tcb) {
+		prev = tcb->blink;
+		if (prev != NULL && prev->sched_priority == priority) {
+			index->last[priority] = prev;
+		} else {
+			index->last[priority] = NULL;
+			index->map[priority >> 5] &= ~((uint32_t)1 << (priority & 31));
+		}
+	}
+
+	dq_rem((FAR dq_entry_t *)tcb, list);
+}
+
+#endif							/* CONFIG_SCHED_PRIOBITMAP */
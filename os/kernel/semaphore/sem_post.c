@@ -62,6 +62,7 @@
 #include <sched.h>
 #include <tinyara/arch.h>
 #include <tinyara/sched.h>
+#include <tinyara/ttrace.h>
 
 #include "sched/sched.h"
 #include "semaphore/semaphore.h"
@@ -140,6 +141,7 @@ int sem_post(FAR sem_t *sem)
 
 		/* Perform the semaphore unlock operation. */
 		ASSERT(sem->semcount < SEM_VALUE_MAX);
+		trace_event(TTRACE_TAG_LOCK, TTRACE_EVENT_SEM_POST, sem, sem->semcount);
 		sem_releaseholder(sem, this_task());
 		sem->semcount++;
 #ifdef CONFIG_SEMAPHORE_HISTORY
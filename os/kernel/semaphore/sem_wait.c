@@ -62,6 +62,7 @@
 #include <assert.h>
 #include <tinyara/arch.h>
 #include <tinyara/cancelpt.h>
+#include <tinyara/ttrace.h>
 
 #include "sched/sched.h"
 #include "semaphore/semaphore.h"
@@ -182,6 +183,7 @@ int sem_wait(FAR sem_t *sem)
 
 			/* Handle the POSIX semaphore (but don't set the owner yet) */
 
+			trace_event(TTRACE_TAG_LOCK, TTRACE_EVENT_SEM_WAIT, sem, sem->semcount);
 			sem->semcount--;
 
 			/* Save the waited on semaphore in the TCB */
@@ -198,24 +198,10 @@ int prctl(int option, ...)
 		char *port_name = va_arg(ap, char *);
 		int *recv_arr = va_arg(ap, int *);
 		int *recv_cnt = va_arg(ap, int *);
-		int total_cnt;
-		static int curr_cnt = 0;
 		int ret;
-		ret = messaging_read_list(port_name, recv_arr, &total_cnt);
-		if (ret == ERROR) {
-			va_end(ap);
-			return ret;
-		}
-		curr_cnt += ret;
-		*recv_cnt = curr_cnt;
+		ret = messaging_read_list(port_name, recv_arr, recv_cnt);
 		va_end(ap);
-		if (curr_cnt == total_cnt) {
-			/* Read whole receivers information. */
-			curr_cnt = 0;
-			return MSG_READ_ALL;
-		} else {
-			return MSG_READ_YET;
-		}
+		return ret;
 	}
 	break;
 	case PR_MSG_REMOVE:
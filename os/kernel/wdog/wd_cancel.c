@@ -108,9 +108,8 @@
 
 int wd_cancel(WDOG_ID wdog)
 {
-	FAR struct wdog_s *curr;
-	FAR struct wdog_s *prev;
 	irqstate_t state;
+	bool head;
 	int ret = ERROR;
 
 	/* Prohibit timer interactions with the timer queue until the
@@ -124,46 +123,14 @@ int wd_cancel(WDOG_ID wdog)
 	 */
 
 	if (wdog && WDOG_ISACTIVE(wdog)) {
-		/* Search the g_wdactivelist for the target FCB.  We can't use sq_rem
-		 * to do this because there are additional operations that need to be
-		 * done.
-		 */
+		/* Remove the watchdog from the heap of active watchdogs */
 
-		prev = NULL;
-		curr = (FAR struct wdog_s *)g_wdactivelist.head;
+		head = (wdog == g_wdactive);
+		wd_heapremove(wdog);
 
-		while ((curr) && (curr != wdog)) {
-			prev = curr;
-			curr = curr->next;
-		}
-
-		/* Check if the watchdog was found in the list.  If not, then an OS
-		 * error has occurred because the watchdog is marked active!
-		 */
-
-		ASSERT(curr);
-
-		/* If there is a watchdog in the timer queue after the one that
-		 * is being cancelled, then it inherits the remaining ticks.
-		 */
-
-		if (curr->next) {
-			curr->next->lag += curr->lag;
-		}
-
-		/* Now, remove the watchdog from the timer queue */
-
-		if (prev) {
-			/* Remove the watchdog from mid- or end-of-queue */
-
-			(void)sq_remafter((FAR sq_entry_t *)prev, &g_wdactivelist);
-		} else {
-			/* Remove the watchdog at the head of the queue */
-
-			(void)sq_remfirst(&g_wdactivelist);
-
-			/* Reassess the interval timer that will generate the next
-			 * interval event.
+		if (head) {
+			/* The next watchdog to expire changed.  Reassess the interval
+			 * timer that will generate the next interval event.
 			 */
 
 			sched_timer_reassess();
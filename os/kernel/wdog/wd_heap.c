@@ -0,0 +1,257 @@
+/****************************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * kernel/wdog/wd_heap.c
+ *
+ * The active watchdogs are kept in a pairing heap ordered by expiration
+ * time.  Each node links to its first child, its next sibling and its
+ * previous sibling (or its parent if it is a first child), so that any
+ * watchdog can be removed without a search.  Insertion is O(1), removal
+ * O(log n) amortized, and the walks below do not recurse since they may
+ * run in the timer interrupt.  Watchdogs expiring at the same time are
+ * ordered by an insertion sequence number, so they expire in the order
+ * they were started.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#include <tinyara/wdog.h>
+
+#include "wdog/wdog.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* True if watchdog 'a' expires before 'b'.  The sequence numbers of the
+ * active watchdogs are never 2^31 apart, so they may wrap too.
+ */
+
+#define WDOG_PRECEDES(a, b) \
+	(WDOG_BEFORE((a)->expire, (b)->expire) || \
+	 ((a)->expire == (b)->expire && (int32_t)((a)->seq - (b)->seq) < 0))
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The sequence number of the next watchdog inserted */
+
+static uint32_t g_wdseq;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_meld
+ *
+ * Description:
+ *   Meld two heaps: the root expiring last becomes the first child of the
+ *   other one.
+ *
+ ****************************************************************************/
+
+static FAR struct wdog_s *wd_meld(FAR struct wdog_s *a, FAR struct wdog_s *b)
+{
+	FAR struct wdog_s *tmp;
+
+	if (WDOG_PRECEDES(b, a)) {
+		tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	b->prev = a;
+	b->next = a->child;
+	if (a->child != NULL) {
+		a->child->prev = b;
+	}
+
+	a->child = b;
+	return a;
+}
+
+/****************************************************************************
+ * Name: wd_mergepairs
+ *
+ * Description:
+ *   Meld a list of sibling heaps into one heap: meld them by pairs from
+ *   left to right, then meld the pairs from right to left.
+ *
+ ****************************************************************************/
+
+static FAR struct wdog_s *wd_mergepairs(FAR struct wdog_s *first)
+{
+	FAR struct wdog_s *pairs = NULL;
+	FAR struct wdog_s *root = NULL;
+	FAR struct wdog_s *a;
+	FAR struct wdog_s *b;
+
+	/* First pass.  The melded pairs are linked in reverse order through
+	 * their (unused) next field.
+	 */
+
+	while (first != NULL) {
+		a = first;
+		b = a->next;
+		first = b ? b->next : NULL;
+
+		a->next = NULL;
+		a->prev = NULL;
+		if (b != NULL) {
+			b->next = NULL;
+			b->prev = NULL;
+			a = wd_meld(a, b);
+		}
+
+		a->next = pairs;
+		pairs = a;
+	}
+
+	/* Second pass */
+
+	while (pairs != NULL) {
+		a = pairs;
+		pairs = a->next;
+		a->next = NULL;
+		root = root ? wd_meld(a, root) : a;
+	}
+
+	return root;
+}
+
+#if defined(CONFIG_SCHED_TICKLESS) && CONFIG_WDOG_SLACK > 0
+/****************************************************************************
+ * Name: wd_parent
+ *
+ * Description:
+ *   Return the parent of a watchdog in the heap.
+ *
+ ****************************************************************************/
+
+static FAR struct wdog_s *wd_parent(FAR struct wdog_s *wdog)
+{
+	while (wdog->prev->child != wdog) {
+		wdog = wdog->prev;
+	}
+
+	return wdog->prev;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_heapinsert
+ ****************************************************************************/
+
+void wd_heapinsert(FAR struct wdog_s *wdog)
+{
+	wdog->child = NULL;
+	wdog->next = NULL;
+	wdog->prev = NULL;
+	wdog->seq = g_wdseq++;
+
+	g_wdactive = g_wdactive ? wd_meld(g_wdactive, wdog) : wdog;
+}
+
+/****************************************************************************
+ * Name: wd_heapremove
+ ****************************************************************************/
+
+void wd_heapremove(FAR struct wdog_s *wdog)
+{
+	FAR struct wdog_s *sub;
+
+	if (wdog == g_wdactive) {
+		g_wdactive = wd_mergepairs(wdog->child);
+	} else {
+		/* Cut the sub-heap of the watchdog from the heap ... */
+
+		if (wdog->prev->child == wdog) {
+			wdog->prev->child = wdog->next;
+		} else {
+			wdog->prev->next = wdog->next;
+		}
+
+		if (wdog->next != NULL) {
+			wdog->next->prev = wdog->prev;
+		}
+
+		/* ... and meld back what remains of it without the watchdog */
+
+		sub = wd_mergepairs(wdog->child);
+		if (sub != NULL) {
+			g_wdactive = wd_meld(g_wdactive, sub);
+		}
+	}
+
+	wdog->child = NULL;
+	wdog->next = NULL;
+	wdog->prev = NULL;
+}
+
+/****************************************************************************
+ * Name: wd_coalesce
+ ****************************************************************************/
+
+#if defined(CONFIG_SCHED_TICKLESS) && CONFIG_WDOG_SLACK > 0
+clock_t wd_coalesce(clock_t limit)
+{
+	FAR struct wdog_s *wdog = g_wdactive;
+	clock_t latest = wdog->expire;
+
+	/* Walk the heap in pre-order, skipping the sub-heaps whose root expires
+	 * after the limit: all of their watchdogs do too.
+	 */
+
+	while (wdog != NULL) {
+		if (!WDOG_BEFORE(limit, wdog->expire)) {
+			if (WDOG_BEFORE(latest, wdog->expire)) {
+				latest = wdog->expire;
+			}
+
+			if (wdog->child != NULL) {
+				wdog = wdog->child;
+				continue;
+			}
+		}
+
+		/* Go to the next sibling, climbing up to the parents as needed */
+
+		while (wdog != g_wdactive && wdog->next == NULL) {
+			wdog = wd_parent(wdog);
+		}
+
+		wdog = (wdog == g_wdactive) ? NULL : wdog->next;
+	}
+
+	return latest;
+}
+#endif
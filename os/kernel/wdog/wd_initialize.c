@@ -78,12 +78,16 @@
 
 sq_queue_t g_wdfreelist;
 
-/* The g_wdactivelist data structure is a singly linked list ordered by
- * watchdog expiration time. When watchdog timers expire,the functions on
- * this linked list are removed and the function is called.
+/* g_wdactive is the root of a pairing heap of the active watchdogs ordered
+ * by expiration time: the root expires first.  When watchdog timers
+ * expire, they are removed from the heap and their function is called.
  */
 
-sq_queue_t g_wdactivelist;
+FAR struct wdog_s *g_wdactive;
+
+/* The watchdog time, in clock ticks, advanced by wd_timer() */
+
+clock_t g_wdtime;
 
 /* This is the number of free, pre-allocated watchdog structures in the
  * g_wdfreelist.  This value is used to enforce a reserve for interrupt
@@ -134,10 +138,11 @@ void wd_initialize(void)
 	FAR struct wdog_s *wdog = g_wdpool;
 	int i;
 
-	/* Initialize watchdog lists */
+	/* Initialize the watchdog free list and active heap */
 
 	sq_init(&g_wdfreelist);
-	sq_init(&g_wdactivelist);
+	g_wdactive = NULL;
+	g_wdtime = 0;
 
 	/* The g_wdfreelist must be loaded at initialization time to hold the
 	 * configured number of watchdogs.
@@ -74,14 +74,6 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
-#ifndef MIN
-#define MIN(a, b) (((a) < (b)) ? (a) : (b))
-#endif
-
-#ifndef MAX
-#define MAX(a, b) (((a) > (b)) ? (a) : (b))
-#endif
-
 /****************************************************************************
  * Private Type Declarations
  ****************************************************************************/
@@ -115,8 +107,8 @@ typedef void (*wdentry4_t)(int argc, uint32_t arg1, uint32_t arg2, uint32_t arg3
  * Name: wd_expiration
  *
  * Description:
- *   Check if the timer for the watchdog at the head of list is ready to
- *   run.  If so, remove the watchdog from the list and execute it.
+ *   Remove the watchdogs whose time has come from the heap and execute
+ *   them, in order of expiration.
  *
  * Parameters:
  *   None
@@ -132,63 +124,52 @@ static inline void wd_expiration(void)
 {
 	FAR struct wdog_s *wdog;
 
-	/* Check if the watchdog at the head of the list is ready to run */
-
-	if (((FAR struct wdog_s *)g_wdactivelist.head)->lag <= 0) {
-		/* Process the watchdog at the head of the list as well as any
-		 * other watchdogs that became ready to run at this time
-		 */
-
-		while (g_wdactivelist.head && ((FAR struct wdog_s *)g_wdactivelist.head)->lag <= 0) {
-			/* Remove the watchdog from the head of the list */
-
-			wdog = (FAR struct wdog_s *)sq_remfirst(&g_wdactivelist);
+	/* Process the watchdog at the root of the heap as well as any other
+	 * watchdogs that became ready to run at this time
+	 */
 
-			/* If there is another watchdog behind this one, update its
-			 * its lag (this shouldn't be necessary).
-			 */
+	while (g_wdactive && !WDOG_BEFORE(g_wdtime, g_wdactive->expire)) {
+		/* Remove the watchdog from the root of the heap */
 
-			if (g_wdactivelist.head) {
-				((FAR struct wdog_s *)g_wdactivelist.head)->lag += wdog->lag;
-			}
+		wdog = g_wdactive;
+		wd_heapremove(wdog);
 
-			/* Indicate that the watchdog is no longer active. */
+		/* Indicate that the watchdog is no longer active. */
 
-			WDOG_CLRACTIVE(wdog);
+		WDOG_CLRACTIVE(wdog);
 
-			/* Execute the watchdog function */
+		/* Execute the watchdog function */
 
-			up_setpicbase(wdog->picbase);
-			switch (wdog->argc) {
-			default:
-				DEBUGPANIC();
-				break;
+		up_setpicbase(wdog->picbase);
+		switch (wdog->argc) {
+		default:
+			DEBUGPANIC();
+			break;
 
-			case 0:
-				(*((wdentry0_t)(wdog->func)))(0);
-				break;
+		case 0:
+			(*((wdentry0_t)(wdog->func)))(0);
+			break;
 
 #if CONFIG_MAX_WDOGPARMS > 0
-			case 1:
-				(*((wdentry1_t)(wdog->func)))(1, wdog->parm[0]);
-				break;
+		case 1:
+			(*((wdentry1_t)(wdog->func)))(1, wdog->parm[0]);
+			break;
 #endif
 #if CONFIG_MAX_WDOGPARMS > 1
-			case 2:
-				(*((wdentry2_t)(wdog->func)))(2, wdog->parm[0], wdog->parm[1]);
-				break;
+		case 2:
+			(*((wdentry2_t)(wdog->func)))(2, wdog->parm[0], wdog->parm[1]);
+			break;
 #endif
 #if CONFIG_MAX_WDOGPARMS > 2
-			case 3:
-				(*((wdentry3_t)(wdog->func)))(3, wdog->parm[0], wdog->parm[1], wdog->parm[2]);
-				break;
+		case 3:
+			(*((wdentry3_t)(wdog->func)))(3, wdog->parm[0], wdog->parm[1], wdog->parm[2]);
+			break;
 #endif
 #if CONFIG_MAX_WDOGPARMS > 3
-			case 4:
-				(*((wdentry4_t)(wdog->func)))(4, wdog->parm[0], wdog->parm[1], wdog->parm[2], wdog->parm[3]);
-				break;
+		case 4:
+			(*((wdentry4_t)(wdog->func)))(4, wdog->parm[0], wdog->parm[1], wdog->parm[2], wdog->parm[3]);
+			break;
 #endif
-			}
 		}
 	}
 }
@@ -233,10 +214,6 @@ static inline void wd_expiration(void)
 int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry, int argc, ...)
 {
 	va_list ap;
-	FAR struct wdog_s *curr;
-	FAR struct wdog_s *prev;
-	FAR struct wdog_s *next;
-	int32_t now;
 	irqstate_t state;
 	int i;
 
@@ -292,80 +269,12 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry, int argc, ...)
 	(void)sched_timer_cancel();
 #endif
 
-	/* Do the easy case first -- when the watchdog timer queue is empty. */
-
-	if (g_wdactivelist.head == NULL) {
-		/* Add the watchdog to the head == tail of the queue. */
-
-		sq_addlast((FAR sq_entry_t *)wdog, &g_wdactivelist);
-	}
-
-	/* There are other active watchdogs in the timer queue */
-
-	else {
-		now = 0;
-		prev = curr = (FAR struct wdog_s *)g_wdactivelist.head;
-
-		/* Advance to positive time */
-
-		while ((now += curr->lag) < 0 && curr->next) {
-			prev = curr;
-			curr = curr->next;
-		}
-
-		/* Advance past shorter delays */
-
-		while (now <= delay && curr->next) {
-			prev = curr;
-			curr = curr->next;
-			now += curr->lag;
-		}
-
-		/* Check if the new wdog must be inserted before the curr. */
-
-		if (delay < now) {
-			/* The relative delay time is smaller or equal to the current delay
-			 * time, so decrement the current delay time by the new relative
-			 * delay time.
-			 */
-
-			delay -= (now - curr->lag);
-			curr->lag -= delay;
-
-			/* Insert the new watchdog in the list */
-
-			if (curr == (FAR struct wdog_s *)g_wdactivelist.head) {
-				/* Insert the watchdog at the head of the list */
-
-				sq_addfirst((FAR sq_entry_t *)wdog, &g_wdactivelist);
-			} else {
-				/* Insert the watchdog in mid- or end-of-queue */
-
-				sq_addafter((FAR sq_entry_t *)prev, (FAR sq_entry_t *)wdog, &g_wdactivelist);
-
-			}
-		}
-
-		/* The new watchdog delay time is greater than the curr delay time,
-		 * so the new wdog must be inserted after the curr. This only occurs
-		 * if the wdog is to be added to the end of the list.
-		 */
-
-		else {
-			delay -= now;
-			if (!curr->next) {
-				sq_addlast((FAR sq_entry_t *)wdog, &g_wdactivelist);
-			} else {
-				next = curr->next;
-				next->lag -= delay;
-				sq_addafter((FAR sq_entry_t *)curr, (FAR sq_entry_t *)wdog, &g_wdactivelist);
-			}
-		}
-	}
-
-	/* Put the lag into the watchdog structure and mark it as active. */
+	/* Put the expiration time into the watchdog structure, add it to the
+	 * heap of active watchdogs and mark it as active.
+	 */
 
-	wdog->lag = delay;
+	wdog->expire = g_wdtime + delay;
+	wd_heapinsert(wdog);
 	WDOG_SETACTIVE(wdog);
 
 #ifdef CONFIG_SCHED_TICKLESS
@@ -409,55 +318,41 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry, int argc, ...)
 #ifdef CONFIG_SCHED_TICKLESS
 unsigned int wd_timer(int ticks)
 {
-	FAR struct wdog_s *wdog;
-	int decr;
-
-	/* Check if there are any active watchdogs to process */
+	clock_t next;
 
-	while (g_wdactivelist.head && ticks > 0) {
-		/* Get the watchdog at the head of the list */
+	/* Advance the watchdog time and process the watchdogs that expired */
 
-		wdog = (FAR struct wdog_s *)g_wdactivelist.head;
-
-#ifndef CONFIG_SCHED_TICKLESS_ALARM
-		/* There is logic to handle the case where ticks is greater than
-		 * the watchdog lag, but if the scheduling is working properly
-		 * that should never happen.
-		 */
-
-		DEBUGASSERT(ticks <= wdog->lag);
-#endif
-		/* Decrement the lag for this watchdog. */
-
-		decr = MIN(wdog->lag, ticks);
-
-		/* There are.  Decrement the lag counter */
+	if (ticks > 0) {
+		g_wdtime += ticks;
+	}
 
-		wdog->lag -= decr;
-		ticks -= decr;
+	wd_expiration();
 
-		/* Check if the watchdog at the head of the list is ready to run */
+	/* Return the delay for the next watchdog to expire */
 
-		wd_expiration();
+	if (!g_wdactive) {
+		return 0;
 	}
 
-	/* Return the delay for the next watchdog to expire */
+	next = g_wdactive->expire;
+#if CONFIG_WDOG_SLACK > 0
+	/* Let the watchdogs due shortly after the next one expire with it, so
+	 * that they share a single timer interrupt.
+	 */
+
+	next = wd_coalesce(next + CONFIG_WDOG_SLACK);
+#endif
 
-	return g_wdactivelist.head ? ((FAR struct wdog_s *)g_wdactivelist.head)->lag : 0;
+	return (unsigned int)(next - g_wdtime);
 }
 
 #else
 void wd_timer(void)
 {
-	/* Check if there are any active watchdogs to process */
-
-	if (g_wdactivelist.head) {
-		/* There are.  Decrement the lag counter */
-
-		--(((FAR struct wdog_s *)g_wdactivelist.head)->lag);
-
-		/* Check if the watchdog at the head of the list is ready to run */
+	/* Advance the watchdog time and process the watchdogs that expired */
 
+	g_wdtime++;
+	if (g_wdactive) {
 		wd_expiration();
 	}
 }
@@ -59,6 +59,7 @@
 
 #include <tinyara/config.h>
 
+#include <sys/types.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -69,6 +70,14 @@
  * Pre-processor Definitions
  ************************************************************************/
 
+/* True if watchdog time 'a' comes before 'b', allowing for wrapping */
+
+#define WDOG_BEFORE(a, b)  ((clock_t)((a) - (b)) > ((clock_t)-1 >> 1))
+
+#ifndef CONFIG_WDOG_SLACK
+#define CONFIG_WDOG_SLACK 0
+#endif
+
 /************************************************************************
  * Public Type Declarations
  ************************************************************************/
@@ -90,12 +99,18 @@ extern "C" {
 
 extern sq_queue_t g_wdfreelist;
 
-/* The g_wdactivelist data structure is a singly linked list ordered by
- * watchdog expiration time. When watchdog timers expire,the functions on
- * this linked list are removed and the function is called.
+/* g_wdactive is the root of a pairing heap of the active watchdogs ordered
+ * by expiration time: the root expires first.  When watchdog timers
+ * expire, they are removed from the heap and their function is called.
+ */
+
+extern FAR struct wdog_s *g_wdactive;
+
+/* The watchdog time, in clock ticks, advanced by wd_timer().  The expire
+ * field of an active watchdog is the watchdog time at which it expires.
  */
 
-extern sq_queue_t g_wdactivelist;
+extern clock_t g_wdtime;
 
 /* This is the number of free, pre-allocated watchdog structures in the
  * g_wdfreelist.  This value is used to enforce a reserve for interrupt
@@ -129,6 +144,69 @@ extern uint16_t g_wdnfree;
 
 void weak_function wd_initialize(void);
 
+/****************************************************************************
+ * Name: wd_heapinsert
+ *
+ * Description:
+ *   Add a watchdog to the heap of active watchdogs.  wdog->expire must be
+ *   set.  O(1).
+ *
+ * Parameters:
+ *   wdog - The watchdog to add
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void wd_heapinsert(FAR struct wdog_s *wdog);
+
+/****************************************************************************
+ * Name: wd_heapremove
+ *
+ * Description:
+ *   Remove a watchdog from the heap of active watchdogs.  O(log n)
+ *   amortized.
+ *
+ * Parameters:
+ *   wdog - The active watchdog to remove
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void wd_heapremove(FAR struct wdog_s *wdog);
+
+/****************************************************************************
+ * Name: wd_coalesce
+ *
+ * Description:
+ *   Return the latest expiration time of the active watchdogs that is not
+ *   after 'limit'.  The heap must not be empty and the root must not
+ *   expire after 'limit'.
+ *
+ * Parameters:
+ *   limit - The end of the coalescing window
+ *
+ * Return Value:
+ *   The time at which the watchdogs of the window should be expired.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_SCHED_TICKLESS) && CONFIG_WDOG_SLACK > 0
+clock_t wd_coalesce(clock_t limit);
+#endif
+
 /****************************************************************************
  * Name: wd_timer
  *
@@ -36,11 +36,30 @@ int g_logm_head;
 int g_logm_tail;
 int g_logm_dropmsg_count;
 int g_logm_overflow_offset = -1;
+int g_logm_dropcnt_prio[LOGM_OFF];
+int g_logm_dropcnt_indx[LOGM_INDEX_MAX];
 
+#ifndef CONFIG_LOGM_BINARY
 static void logm_putc(FAR struct lib_outstream_s *this, int ch)
 {
-	if ((g_logm_tail + this->nput + 1) % logm_bufsize != g_logm_head) {
-		g_logm_rsvbuf[(g_logm_tail + this->nput++) % logm_bufsize] = ch;
+	int pos;
+	int next;
+
+	/* nput never exceeds logm_bufsize, so a compare replaces the modulo */
+
+	pos = g_logm_tail + this->nput;
+	if (pos >= logm_bufsize) {
+		pos -= logm_bufsize;
+	}
+
+	next = pos + 1;
+	if (next == logm_bufsize) {
+		next = 0;
+	}
+
+	if (next != g_logm_head) {
+		g_logm_rsvbuf[pos] = ch;
+		this->nput++;
 	}
 }
 
@@ -52,8 +71,9 @@ static void logm_outstream(FAR struct lib_outstream_s *outstream)
 #endif
 	outstream->nput = 0;
 }
+#endif
 
-#ifdef CONFIG_ARCH_LOWPUTC
+#if defined(CONFIG_ARCH_LOWPUTC) && !defined(CONFIG_LOGM_BINARY)
 static void logm_flush(struct lib_outstream_s *stream)
 {
 	sched_lock();
@@ -74,16 +94,43 @@ static void logm_flush(struct lib_outstream_s *stream)
 }
 #endif
 
+/* Count a dropped message per priority and per index */
+void logm_count_drop(int indx, int priority)
+{
+	if (priority >= 0 && priority < LOGM_OFF) {
+		g_logm_dropcnt_prio[priority]++;
+	}
+
+	if (indx >= 0 && indx < LOGM_INDEX_MAX) {
+		g_logm_dropcnt_indx[indx]++;
+	}
+}
+
 /* logm_internal hook for syslog & printfs */
 int logm_internal(int flag, int indx, int priority, const char *fmt, va_list ap)
 {
-	irqstate_t flags;
 	int ret = 0;
 	struct lib_outstream_s strm;
+#ifndef CONFIG_LOGM_BINARY
+	irqstate_t flags;
 #ifdef CONFIG_LOGM_TIMESTAMP
 	struct timespec ts;
 #endif
+#endif
 
+#ifdef CONFIG_LOGM_BINARY
+	/* Record the message and let logm task format it.  Only messages which
+	 * would have to be formatted in an interrupt handler fall through.
+	 */
+
+	if (LOGM_STATUS(LOGM_READY) && !LOGM_STATUS(LOGM_BUFFER_RESIZE_REQ) && flag == LOGM_NORMAL) {
+		ret = logm_bin_record(indx, priority, fmt, ap);
+		if (ret >= 0) {
+			return ret;
+		}
+		ret = 0;
+	}
+#else
 	if (LOGM_STATUS(LOGM_READY) && !LOGM_STATUS(LOGM_BUFFER_RESIZE_REQ) \
 		&& flag == LOGM_NORMAL && !up_interrupt_context()) {
 
@@ -91,6 +138,7 @@ int logm_internal(int flag, int indx, int priority, const char *fmt, va_list ap)
 
 		if (LOGM_STATUS(LOGM_BUFFER_OVERFLOW)) {
 			g_logm_dropmsg_count++;
+			logm_count_drop(indx, priority);
 			irqrestore(flags);
 			return 0;
 		}
@@ -112,16 +160,21 @@ int logm_internal(int flag, int indx, int priority, const char *fmt, va_list ap)
 			LOGM_STATUS_SET(LOGM_BUFFER_OVERFLOW);
 			g_logm_dropmsg_count = 1;
 			g_logm_overflow_offset = g_logm_tail;
+			logm_count_drop(indx, priority);
 		}
 		irqrestore(flags);
-	} else {
-		/* Low Output: Sytem is not yet completely ready or this is called from interrupt handler */
+		return ret;
+	}
+#endif
+
+	/* Low Output: Sytem is not yet completely ready or this is called from interrupt handler */
 #ifdef CONFIG_ARCH_LOWPUTC
-		lib_lowoutstream(&strm);
-		logm_flush(&strm);
-		ret = lib_vsprintf(&strm, fmt, ap);
+	lib_lowoutstream(&strm);
+#ifndef CONFIG_LOGM_BINARY
+	logm_flush(&strm);
+#endif
+	ret = lib_vsprintf(&strm, fmt, ap);
 #endif
-	}
 
 	return ret;
 }
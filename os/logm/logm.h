@@ -20,6 +20,9 @@
 
 #include <tinyara/config.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <tinyara/logm.h>
 
 /****************************************************************************
  * Preprocessor Definitions
@@ -47,6 +50,9 @@
 #define LOGM_BUFFER_RESIZE_REQ BIT(1)
 #define LOGM_BUFFER_OVERFLOW BIT(2)
 
+/* Maximum number of arguments of a message recorded in binary */
+#define LOGM_BIN_MAXARGS 8
+
 #define LOGM_STATUS(a) (logm_status & (a))
 #define LOGM_STATUS_SET(a) (logm_status |= (a))
 #define LOGM_STATUS_CLEAR(a) (logm_status &= ~(a))
@@ -57,6 +63,20 @@
 
 /* Structure for a single debug message */
 
+#ifdef CONFIG_LOGM_BINARY
+struct logm_binrec_s {
+	uint16_t size;				/* Size of the record in bytes, including this header */
+	volatile uint8_t state;		/* See LOGM_REC_xxx in logm_binary.c */
+	uint8_t priority;			/* Priority of the message */
+	uint8_t indx;				/* Index of the message */
+	uint8_t reserved[3];
+	uint32_t ticks;				/* System time when the message was logged */
+	const char *fmt;			/* Format string, NULL for a text record */
+	uint8_t types[LOGM_BIN_MAXARGS];	/* Type of each argument, see LOGM_ARG_xxx */
+	uintptr_t args[0];			/* Arguments, or the text of a text record */
+};
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 #define EXTERN extern "C"
@@ -74,12 +94,23 @@ EXTERN int logm_bufsize;
 EXTERN uint8_t logm_status;
 EXTERN volatile int new_logm_bufsize;
 EXTERN volatile int logm_print_interval;
+EXTERN int g_logm_dropcnt_prio[LOGM_OFF];
+EXTERN int g_logm_dropcnt_indx[LOGM_INDEX_MAX];
 
 /************************************************************************************
  * Private Function Prototypes
  ************************************************************************************/
 int logm_task(int argc, char *argv[]);
 void logm_register_tashcmds(void);
+void logm_count_drop(int indx, int priority);
+#ifdef CONFIG_LOGM_BINARY
+void logm_bin_initialize(void);
+int logm_bin_record(int indx, int priority, const char *fmt, va_list ap);
+void logm_bin_flush(void);
+void logm_bin_wait(void);
+void logm_bin_wakeup(void);
+bool logm_bin_busy(void);
+#endif
 
 #undef EXTERN
 #if defined(__cplusplus)
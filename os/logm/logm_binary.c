@@ -0,0 +1,651 @@
+/****************************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * logm/logm_binary.c
+ *
+ * Binary logging for logm.  Instead of formatting each message into the
+ * buffer with interrupts disabled, the caller reserves a record in the
+ * buffer, fills it with the format pointer, the raw arguments and a tick
+ * count, and marks it ready.  Interrupts are only disabled while the
+ * record is reserved and committed.  Formatting is deferred to the logm
+ * task, which sleeps until a record is committed.
+ *
+ * The type of each argument is recorded with it, and the logm task passes
+ * it back with that type, one conversion at a time.  Only formats whose
+ * conversions are all integers, characters, floating point or pointers
+ * can be recorded like this.  Other messages (strings, or more than
+ * LOGM_BIN_MAXARGS arguments) are formatted by the caller into a text
+ * record of at most CONFIG_LOGM_BINARY_TEXTMAX bytes in the same buffer,
+ * so messages keep their order.
+ *
+ * The buffer is a ring of variable sized records.  A record never wraps;
+ * if it does not fit before the end of the buffer, the rest of the buffer
+ * is skipped with a pad record, or implicitly when it is too small to hold
+ * a record header.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <semaphore.h>
+
+#include <arch/irq.h>
+#include <tinyara/arch.h>
+#include <tinyara/clock.h>
+#include <tinyara/logm.h>
+#include <tinyara/semaphore.h>
+#include <tinyara/streams.h>
+
+#include "logm.h"
+
+#ifdef CONFIG_LOGM_BINARY
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define LOGM_REC_HDRSIZE     (sizeof(struct logm_binrec_s))
+#define LOGM_REC_ALIGN(n)    (((n) + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1))
+#define LOGM_REC(off)        ((FAR struct logm_binrec_s *)&g_logm_rsvbuf[off])
+
+/* Record states */
+
+#define LOGM_REC_BUSY        0	/* Reserved, being filled by the caller */
+#define LOGM_REC_BIN         1	/* Format string and arguments */
+#define LOGM_REC_TEXT        2	/* Preformatted text */
+#define LOGM_REC_PAD         3	/* Unused space up to the end of the buffer */
+
+/* Argument types */
+
+#define LOGM_ARG_INT         0
+#define LOGM_ARG_LONG        1
+#define LOGM_ARG_LLONG       2	/* Two words */
+#define LOGM_ARG_DOUBLE      3	/* Two words */
+#define LOGM_ARG_PTR         4
+
+#define LOGM_ARG_WORDS(t)    (((t) == LOGM_ARG_LLONG || (t) == LOGM_ARG_DOUBLE) ? 2 : 1)
+
+/* Maximum length of a conversion specification, and of one once the '*'
+ * width and precision are replaced by their values.
+ */
+
+#define LOGM_SPEC_MAX        16
+#define LOGM_SPEC_BUFSIZE    (LOGM_SPEC_MAX + 2 * 11)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static sem_t g_logm_sem;
+static volatile bool g_logm_waiting;
+static volatile int g_logm_writers;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: logm_bin_scan
+ *
+ * Description: Find the type of each argument consumed by 'fmt'.
+ *
+ * Returned Value:
+ *   The number of arguments, or -1 if 'fmt' can not be recorded in binary.
+ *
+ ****************************************************************************/
+
+static int logm_bin_scan(FAR const char *fmt, FAR uint8_t *types)
+{
+	FAR const char *spec;
+	int nargs = 0;
+	int nstars;
+	int length;
+
+	while (*fmt != '\0') {
+		if (*fmt != '%') {
+			fmt++;
+			continue;
+		}
+
+		spec = fmt++;
+		if (*fmt == '%') {
+			fmt++;
+			continue;
+		}
+
+		/* Flags */
+
+		while (*fmt == '-' || *fmt == '+' || *fmt == ' ' || *fmt == '#' || *fmt == '0') {
+			fmt++;
+		}
+
+		/* Field width and precision, either of which may be an argument */
+
+		nstars = 0;
+		while ((*fmt >= '0' && *fmt <= '9') || *fmt == '.' || *fmt == '*') {
+			if (*fmt == '*') {
+				if (nargs >= LOGM_BIN_MAXARGS || ++nstars > 2) {
+					return -1;
+				}
+				types[nargs++] = LOGM_ARG_INT;
+			}
+			fmt++;
+		}
+
+		/* Length modifier */
+
+		length = LOGM_ARG_INT;
+		if (*fmt == 'h') {
+			fmt++;
+			if (*fmt == 'h') {
+				fmt++;
+			}
+		} else if (*fmt == 'l') {
+			fmt++;
+			length = LOGM_ARG_LONG;
+			if (*fmt == 'l') {
+				fmt++;
+				length = LOGM_ARG_LLONG;
+			}
+		} else if (*fmt == 'z' || *fmt == 't') {
+			fmt++;
+			length = LOGM_ARG_LONG;
+		}
+
+		if (nargs >= LOGM_BIN_MAXARGS || fmt - spec >= LOGM_SPEC_MAX) {
+			return -1;
+		}
+
+		switch (*fmt) {
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+		case 'c':
+			types[nargs++] = length;
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+			types[nargs++] = LOGM_ARG_DOUBLE;
+			break;
+		case 'p':
+			types[nargs++] = LOGM_ARG_PTR;
+			break;
+		default:
+			return -1;
+		}
+
+		fmt++;
+	}
+
+	return nargs;
+}
+
+/****************************************************************************
+ * Name: logm_bin_reserve
+ *
+ * Description: Reserve a record of 'size' bytes at the tail of the buffer.
+ *              Must be called with interrupts disabled.
+ *
+ * Returned Value:
+ *   The offset of the record, or -1 if the buffer is full.
+ *
+ ****************************************************************************/
+
+static int logm_bin_reserve(int size)
+{
+	FAR struct logm_binrec_s *rec;
+	int tail = g_logm_tail;
+	int room = logm_bufsize - tail;
+	int used;
+	int need;
+
+	used = tail - g_logm_head;
+	if (used < 0) {
+		used += logm_bufsize;
+	}
+
+	/* Keep one word free so that a full buffer is not taken as empty */
+
+	need = (room < size) ? room + size : size;
+	if (need > logm_bufsize - used - (int)sizeof(uintptr_t)) {
+		return -1;
+	}
+
+	if (room < size) {
+		if (room >= LOGM_REC_HDRSIZE) {
+			rec = LOGM_REC(tail);
+			rec->size = room;
+			rec->state = LOGM_REC_PAD;
+		}
+		tail = 0;
+	}
+
+	rec = LOGM_REC(tail);
+	rec->size = size;
+	rec->state = LOGM_REC_BUSY;
+
+	g_logm_tail = (tail + size == logm_bufsize) ? 0 : tail + size;
+	g_logm_writers++;
+
+	return tail;
+}
+
+/****************************************************************************
+ * Name: logm_bin_commit
+ *
+ * Description: Publish a filled record and wake up the logm task if it is
+ *              waiting for one.
+ *
+ ****************************************************************************/
+
+static void logm_bin_commit(FAR struct logm_binrec_s *rec, uint8_t state)
+{
+	irqstate_t flags;
+
+	flags = irqsave();
+	rec->state = state;
+	g_logm_writers--;
+	if (g_logm_waiting) {
+		g_logm_waiting = false;
+		sem_post(&g_logm_sem);
+	}
+	irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: logm_bin_drop
+ *
+ * Description: Account a message that did not fit in the buffer.  Must be
+ *              called with interrupts disabled.
+ *
+ ****************************************************************************/
+
+static void logm_bin_drop(int indx, int priority)
+{
+	g_logm_dropmsg_count++;
+	logm_count_drop(indx, priority);
+}
+
+/****************************************************************************
+ * Name: logm_bin_printarg
+ *
+ * Description: Format one argument to stdout with the conversion 'spec',
+ *              passing it back with the type it was recorded with.
+ *
+ ****************************************************************************/
+
+static void logm_bin_printarg(FAR const char *spec, uint8_t type, FAR const uintptr_t *arg)
+{
+	long long llval;
+	double dval;
+
+	switch (type) {
+	case LOGM_ARG_INT:
+		fprintf(stdout, spec, (int)arg[0]);
+		break;
+	case LOGM_ARG_LONG:
+		fprintf(stdout, spec, (long)arg[0]);
+		break;
+	case LOGM_ARG_LLONG:
+		memcpy(&llval, arg, sizeof(llval));
+		fprintf(stdout, spec, llval);
+		break;
+	case LOGM_ARG_DOUBLE:
+		memcpy(&dval, arg, sizeof(dval));
+		fprintf(stdout, spec, dval);
+		break;
+	default:
+		fprintf(stdout, spec, (FAR void *)arg[0]);
+		break;
+	}
+}
+
+/****************************************************************************
+ * Name: logm_bin_print
+ *
+ * Description: Format one record to stdout.  The format of a binary record
+ *              was checked by logm_bin_scan(), so each conversion ends with
+ *              one of the letters it accepts.
+ *
+ ****************************************************************************/
+
+static void logm_bin_print(FAR struct logm_binrec_s *rec)
+{
+	FAR const uintptr_t *a = rec->args;
+	FAR const char *fmt;
+	char spec[LOGM_SPEC_BUFSIZE];
+	size_t len;
+	int i;
+#ifdef CONFIG_LOGM_TIMESTAMP
+	uint64_t msec = TICK2MSEC((uint64_t)rec->ticks);
+
+	fprintf(stdout, "[%4d.%4d] ", (int)(msec / 1000), (int)(msec % 1000) * 10);
+#endif
+
+	if (rec->state == LOGM_REC_TEXT) {
+		fputs((FAR const char *)a, stdout);
+		return;
+	}
+
+	fmt = rec->fmt;
+	i = 0;
+	while (*fmt != '\0') {
+		/* Text up to the next conversion */
+
+		len = strcspn(fmt, "%");
+		if (len > 0) {
+			fwrite(fmt, 1, len, stdout);
+			fmt += len;
+			continue;
+		}
+
+		if (fmt[1] == '%') {
+			fputc('%', stdout);
+			fmt += 2;
+			continue;
+		}
+
+		/* Copy the conversion, replacing '*' by the recorded value.  A
+		 * negative precision is taken as if it was omitted.
+		 */
+
+		spec[0] = *fmt++;
+		len = 1;
+		while (strchr("diuxXocfFeEgGp", *fmt) == NULL) {
+			if (*fmt != '*') {
+				spec[len++] = *fmt++;
+				continue;
+			}
+
+			if (spec[len - 1] == '.' && (int)*a < 0) {
+				len--;
+			} else {
+				len += sprintf(&spec[len], "%d", (int)*a);
+			}
+			a++;
+			i++;
+			fmt++;
+		}
+
+		spec[len++] = *fmt++;
+		spec[len] = '\0';
+
+		logm_bin_printarg(spec, rec->types[i], a);
+		a += LOGM_ARG_WORDS(rec->types[i]);
+		i++;
+	}
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: logm_bin_initialize
+ *
+ * Description: Initialize the binary logging state.  Called by the logm
+ *              task before logm is ready.
+ *
+ ****************************************************************************/
+
+void logm_bin_initialize(void)
+{
+	/* The semaphore is used for signaling and not for mutual exclusion */
+
+	sem_init(&g_logm_sem, 0, 0);
+	sem_setprotocol(&g_logm_sem, SEM_PRIO_NONE);
+
+	logm_bufsize &= ~(sizeof(uintptr_t) - 1);
+}
+
+/****************************************************************************
+ * Name: logm_bin_record
+ *
+ * Description: Record one message in the buffer.  This may be called from
+ *              an interrupt handler, as long as 'fmt' can be recorded
+ *              without formatting.
+ *
+ * Returned Value:
+ *   The number of characters written for a text record, zero for a binary
+ *   or dropped record, or -1 if the message must be formatted some other
+ *   way.  In the last case 'ap' has not been used.
+ *
+ ****************************************************************************/
+
+int logm_bin_record(int indx, int priority, FAR const char *fmt, va_list ap)
+{
+	FAR struct logm_binrec_s *rec;
+	struct lib_memoutstream_s strm;
+	uint8_t types[LOGM_BIN_MAXARGS];
+	irqstate_t flags;
+	uint8_t state;
+	int nargs;
+	int nwords;
+	int size;
+	int off;
+	int end;
+	int ret = 0;
+	int i;
+
+	nargs = logm_bin_scan(fmt, types);
+	if (nargs >= 0) {
+		state = LOGM_REC_BIN;
+		nwords = 0;
+		for (i = 0; i < nargs; i++) {
+			nwords += LOGM_ARG_WORDS(types[i]);
+		}
+		size = LOGM_REC_ALIGN(LOGM_REC_HDRSIZE + nwords * sizeof(uintptr_t));
+	} else if (!up_interrupt_context()) {
+		state = LOGM_REC_TEXT;
+		size = LOGM_REC_ALIGN(LOGM_REC_HDRSIZE + CONFIG_LOGM_BINARY_TEXTMAX);
+	} else {
+		return -1;
+	}
+
+	flags = irqsave();
+	if (LOGM_STATUS(LOGM_BUFFER_RESIZE_REQ) || (off = logm_bin_reserve(size)) < 0) {
+		logm_bin_drop(indx, priority);
+		irqrestore(flags);
+		return 0;
+	}
+	irqrestore(flags);
+
+	rec = LOGM_REC(off);
+	rec->priority = priority;
+	rec->indx = indx;
+	rec->ticks = (uint32_t)clock_systimer();
+
+	if (state == LOGM_REC_BIN) {
+		FAR uintptr_t *a = rec->args;
+		long long llval;
+		double dval;
+
+		rec->fmt = fmt;
+		for (i = 0; i < nargs; i++) {
+			rec->types[i] = types[i];
+			switch (types[i]) {
+			case LOGM_ARG_INT:
+				*a = (uintptr_t)va_arg(ap, unsigned int);
+				break;
+			case LOGM_ARG_LONG:
+				*a = (uintptr_t)va_arg(ap, unsigned long);
+				break;
+			case LOGM_ARG_LLONG:
+				llval = va_arg(ap, long long);
+				memcpy(a, &llval, sizeof(llval));
+				break;
+			case LOGM_ARG_DOUBLE:
+				dval = va_arg(ap, double);
+				memcpy(a, &dval, sizeof(dval));
+				break;
+			default:
+				*a = (uintptr_t)va_arg(ap, FAR void *);
+				break;
+			}
+			a += LOGM_ARG_WORDS(types[i]);
+		}
+	} else {
+		rec->fmt = NULL;
+		lib_memoutstream(&strm, (FAR char *)rec->args, CONFIG_LOGM_BINARY_TEXTMAX);
+		(void)lib_vsprintf((FAR struct lib_outstream_s *)&strm, fmt, ap);
+		ret = strm.public.nput;
+
+		/* Give back the unused part of the record if it is still the last one */
+
+		size = LOGM_REC_ALIGN(LOGM_REC_HDRSIZE + ret + 1);
+		end = off + rec->size;
+
+		flags = irqsave();
+		if (g_logm_tail == (end == logm_bufsize ? 0 : end)) {
+			rec->size = size;
+			g_logm_tail = (off + size == logm_bufsize) ? 0 : off + size;
+		}
+		irqrestore(flags);
+	}
+
+	logm_bin_commit(rec, state);
+	return ret;
+}
+
+/****************************************************************************
+ * Name: logm_bin_flush
+ *
+ * Description: Format and print all committed records, in order, and
+ *              report dropped messages.  Called by the logm task.
+ *
+ ****************************************************************************/
+
+void logm_bin_flush(void)
+{
+	FAR struct logm_binrec_s *rec;
+	irqstate_t flags;
+	int dropped;
+	int head;
+
+	head = g_logm_head;
+	while (head != g_logm_tail) {
+		if (logm_bufsize - head < LOGM_REC_HDRSIZE) {
+			head = g_logm_head = 0;
+			continue;
+		}
+
+		rec = LOGM_REC(head);
+		if (rec->state == LOGM_REC_BUSY) {
+			break;
+		}
+
+		if (rec->state != LOGM_REC_PAD) {
+			logm_bin_print(rec);
+		}
+
+		head += rec->size;
+		if (head == logm_bufsize) {
+			head = 0;
+		}
+		g_logm_head = head;
+	}
+
+	flags = irqsave();
+	dropped = g_logm_dropmsg_count;
+	g_logm_dropmsg_count = 0;
+	irqrestore(flags);
+
+	if (dropped > 0) {
+		fprintf(stdout, "\n[LOGM BUFFER OVERFLOW] %d messages are dropped\n", dropped);
+	}
+}
+
+/****************************************************************************
+ * Name: logm_bin_wait
+ *
+ * Description: Sleep until a record is committed at the head of the buffer
+ *              or logm_bin_wakeup() is called.
+ *
+ ****************************************************************************/
+
+void logm_bin_wait(void)
+{
+	irqstate_t flags;
+	bool wait;
+
+	flags = irqsave();
+	wait = (g_logm_head == g_logm_tail || (logm_bufsize - g_logm_head >= LOGM_REC_HDRSIZE && LOGM_REC(g_logm_head)->state == LOGM_REC_BUSY));
+	wait = wait && !LOGM_STATUS(LOGM_BUFFER_RESIZE_REQ);
+	g_logm_waiting = wait;
+	irqrestore(flags);
+
+	/* A record committed after irqrestore() posts the semaphore, so the
+	 * wait below returns at once.
+	 */
+
+	if (wait) {
+		while (sem_wait(&g_logm_sem) < 0 && get_errno() == EINTR) ;
+	}
+}
+
+/****************************************************************************
+ * Name: logm_bin_wakeup
+ *
+ * Description: Wake up the logm task, e.g. to handle a resize request.
+ *
+ ****************************************************************************/
+
+void logm_bin_wakeup(void)
+{
+	irqstate_t flags;
+
+	flags = irqsave();
+	if (g_logm_waiting) {
+		g_logm_waiting = false;
+		sem_post(&g_logm_sem);
+	}
+	irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: logm_bin_busy
+ *
+ * Description: Return true while a caller is filling a record, so the
+ *              buffer must not be reallocated.  Must be called with
+ *              interrupts disabled.
+ *
+ ****************************************************************************/
+
+bool logm_bin_busy(void)
+{
+	return g_logm_writers > 0;
+}
+
+#endif							/* CONFIG_LOGM_BINARY */
@@ -41,6 +41,11 @@ static int logm_change_bufsize(int buflen)
 		return ERROR;
 	}
 
+#ifdef CONFIG_LOGM_BINARY
+	/* Records are word aligned */
+	buflen &= ~(sizeof(uintptr_t) - 1);
+#endif
+
 	/* Realloc new buffer with new length */
 	char *new_g_logm_rsvbuf = (char *)realloc(g_logm_rsvbuf, buflen);
 	if (new_g_logm_rsvbuf == NULL) {
@@ -66,6 +71,10 @@ int logm_task(int argc, char *argv[])
 {
 	irqstate_t flags;
 
+#ifdef CONFIG_LOGM_BINARY
+	logm_bin_initialize();
+#endif
+
 	g_logm_rsvbuf = (char *)malloc(logm_bufsize);
 	memset(g_logm_rsvbuf, 0, logm_bufsize);
 
@@ -77,6 +86,9 @@ int logm_task(int argc, char *argv[])
 #endif
 
 	while (1) {
+#ifdef CONFIG_LOGM_BINARY
+		logm_bin_flush();
+#else
 		while (g_logm_head != g_logm_tail) {
 			fputc(g_logm_rsvbuf[g_logm_head], stdout);
 			g_logm_head = (g_logm_head + 1) % logm_bufsize;
@@ -88,14 +100,30 @@ int logm_task(int argc, char *argv[])
 				g_logm_overflow_offset = -1;
 			}
 		}
+#endif
 
 		if (LOGM_STATUS(LOGM_BUFFER_RESIZE_REQ)) {
 			flags = irqsave();
+#ifdef CONFIG_LOGM_BINARY
+			/* A caller still filling a record points into the buffer */
+			if (logm_bin_busy()) {
+				irqrestore(flags);
+				usleep(logm_print_interval);
+				continue;
+			}
+#endif
 			if (logm_change_bufsize(new_logm_bufsize) != OK) {
 				fprintf(stdout, "\n[LOGM] Failed to change buffer size\n");
 			}
 			irqrestore(flags);
 		}
+
+#ifdef CONFIG_LOGM_BINARY
+		/* Sleep until there is something to print, then let more messages
+		 * queue up for one interval before flushing them.
+		 */
+		logm_bin_wait();
+#endif
 		usleep(logm_print_interval);
 	}
 	return 0;					// Just to make compiler happy
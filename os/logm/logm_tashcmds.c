@@ -52,6 +52,7 @@ static void logm_info(void)
 {
 	int bufsize;
 	int interval;
+	int i;
 
 	logm_get_values(LOGM_BUFSIZE, &bufsize);
 	logm_get_values(LOGM_INTERVAL, &interval);
@@ -59,6 +60,20 @@ static void logm_info(void)
 	fprintf(stdout, "[LOGM CONFIGURATIONS]\n");
 	fprintf(stdout, "  Buffer size : %d (bytes)\n", bufsize);
 	fprintf(stdout, "  Flusing interval : %d (ms)\n", interval);
+#ifdef CONFIG_LOGM_BINARY
+	fprintf(stdout, "  Binary logging : enabled\n");
+#endif
+
+	fprintf(stdout, "[LOGM DROPPED MESSAGES]\n");
+	fprintf(stdout, "  Priority :");
+	for (i = 0; i < LOGM_OFF; i++) {
+		fprintf(stdout, " %d", g_logm_dropcnt_prio[i]);
+	}
+	fprintf(stdout, "\n  Index    :");
+	for (i = 0; i < LOGM_INDEX_MAX; i++) {
+		fprintf(stdout, " %d", g_logm_dropcnt_indx[i]);
+	}
+	fprintf(stdout, "\n");
 }
 
 static int logm_tash(int argc, char **args)
@@ -91,6 +106,9 @@ static int logm_tash(int argc, char **args)
 			if (optarg != NULL && atoi(optarg) > 0) {
 				logm_set_values(LOGM_BUFSIZE, atoi(optarg));
 				LOGM_STATUS_SET(LOGM_BUFFER_RESIZE_REQ);
+#ifdef CONFIG_LOGM_BINARY
+				logm_bin_wakeup();
+#endif
 			}
 			break;
 		case 'i':
@@ -58,6 +58,8 @@
 
 #include <tinyara/mm/mm.h>
 
+#include "mm_node.h"
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -88,9 +90,22 @@ void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
 
 	int ndx = mm_size2ndx(node->size);
 
+#ifdef CONFIG_MM_ALLOC_TLSF
+	/* Every chunk in a segregated list is in the same size class, so there
+	 * is no need to keep the list sorted.  Just push the node at the head
+	 * and mark the class as non-empty.
+	 */
+
+	prev = &heap->mm_nodelist[ndx];
+	next = prev->flink;
+
+	heap->mm_flbitmap |= (uint32_t)1 << MM_NDX2NODE(ndx);
+	heap->mm_slbitmap[MM_NDX2NODE(ndx)] |= (uint32_t)1 << (ndx & (MM_SLI_COUNT - 1));
+#else
 	/* Now put the new free node in a descending order */
 
 	for (prev = &heap->mm_nodelist[ndx], next = prev->flink; next && next->size > node->size; prev = next, next = next->flink) ;
+#endif
 
 	/* Does it go in mid next or at the end? */
 
@@ -104,3 +119,41 @@ void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
 		next->blink = node;
 	}
 }
+
+#ifdef CONFIG_MM_ALLOC_TLSF
+/****************************************************************************
+ * Name: mm_removefreechunk
+ *
+ * Description:
+ *   Remove a free chunk from its segregated free list and clear the bitmap
+ *   bits of its class if the list became empty.  It is assumed that the
+ *   caller holds the mm semaphore
+ *
+ ****************************************************************************/
+
+void mm_removefreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+	FAR struct mm_freenode_s *prev = node->blink;
+	int ndx;
+
+	DEBUGASSERT(prev);
+
+	prev->flink = node->flink;
+	if (node->flink) {
+		node->flink->blink = prev;
+		return;
+	}
+
+	/* The list heads are the only nodes with a zero size.  If the previous
+	 * node is a list head and there is no next node, the list is now empty.
+	 */
+
+	if (prev->size == 0) {
+		ndx = prev - heap->mm_nodelist;
+		heap->mm_slbitmap[MM_NDX2NODE(ndx)] &= ~((uint32_t)1 << (ndx & (MM_SLI_COUNT - 1)));
+		if (heap->mm_slbitmap[MM_NDX2NODE(ndx)] == 0) {
+			heap->mm_flbitmap &= ~((uint32_t)1 << MM_NDX2NODE(ndx));
+		}
+	}
+}
+#endif
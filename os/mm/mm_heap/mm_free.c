@@ -79,73 +79,21 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: mm_free
+ * Name: mm_freechunk
  *
  * Description:
- *   Returns a chunk of memory to the list of free nodes,  merging with
- *   adjacent free chunks if possible.
+ *   Return an allocated chunk to the list of free nodes, merging with
+ *   adjacent free chunks if possible.  No heapinfo accounting is done here.
+ *   It is assumed that the caller holds the mm semaphore.
  *
  ****************************************************************************/
-void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
+
+void mm_freechunk(FAR struct mm_heap_s *heap, FAR struct mm_allocnode_s *chunk)
 {
-	FAR struct mm_freenode_s *node;
+	FAR struct mm_freenode_s *node = (FAR struct mm_freenode_s *)chunk;
 	FAR struct mm_freenode_s *prev;
 	FAR struct mm_freenode_s *next;
-#ifdef CONFIG_DEBUG_MM_HEAPINFO
-	struct mm_allocnode_s *alloc_node;
-#endif
-
-	mvdbg("Freeing %p\n", mem);
-
-	/* Protect against attempts to free a NULL reference */
-
-	if (!mem) {
-#ifdef CONFIG_DEBUG_DOUBLE_FREE
-		/* Though it's permitted to attempt for releasing a NULL
-		 * reference in C, it would be good to catch those cases
-		 * atleast in DEBUG MODE as there is no logical reason to
-		 * release a NULL reference.
-		 * It can be a logical bug in sw to make an attempt of double free!
-		 * free(ptr); ptr = NULL; free(ptr);
-		 */
-		dbg("Attempt to release a null pointer\n");
-#endif
-		return;
-	}
 
-	/* We need to hold the MM semaphore while we muck with the
-	 * nodelist.
-	 */
-
-	mm_takesemaphore(heap);
-
-	/* Map the memory chunk into a free node */
-
-	node = (FAR struct mm_freenode_s *)((char *)mem - SIZEOF_MM_ALLOCNODE);
-#ifdef CONFIG_DEBUG_DOUBLE_FREE
-	/* Assert on following logical error scenarios
-	 * 1) Attempt to free an unallocated memory or
-	 * 2) Attempt to release some arbitrary memory or
-	 * 3) Attempt to release already released memory ( double free )
-	 * Catch this bug and report to USER in debug mode
-	 * 1st scenario: int *ptr; free(ptr);
-	 * 2nd scenario: int *ptr = (int*)0x02069f50; free(ptr);
-	 * 3rd scenario: ptr = malloc(100); free(ptr); if(ptr) { free(ptr); }
-	 */
-	if ((node->preceding & MM_ALLOC_BIT) != MM_ALLOC_BIT) {
-		dbg("Attempt for double freeing a pointer or releasing an unallocated pointer\n");
-		PANIC();
-	}
-
-#endif
-#ifdef CONFIG_DEBUG_MM_HEAPINFO
-	alloc_node = (struct mm_allocnode_s *)node;
-
-	if ((alloc_node->preceding & MM_ALLOC_BIT) != 0) {
-		heapinfo_subtract_size(heap, alloc_node->pid, alloc_node->size);
-		heapinfo_update_total_size(heap, ((-1) * alloc_node->size), alloc_node->pid);
-	}
-#endif
 	node->preceding &= ~MM_ALLOC_BIT;
 
 	/* Check if the following node is free and, if so, merge it */
@@ -165,7 +113,7 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 		 * but there may not be a successor node.
 		 */
 
-		REMOVE_NODE_FROM_LIST(next);
+		REMOVE_NODE_FROM_LIST(heap, next);
 
 		/* Then merge the two chunks */
 
@@ -184,7 +132,7 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 		 * not be a successor node.
 		 */
 
-		REMOVE_NODE_FROM_LIST(prev);
+		REMOVE_NODE_FROM_LIST(heap, prev);
 
 		/* Then merge the two chunks */
 
@@ -196,5 +144,80 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 	/* Add the merged node to the nodelist */
 
 	mm_addfreechunk(heap, node);
+}
+
+/****************************************************************************
+ * Name: mm_free
+ *
+ * Description:
+ *   Returns a chunk of memory to the list of free nodes,  merging with
+ *   adjacent free chunks if possible.
+ *
+ ****************************************************************************/
+void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+	FAR struct mm_allocnode_s *node;
+
+	mvdbg("Freeing %p\n", mem);
+
+	/* Protect against attempts to free a NULL reference */
+
+	if (!mem) {
+#ifdef CONFIG_DEBUG_DOUBLE_FREE
+		/* Though it's permitted to attempt for releasing a NULL
+		 * reference in C, it would be good to catch those cases
+		 * atleast in DEBUG MODE as there is no logical reason to
+		 * release a NULL reference.
+		 * It can be a logical bug in sw to make an attempt of double free!
+		 * free(ptr); ptr = NULL; free(ptr);
+		 */
+		dbg("Attempt to release a null pointer\n");
+#endif
+		return;
+	}
+
+#ifdef CONFIG_MM_SMALLCACHE
+	/* Chunks of one of the small-object cache sizes are kept in the cache
+	 * without taking the MM semaphore.
+	 */
+
+	if (mm_smallcache_free(heap, mem)) {
+		return;
+	}
+#endif
+
+	/* We need to hold the MM semaphore while we muck with the
+	 * nodelist.
+	 */
+
+	mm_takesemaphore(heap);
+
+	/* Map the memory chunk into a free node */
+
+	node = (FAR struct mm_allocnode_s *)((char *)mem - SIZEOF_MM_ALLOCNODE);
+#ifdef CONFIG_DEBUG_DOUBLE_FREE
+	/* Assert on following logical error scenarios
+	 * 1) Attempt to free an unallocated memory or
+	 * 2) Attempt to release some arbitrary memory or
+	 * 3) Attempt to release already released memory ( double free )
+	 * Catch this bug and report to USER in debug mode
+	 * 1st scenario: int *ptr; free(ptr);
+	 * 2nd scenario: int *ptr = (int*)0x02069f50; free(ptr);
+	 * 3rd scenario: ptr = malloc(100); free(ptr); if(ptr) { free(ptr); }
+	 */
+	if ((node->preceding & MM_ALLOC_BIT) != MM_ALLOC_BIT) {
+		dbg("Attempt for double freeing a pointer or releasing an unallocated pointer\n");
+		PANIC();
+	}
+
+#endif
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+	if ((node->preceding & MM_ALLOC_BIT) != 0) {
+		heapinfo_subtract_size(heap, node->pid, node->size);
+		heapinfo_update_total_size(heap, ((-1) * node->size), node->pid);
+	}
+#endif
+
+	mm_freechunk(heap, node);
 	mm_givesemaphore(heap);
 }
@@ -56,6 +56,7 @@
 #include <tinyara/sched.h>
 #include <tinyara/mm/mm.h>
 #include <tinyara/arch.h>
+#include <tinyara/irq.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -70,6 +71,18 @@
 #define HEAPINFO_INT INT16_MAX
 #define HEAPINFO_NONSCHED (INT16_MAX - 1)
 
+/* The small-object cache accounts its chunks without holding the MM
+ * semaphore, so the counters are then updated with interrupts masked.
+ */
+
+#ifdef CONFIG_MM_SMALLCACHE
+#define heapinfo_lock()           irqsave()
+#define heapinfo_unlock(flags)    irqrestore(flags)
+#else
+#define heapinfo_lock()           0
+#define heapinfo_unlock(flags)    (void)(flags)
+#endif
+
 #ifdef CONFIG_HEAPINFO_USER_GROUP
 int max_group;
 struct heapinfo_group_s heapinfo_group[HEAPINFO_USER_GROUP_NUM];
@@ -100,6 +113,10 @@ void heapinfo_parse(FAR struct mm_heap_s *heap, int mode, pid_t pid)
 	size_t heap_resource;
 	size_t stack_resource;
 	size_t nonsched_resource;
+#ifdef CONFIG_MM_SMALLCACHE
+	size_t cache_resource;
+	uint32_t cache_reqs;
+#endif
 	int nonsched_idx;
 	struct sched_param sched_data;
 	size_t heap_size;
@@ -114,8 +131,10 @@ void heapinfo_parse(FAR struct mm_heap_s *heap, int mode, pid_t pid)
 #define region 0
 #endif
 
-#ifdef CONFIG_DEBUG_CHECK_FRAGMENTATION
+#if defined(CONFIG_DEBUG_CHECK_FRAGMENTATION) || defined(CONFIG_MM_SMALLCACHE)
 	int ndx;
+#endif
+#ifdef CONFIG_DEBUG_CHECK_FRAGMENTATION
 	int nodelist_cnt[MM_NNODES] = {0, };
 	size_t nodelist_size[MM_NNODES] = {0, };
 	FAR struct mm_freenode_s *fnode;
@@ -123,6 +142,9 @@ void heapinfo_parse(FAR struct mm_heap_s *heap, int mode, pid_t pid)
 
 	/* initialize the heap, stack and nonsched resource */
 	nonsched_resource = 0;
+#ifdef CONFIG_MM_SMALLCACHE
+	cache_resource = 0;
+#endif
 	heap_resource = 0;
 	stack_resource = 0;
 	for (nonsched_idx = 0; nonsched_idx < CONFIG_MAX_TASKS; nonsched_idx++) {
@@ -158,6 +180,11 @@ void heapinfo_parse(FAR struct mm_heap_s *heap, int mode, pid_t pid)
 			/* Check if the node corresponds to an allocated memory chunk */
 			if ((pid == HEAPINFO_PID_ALL || node->pid == pid) && (node->preceding & MM_ALLOC_BIT) != 0) {
 				if (mode == HEAPINFO_DETAIL_ALL || mode == HEAPINFO_DETAIL_PID || mode == HEAPINFO_DETAIL_SPECIFIC_HEAP) {
+#ifdef CONFIG_MM_SMALLCACHE
+					if (node->pid == HEAPINFO_CACHED) {
+						printf("0x%x | %8u |   %c    |            |       |\n", node, node->size, 'C');
+					} else
+#endif
 					if (node->pid >= 0) {
 						printf("0x%x | %8u |   %c    | 0x%8x | %3d   |\n", node, node->size, 'A', node->alloc_call_addr, node->pid);
 					} else {
@@ -168,6 +195,10 @@ void heapinfo_parse(FAR struct mm_heap_s *heap, int mode, pid_t pid)
 #if CONFIG_TASK_NAME_SIZE > 0
 				if (node->pid == HEAPINFO_INT && mode != HEAPINFO_SIMPLE) {
 					printf("INT Context\n");
+#ifdef CONFIG_MM_SMALLCACHE
+				} else if (node->pid == HEAPINFO_CACHED) {
+					cache_resource += node->size;
+#endif
 				} else if (node->pid < 0 && sched_getparam((-1) * (node->pid), &sched_data) != ERROR) {
 					stack_resource += node->size;
 				} else if (sched_getparam(node->pid, &sched_data) == ERROR) {
@@ -242,27 +273,44 @@ void heapinfo_parse(FAR struct mm_heap_s *heap, int mode, pid_t pid)
 	printf("        - Sum of \"STACK\"(**) (2)      : %u\n", stack_resource);
 	printf("        - Sum of \"CURR_HEAP\" (3)      : %u\n", heap_resource - SIZEOF_MM_ALLOCNODE);	// Because of above for loop (node < heap->mm_heapend[region];),
 													// one of SIZEOF_MM_ALLOCNODE is subtracted.
+#ifdef CONFIG_MM_SMALLCACHE
+	printf("  - Held by Small-object Cache        : %u\n", cache_resource);
+#endif
 	printf("** NOTE **\n");
 	printf("(*)  Alive allocation by dead threads might be used by others or might be a leakage.\n");
 	printf("(**) Only Idle task has a separate stack region,\n");
 	printf("  rest are all allocated on the heap region.\n");
 
+#ifdef CONFIG_MM_SMALLCACHE
+	printf("\n< Small-object Cache >\n");
+	printf(" Size | Cached |    Hits    |   Misses   | Drains | Hit Rate\n");
+	printf("------|--------|------------|------------|--------|---------\n");
+	for (ndx = 0; ndx < MM_SMALLCACHE_NCLASSES; ndx++) {
+		cache_reqs = heap->mm_smallcache[ndx].hits + heap->mm_smallcache[ndx].misses;
+		printf(" %4u | %6u | %10u | %10u | %6u | %6u%%\n", MM_SMALLCACHE_MINSIZE << ndx, heap->mm_smallcache[ndx].count, heap->mm_smallcache[ndx].hits, heap->mm_smallcache[ndx].misses, heap->mm_smallcache[ndx].drains, cache_reqs ? (uint32_t)((uint64_t)heap->mm_smallcache[ndx].hits * 100 / cache_reqs) : 0);
+	}
+#endif
+
 #ifdef CONFIG_DEBUG_CHECK_FRAGMENTATION
 	printf("\nAvailable fragmented memory segments in heap memory\n");
 
 	mm_takesemaphore(heap);
 
-	for (ndx = 0; ndx < MM_NNODES; ++ndx) {
+	for (ndx = 0; ndx < MM_NFREELISTS; ++ndx) {
 		for (fnode = heap->mm_nodelist[ndx].flink; fnode && fnode->size; fnode = fnode->flink) {
-			++nodelist_cnt[ndx];
-			nodelist_size[ndx] += fnode->size;
+			++nodelist_cnt[MM_NDX2NODE(ndx)];
+			nodelist_size[MM_NDX2NODE(ndx)] += fnode->size;
 		}
 	}
 
 	mm_givesemaphore(heap);
 
 	for (ndx = 0; ndx < MM_NNODES; ++ndx) {
+#ifdef CONFIG_MM_ALLOC_TLSF
+		printf("Nodelist[%d] ranging [%u, %u[ : num %d, size %u [Bytes]\n", ndx, 1 << (ndx + MM_MIN_SHIFT), 1 << (ndx + MM_MIN_SHIFT + 1), nodelist_cnt[ndx], nodelist_size[ndx]);
+#else
 		printf("Nodelist[%d] ranging [%u, %u] : num %d, size %u [Bytes]\n", ndx, ((ndx > 0 ? (1 << (ndx + MM_MIN_SHIFT)) : 0) + 1), 1 << (ndx + MM_MIN_SHIFT + 1), nodelist_cnt[ndx], nodelist_size[ndx]);
+#endif
 	}
 #endif
 
@@ -321,8 +369,10 @@ static void heapinfo_update_group(mmsize_t size, pid_t pid)
 void heapinfo_add_size(struct mm_heap_s *heap, pid_t pid, mmsize_t size)
 {
 	pid_t hash_pid;
+	irqstate_t flags;
 
 	hash_pid = PIDHASH(pid);
+	flags = heapinfo_lock();
 	if (heap->alloc_list[hash_pid].pid == HEAPINFO_INIT_INFO || heap->alloc_list[hash_pid].pid == pid) {
 			heap->alloc_list[hash_pid].pid = pid;
 			heap->alloc_list[hash_pid].curr_alloc_size += size;
@@ -331,6 +381,7 @@ void heapinfo_add_size(struct mm_heap_s *heap, pid_t pid, mmsize_t size)
 			}
 			heap->alloc_list[hash_pid].num_alloc_free++;
 	}
+	heapinfo_unlock(flags);
 }
 
 /****************************************************************************
@@ -342,12 +393,15 @@ void heapinfo_add_size(struct mm_heap_s *heap, pid_t pid, mmsize_t size)
 void heapinfo_subtract_size(struct mm_heap_s *heap, pid_t pid, mmsize_t size)
 {
 	pid_t hash_pid;
+	irqstate_t flags;
 
 	hash_pid = PIDHASH(pid);
+	flags = heapinfo_lock();
 	if (heap->alloc_list[hash_pid].pid == pid) {
 			heap->alloc_list[hash_pid].curr_alloc_size -= size;
 			heap->alloc_list[hash_pid].num_alloc_free--;
 	}
+	heapinfo_unlock(flags);
 }
 
 /****************************************************************************
@@ -358,6 +412,8 @@ void heapinfo_subtract_size(struct mm_heap_s *heap, pid_t pid, mmsize_t size)
  ****************************************************************************/
 void heapinfo_update_total_size(struct mm_heap_s *heap, mmsize_t size, pid_t pid)
 {
+	irqstate_t flags = heapinfo_lock();
+
 	heap->total_alloc_size += size;
 	if (heap->total_alloc_size > heap->peak_alloc_size) {
 		heap->peak_alloc_size = heap->total_alloc_size;
@@ -371,6 +427,7 @@ void heapinfo_update_total_size(struct mm_heap_s *heap, mmsize_t size, pid_t pid
 #ifdef CONFIG_HEAPINFO_USER_GROUP
 	heapinfo_update_group(size, pid);
 #endif
+	heapinfo_unlock(flags);
 }
 /****************************************************************************
  * Name: heapinfo_update_node
@@ -220,7 +220,14 @@ void mm_initialize(FAR struct mm_heap_s *heap, FAR void *heapstart, size_t heaps
 
 	/* Initialize the node array */
 
-	memset(heap->mm_nodelist, 0, sizeof(struct mm_freenode_s) * (MM_NNODES + 1));
+	memset(heap->mm_nodelist, 0, sizeof(struct mm_freenode_s) * (MM_NFREELISTS + 1));
+#ifdef CONFIG_MM_ALLOC_TLSF
+	heap->mm_flbitmap = 0;
+	memset(heap->mm_slbitmap, 0, sizeof(heap->mm_slbitmap));
+#endif
+#ifdef CONFIG_MM_SMALLCACHE
+	memset(heap->mm_smallcache, 0, sizeof(heap->mm_smallcache));
+#endif
 
 	/* Initialize the malloc semaphore to one (to support one-at-
 	 * a-time access to private data sets).
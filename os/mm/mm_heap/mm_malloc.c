@@ -89,53 +89,85 @@
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_MM_ALLOC_TLSF
 /****************************************************************************
- * Public Functions
- ****************************************************************************/
-
-/****************************************************************************
- * Name: mm_malloc
+ * Name: mm_findfreechunk
  *
  * Description:
- *  Find the smallest chunk that satisfies the request. Take the memory from
- *  that chunk, save the remaining, smaller chunk (if any).
- *
- *  8-byte alignment of the allocated data is assured.
+ *  Find a free chunk of at least 'size' bytes using the two-level bitmap.
+ *  The search starts at the first class whose chunks are all large enough
+ *  and takes the head of the first non-empty list at or above it, so no
+ *  list is walked except the unbounded last one.  It is assumed that the
+ *  caller holds the mm semaphore.
  *
  ****************************************************************************/
-#ifdef CONFIG_DEBUG_MM_HEAPINFO
-FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size, mmaddress_t caller_retaddr)
-#else
-FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
-#endif
+
+static FAR struct mm_freenode_s *mm_findfreechunk(FAR struct mm_heap_s *heap, size_t size)
 {
 	FAR struct mm_freenode_s *node;
-	void *ret = NULL;
+	uint32_t slmap;
+	uint32_t flmap;
 	int ndx;
+	int fl;
 
-	/* Handle bad sizes */
+	ndx = mm_size2ndx_ceil(size);
+	fl = MM_NDX2NODE(ndx);
 
-	if (size < 1) {
-		return NULL;
+	slmap = heap->mm_slbitmap[fl] & ((uint32_t)~0 << (ndx & (MM_SLI_COUNT - 1)));
+	if (!slmap) {
+		flmap = heap->mm_flbitmap & ((uint32_t)~0 << (fl + 1));
+		if (!flmap) {
+			return NULL;
+		}
+
+		fl = mm_ffs(flmap);
+		slmap = heap->mm_slbitmap[fl];
 	}
 
-	if (size > MM_ALIGN_DOWN(MMSIZE_MAX) - SIZEOF_MM_ALLOCNODE) {
-		mdbg("Because of mm_allocnode, %u cannot be allocated. The maximum \
-			 allocable size is (MM_ALIGN_DOWN(MMSIZE_MAX) - SIZEOF_MM_ALLOCNODE) \
-			 : %u\n.", size, (MM_ALIGN_DOWN(MMSIZE_MAX) - SIZEOF_MM_ALLOCNODE));
-		return NULL;
+	node = heap->mm_nodelist[(fl << MM_SLI_SHIFT) + mm_ffs(slmap)].flink;
+
+	/* Only the last list can hold chunks smaller than the request */
+
+	while (node && node->size < size) {
+		node = node->flink;
 	}
 
-	/* Adjust the size to account for (1) the size of the allocated node and
-	 * (2) to make sure that it is an even multiple of our granule size.
-	 */
+	return node;
+}
+#endif
 
-	size = MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE);
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
 
-	/* We need to hold the MM semaphore while we muck with the nodelist. */
+/****************************************************************************
+ * Name: mm_allocchunk
+ *
+ * Description:
+ *  Find the smallest free chunk of at least 'size' bytes, remove it from
+ *  the nodelist, split off and return the remainder (if any) and mark the
+ *  chunk as allocated.  'size' must already include SIZEOF_MM_ALLOCNODE and
+ *  be aligned to MM_MIN_CHUNK.  No heapinfo accounting is done here.  It
+ *  is assumed that the caller holds the mm semaphore.
+ *
+ ****************************************************************************/
 
-	mm_takesemaphore(heap);
+FAR struct mm_allocnode_s *mm_allocchunk(FAR struct mm_heap_s *heap, size_t size)
+{
+	FAR struct mm_freenode_s *node;
+	FAR struct mm_freenode_s *remainder;
+	FAR struct mm_freenode_s *next;
+	size_t remaining;
+#ifndef CONFIG_MM_ALLOC_TLSF
+	int ndx;
+#endif
 
+#ifdef CONFIG_MM_ALLOC_TLSF
+	node = mm_findfreechunk(heap, size);
+	if (!node) {
+		return NULL;
+	}
+#else
 	/* Get the location in the node list to start the search
 	 * by converting the request size into a nodelist index.
 	 */
@@ -165,59 +197,134 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 	 * available.
 	 */
 
-	if (node->size) {
-		FAR struct mm_freenode_s *remainder;
-		FAR struct mm_freenode_s *next;
-		size_t remaining;
+	if (!node->size) {
+		return NULL;
+	}
+#endif
 
-		/* Remove the node.  There must be a predecessor, but there may not be
-		 * a successor node.
-		 */
+	/* Remove the node.  There must be a predecessor, but there may not be
+	 * a successor node.
+	 */
+
+	REMOVE_NODE_FROM_LIST(heap, node);
 
-		REMOVE_NODE_FROM_LIST(node);
+	/* Check if we have to split the free node into one of the allocated
+	 * size and another smaller freenode.  In some cases, the remaining
+	 * bytes can be smaller (they may be SIZEOF_MM_ALLOCNODE).  In that
+	 * case, we will just carry the few wasted bytes at the end of the
+	 * allocation.
+	 */
 
-		/* Check if we have to split the free node into one of the allocated
-		 * size and another smaller freenode.  In some cases, the remaining
-		 * bytes can be smaller (they may be SIZEOF_MM_ALLOCNODE).  In that
-		 * case, we will just carry the few wasted bytes at the end of the
-		 * allocation.
+	remaining = node->size - size;
+	if (remaining >= SIZEOF_MM_FREENODE) {
+		/* Get a pointer to the next node in physical memory */
+
+		next = (FAR struct mm_freenode_s *)(((char *)node) + node->size);
+
+		/* Create the remainder node */
+
+		remainder = (FAR struct mm_freenode_s *)(((char *)node) + size);
+		remainder->size = remaining;
+		remainder->preceding = size;
+
+		/* Adjust the size of the node under consideration */
+
+		node->size = size;
+
+		/* Adjust the 'preceding' size of the (old) next node, preserving
+		 * the allocated flag.
 		 */
 
-		remaining = node->size - size;
-		if (remaining >= SIZEOF_MM_FREENODE) {
-			/* Get a pointer to the next node in physical memory */
+		next->preceding = remaining | (next->preceding & MM_ALLOC_BIT);
 
-			next = (FAR struct mm_freenode_s *)(((char *)node) + node->size);
+		/* Add the remainder back into the nodelist */
 
-			/* Create the remainder node */
+		mm_addfreechunk(heap, remainder);
+	}
 
-			remainder = (FAR struct mm_freenode_s *)(((char *)node) + size);
-			remainder->size = remaining;
-			remainder->preceding = size;
+	/* Handle the case of an exact size match */
 
-			/* Adjust the size of the node under consideration */
+	node->preceding |= MM_ALLOC_BIT;
 
-			node->size = size;
+	return (FAR struct mm_allocnode_s *)node;
+}
 
-			/* Adjust the 'preceding' size of the (old) next node, preserving
-			 * the allocated flag.
-			 */
+/****************************************************************************
+ * Name: mm_malloc
+ *
+ * Description:
+ *  Find the smallest chunk that satisfies the request. Take the memory from
+ *  that chunk, save the remaining, smaller chunk (if any).
+ *
+ *  8-byte alignment of the allocated data is assured.
+ *
+ ****************************************************************************/
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size, mmaddress_t caller_retaddr)
+#else
+FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+#endif
+{
+	FAR struct mm_allocnode_s *node;
+	void *ret = NULL;
 
-			next->preceding = remaining | (next->preceding & MM_ALLOC_BIT);
+	/* Handle bad sizes */
 
-			/* Add the remainder back into the nodelist */
+	if (size < 1) {
+		return NULL;
+	}
 
-			mm_addfreechunk(heap, remainder);
+	if (size > MM_ALIGN_DOWN(MMSIZE_MAX) - SIZEOF_MM_ALLOCNODE) {
+		mdbg("Because of mm_allocnode, %u cannot be allocated. The maximum \
+			 allocable size is (MM_ALIGN_DOWN(MMSIZE_MAX) - SIZEOF_MM_ALLOCNODE) \
+			 : %u\n.", size, (MM_ALIGN_DOWN(MMSIZE_MAX) - SIZEOF_MM_ALLOCNODE));
+		return NULL;
+	}
+
+#ifdef CONFIG_MM_SMALLCACHE
+	/* Small requests are served from the per-heap small-object cache
+	 * without taking the MM semaphore when possible.
+	 */
+
+	if (size <= MM_SMALLCACHE_MAXSIZE) {
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+		ret = mm_smallcache_alloc(heap, size, caller_retaddr);
+#else
+		ret = mm_smallcache_alloc(heap, size);
+#endif
+		if (ret) {
+			return ret;
 		}
+	}
+#endif
 
-		/* Handle the case of an exact size match */
+	/* Adjust the size to account for (1) the size of the allocated node and
+	 * (2) to make sure that it is an even multiple of our granule size.
+	 */
+
+	size = MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE);
+
+	/* We need to hold the MM semaphore while we muck with the nodelist. */
 
-		node->preceding |= MM_ALLOC_BIT;
+	mm_takesemaphore(heap);
+
+	node = mm_allocchunk(heap, size);
+
+#ifdef CONFIG_MM_SMALLCACHE
+	/* The chunks held by the small-object cache may be what prevents this
+	 * allocation.  Give them back to the heap and try once more.
+	 */
+
+	if (!node && mm_smallcache_flush(heap) > 0) {
+		node = mm_allocchunk(heap, size);
+	}
+#endif
 
+	if (node) {
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
-		heapinfo_update_node((struct mm_allocnode_s *)node, caller_retaddr);
-		heapinfo_add_size(heap, ((struct mm_allocnode_s *)node)->pid, node->size);
-		heapinfo_update_total_size(heap, node->size, ((struct mm_allocnode_s *)node)->pid);
+		heapinfo_update_node(node, caller_retaddr);
+		heapinfo_add_size(heap, node->pid, node->size);
+		heapinfo_update_total_size(heap, node->size, node->pid);
 #endif
 		ret = (void *)((char *)node + SIZEOF_MM_ALLOCNODE);
 	}
@@ -23,13 +23,21 @@
  * Included Files
  ****************************************************************************/
 
+#include <tinyara/config.h>
+
+#include <stdint.h>
 #include <assert.h>
 
+#include <tinyara/mm/mm.h>
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
-#define REMOVE_NODE_FROM_LIST(node)				\
+#ifdef CONFIG_MM_ALLOC_TLSF
+#define REMOVE_NODE_FROM_LIST(heap, node) mm_removefreechunk(heap, node)
+#else
+#define REMOVE_NODE_FROM_LIST(heap, node)			\
 	do {							\
 		DEBUGASSERT((node)->blink);			\
 		(node)->blink->flink = (node)->flink;		\
@@ -37,6 +45,40 @@
 			(node)->flink->blink = (node)->blink;	\
 		}						\
 	} while (0)
+#endif
+
+/* Bit scan helpers for the TLSF bitmaps.  mm_ffs() returns the index of the
+ * least significant set bit and mm_fls() the index of the most significant
+ * set bit.  The argument must not be zero.
+ */
+
+#ifdef CONFIG_MM_ALLOC_TLSF
+#ifdef __GNUC__
+#define mm_ffs(x) __builtin_ctz(x)
+#define mm_fls(x) (31 - __builtin_clz(x))
+#else
+static inline int mm_ffs(uint32_t x)
+{
+	int bit = 0;
+
+	while (!(x & 1)) {
+		x >>= 1;
+		bit++;
+	}
+	return bit;
+}
+
+static inline int mm_fls(uint32_t x)
+{
+	int bit = 0;
+
+	while (x >>= 1) {
+		bit++;
+	}
+	return bit;
+}
+#endif
+#endif
 
 /****************************************************************************
  * Public Functions
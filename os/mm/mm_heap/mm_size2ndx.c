@@ -58,6 +58,8 @@
 
 #include <tinyara/mm/mm.h>
 
+#include "mm_node.h"
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -66,6 +68,58 @@
  * Public Functions
  ****************************************************************************/
 
+#ifdef CONFIG_MM_ALLOC_TLSF
+/****************************************************************************
+ * Name: mm_size2ndx
+ *
+ * Description:
+ *    Convert the size of a free chunk to the index of the segregated free
+ *    list that holds it.  The first-level class is the position of the
+ *    most significant bit and the second-level class is given by the next
+ *    MM_SLI_SHIFT bits, so every chunk in mm_nodelist[ndx] is in the range
+ *    [class base, next class base[.  Chunks of MM_MAX_CHUNK * 2 or more
+ *    all go to the last list.
+ *
+ ****************************************************************************/
+
+int mm_size2ndx(size_t size)
+{
+	int fl;
+	int sl;
+
+	if ((size >> (MM_MAX_SHIFT + 1)) >= 1) {
+		return MM_NFREELISTS - 1;
+	}
+
+	fl = mm_fls(size);
+	sl = (size >> (fl - MM_SLI_SHIFT)) - MM_SLI_COUNT;
+
+	return ((fl - MM_MIN_SHIFT) << MM_SLI_SHIFT) + sl;
+}
+
+/****************************************************************************
+ * Name: mm_size2ndx_ceil
+ *
+ * Description:
+ *    Convert an allocation request size to the index of the first free list
+ *    whose chunks are all large enough to satisfy it.  This is the index
+ *    for size rounded up to the next second-level class boundary.  The
+ *    last list is the exception: it is not bounded above, so the caller
+ *    must check the size of the chunks found there.
+ *
+ ****************************************************************************/
+
+int mm_size2ndx_ceil(size_t size)
+{
+	if ((size >> (MM_MAX_SHIFT + 1)) >= 1) {
+		return MM_NFREELISTS - 1;
+	}
+
+	size += ((size_t)1 << (mm_fls(size) - MM_SLI_SHIFT)) - 1;
+
+	return mm_size2ndx(size);
+}
+#else
 /****************************************************************************
  * Name: mm_size2ndx
  *
@@ -104,3 +158,4 @@ int mm_size2ndx(size_t size)
 		return ndx;
 	}
 }
+#endif
@@ -0,0 +1,334 @@
+/****************************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * mm/mm_heap/mm_smallcache.c
+ *
+ * A small-object cache in front of the heap.  Freed chunks of one of
+ * MM_SMALLCACHE_NCLASSES fixed sizes are kept in a per-heap, per-class
+ * list instead of being returned to the nodelist.  Small allocations pop a
+ * chunk from that list, so the common path only masks interrupts for a few
+ * instructions and never waits on the MM semaphore.  The lists are filled
+ * from and drained to the heap in batches of CONFIG_MM_SMALLCACHE_BATCH
+ * chunks under a single hold of the semaphore.
+ *
+ * Cached chunks stay marked as allocated in the heap.  With
+ * CONFIG_DEBUG_MM_HEAPINFO they are not accounted to any task; their pid
+ * is set to HEAPINFO_CACHED.  The heapinfo counters mask interrupts when
+ * the cache is enabled, so the fast paths do not take the semaphore for
+ * the accounting either.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdbool.h>
+#include <debug.h>
+
+#include <tinyara/irq.h>
+#include <tinyara/mm/mm.h>
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_smallcache_size2ndx
+ *
+ * Description:
+ *   Return the cache class that serves requests of 'size' bytes.
+ *
+ ****************************************************************************/
+
+static int mm_smallcache_size2ndx(size_t size)
+{
+	int ndx;
+
+	for (ndx = 0; ndx < MM_SMALLCACHE_NCLASSES; ndx++) {
+		if (size <= (MM_SMALLCACHE_MINSIZE << ndx)) {
+			return ndx;
+		}
+	}
+
+	return -1;
+}
+
+/****************************************************************************
+ * Name: mm_smallcache_chunk2ndx
+ *
+ * Description:
+ *   Return the cache class of a chunk of 'size' bytes (including the
+ *   allocnode), or -1 if chunks of that size are not cached.
+ *
+ ****************************************************************************/
+
+static int mm_smallcache_chunk2ndx(size_t size)
+{
+	int ndx;
+
+	for (ndx = 0; ndx < MM_SMALLCACHE_NCLASSES; ndx++) {
+		if (size == MM_SMALLCACHE_CHUNK(ndx)) {
+			return ndx;
+		}
+	}
+
+	return -1;
+}
+
+/****************************************************************************
+ * Name: mm_smallcache_release
+ *
+ * Description:
+ *   Return a detached list of cached chunks to the heap.
+ *
+ ****************************************************************************/
+
+static int mm_smallcache_release(FAR struct mm_heap_s *heap, FAR void *list)
+{
+	FAR void *next;
+	int count = 0;
+
+	mm_takesemaphore(heap);
+
+	while (list) {
+		next = *(FAR void **)list;
+		mm_freechunk(heap, (FAR struct mm_allocnode_s *)((FAR char *)list - SIZEOF_MM_ALLOCNODE));
+		list = next;
+		count++;
+	}
+
+	mm_givesemaphore(heap);
+	return count;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_smallcache_alloc
+ *
+ * Description:
+ *   Allocate a chunk for a request of up to MM_SMALLCACHE_MAXSIZE bytes
+ *   from the small-object cache.  If the cache class is empty, one batch of
+ *   chunks is taken from the heap: the first is returned and the rest are
+ *   kept in the cache.
+ *
+ * Return Value:
+ *   The allocated memory, or NULL if the heap cannot supply the chunk.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+FAR void *mm_smallcache_alloc(FAR struct mm_heap_s *heap, size_t size, mmaddress_t caller_retaddr)
+#else
+FAR void *mm_smallcache_alloc(FAR struct mm_heap_s *heap, size_t size)
+#endif
+{
+	FAR struct mm_smallcache_s *cache;
+	FAR struct mm_allocnode_s *node;
+	FAR void *list = NULL;
+	FAR void *tail = NULL;
+	FAR void *mem;
+	irqstate_t flags;
+	int count;
+	int ndx;
+
+	ndx = mm_smallcache_size2ndx(size);
+	if (ndx < 0) {
+		return NULL;
+	}
+
+	cache = &heap->mm_smallcache[ndx];
+
+	/* Fast path: pop the head of the class list */
+
+	flags = irqsave();
+	mem = cache->head;
+	if (mem) {
+		cache->head = *(FAR void **)mem;
+		cache->count--;
+		cache->hits++;
+		irqrestore(flags);
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+		node = (FAR struct mm_allocnode_s *)((FAR char *)mem - SIZEOF_MM_ALLOCNODE);
+		heapinfo_update_node(node, caller_retaddr);
+		heapinfo_add_size(heap, node->pid, node->size);
+		heapinfo_update_total_size(heap, node->size, node->pid);
+#endif
+		return mem;
+	}
+
+	cache->misses++;
+	irqrestore(flags);
+
+	/* Slow path: take one batch of chunks from the heap */
+
+	mm_takesemaphore(heap);
+
+	node = mm_allocchunk(heap, MM_SMALLCACHE_CHUNK(ndx));
+	if (!node) {
+		mm_givesemaphore(heap);
+		return NULL;
+	}
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+	heapinfo_update_node(node, caller_retaddr);
+	heapinfo_add_size(heap, node->pid, node->size);
+	heapinfo_update_total_size(heap, node->size, node->pid);
+#endif
+	mem = (FAR char *)node + SIZEOF_MM_ALLOCNODE;
+
+	for (count = 1; count < CONFIG_MM_SMALLCACHE_BATCH; count++) {
+		node = mm_allocchunk(heap, MM_SMALLCACHE_CHUNK(ndx));
+		if (!node) {
+			break;
+		}
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+		node->pid = HEAPINFO_CACHED;
+		node->alloc_call_addr = 0;
+#endif
+		if (!tail) {
+			tail = (FAR char *)node + SIZEOF_MM_ALLOCNODE;
+		}
+
+		*(FAR void **)((FAR char *)node + SIZEOF_MM_ALLOCNODE) = list;
+		list = (FAR char *)node + SIZEOF_MM_ALLOCNODE;
+	}
+
+	mm_givesemaphore(heap);
+
+	/* Splice the rest of the batch into the class list */
+
+	if (list) {
+		flags = irqsave();
+		*(FAR void **)tail = cache->head;
+		cache->head = list;
+		cache->count += count - 1;
+		irqrestore(flags);
+	}
+
+	return mem;
+}
+
+/****************************************************************************
+ * Name: mm_smallcache_free
+ *
+ * Description:
+ *   Keep a freed chunk in the small-object cache if it has one of the
+ *   cached sizes.  When a class holds more than CONFIG_MM_SMALLCACHE_DEPTH
+ *   chunks, one batch of them is returned to the heap.
+ *
+ * Return Value:
+ *   true if the chunk was taken by the cache, false if the caller must
+ *   return it to the heap.
+ *
+ ****************************************************************************/
+
+bool mm_smallcache_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+	FAR struct mm_smallcache_s *cache;
+	FAR struct mm_allocnode_s *node;
+	FAR void *list = NULL;
+	FAR void *last;
+	irqstate_t flags;
+	int count;
+	int ndx;
+
+	node = (FAR struct mm_allocnode_s *)((FAR char *)mem - SIZEOF_MM_ALLOCNODE);
+	ndx = mm_smallcache_chunk2ndx(node->size);
+	if (ndx < 0) {
+		return false;
+	}
+
+	cache = &heap->mm_smallcache[ndx];
+
+#ifdef CONFIG_DEBUG_MM_HEAPINFO
+	heapinfo_subtract_size(heap, node->pid, node->size);
+	heapinfo_update_total_size(heap, ((-1) * node->size), node->pid);
+	node->pid = HEAPINFO_CACHED;
+#endif
+
+	flags = irqsave();
+	*(FAR void **)mem = cache->head;
+	cache->head = mem;
+	cache->count++;
+
+	/* If the list is overfull, detach one batch from its head.  The walk
+	 * is bounded by the batch size.
+	 */
+
+	if (cache->count > CONFIG_MM_SMALLCACHE_DEPTH) {
+		list = cache->head;
+		last = list;
+		for (count = 1; count < CONFIG_MM_SMALLCACHE_BATCH; count++) {
+			last = *(FAR void **)last;
+		}
+
+		cache->head = *(FAR void **)last;
+		*(FAR void **)last = NULL;
+		cache->count -= CONFIG_MM_SMALLCACHE_BATCH;
+		cache->drains++;
+	}
+
+	irqrestore(flags);
+
+	if (list) {
+		(void)mm_smallcache_release(heap, list);
+	}
+
+	return true;
+}
+
+/****************************************************************************
+ * Name: mm_smallcache_flush
+ *
+ * Description:
+ *   Return every chunk held by the small-object cache to the heap.
+ *
+ * Return Value:
+ *   The number of chunks returned.
+ *
+ ****************************************************************************/
+
+int mm_smallcache_flush(FAR struct mm_heap_s *heap)
+{
+	FAR void *list;
+	irqstate_t flags;
+	int count = 0;
+	int ndx;
+
+	for (ndx = 0; ndx < MM_SMALLCACHE_NCLASSES; ndx++) {
+		flags = irqsave();
+		list = heap->mm_smallcache[ndx].head;
+		heap->mm_smallcache[ndx].head = NULL;
+		heap->mm_smallcache[ndx].count = 0;
+		irqrestore(flags);
+
+		if (list) {
+			count += mm_smallcache_release(heap, list);
+		}
+	}
+
+	return count;
+}
@@ -102,6 +102,10 @@
 #include <tinyara/clock.h>
 #endif
 
+#if LWIP_SOCKET_EPOLL
+#include <sys/epoll.h>
+#endif
+
 /* If the netconn API is not required publicly, then we include the necessary
    files here to get the implementation */
 #if !LWIP_NETCONN
@@ -238,7 +242,7 @@ static void sockaddr_to_ipaddr_port(const struct sockaddr *sockaddr, ip_addr_t *
 #define SELECT_SEM_PTR(sem) (&(sem))
 #endif							/* LWIP_NETCONN_SEM_PER_THREAD */
 
-/** Description for a task waiting in select */
+/** Description for a task waiting in select, or in poll for one socket */
 struct lwip_select_cb {
 	/** Pointer to the next waiting task */
 	struct lwip_select_cb *next;
@@ -304,13 +308,62 @@ static void lwip_socket_unregister_membership(int s, const ip4_addr_t *if_addr,
 static void lwip_socket_drop_registered_memberships(int s);
 #endif							/* LWIP_IGMP */
 
+#if LWIP_SOCKET_EPOLL
+/** A socket watched by an epoll instance. It is linked in the list of the
+    socket, in the interest list of the instance and, while the socket may
+    be ready, in the ready queue of the instance. */
+struct lwip_epoll_item {
+	/** next item of the same socket */
+	struct lwip_epoll_item *sock_next;
+	/** next item of the same epoll instance */
+	struct lwip_epoll_item *ep_next;
+	/** next item of the ready queue */
+	struct lwip_epoll_item *ready_next;
+	/** the epoll instance */
+	struct lwip_epoll *ep;
+	/** the socket */
+	struct lwip_sock *sock;
+	/** requested events, including EPOLLET */
+	u32_t events;
+	/** user data returned with the events */
+	epoll_data_t data;
+	/** 1 while the item is in the ready queue */
+	u8_t queued;
+};
+
+/** An epoll instance */
+struct lwip_epoll {
+	/** interest list */
+	struct lwip_epoll_item *items;
+	/** queue of the items that became ready, first and last */
+	struct lwip_epoll_item *ready_head;
+	struct lwip_epoll_item *ready_tail;
+	/** semaphore to wake up the task waiting in epoll_wait */
+	sys_sem_t sem;
+	/** 1 if the instance is allocated, 2 while it is set up or torn down */
+	u8_t used;
+	/** 1 while a task waits on sem */
+	u8_t waiting;
+	/** don't signal the semaphore twice: set to 1 when signalled */
+	u8_t signalled;
+	/** number of epoll_ctl/epoll_wait calls using the instance */
+	u8_t users;
+};
+#endif							/* LWIP_SOCKET_EPOLL */
+
 /** The global array of available sockets */
 static struct lwip_sock sockets[NUM_SOCKETS];
+#if LWIP_SELECT
 /** The global list of tasks waiting for select */
 static struct lwip_select_cb *select_cb_list;
 /** This counter is increased from lwip_select when the list is chagned
     and checked in event_callback to see if it has changed. */
 static volatile int select_cb_ctr;
+#endif
+#if LWIP_SOCKET_EPOLL
+/** The global array of epoll instances */
+static struct lwip_epoll epolls[LWIP_SOCKET_EPOLL_MAX];
+#endif
 
 #if LWIP_SOCKET_SET_ERRNO
 #ifdef ERRNO
@@ -335,6 +388,9 @@ static volatile int select_cb_ctr;
 
 /* Forward delcaration of some functions */
 static void event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len);
+#if LWIP_SOCKET_EPOLL
+static void lwip_epoll_drop(struct lwip_sock *sock);
+#endif
 #if !LWIP_TCPIP_CORE_LOCKING
 static void lwip_getsockopt_callback(void *arg);
 static void lwip_setsockopt_callback(void *arg);
@@ -572,6 +628,11 @@ void free_socket(struct lwip_sock *sock, int is_tcp)
 	sock->lastoffset = 0;
 	sock->err = 0;
 
+#if LWIP_SOCKET_EPOLL
+	/* Remove the socket from the epoll instances watching it */
+	lwip_epoll_drop(sock);
+#endif
+
 	/* Protect socket array */
 	SYS_ARCH_SET(sock->conn, NULL);
 	/* don't use 'sock' after this line, as another task might have allocated it */
@@ -1159,16 +1220,25 @@ int lwip_sendmsg(int s, const struct msghdr *msg, int flags)
 		} else {
 			/* flatten the IO vectors */
 			size_t offset = 0;
+#if LWIP_CHECKSUM_ON_COPY
+			/* checksum each IO vector while copying it and aggregate the sums */
+			u32_t acc = 0;
+			u16_t part;
+#endif							/* LWIP_CHECKSUM_ON_COPY */
 			for (i = 0; i < msg->msg_iovlen; i++) {
+#if LWIP_CHECKSUM_ON_COPY
+				part = LWIP_CHKSUM_COPY(&((u8_t *) chain_buf->p->payload)[offset], msg->msg_iov[i].iov_base, (u16_t) msg->msg_iov[i].iov_len);
+				if (offset & 1) {
+					part = SWAP_BYTES_IN_WORD(part);
+				}
+				acc = FOLD_U32T(acc + part);
+#else
 				MEMCPY(&((u8_t *) chain_buf->p->payload)[offset], msg->msg_iov[i].iov_base, msg->msg_iov[i].iov_len);
+#endif							/* LWIP_CHECKSUM_ON_COPY */
 				offset += msg->msg_iov[i].iov_len;
 			}
 #if LWIP_CHECKSUM_ON_COPY
-			{
-				/* This can be improved by using LWIP_CHKSUM_COPY() and aggregating the checksum for each IO vector */
-				u16_t chksum = ~inet_chksum_pbuf(chain_buf->p);
-				netbuf_set_chksum(chain_buf, chksum);
-			}
+			netbuf_set_chksum(chain_buf, (u16_t) FOLD_U32T(acc));
 #endif							/* LWIP_CHECKSUM_ON_COPY */
 			err = ERR_OK;
 		}
@@ -1648,6 +1718,27 @@ return_copy_fdsets:
 
 #else							/* LWIP_SELECT */
 
+/**
+ * Return the poll events in effect on a socket. Must be called with SYS_ARCH
+ * protected.
+ */
+static u32_t lwip_sock_revents(struct lwip_sock *sock)
+{
+	u32_t revents = 0;
+
+	if (sock->lastdata != NULL || sock->rcvevent > 0) {
+		revents |= POLLIN;
+	}
+	if (sock->sendevent != 0) {
+		revents |= POLLOUT;
+	}
+	if (sock->errevent != 0) {
+		revents |= POLLERR;
+	}
+
+	return revents;
+}
+
 static int lwip_poll_scan(int fd, struct lwip_sock *sock, struct pollfd *fds)
 {
 
@@ -1729,20 +1820,18 @@ static int lwip_poll_setup(int fd, struct lwip_sock *sock, struct pollfd *fds)
 	select_cb->events = fds->events;
 	select_cb->sfd = fd;
 
-	/* Protect the select_cb_list */
+	/* Protect the list of the socket */
 	SYS_ARCH_PROTECT(lev);
 
-	/* Put this select_cb on top of list */
-	select_cb->next = select_cb_list;
-	if (select_cb_list != NULL) {
-		select_cb_list->prev = select_cb;
+	/* Put this select_cb on top of the list: event_callback only walks the
+	   waiters of the socket that got the event */
+	select_cb->next = sock->select_cb;
+	if (sock->select_cb != NULL) {
+		sock->select_cb->prev = select_cb;
 	}
 
 	fds->scb = (void *)select_cb;
-	select_cb_list = select_cb;
-
-	/* Increasing this counter tells event_callback that the list has changed. */
-	select_cb_ctr++;
+	sock->select_cb = select_cb;
 
 	/* Increase select_waiting for the socket */
 	sock->select_waiting++;
@@ -1776,24 +1865,24 @@ static int lwip_poll_teardown(int fd, struct lwip_sock *sock, struct pollfd *fds
 		sock->select_waiting--;
 	}
 
-	/* Take select_cb_list off the list */
+	/* Take select_cb off the list of the socket */
 	if (select_cb) {
 		if (select_cb->next != NULL) {
 			select_cb->next->prev = select_cb->prev;
 		}
-		if (select_cb_list == select_cb) {
+		if (sock->select_cb == select_cb) {
 			LWIP_ASSERT("select_cb.prev == NULL", select_cb->prev == NULL);
-			select_cb_list = select_cb->next;
+			sock->select_cb = select_cb->next;
 		} else {
 			LWIP_ASSERT("select_cb.prev != NULL", select_cb->prev != NULL);
 			select_cb->prev->next = select_cb->next;
 		}
+	}
+	SYS_ARCH_UNPROTECT(lev);
 
+	if (select_cb) {
 		mem_free((void *)select_cb);
-		/* Increasing this counter tells event_callback that the list has changed. */
-		select_cb_ctr++;
 	}
-	SYS_ARCH_UNPROTECT(lev);
 
 	/* See what's set */
 	lwip_poll_scan(fd, sock, fds);
@@ -1859,6 +1948,475 @@ int lwip_poll(int fd, struct pollfd *fds, bool setup)
 
 #endif							/*LWIP_SELECT */
 
+#if LWIP_SOCKET_EPOLL
+/**
+ * Return the epoll instance matching a handle, or NULL. The instance cannot
+ * be closed until it is released with lwip_epoll_put().
+ */
+static struct lwip_epoll *lwip_epoll_get(int epfd)
+{
+	struct lwip_epoll *ep = NULL;
+	SYS_ARCH_DECL_PROTECT(lev);
+
+	if (epfd < 0 || epfd >= LWIP_SOCKET_EPOLL_MAX) {
+		return NULL;
+	}
+
+	SYS_ARCH_PROTECT(lev);
+	if (epolls[epfd].used == 1) {
+		ep = &epolls[epfd];
+		ep->users++;
+	}
+	SYS_ARCH_UNPROTECT(lev);
+
+	return ep;
+}
+
+/**
+ * Release an instance returned by lwip_epoll_get().
+ */
+static void lwip_epoll_put(struct lwip_epoll *ep)
+{
+	SYS_ARCH_DECL_PROTECT(lev);
+
+	SYS_ARCH_PROTECT(lev);
+	ep->users--;
+	SYS_ARCH_UNPROTECT(lev);
+}
+
+/**
+ * Return true if the socket of an item has one of the events it requests.
+ * Must be called with SYS_ARCH protected.
+ */
+static int lwip_epoll_ready(struct lwip_epoll_item *item)
+{
+	return (lwip_sock_revents(item->sock) & (item->events | EPOLLERR)) != 0;
+}
+
+/**
+ * Append an item to the ready queue of its instance if it is not there yet
+ * and wake up the waiting task. Must be called with SYS_ARCH protected.
+ */
+static void lwip_epoll_enqueue(struct lwip_epoll_item *item)
+{
+	struct lwip_epoll *ep = item->ep;
+
+	if (item->queued) {
+		return;
+	}
+
+	item->queued = 1;
+	item->ready_next = NULL;
+	if (ep->ready_tail != NULL) {
+		ep->ready_tail->ready_next = item;
+	} else {
+		ep->ready_head = item;
+	}
+	ep->ready_tail = item;
+
+	if (ep->waiting && !ep->signalled) {
+		ep->signalled = 1;
+		sys_sem_signal(&ep->sem);
+	}
+}
+
+/**
+ * Take an item off the lists of its instance. Must be called with SYS_ARCH
+ * protected.
+ */
+static void lwip_epoll_unlink(struct lwip_epoll_item *item)
+{
+	struct lwip_epoll *ep = item->ep;
+	struct lwip_epoll_item **pp;
+	struct lwip_epoll_item *prev = NULL;
+
+	for (pp = &ep->items; *pp != item; pp = &(*pp)->ep_next) ;
+	*pp = item->ep_next;
+
+	if (item->queued) {
+		for (pp = &ep->ready_head; *pp != item; pp = &(*pp)->ready_next) {
+			prev = *pp;
+		}
+		*pp = item->ready_next;
+		if (ep->ready_tail == item) {
+			ep->ready_tail = prev;
+		}
+		item->queued = 0;
+	}
+}
+
+/**
+ * Queue the items of a socket that became ready. Called by event_callback
+ * with SYS_ARCH protected, so that the cost of an event is the number of
+ * instances watching the socket.
+ */
+static void lwip_epoll_notify(struct lwip_sock *sock)
+{
+	struct lwip_epoll_item *item;
+
+	for (item = sock->epoll_items; item != NULL; item = item->sock_next) {
+		if (!item->queued && lwip_epoll_ready(item)) {
+			lwip_epoll_enqueue(item);
+		}
+	}
+}
+
+/**
+ * Remove a socket that is being freed from all the epoll instances.
+ */
+static void lwip_epoll_drop(struct lwip_sock *sock)
+{
+	struct lwip_epoll_item *item;
+	struct lwip_epoll_item *next;
+	SYS_ARCH_DECL_PROTECT(lev);
+
+	SYS_ARCH_PROTECT(lev);
+	item = sock->epoll_items;
+	sock->epoll_items = NULL;
+	for (next = item; next != NULL; next = next->sock_next) {
+		lwip_epoll_unlink(next);
+	}
+	SYS_ARCH_UNPROTECT(lev);
+
+	while (item != NULL) {
+		next = item->sock_next;
+		mem_free(item);
+		item = next;
+	}
+}
+
+int lwip_epoll_create(int size)
+{
+	int i;
+	SYS_ARCH_DECL_PROTECT(lev);
+
+	if (size <= 0) {
+		set_errno(EINVAL);
+		return -1;
+	}
+
+	for (i = 0; i < LWIP_SOCKET_EPOLL_MAX; i++) {
+		SYS_ARCH_PROTECT(lev);
+		if (!epolls[i].used) {
+			/* Reserve the slot; it is only published once fully set up */
+			epolls[i].used = 2;
+			SYS_ARCH_UNPROTECT(lev);
+
+			epolls[i].items = NULL;
+			epolls[i].ready_head = NULL;
+			epolls[i].ready_tail = NULL;
+			epolls[i].waiting = 0;
+			epolls[i].signalled = 0;
+			epolls[i].users = 0;
+			if (sys_sem_new(&epolls[i].sem, 0) != ERR_OK) {
+				epolls[i].used = 0;
+				set_errno(ENOMEM);
+				return -1;
+			}
+
+			SYS_ARCH_PROTECT(lev);
+			epolls[i].used = 1;
+			SYS_ARCH_UNPROTECT(lev);
+			return i;
+		}
+		SYS_ARCH_UNPROTECT(lev);
+	}
+
+	set_errno(ENFILE);
+	return -1;
+}
+
+int lwip_epoll_ctl(int epfd, int op, int s, struct epoll_event *event)
+{
+	struct lwip_epoll *ep;
+	struct lwip_sock *sock;
+	struct lwip_epoll_item *item;
+	struct lwip_epoll_item *newitem = NULL;
+	struct lwip_epoll_item **pp;
+	int err = 0;
+	SYS_ARCH_DECL_PROTECT(lev);
+
+	sock = get_socket(s);
+	if (sock == NULL) {
+		return -1;
+	}
+
+	if (op != EPOLL_CTL_DEL && event == NULL) {
+		set_errno(EFAULT);
+		return -1;
+	}
+
+	ep = lwip_epoll_get(epfd);
+	if (ep == NULL) {
+		set_errno(EBADF);
+		return -1;
+	}
+
+	if (op == EPOLL_CTL_ADD) {
+		newitem = (struct lwip_epoll_item *)mem_malloc(sizeof(struct lwip_epoll_item));
+		if (newitem == NULL) {
+			lwip_epoll_put(ep);
+			set_errno(ENOMEM);
+			return -1;
+		}
+
+		memset(newitem, 0, sizeof(struct lwip_epoll_item));
+		newitem->ep = ep;
+		newitem->sock = sock;
+		newitem->events = event->events;
+		newitem->data = event->data;
+	}
+
+	SYS_ARCH_PROTECT(lev);
+	for (pp = &sock->epoll_items; *pp != NULL && (*pp)->ep != ep; pp = &(*pp)->sock_next) ;
+	item = *pp;
+
+	switch (op) {
+	case EPOLL_CTL_ADD:
+		if (item != NULL) {
+			err = EEXIST;
+			break;
+		}
+
+		newitem->sock_next = sock->epoll_items;
+		sock->epoll_items = newitem;
+		newitem->ep_next = ep->items;
+		ep->items = newitem;
+		if (lwip_epoll_ready(newitem)) {
+			lwip_epoll_enqueue(newitem);
+		}
+		newitem = NULL;
+		break;
+
+	case EPOLL_CTL_MOD:
+		if (item == NULL) {
+			err = ENOENT;
+			break;
+		}
+
+		item->events = event->events;
+		item->data = event->data;
+		if (lwip_epoll_ready(item)) {
+			lwip_epoll_enqueue(item);
+		}
+		break;
+
+	case EPOLL_CTL_DEL:
+		if (item == NULL) {
+			err = ENOENT;
+			break;
+		}
+
+		*pp = item->sock_next;
+		lwip_epoll_unlink(item);
+		newitem = item;
+		break;
+
+	default:
+		err = EINVAL;
+		break;
+	}
+	SYS_ARCH_UNPROTECT(lev);
+	lwip_epoll_put(ep);
+
+	/* Free the item not added or the one removed */
+
+	if (newitem != NULL) {
+		mem_free(newitem);
+	}
+
+	if (err != 0) {
+		set_errno(err);
+		return -1;
+	}
+
+	return 0;
+}
+
+int lwip_epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout)
+{
+	struct lwip_epoll *ep;
+	struct lwip_epoll_item *item;
+	struct lwip_epoll_item *next;
+	struct lwip_epoll_item *tail;
+	struct lwip_epoll_item *again_head;
+	struct lwip_epoll_item *again_tail;
+	u32_t revents;
+	u32_t waited;
+	int nready;
+	int drain;
+	SYS_ARCH_DECL_PROTECT(lev);
+
+	if (events == NULL || maxevents <= 0) {
+		set_errno(EINVAL);
+		return -1;
+	}
+
+	ep = lwip_epoll_get(epfd);
+	if (ep == NULL) {
+		set_errno(EBADF);
+		return -1;
+	}
+
+	for (;;) {
+		SYS_ARCH_PROTECT(lev);
+		if (ep->waiting) {
+			SYS_ARCH_UNPROTECT(lev);
+			lwip_epoll_put(ep);
+			set_errno(EBUSY);
+			return -1;
+		}
+
+		/* Take the ready queue: only the items in it are examined */
+
+		item = ep->ready_head;
+		tail = ep->ready_tail;
+		ep->ready_head = NULL;
+		ep->ready_tail = NULL;
+		again_head = NULL;
+		again_tail = NULL;
+		nready = 0;
+
+		while (item != NULL && nready < maxevents) {
+			next = item->ready_next;
+			item->ready_next = NULL;
+
+			revents = lwip_sock_revents(item->sock) & (item->events | EPOLLERR);
+			if (revents == 0 || (item->events & EPOLLET)) {
+				/* Not ready anymore, or reported once per event */
+
+				item->queued = 0;
+			} else {
+				/* Level-triggered: keep it queued, behind the others */
+
+				if (again_tail != NULL) {
+					again_tail->ready_next = item;
+				} else {
+					again_head = item;
+				}
+				again_tail = item;
+			}
+
+			if (revents != 0) {
+				events[nready].events = revents;
+				events[nready].data = item->data;
+				nready++;
+			}
+
+			item = next;
+		}
+
+		/* Put back the items not examined, then the ones to report again */
+
+		if (item != NULL) {
+			ep->ready_head = item;
+			ep->ready_tail = tail;
+		}
+
+		if (again_head != NULL) {
+			if (ep->ready_tail != NULL) {
+				ep->ready_tail->ready_next = again_head;
+			} else {
+				ep->ready_head = again_head;
+			}
+			ep->ready_tail = again_tail;
+		}
+
+		if (nready > 0 || timeout == 0) {
+			ep->users--;
+			SYS_ARCH_UNPROTECT(lev);
+			return nready;
+		}
+
+		ep->waiting = 1;
+		ep->signalled = 0;
+		SYS_ARCH_UNPROTECT(lev);
+
+		waited = sys_arch_sem_wait(&ep->sem, timeout < 0 ? 0 : (u32_t)timeout);
+
+		SYS_ARCH_PROTECT(lev);
+		ep->waiting = 0;
+		drain = (waited == SYS_ARCH_TIMEOUT && ep->signalled);
+		ep->signalled = 0;
+		SYS_ARCH_UNPROTECT(lev);
+
+		if (waited == SYS_ARCH_CANCELED) {
+			lwip_epoll_put(ep);
+			set_errno(EINTR);
+			return -1;
+		}
+
+		if (waited == SYS_ARCH_TIMEOUT) {
+			/* Consume a signal posted after the timeout, then scan once more */
+
+			if (drain) {
+				sys_arch_sem_wait(&ep->sem, 0);
+			}
+			timeout = 0;
+		} else if (timeout > 0) {
+			/* Woken up: wait for the remaining time if nothing is ready */
+
+			timeout = (waited < (u32_t)timeout) ? timeout - (int)waited : 0;
+		}
+	}
+}
+
+int lwip_epoll_close(int epfd)
+{
+	struct lwip_epoll *ep;
+	struct lwip_epoll_item *item;
+	struct lwip_epoll_item *next;
+	struct lwip_epoll_item **pp;
+	SYS_ARCH_DECL_PROTECT(lev);
+
+	if (epfd < 0 || epfd >= LWIP_SOCKET_EPOLL_MAX) {
+		set_errno(EBADF);
+		return -1;
+	}
+
+	ep = &epolls[epfd];
+	SYS_ARCH_PROTECT(lev);
+	if (ep->used != 1) {
+		SYS_ARCH_UNPROTECT(lev);
+		set_errno(EBADF);
+		return -1;
+	}
+
+	if (ep->users > 0) {
+		SYS_ARCH_UNPROTECT(lev);
+		set_errno(EBUSY);
+		return -1;
+	}
+
+	/* Unpublish the instance while it is torn down */
+
+	ep->used = 2;
+
+	/* Take the items off the lists of their sockets */
+
+	item = ep->items;
+	for (next = item; next != NULL; next = next->ep_next) {
+		for (pp = &next->sock->epoll_items; *pp != next; pp = &(*pp)->sock_next) ;
+		*pp = next->sock_next;
+	}
+
+	ep->items = NULL;
+	ep->ready_head = NULL;
+	ep->ready_tail = NULL;
+	SYS_ARCH_UNPROTECT(lev);
+
+	while (item != NULL) {
+		next = item->ep_next;
+		mem_free(item);
+		item = next;
+	}
+
+	sys_sem_free(&ep->sem);
+	ep->used = 0;
+	return 0;
+}
+#endif							/* LWIP_SOCKET_EPOLL */
+
 /**
  * Callback registered in the netconn layer for each socket-netconn.
  * Processes recvevent (data available) and wakes up tasks waiting for select.
@@ -1868,7 +2426,11 @@ static void event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len
 	int s;
 	struct lwip_sock *sock;
 	struct lwip_select_cb *scb;
+#if LWIP_SELECT
 	int last_select_cb_ctr;
+#else
+	u32_t revents;
+#endif
 	SYS_ARCH_DECL_PROTECT(lev);
 
 	LWIP_UNUSED_ARG(len);
@@ -1925,12 +2487,20 @@ static void event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len
 		break;
 	}
 
+#if LWIP_SOCKET_EPOLL
+	/* Queue the socket to the epoll instances if it became ready */
+	if (evt == NETCONN_EVT_RCVPLUS || evt == NETCONN_EVT_SENDPLUS || evt == NETCONN_EVT_ERROR) {
+		lwip_epoll_notify(sock);
+	}
+#endif
+
 	if (sock->select_waiting == 0) {
 		/* none is waiting for this socket, no need to check select_cb_list */
 		SYS_ARCH_UNPROTECT(lev);
 		return;
 	}
 
+#if LWIP_SELECT
 	/* Now decide if anyone is waiting for this socket */
 	/* NOTE: This code goes through the select_cb_list list multiple times
 	   ONLY IF a select was actually waiting. We go through the list the number
@@ -1944,35 +2514,19 @@ again:
 		if (scb->sem_signalled == 0) {
 			/* semaphore not signalled yet */
 			int do_signal = 0;
-			int check_set = 0;
 			/* Test this select call for our socket */
 			if (sock->rcvevent > 0) {
-#if LWIP_SELECT
-				check_set = scb->readset && FD_ISSET(s, scb->readset);
-#else
-				check_set = (scb->sfd == s) && (scb->events & POLLIN);
-#endif
-				if (check_set) {
+				if (scb->readset && FD_ISSET(s, scb->readset)) {
 					do_signal = 1;
 				}
 			}
 			if (sock->sendevent != 0) {
-#if LWIP_SELECT
-				check_set = scb->writeset && FD_ISSET(s, scb->writeset);
-#else
-				check_set = (scb->sfd == s) && (scb->events & POLLOUT);
-#endif
-				if (!do_signal && check_set) {
+				if (!do_signal && scb->writeset && FD_ISSET(s, scb->writeset)) {
 					do_signal = 1;
 				}
 			}
 			if (sock->errevent != 0) {
-#if LWIP_SELECT
-				check_set = scb->exceptset && FD_ISSET(s, scb->exceptset);
-#else
-				check_set = (scb->sfd == s) && (scb->events & POLLERR);
-#endif
-				if (!do_signal && check_set) {
+				if (!do_signal && scb->exceptset && FD_ISSET(s, scb->exceptset)) {
 					do_signal = 1;
 				}
 			}
@@ -1980,11 +2534,7 @@ again:
 				scb->sem_signalled = 1;
 				/* Don't call SYS_ARCH_UNPROTECT() before signaling the semaphore, as this might
 				   lead to the select thread taking itself off the list, invalidagin the semaphore. */
-#if LWIP_SELECT
 				sys_sem_signal(&scb->sem);
-#else
-				sys_sem_signal(scb->poll_sem);
-#endif
 			}
 		}
 		/* unlock interrupts with each step */
@@ -1996,6 +2546,20 @@ again:
 			goto again;
 		}
 	}
+#else
+	/* Only the poll calls waiting for this socket are on its list. The
+	   list is walked at once: it is as long as the number of tasks polling
+	   the socket, and the walk does not have to restart on changes. */
+	revents = lwip_sock_revents(sock);
+	for (scb = sock->select_cb; scb != NULL; scb = scb->next) {
+		if (scb->sem_signalled == 0 && (scb->events & revents) != 0) {
+			scb->sem_signalled = 1;
+			/* Don't call SYS_ARCH_UNPROTECT() before signaling the semaphore, as this might
+			   lead to the poll thread taking itself off the list, invalidating the semaphore. */
+			sys_sem_signal(scb->poll_sem);
+		}
+	}
+#endif
 	SYS_ARCH_UNPROTECT(lev);
 }
 
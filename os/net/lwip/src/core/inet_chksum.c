@@ -27,7 +27,7 @@
  * \#define LWIP_CHKSUM your_checksum_routine
  *
  * Or you can select from the implementations below by defining
- * LWIP_CHKSUM_ALGORITHM to 1, 2 or 3.
+ * LWIP_CHKSUM_ALGORITHM to 1, 2, 3 or 4.
  */
 
 /*
@@ -269,6 +269,104 @@ u16_t lwip_standard_chksum(const void *dataptr, int len)
 }
 #endif
 
+#if (LWIP_CHKSUM_ALGORITHM == 4) || (LWIP_CHKSUM_COPY_ALGORITHM == 2)
+/**
+ * Fold a 64-bit sum of 16-bit or 32-bit words to 16 bits.
+ */
+static u16_t lwip_chksum_fold64(unsigned long long sum)
+{
+	u32_t sum32;
+
+	sum = (sum >> 32) + (sum & 0xffffffffULL);
+	sum = (sum >> 32) + (sum & 0xffffffffULL);
+
+	sum32 = (u32_t)sum;
+	sum32 = FOLD_U32T(sum32);
+	sum32 = FOLD_U32T(sum32);
+	return (u16_t)sum32;
+}
+#endif
+
+#if (LWIP_CHKSUM_ALGORITHM == 4)	/* Alternative version #4 */
+/**
+ * Word-at-a-time checksum: after aligning to 4 bytes, it adds 32-bit words
+ * into a 64-bit accumulator, four words per iteration. The carries pile up
+ * in the upper half of the accumulator and are folded back once at the end,
+ * so the inner loop does no carry test. On 32-bit cores the compiler turns
+ * each addition into an add/add-with-carry pair (ARMv7-M ADDS/ADC); on cores
+ * without a carry flag, such as Xtensa, it is still one compare less per
+ * word than version #3.
+ *
+ * The one's complement sum of 32-bit words folded to 16 bits equals the
+ * sum of the 16-bit words they contain (RFC 1071), in the same byte order.
+ *
+ * @param dataptr points to start of data to be summed at any boundary
+ * @param len length of data to be summed
+ * @return host order (!) lwip checksum (non-inverted Internet sum)
+ */
+u16_t lwip_standard_chksum(const void *dataptr, int len)
+{
+	const u8_t *pb = (const u8_t *)dataptr;
+	const u16_t *ps;
+	const u32_t *pl;
+	u16_t t = 0;
+	unsigned long long sum = 0;
+	u16_t result;
+	/* starts at odd byte address? */
+	int odd = ((mem_ptr_t) pb & 1);
+
+	if (odd && len > 0) {
+		((u8_t *)&t)[1] = *pb++;
+		len--;
+	}
+
+	ps = (const u16_t *)(const void *)pb;
+
+	if (((mem_ptr_t) ps & 2) && len > 1) {
+		sum += *ps++;
+		len -= 2;
+	}
+
+	pl = (const u32_t *)(const void *)ps;
+
+	while (len >= 16) {
+		sum += pl[0];
+		sum += pl[1];
+		sum += pl[2];
+		sum += pl[3];
+		pl += 4;
+		len -= 16;
+	}
+
+	while (len >= 4) {
+		sum += *pl++;
+		len -= 4;
+	}
+
+	ps = (const u16_t *)(const void *)pl;
+
+	/* 16-bit aligned word remaining? */
+	if (len > 1) {
+		sum += *ps++;
+		len -= 2;
+	}
+
+	/* dangling tail byte remaining? */
+	if (len > 0) {
+		((u8_t *)&t)[0] = *(const u8_t *)ps;
+	}
+
+	sum += t;
+
+	result = lwip_chksum_fold64(sum);
+	if (odd) {
+		result = SWAP_BYTES_IN_WORD(result);
+	}
+
+	return result;
+}
+#endif
+
 /** Parts of the pseudo checksum which are common to IPv4 and IPv6 */
 static u16_t inet_cksum_pseudo_base(struct pbuf *p, u8_t proto, u16_t proto_len, u32_t acc)
 {
@@ -601,3 +699,86 @@ u16_t lwip_chksum_copy(void *dst, const void *src, u16_t len)
 	return LWIP_CHKSUM(dst, len);
 }
 #endif							/* (LWIP_CHKSUM_COPY_ALGORITHM == 1) */
+
+#if (LWIP_CHKSUM_COPY_ALGORITHM == 2)	/* Version #2 */
+/** Copy and sum in one pass: each 32-bit word is added to the checksum
+ * while it is in a register, so the data is read only once. This needs the
+ * source and the destination to have the same alignment modulo 4, which is
+ * the usual case when copying into a fresh pbuf; otherwise, and for short
+ * buffers, it falls back to version #1.
+ */
+u16_t lwip_chksum_copy(void *dst, const void *src, u16_t len)
+{
+	const u8_t *sb = (const u8_t *)src;
+	u8_t *db = (u8_t *)dst;
+	const u32_t *sl;
+	u32_t *dl;
+	u32_t w0, w1, w2, w3;
+	unsigned long long sum = 0;
+	u32_t acc;
+	u16_t head;
+	u16_t tail;
+	u16_t words;
+	u16_t part;
+
+	if (len < 16 || (((mem_ptr_t) sb ^ (mem_ptr_t) db) & 3) != 0) {
+		MEMCPY(dst, src, len);
+		return LWIP_CHKSUM(dst, len);
+	}
+
+	/* Bytes before the first aligned word, summed from the start */
+
+	head = (u16_t)((4 - ((mem_ptr_t) sb & 3)) & 3);
+	MEMCPY(db, sb, head);
+	acc = LWIP_CHKSUM(db, head);
+
+	/* Aligned words */
+
+	sl = (const u32_t *)(const void *)(sb + head);
+	dl = (u32_t *)(void *)(db + head);
+	words = (u16_t)((len - head) >> 2);
+	tail = (u16_t)((len - head) & 3);
+
+	while (words >= 4) {
+		w0 = sl[0];
+		w1 = sl[1];
+		w2 = sl[2];
+		w3 = sl[3];
+		dl[0] = w0;
+		dl[1] = w1;
+		dl[2] = w2;
+		dl[3] = w3;
+		sum += w0;
+		sum += w1;
+		sum += w2;
+		sum += w3;
+		sl += 4;
+		dl += 4;
+		words -= 4;
+	}
+
+	while (words > 0) {
+		w0 = *sl++;
+		*dl++ = w0;
+		sum += w0;
+		words--;
+	}
+
+	/* Bytes after the last word */
+
+	MEMCPY(dl, sl, tail);
+	sum += LWIP_CHKSUM(dl, tail);
+
+	/* The words and the tail start at an odd offset if head is odd */
+
+	part = lwip_chksum_fold64(sum);
+	if (head & 1) {
+		part = SWAP_BYTES_IN_WORD(part);
+	}
+
+	acc += part;
+	acc = FOLD_U32T(acc);
+	acc = FOLD_U32T(acc);
+	return (u16_t)acc;
+}
+#endif							/* (LWIP_CHKSUM_COPY_ALGORITHM == 2) */
@@ -87,7 +87,11 @@
 #define LWIP_CHKSUM_COPY_ALGORITHM 0
 #endif							/* LWIP_CHKSUM_COPY */
 #else							/* LWIP_CHECKSUM_ON_COPY */
+/* lwip_chksum_copy() is still built if an algorithm is chosen, e.g. for the
+   unit tests, but the stack does not use it */
+#ifndef LWIP_CHKSUM_COPY_ALGORITHM
 #define LWIP_CHKSUM_COPY_ALGORITHM 0
+#endif							/* LWIP_CHKSUM_COPY_ALGORITHM */
 #endif							/* LWIP_CHECKSUM_ON_COPY */
 
 #ifdef __cplusplus
@@ -640,6 +640,13 @@
 #define LWIP_SELECT                     0
 #endif
 
+#ifdef CONFIG_NET_SOCKET_EPOLL
+#define LWIP_SOCKET_EPOLL               1
+#define LWIP_SOCKET_EPOLL_MAX           CONFIG_NET_SOCKET_EPOLL_MAX
+#else
+#define LWIP_SOCKET_EPOLL               0
+#endif
+
 #ifdef CONFIG_NET_SOCKET
 #define LWIP_SOCKET	CONFIG_NET_SOCKET
 #endif
@@ -1178,4 +1185,12 @@
 #define LWIP_NETIF_TX_SINGLE_PBUF             1
 #endif
 
+/* Sum 32-bit words in a 64-bit accumulator */
+#define LWIP_CHKSUM_ALGORITHM                 4
+
+#if defined(CONFIG_NET_LWIP_CHECKSUM_ON_COPY)
+#define LWIP_CHECKSUM_ON_COPY                 1
+#define LWIP_CHKSUM_COPY_ALGORITHM            2
+#endif
+
 #endif							/* __LWIP_LWIPOPTS_H__ */
@@ -473,6 +473,11 @@ typedef struct ip_mreq {
 #define SELWAIT_T u8_t
 #endif
 
+struct lwip_select_cb;
+#if LWIP_SOCKET_EPOLL
+struct lwip_epoll_item;
+#endif
+
 /** Contains all internal pointers and states used for a socket */
 struct lwip_sock {
 	/** sockets currently are built on netconns, each socket has one netconn */
@@ -493,6 +498,14 @@ struct lwip_sock {
 	u8_t err;
 	/** counter of how many threads are waiting for this socket using select */
 	SELWAIT_T select_waiting;
+#if !LWIP_SELECT
+	/** list of the poll calls waiting for this socket */
+	struct lwip_select_cb *select_cb;
+#endif
+#if LWIP_SOCKET_EPOLL
+	/** list of the epoll instances watching this socket */
+	struct lwip_epoll_item *epoll_items;
+#endif
 };
 
 #define lwip_socket_init()		/* Compatibility define, no init needed. */
@@ -525,7 +538,16 @@ int lwip_select(int maxfdp1, fd_set * readset, fd_set * writeset, fd_set * excep
 int lwip_ioctl(int s, long cmd, void *argp);
 int lwip_fcntl(int s, int cmd, int val);
 
+#if !LWIP_SELECT
 int lwip_poll(int fd, struct pollfd *fds, bool setup);
+#endif
+#if LWIP_SOCKET_EPOLL
+struct epoll_event;
+int lwip_epoll_create(int size);
+int lwip_epoll_ctl(int epfd, int op, int s, struct epoll_event *event);
+int lwip_epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout);
+int lwip_epoll_close(int epfd);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,206 @@
+/****************************************************************************
+ *
+ * Copyright 2026 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "test_chksum.h"
+
+#include "lwip/inet_chksum.h"
+#include "lwip/def.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if LWIP_CHKSUM_COPY_ALGORITHM != 2
+#error "This tests needs LWIP_CHKSUM_COPY_ALGORITHM 2"
+#endif
+
+#define CHKSUM_BUFSIZE    2048
+#define CHKSUM_BENCH_LEN  1460
+#define CHKSUM_BENCH_RUNS 20000
+
+static u8_t src_buf[CHKSUM_BUFSIZE + 8];
+static u8_t dst_buf[CHKSUM_BUFSIZE + 8];
+
+/* Helper functions */
+
+/** Reference checksum: RFC 1071, two octets at a time in network order */
+static u16_t ref_chksum(const u8_t *data, int len)
+{
+	u32_t acc = 0;
+
+	while (len > 1) {
+		acc += ((u32_t)data[0] << 8) | data[1];
+		data += 2;
+		len -= 2;
+	}
+	if (len > 0) {
+		acc += (u32_t)data[0] << 8;
+	}
+
+	while (acc >> 16) {
+		acc = (acc >> 16) + (acc & 0xffffUL);
+	}
+
+	return lwip_htons((u16_t)acc);
+}
+
+static void fill_random(u8_t *buf, int len, u32_t seed)
+{
+	int i;
+
+	for (i = 0; i < len; i++) {
+		seed = seed * 1103515245UL + 12345UL;
+		buf[i] = (u8_t)(seed >> 16);
+	}
+}
+
+static double elapsed_us(clock_t start)
+{
+	return (double)(clock() - start) * 1000000.0 / CLOCKS_PER_SEC;
+}
+
+/* Setups/teardown functions */
+
+static void chksum_setup(void)
+{
+	fill_random(src_buf, sizeof(src_buf), 1);
+}
+
+static void chksum_teardown(void)
+{
+}
+
+/* Test functions */
+
+/** Compare LWIP_CHKSUM to the reference at every alignment and many lengths */
+START_TEST(test_chksum_standard)
+{
+	int offset;
+	int len;
+	LWIP_UNUSED_ARG(_i);
+
+	for (offset = 0; offset < 8; offset++) {
+		for (len = 0; len <= 300; len++) {
+			fail_unless(LWIP_CHKSUM(src_buf + offset, len) == ref_chksum(src_buf + offset, len));
+		}
+		for (len = 1400; len <= CHKSUM_BUFSIZE; len += 37) {
+			fail_unless(LWIP_CHKSUM(src_buf + offset, len) == ref_chksum(src_buf + offset, len));
+		}
+	}
+
+	/* All ones: the carries of the accumulator must be folded back */
+	memset(src_buf, 0xff, sizeof(src_buf));
+	for (offset = 0; offset < 4; offset++) {
+		for (len = CHKSUM_BUFSIZE - 8; len <= CHKSUM_BUFSIZE; len++) {
+			fail_unless(LWIP_CHKSUM(src_buf + offset, len) == ref_chksum(src_buf + offset, len));
+		}
+	}
+}
+
+END_TEST
+
+/** Check that lwip_chksum_copy copies and sums for any pair of alignments */
+START_TEST(test_chksum_copy)
+{
+	int soff;
+	int doff;
+	int len;
+	u16_t chksum;
+	LWIP_UNUSED_ARG(_i);
+
+	for (soff = 0; soff < 4; soff++) {
+		for (doff = 0; doff < 4; doff++) {
+			for (len = 0; len <= 200; len += (len < 40) ? 1 : 13) {
+				memset(dst_buf, 0, sizeof(dst_buf));
+				chksum = lwip_chksum_copy(dst_buf + doff, src_buf + soff, (u16_t)len);
+				fail_unless(chksum == ref_chksum(src_buf + soff, len));
+				fail_unless(memcmp(dst_buf + doff, src_buf + soff, len) == 0);
+				/* Nothing written around the destination */
+				fail_unless(doff == 0 || dst_buf[doff - 1] == 0);
+				fail_unless(dst_buf[doff + len] == 0);
+			}
+
+			len = CHKSUM_BENCH_LEN + soff;
+			chksum = lwip_chksum_copy(dst_buf + doff, src_buf + soff, (u16_t)len);
+			fail_unless(chksum == ref_chksum(src_buf + soff, len));
+			fail_unless(memcmp(dst_buf + doff, src_buf + soff, len) == 0);
+		}
+	}
+}
+
+END_TEST
+
+/** Checksum a segment sized buffer many times and print the throughput of
+    each way of doing it. This only fails if a result is wrong. */
+START_TEST(test_chksum_bench)
+{
+	clock_t start;
+	double t_ref;
+	double t_std;
+	double t_split;
+	double t_copy;
+	u32_t acc_ref = 0;
+	u32_t acc_std = 0;
+	u32_t acc_split = 0;
+	u32_t acc_copy = 0;
+	int i;
+	LWIP_UNUSED_ARG(_i);
+
+	start = clock();
+	for (i = 0; i < CHKSUM_BENCH_RUNS; i++) {
+		acc_ref += ref_chksum(src_buf + (i & 2), CHKSUM_BENCH_LEN);
+	}
+	t_ref = elapsed_us(start);
+
+	start = clock();
+	for (i = 0; i < CHKSUM_BENCH_RUNS; i++) {
+		acc_std += LWIP_CHKSUM(src_buf + (i & 2), CHKSUM_BENCH_LEN);
+	}
+	t_std = elapsed_us(start);
+
+	start = clock();
+	for (i = 0; i < CHKSUM_BENCH_RUNS; i++) {
+		MEMCPY(dst_buf + (i & 2), src_buf + (i & 2), CHKSUM_BENCH_LEN);
+		acc_split += LWIP_CHKSUM(dst_buf + (i & 2), CHKSUM_BENCH_LEN);
+	}
+	t_split = elapsed_us(start);
+
+	start = clock();
+	for (i = 0; i < CHKSUM_BENCH_RUNS; i++) {
+		acc_copy += lwip_chksum_copy(dst_buf + (i & 2), src_buf + (i & 2), CHKSUM_BENCH_LEN);
+	}
+	t_copy = elapsed_us(start);
+
+	fail_unless(acc_std == acc_ref);
+	fail_unless(acc_split == acc_ref);
+	fail_unless(acc_copy == acc_ref);
+
+	printf("chksum bench (%d x %d bytes, us): reference %.0f, LWIP_CHKSUM %.0f, copy then sum %.0f, lwip_chksum_copy %.0f\n", CHKSUM_BENCH_RUNS, CHKSUM_BENCH_LEN, t_ref, t_std, t_split, t_copy);
+}
+
+END_TEST
+/** Create the suite including all tests for this module */
+Suite *chksum_suite(void)
+{
+	TFun tests[] = {
+		test_chksum_standard,
+		test_chksum_copy,
+		test_chksum_bench
+	};
+	return create_suite("CHKSUM", tests, sizeof(tests) / sizeof(TFun), chksum_setup, chksum_teardown);
+}
@@ -65,4 +65,10 @@
 /* Minimal changes to opt.h required for etharp unit tests: */
 #define ETHARP_SUPPORT_STATIC_ENTRIES   1
 
+/* Checksum unit tests: use the word-at-a-time version, and build the
+   copy-fused one for test_chksum.c only. LWIP_CHECKSUM_ON_COPY stays off,
+   so the other suites copy and sum separately. */
+#define LWIP_CHKSUM_ALGORITHM           4
+#define LWIP_CHKSUM_COPY_ALGORITHM      2
+
 #endif							/* __LWIPOPTS_H__ */
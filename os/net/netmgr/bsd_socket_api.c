@@ -29,6 +29,8 @@
 
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/epoll.h>
+#include <errno.h>
 #include <netinet/in.h>
 #include <net/if.h>
 #include <tinyara/lwnl/lwnl.h>
@@ -211,4 +213,49 @@ int socket(int domain, int type, int protocol)
 	struct netstack *stk = get_netstack();
 	return stk->ops->socket(domain, type, protocol);
 }
+
+
+#ifdef CONFIG_NET_SOCKET_EPOLL
+int epoll_create(int size)
+{
+	struct netstack *stk = get_netstack();
+	return stk->ops->epoll_create(size);
+}
+
+
+int epoll_create1(int flags)
+{
+	if (flags != 0) {
+		set_errno(EINVAL);
+		return -1;
+	}
+
+	return epoll_create(1);
+}
+
+
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event)
+{
+	struct netstack *stk = get_netstack();
+	return stk->ops->epoll_ctl(epfd, op, fd, event);
+}
+
+
+int epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout)
+{
+	/* Treat as a cancellation point */
+	(void)enter_cancellation_point();
+	struct netstack *stk = get_netstack();
+	int res = stk->ops->epoll_wait(epfd, events, maxevents, timeout);
+	leave_cancellation_point();
+	return res;
+}
+
+
+int epoll_close(int epfd)
+{
+	struct netstack *stk = get_netstack();
+	return stk->ops->epoll_close(epfd);
+}
+#endif
 #endif // CONFIG_NET
@@ -19,6 +19,10 @@
 #ifndef _NETMGR_NETSTACK_H__
 #define _NETMGR_NETSTACK_H__
 
+#ifdef CONFIG_NET_SOCKET_EPOLL
+struct epoll_event;
+#endif
+
 struct netstack_ops {
 	// start, stop
 	int (*init)(void *data);
@@ -58,6 +62,12 @@ struct netstack_ops {
 	int (*addroute)(struct rtentry *entry);
 	int (*delroute)(struct rtentry *entry);
 #endif
+#ifdef CONFIG_NET_SOCKET_EPOLL
+	int (*epoll_create)(int size);
+	int (*epoll_ctl)(int epfd, int op, int s, struct epoll_event *event);
+	int (*epoll_wait)(int epfd, struct epoll_event *events, int maxevents, int timeout);
+	int (*epoll_close)(int epfd);
+#endif
 };
 
 struct netstack {
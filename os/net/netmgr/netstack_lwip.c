@@ -18,11 +18,13 @@
 
 #include <tinyara/config.h>
 #include <poll.h>
+#include <sys/epoll.h>
 #include <sys/types.h>
 #include <netinet/in.h>
 #include <net/route.h>
 #include <tinyara/net/net.h>
 #include <fcntl.h>
+#include <errno.h>
 #include "netstack.h"
 #include "lwip/opt.h"
 #include "lwip/init.h"
@@ -147,8 +149,11 @@ static int lwip_ns_vfcntl(int sockfd, int cmd, va_list ap)
 
 static int lwip_ns_poll(int fd, struct pollfd *fds, bool setup)
 {
-	// ToDo
-	return 0;
+#ifndef CONFIG_DISABLE_POLL
+	return lwip_poll(fd, fds, setup);
+#else
+	return -ENOSYS;
+#endif
 }
 
 
@@ -311,6 +316,32 @@ static int lwip_ns_delroute(struct rtentry *entry)
 #endif
 
 
+#ifdef CONFIG_NET_SOCKET_EPOLL
+static int lwip_ns_epoll_create(int size)
+{
+	return lwip_epoll_create(size);
+}
+
+
+static int lwip_ns_epoll_ctl(int epfd, int op, int s, struct epoll_event *event)
+{
+	return lwip_epoll_ctl(epfd, op, s, event);
+}
+
+
+static int lwip_ns_epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout)
+{
+	return lwip_epoll_wait(epfd, events, maxevents, timeout);
+}
+
+
+static int lwip_ns_epoll_close(int epfd)
+{
+	return lwip_epoll_close(epfd);
+}
+#endif
+
+
 struct netstack_ops g_lwip_stack_ops = {
 	lwip_ns_init,
 	lwip_ns_deinit,
@@ -346,7 +377,13 @@ struct netstack_ops g_lwip_stack_ops = {
 	lwip_ns_getsockopt,
 #ifdef CONFIG_NET_ROUTE
 	lwip_ns_addroute,
-	lwip_ns_delroute
+	lwip_ns_delroute,
+#endif
+#ifdef CONFIG_NET_SOCKET_EPOLL
+	lwip_ns_epoll_create,
+	lwip_ns_epoll_ctl,
+	lwip_ns_epoll_wait,
+	lwip_ns_epoll_close,
 #endif
 };
 
@@ -73,6 +73,7 @@
 #include <sys/statfs.h>
 #include <sys/prctl.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
 #include <sys/mount.h>
 #include <sys/boardctl.h>
 
@@ -103,6 +104,7 @@
 
 #include <tinyara/errno.h>
 #include <tinyara/clock.h>
+#include <tinyara/ttrace.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -200,6 +200,7 @@ SYSCALL_LOOKUP(aio_read,                1, SYS_aio_read)
 SYSCALL_LOOKUP(aio_write,               1, SYS_aio_write)
 SYSCALL_LOOKUP(aio_fsync,               2, SYS_aio_fsync)
 SYSCALL_LOOKUP(aio_cancel,              2, SYS_aio_cancel)
+SYSCALL_LOOKUP(lio_listio,              4, SYS_lio_listio)
 #  endif
 #  ifndef CONFIG_DISABLE_POLL
 SYSCALL_LOOKUP(poll,                    3, STUB_poll)
@@ -343,6 +344,16 @@ SYSCALL_LOOKUP(sendto,                  6, STUB_sendto)
 SYSCALL_LOOKUP(setsockopt,              5, STUB_setsockopt)
 SYSCALL_LOOKUP(shutdown,                2, STUB_shutdown)
 SYSCALL_LOOKUP(socket,                  3, STUB_socket)
+
+/* The following are defined only if the epoll socket API is enabled */
+
+#ifdef CONFIG_NET_SOCKET_EPOLL
+SYSCALL_LOOKUP(epoll_close,             1, STUB_epoll_close)
+SYSCALL_LOOKUP(epoll_create,            1, STUB_epoll_create)
+SYSCALL_LOOKUP(epoll_create1,           1, STUB_epoll_create1)
+SYSCALL_LOOKUP(epoll_ctl,               4, STUB_epoll_ctl)
+SYSCALL_LOOKUP(epoll_wait,              4, STUB_epoll_wait)
+#endif
 #endif
 
 /* The following is defined only if CONFIG_TASK_NAME_SIZE > 0 */
@@ -351,6 +362,13 @@ SYSCALL_LOOKUP(socket,                  3, STUB_socket)
 SYSCALL_LOOKUP(prctl,                   5, STUB_prctl)
 #endif
 
+/* The following are defined only if binary T-trace events are enabled */
+
+#ifdef CONFIG_TTRACE_BINARY
+SYSCALL_LOOKUP(ttrace_event,            4, STUB_ttrace_event)
+SYSCALL_LOOKUP(ttrace_intern,           1, STUB_ttrace_intern)
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -202,6 +202,7 @@ uintptr_t STUB_aio_read(int nbr, uintptr_t parm1);
 uintptr_t STUB_aio_write(int nbr, uintptr_t parm1);
 uintptr_t STUB_aio_fsync(int nbr, uintptr_t parm1, uintptr_t parm2);
 uintptr_t STUB_aio_cancel(int nbr, uintptr_t parm1, uintptr_t parm2);
+uintptr_t STUB_lio_listio(int nbr, uintptr_t parm1, uintptr_t parm2, uintptr_t parm3, uintptr_t parm4);
 
 /* Board support */
 
@@ -362,11 +363,31 @@ uintptr_t STUB_shutdown(int nbr, uintptr_t parm1, uintptr_t parm2);
 uintptr_t STUB_socket(int nbr, uintptr_t parm1, uintptr_t parm2,
 					  uintptr_t parm3);
 
+/* The following are defined only if the epoll socket API is enabled */
+
+#ifdef CONFIG_NET_SOCKET_EPOLL
+uintptr_t STUB_epoll_close(int nbr, uintptr_t parm1);
+uintptr_t STUB_epoll_create(int nbr, uintptr_t parm1);
+uintptr_t STUB_epoll_create1(int nbr, uintptr_t parm1);
+uintptr_t STUB_epoll_ctl(int nbr, uintptr_t parm1, uintptr_t parm2,
+						 uintptr_t parm3, uintptr_t parm4);
+uintptr_t STUB_epoll_wait(int nbr, uintptr_t parm1, uintptr_t parm2,
+						  uintptr_t parm3, uintptr_t parm4);
+#endif
+
 /* The following is defined only if CONFIG_TASK_NAME_SIZE > 0 */
 
 uintptr_t STUB_prctl(int nbr, uintptr_t parm1, uintptr_t parm2,
 					 uintptr_t parm3, uintptr_t parm4, uintptr_t parm5);
 
+/* The following are defined only if binary T-trace events are enabled */
+
+#ifdef CONFIG_TTRACE_BINARY
+uintptr_t STUB_ttrace_event(int nbr, uintptr_t parm1, uintptr_t parm2,
+							uintptr_t parm3, uintptr_t parm4);
+uintptr_t STUB_ttrace_intern(int nbr, uintptr_t parm1);
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
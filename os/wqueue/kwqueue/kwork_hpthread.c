@@ -173,7 +173,7 @@ int work_hpstart(void)
 
 	/* Initialize work queue data structures */
 
-	dq_init(&g_hpwork.q);
+	work_qinit((FAR struct wqueue_s *)&g_hpwork, 1);
 
 	/* Start the high-priority, kernel mode worker thread */
 
@@ -208,7 +208,7 @@ int work_lpstart(void)
 
 	memset(&g_lpwork, 0, sizeof(struct wqueue_s));
 
-	dq_init(&g_lpwork.q);
+	work_qinit((FAR struct wqueue_s *)&g_lpwork, CONFIG_SCHED_LPNTHREADS);
 
 	/* Don't permit any of the threads to run until we have fully initialized
 	 * g_lpwork.
@@ -122,6 +122,31 @@
  ****************************************************************************/
 
 int work_queue(int qid, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay)
+{
+	return work_queue_class(qid, work, worker, arg, delay, WORK_CLASS_NORMAL);
+}
+
+/****************************************************************************
+ * Name: work_queue_class
+ *
+ * Description:
+ *   Queue work like work_queue() in a given priority class.
+ *
+ * Input parameters:
+ *   qid    - The work queue ID (index)
+ *   work   - The work structure to queue
+ *   worker - The worker callback to be invoked.
+ *   arg    - The argument that will be passed to the worker callback.
+ *   delay  - Delay (in clock ticks) from the time queue until the worker
+ *            is invoked. Zero means to perform the work immediately.
+ *   wclass - The priority class of the work, one of WORK_CLASS_*
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno on failure
+ *
+ ****************************************************************************/
+
+int work_queue_class(int qid, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay, uint8_t wclass)
 {
 #if defined(CONFIG_SCHED_HPWORK) || defined(CONFIG_SCHED_LPWORK)
 	int result;
@@ -130,7 +155,7 @@ int work_queue(int qid, FAR struct work_s *work, worker_t worker, FAR void *arg,
 	if (qid == HPWORK) {
 		/* Cancel high priority work */
 
-		result = work_qqueue((FAR struct wqueue_s *)&g_hpwork, work, worker, arg, delay);
+		result = work_qqueue((FAR struct wqueue_s *)&g_hpwork, work, worker, arg, delay, wclass);
 		if (result != OK) {
 			return result;
 		}
@@ -141,7 +166,7 @@ int work_queue(int qid, FAR struct work_s *work, worker_t worker, FAR void *arg,
 		if (qid == LPWORK) {
 			/* Cancel low priority work */
 
-			result = work_qqueue((FAR struct wqueue_s *)&g_lpwork, work, worker, arg, delay);
+			result = work_qqueue((FAR struct wqueue_s *)&g_lpwork, work, worker, arg, delay, wclass);
 			if (result != OK) {
 				return result;
 			}
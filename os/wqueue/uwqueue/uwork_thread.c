@@ -167,7 +167,7 @@ int work_usrstart(void)
 {
 	/* Initialize work queue data structures */
 
-	dq_init(&g_usrwork.q);
+	work_qinit(&g_usrwork, 1);
 
 #ifdef CONFIG_BUILD_PROTECTED
 	{
@@ -56,6 +56,8 @@
 #include <tinyara/config.h>
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
 #include <unistd.h>
 #include <signal.h>
 #include <assert.h>
@@ -89,6 +91,37 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: work_latency
+ *
+ * Description:
+ *   Account the latency of work about to be performed: the time from when
+ *   it was due until now.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+static void work_latency(FAR struct wqueue_s *wqueue, FAR struct work_s *work)
+{
+	FAR struct work_stats_s *stats = &wqueue->stats;
+	clock_t latency = clock() - (work->qtime + work->delay);
+	int bucket;
+
+	/* Work is never taken before it is due, but be safe with the wrap */
+
+	if (latency > ((clock_t)-1 >> 1)) {
+		latency = 0;
+	}
+
+	for (bucket = 0; bucket < WORK_LATENCY_BUCKETS - 1 && latency >= ((clock_t)1 << bucket); bucket++) ;
+
+	stats->latency[work->wclass][bucket]++;
+	if (latency > stats->maxlatency[work->wclass]) {
+		stats->maxlatency[work->wclass] = latency;
+	}
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -114,16 +147,17 @@ void work_process(FAR struct wqueue_s *wqueue, int wndx)
 	volatile FAR struct work_s *work;
 	worker_t worker;
 	FAR void *arg;
-	clock_t elapsed;
-	clock_t ctick;
+	bool bulk;
+	struct timespec timeout;
+	uint64_t usec;
 	clock_t next;
+	clock_t ctick;
+	bool delayed;
 
 	/* Then process queued work.  We need to keep interrupts disabled while
 	 * we process items in the work list.
 	 */
 
-	next = 0;
-
 #if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
 	while (work_lock() < 0);
 #else
@@ -131,117 +165,108 @@ void work_process(FAR struct wqueue_s *wqueue, int wndx)
 	flags = irqsave();
 #endif
 
-
-	/* And check each entry in the work queue.  Since we have disabled
-	 * interrupts we know:  (1) we will not be suspended unless we do
-	 * so ourselves, and (2) there will be no changes to the work queue
+	/* Move the delayed work whose time has come to the ready FIFOs, then
+	 * perform the ready work in order of class.  Since we have disabled interrupts
+	 * we know:  (1) we will not be suspended unless we do so ourselves, and
+	 * (2) there will be no changes to the work queue
 	 */
 
-	work = (FAR struct work_s *)wqueue->q.head;
-	
-	while (work) {
-		
-		/* Is this work ready?  It is ready if there is no delay or if
-		 * the delay has elapsed. qtime is the time that the work was added
-		 * to the work queue.  It will always be greater than or equal to
-		 * zero.  Therefore a delay of zero will always execute immediately.
-		 */
+	work_qexpire(wqueue, clock());
+	work = work_qtake(wqueue);
 
-		ctick = clock();
-		elapsed = ctick - work->qtime;
+	while (work) {
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+		work_latency(wqueue, (FAR struct work_s *)work);
+#endif
 
-		if (elapsed >= work->delay) {
-			/* Remove the ready-to-execute work from the list */
+		/* Extract the work description from the entry (in case the work
+		 * instance by the re-used after it has been de-queued).
+		 */
 
-			(void)dq_rem((struct dq_entry_s *)work, &wqueue->q);
+		worker = work->worker;
 
-			/* Extract the work description from the entry (in case the work
-			 * instance by the re-used after it has been de-queued).
-			 */
+		/* Check for a race condition where the work may be nullified
+		 * before it is removed from the queue.
+		 */
 
-			worker = work->worker;
+		if (worker != NULL) {
+			/* Extract the work argument (before re-enabling interrupts) */
 
-			/* Check for a race condition where the work may be nullified
-			 * before it is removed from the queue.
-			 */
+			arg = work->arg;
 
-			if (worker != NULL) {
-				/* Extract the work argument (before re-enabling interrupts) */
+			/* Mark the work as no longer being queued */
 
-				arg = work->arg;
+			work->worker = NULL;
 
-				/* Mark the work as no longer being queued */
+			bulk = (work->wclass == WORK_CLASS_BULK);
+			if (bulk) {
+				wqueue->nbulk++;
+			}
 
-				work->worker = NULL;
+			/* Do the work.  Re-enable interrupts while the work is being
+			 * performed... we don't have any idea how long this will take!
+			 */
 
-				/* Do the work.  Re-enable interrupts while the work is being
-				 * performed... we don't have any idea how long this will take!
-				 */
-				
 #if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
-				work_unlock();
+			work_unlock();
 #else
-				irqrestore(flags);
+			irqrestore(flags);
 #endif
-				worker(arg);
-
-				/* Now, unfortunately, since we re-enabled interrupts we don't
-				 * know the state of the work list and we will have to start
-				 * back at the head of the list.
-				 */
+			worker(arg);
 
 #if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
-				while (work_lock() < 0);
+			while (work_lock() < 0);
 #else
-				flags = irqsave();
+			flags = irqsave();
 #endif
-				work = (FAR struct work_s *)wqueue->q.head;
-			} else {
-				/* Cancelled.. Just move to the next work in the list with
-				 * interrupts still disabled.
-				 */
-
-				work = (FAR struct work_s *)work->dq.flink;
+			if (bulk) {
+				wqueue->nbulk--;
 			}
-		} else {				/* elapsed < work->delay */
+		}
 
-			next = work->delay - elapsed;
+		/* Time has passed while the work was performed */
 
-			/* Then break at while loop due to sorted list */
-			break;
-		}
+		work_qexpire(wqueue, clock());
+		work = work_qtake(wqueue);
 	}
 
-	if (wqueue->q.head == NULL) {
+	/* No ready work can be taken.  Sleep until the earliest delayed work is
+	 * due or until we are signalled that new work was queued.
+	 */
+
+	delayed = work_qnext(wqueue, &next);
+	ctick = clock();
+
 #if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
-		work_unlock();
+	work_unlock();
 #endif
-		sigset_t set;
-		sigemptyset(&set);
-		sigaddset(&set, SIGWORK);
 
+	sigset_t set;
+	sigemptyset(&set);
+	sigaddset(&set, SIGWORK);
+
+	if (!delayed) {
 		/* Wait indefinitely until signalled with SIGWORK */
+
 		wqueue->worker[wndx].busy = false;
 		DEBUGVERIFY(sigwaitinfo(&set, NULL));
 		wqueue->worker[wndx].busy = true;
-	} else if (next > 0) {
-#if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
-		work_unlock();
-#endif
-		/* Wait awhile to check the work list.  We will wait here until
-		 * either the time elapses or until we are awakened by a signal.
-		 * Interrupts will be re-enabled while we wait.
+	} else if (next - ctick - 1 < ((clock_t)-1 >> 1)) {
+		/* next is after ctick.  Wait until then, the timeout is converted
+		 * back to exactly (next - ctick) ticks.  Interrupts will be
+		 * re-enabled while we wait.
 		 */
+
+		usec = (uint64_t)(next - ctick) * USEC_PER_TICK;
+		timeout.tv_sec = usec / USEC_PER_SEC;
+		timeout.tv_nsec = (usec % USEC_PER_SEC) * NSEC_PER_USEC;
+
 		wqueue->worker[wndx].busy = false;
-		usleep(next * USEC_PER_TICK);
+		(void)sigtimedwait(&set, NULL, &timeout);
 		wqueue->worker[wndx].busy = true;
 	}
-#if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
-	else {
-		work_unlock();
-	}
-#else
+
+#if !defined(CONFIG_SCHED_USRWORK) || defined(__KERNEL__)
 	irqrestore(flags);
 #endif
-
 }
@@ -110,19 +110,17 @@
  *            int is invoked.
  *   delay  - Delay (in clock ticks) from the time queue until the worker
  *            is invoked. Zero means to perform the work immediately.
+ *   wclass - The priority class of the work, one of WORK_CLASS_*
  *
  * Returned Value:
  *   Zero (OK) on success, a negated errno on failure.
  *
  ****************************************************************************/
 
-int work_qqueue(FAR struct wqueue_s *wqueue, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay)
+int work_qqueue(FAR struct wqueue_s *wqueue, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay, uint8_t wclass)
 {
-	DEBUGASSERT(work != NULL);
+	DEBUGASSERT(work != NULL && wclass < WORK_NCLASSES);
 
-	struct work_s *next_work = NULL;
-	struct work_s *cur_work;
-	clock_t elapsed;
 	clock_t ctick;
 	ctick = clock();
 
@@ -134,37 +132,24 @@ int work_qqueue(FAR struct wqueue_s *wqueue, FAR struct work_s *work, worker_t w
 #endif
 
 	/* check whether requested work is in queue list or not */
-	cur_work = (struct work_s *)wqueue->q.head;
-	while (cur_work != NULL) {
-		if (cur_work == work) {
+	if (work_qqueued(wqueue, work)) {
 #if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
-			work_unlock();
+		work_unlock();
 #else
-			irqrestore(flags);
+		irqrestore(flags);
 #endif
-			return -EALREADY;
-		}
-
-		if (next_work == NULL) {
-			elapsed = ctick - cur_work->qtime;
-			if (cur_work->delay > elapsed && cur_work->delay - elapsed > delay) {
-				next_work = cur_work;
-			}
-		}
-
-		cur_work = (struct work_s *)cur_work->dq.flink;
+		return -EALREADY;
 	}
 
 	work->worker = worker;		/* Work callback */
 	work->arg = arg;		/* Callback argument */
 	work->delay = delay;		/* Delay until work performed */
 	work->qtime = ctick;		/* Time work queued */
+	work->wclass = wclass;		/* Priority class */
 
-	if (next_work) {
-		dq_addbefore((FAR dq_entry_t *)next_work, (FAR dq_entry_t *)work, &wqueue->q);
-	} else {
-		dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
-	}
+	/* Immediate work goes to a ready FIFO, delayed work to the timer wheel */
+
+	work_qadd(wqueue, work);
 #if defined(CONFIG_SCHED_USRWORK) && !defined(__KERNEL__)
 	work_unlock();
 #else
@@ -0,0 +1,400 @@
+/****************************************************************************
+ *
+ * Copyright 2019 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * wqueue/work_wheel.c
+ *
+ * The pending work of a work queue is split in two: one FIFO per priority
+ * class of work that is ready to be performed and a hierarchical timer
+ * wheel holding the work whose delay has not elapsed yet.  Adding and
+ * removing work is O(1); the workers advance the wheel to the current time,
+ * which moves the expired work to the FIFOs in expiry order, take work from
+ * the FIFOs by class and then sleep until the next expiry.
+ *
+ * A slot of level 0 holds the work expiring at one tick.  A slot of level
+ * n spans WORK_WHEEL_SLOTS slots of level n - 1; when the wheel reaches the
+ * first tick of such a slot, its work is placed again in the lower levels
+ * ("cascaded").  All functions but work_qinit() must be called with the
+ * work queue locked.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+#include <assert.h>
+
+#include <tinyara/clock.h>
+#include <tinyara/wqueue.h>
+
+#include "wqueue.h"
+
+#ifdef CONFIG_SCHED_WORKQUEUE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* True if tick 'a' comes before tick 'b', allowing for the clock wrapping */
+
+#define WORK_BEFORE(a, b)    ((clock_t)((a) - (b)) > ((clock_t)-1 >> 1))
+
+/* Number of ticks covered by the whole wheel */
+
+#define WORK_WHEEL_SPAN      ((clock_t)1 << (WORK_WHEEL_BITS * WORK_WHEEL_LEVELS))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: work_wheel_insert
+ *
+ * Description:
+ *   Put work expiring at or after wheel->base into the slot matching its
+ *   expiry.
+ *
+ ****************************************************************************/
+
+static void work_wheel_insert(FAR struct work_wheel_s *wheel, FAR struct work_s *work)
+{
+	FAR struct dq_queue_s *list;
+	clock_t expiry = work->qtime + work->delay;
+	clock_t delta = expiry - wheel->base;
+	int level;
+	int index;
+
+	for (level = 0; level < WORK_WHEEL_LEVELS - 1; level++) {
+		if (delta < ((clock_t)1 << (WORK_WHEEL_BITS * (level + 1)))) {
+			break;
+		}
+	}
+
+	/* Too far in the future: park it in the last slot the wheel covers */
+
+	if (delta >= WORK_WHEEL_SPAN) {
+		expiry = wheel->base + WORK_WHEEL_SPAN - 1;
+	}
+
+	index = (expiry >> (WORK_WHEEL_BITS * level)) & WORK_WHEEL_MASK;
+	list = &wheel->slot[level][index];
+
+	dq_addlast((FAR dq_entry_t *)work, list);
+	work->list = list;
+	wheel->map[level] |= (uint32_t)1 << index;
+}
+
+/****************************************************************************
+ * Name: work_wheel_cascade
+ *
+ * Description:
+ *   Place again the work of one slot of level 1 or above.
+ *
+ ****************************************************************************/
+
+static void work_wheel_cascade(FAR struct work_wheel_s *wheel, int level, int index)
+{
+	FAR struct dq_queue_s list = wheel->slot[level][index];
+	FAR struct work_s *work;
+
+	dq_init(&wheel->slot[level][index]);
+	wheel->map[level] &= ~((uint32_t)1 << index);
+
+	while ((work = (FAR struct work_s *)dq_remfirst(&list)) != NULL) {
+		work_wheel_insert(wheel, work);
+	}
+}
+
+/****************************************************************************
+ * Name: work_wheel_first
+ *
+ * Description:
+ *   Return the time at which the wheel reaches the first non-empty slot of
+ *   'level': the expiry of its work for level 0, the time it is cascaded
+ *   for the other levels.
+ *
+ ****************************************************************************/
+
+static clock_t work_wheel_first(FAR struct work_wheel_s *wheel, int level)
+{
+	int shift = WORK_WHEEL_BITS * level;
+	clock_t block = wheel->base >> shift;
+	int i;
+
+	/* A slot whose first tick has passed is cascaded one turn later */
+
+	if ((wheel->base & (((clock_t)1 << shift) - 1)) != 0) {
+		block++;
+	}
+
+	for (i = 0; i < WORK_WHEEL_SLOTS; i++) {
+		if (wheel->map[level] & ((uint32_t)1 << ((block + i) & WORK_WHEEL_MASK))) {
+			break;
+		}
+	}
+
+	DEBUGASSERT(i < WORK_WHEEL_SLOTS);
+	return (block + i) << shift;
+}
+
+/****************************************************************************
+ * Name: work_wheel_next
+ *
+ * Description:
+ *   Return the earliest time returned by work_wheel_first() over the levels
+ *   from 'level' up, or false if they are all empty.
+ *
+ ****************************************************************************/
+
+static bool work_wheel_next(FAR struct work_wheel_s *wheel, int level, FAR clock_t *next)
+{
+	bool found = false;
+	clock_t first;
+
+	for (; level < WORK_WHEEL_LEVELS; level++) {
+		if (wheel->map[level] != 0) {
+			first = work_wheel_first(wheel, level);
+			if (!found || first - wheel->base < *next - wheel->base) {
+				*next = first;
+				found = true;
+			}
+		}
+	}
+
+	return found;
+}
+
+/****************************************************************************
+ * Name: work_qready
+ *
+ * Description:
+ *   Append work to the ready FIFO of its class.
+ *
+ ****************************************************************************/
+
+static void work_qready(FAR struct wqueue_s *wqueue, FAR struct work_s *work)
+{
+	FAR struct dq_queue_s *list = &wqueue->q[work->wclass];
+
+	dq_addlast((FAR dq_entry_t *)work, list);
+	work->list = list;
+}
+
+/****************************************************************************
+ * Name: work_qholds
+ *
+ * Description:
+ *   Check that 'work' is linked in 'list'.  This does not trust
+ *   work->list alone since the caller may not have initialized it.
+ *
+ ****************************************************************************/
+
+static bool work_qholds(FAR struct dq_queue_s *list, FAR struct work_s *work)
+{
+	if (work->dq.blink != NULL) {
+		return work->dq.blink->flink == (FAR dq_entry_t *)work;
+	}
+
+	return list->head == (FAR dq_entry_t *)work;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: work_qinit
+ ****************************************************************************/
+
+void work_qinit(FAR struct wqueue_s *wqueue, int nworkers)
+{
+	int level;
+	int index;
+
+	for (index = 0; index < WORK_NCLASSES; index++) {
+		dq_init(&wqueue->q[index]);
+	}
+
+	for (level = 0; level < WORK_WHEEL_LEVELS; level++) {
+		for (index = 0; index < WORK_WHEEL_SLOTS; index++) {
+			dq_init(&wqueue->wheel.slot[level][index]);
+		}
+
+		wqueue->wheel.map[level] = 0;
+	}
+
+	wqueue->wheel.base = clock();
+	wqueue->nworkers = nworkers;
+	wqueue->nbulk = 0;
+}
+
+/****************************************************************************
+ * Name: work_qqueued
+ ****************************************************************************/
+
+bool work_qqueued(FAR struct wqueue_s *wqueue, FAR struct work_s *work)
+{
+	FAR struct dq_queue_s *list = work->list;
+	FAR struct dq_queue_s *first = &wqueue->wheel.slot[0][0];
+
+	if ((list < wqueue->q || list >= wqueue->q + WORK_NCLASSES) && (list < first || list >= first + WORK_WHEEL_LEVELS * WORK_WHEEL_SLOTS)) {
+		return false;
+	}
+
+	return work_qholds(list, work);
+}
+
+/****************************************************************************
+ * Name: work_qadd
+ ****************************************************************************/
+
+void work_qadd(FAR struct wqueue_s *wqueue, FAR struct work_s *work)
+{
+	FAR struct work_wheel_s *wheel = &wqueue->wheel;
+	int level;
+
+	if (work->delay == 0 || WORK_BEFORE(work->qtime + work->delay, wheel->base)) {
+		work_qready(wqueue, work);
+		return;
+	}
+
+	/* The base of an empty wheel may be far behind, catch up at once */
+
+	for (level = 0; level < WORK_WHEEL_LEVELS && wheel->map[level] == 0; level++) ;
+	if (level == WORK_WHEEL_LEVELS) {
+		wheel->base = work->qtime;
+	}
+
+	work_wheel_insert(wheel, work);
+}
+
+/****************************************************************************
+ * Name: work_qrem
+ ****************************************************************************/
+
+bool work_qrem(FAR struct wqueue_s *wqueue, FAR struct work_s *work)
+{
+	FAR struct dq_queue_s *list = work->list;
+	FAR struct dq_queue_s *first = &wqueue->wheel.slot[0][0];
+	int index;
+
+	if (!work_qqueued(wqueue, work)) {
+		return false;
+	}
+
+	dq_rem((FAR dq_entry_t *)work, list);
+	work->list = NULL;
+
+	if (list >= first && list->head == NULL) {
+		index = list - first;
+		wqueue->wheel.map[index / WORK_WHEEL_SLOTS] &= ~((uint32_t)1 << (index % WORK_WHEEL_SLOTS));
+	}
+
+	return true;
+}
+
+/****************************************************************************
+ * Name: work_qexpire
+ ****************************************************************************/
+
+void work_qexpire(FAR struct wqueue_s *wqueue, clock_t now)
+{
+	FAR struct work_wheel_s *wheel = &wqueue->wheel;
+	FAR struct dq_queue_s *list;
+	FAR struct work_s *work;
+	clock_t next;
+	int level;
+	int index;
+
+	while (!WORK_BEFORE(now, wheel->base)) {
+		if (wheel->map[0] == 0) {
+			/* Nothing expires before the next cascade, skip to it */
+
+			if (!work_wheel_next(wheel, 1, &next) || WORK_BEFORE(now, next)) {
+				wheel->base = now + 1;
+				break;
+			}
+
+			wheel->base = next;
+		}
+
+		/* Cascade the slots starting at this tick, top level first */
+
+		for (level = WORK_WHEEL_LEVELS - 1; level > 0; level--) {
+			if ((wheel->base & (((clock_t)1 << (WORK_WHEEL_BITS * level)) - 1)) == 0) {
+				index = (wheel->base >> (WORK_WHEEL_BITS * level)) & WORK_WHEEL_MASK;
+				if (wheel->map[level] & ((uint32_t)1 << index)) {
+					work_wheel_cascade(wheel, level, index);
+				}
+			}
+		}
+
+		/* Then the work expiring at this tick is ready */
+
+		index = wheel->base & WORK_WHEEL_MASK;
+		list = &wheel->slot[0][index];
+		while ((work = (FAR struct work_s *)dq_remfirst(list)) != NULL) {
+			work_qready(wqueue, work);
+		}
+
+		wheel->map[0] &= ~((uint32_t)1 << index);
+		wheel->base++;
+	}
+}
+
+/****************************************************************************
+ * Name: work_qtake
+ ****************************************************************************/
+
+FAR struct work_s *work_qtake(FAR struct wqueue_s *wqueue)
+{
+	FAR struct work_s *work;
+	int wclass;
+
+	for (wclass = 0; wclass < WORK_NCLASSES; wclass++) {
+		/* Keep one worker available for the other classes */
+
+		if (wclass == WORK_CLASS_BULK && wqueue->nworkers > 1 && wqueue->nbulk >= wqueue->nworkers - 1) {
+			break;
+		}
+
+		work = (FAR struct work_s *)dq_remfirst(&wqueue->q[wclass]);
+		if (work != NULL) {
+			work->list = NULL;
+			return work;
+		}
+	}
+
+	return NULL;
+}
+
+/****************************************************************************
+ * Name: work_qnext
+ ****************************************************************************/
+
+bool work_qnext(FAR struct wqueue_s *wqueue, FAR clock_t *next)
+{
+	return work_wheel_next(&wqueue->wheel, 0, next);
+}
+
+#endif							/* CONFIG_SCHED_WORKQUEUE */
@@ -60,6 +60,7 @@
 #include <tinyara/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <queue.h>
 #include <semaphore.h>
@@ -75,6 +76,18 @@
 #define HPWORKNAME "hpwork"
 #define LPWORKNAME "lpwork"
 
+/* Delayed work is kept in a hierarchical timer wheel.  Each level has
+ * WORK_WHEEL_SLOTS slots and each slot of a level spans all of the slots of
+ * the level below, so three levels of 16 slots cover 4096 ticks.  Work due
+ * later than that waits in the last slot of the top level and is placed
+ * again when that slot is cascaded.
+ */
+
+#define WORK_WHEEL_BITS    4
+#define WORK_WHEEL_SLOTS   (1 << WORK_WHEEL_BITS)
+#define WORK_WHEEL_MASK    (WORK_WHEEL_SLOTS - 1)
+#define WORK_WHEEL_LEVELS  3
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -86,10 +99,24 @@ struct worker_s {
 	volatile bool busy;			/* True: Worker is not available */
 };
 
+/* The timer wheel of one work queue */
+
+struct work_wheel_s {
+	clock_t base;				/* Next tick to be processed */
+	uint32_t map[WORK_WHEEL_LEVELS];	/* Non-empty slots of each level */
+	struct dq_queue_s slot[WORK_WHEEL_LEVELS][WORK_WHEEL_SLOTS];
+};
+
 /* This structure defines the state of work queue */
 
 struct wqueue_s {
-	struct dq_queue_s q;		/* The queue of pending work */
+	struct dq_queue_s q[WORK_NCLASSES];	/* FIFOs of ready work, one per class */
+	struct work_wheel_s wheel;	/* Work waiting for its delay to elapse */
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+	struct work_stats_s stats;	/* Latency statistics */
+#endif
+	uint8_t nworkers;			/* Number of worker threads */
+	uint8_t nbulk;				/* Number of workers performing bulk work */
 	struct worker_s worker[1];	/* Describes a worker thread */
 };
 
@@ -99,7 +126,13 @@ struct wqueue_s {
 
 #ifdef CONFIG_SCHED_HPWORK
 struct hp_wqueue_s {
-	struct dq_queue_s q;		/* The queue of pending work */
+	struct dq_queue_s q[WORK_NCLASSES];	/* FIFOs of ready work, one per class */
+	struct work_wheel_s wheel;	/* Work waiting for its delay to elapse */
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+	struct work_stats_s stats;	/* Latency statistics */
+#endif
+	uint8_t nworkers;			/* Number of worker threads */
+	uint8_t nbulk;				/* Number of workers performing bulk work */
 	struct worker_s worker[1];	/* Describes the single high priority worker */
 };
 #endif
@@ -110,7 +143,13 @@ struct hp_wqueue_s {
 
 #ifdef CONFIG_SCHED_LPWORK
 struct lp_wqueue_s {
-	struct dq_queue_s q;		/* The queue of pending work */
+	struct dq_queue_s q[WORK_NCLASSES];	/* FIFOs of ready work, one per class */
+	struct work_wheel_s wheel;	/* Work waiting for its delay to elapse */
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+	struct work_stats_s stats;	/* Latency statistics */
+#endif
+	uint8_t nworkers;			/* Number of worker threads */
+	uint8_t nbulk;				/* Number of workers performing bulk work */
 
 	/* Describes each thread in the low priority queue's thread pool */
 	struct worker_s worker[CONFIG_SCHED_LPNTHREADS];
@@ -185,6 +224,133 @@ int work_lock(void);
 void work_unlock(void);
 #endif
 
+/****************************************************************************
+ * Name: work_qinit
+ *
+ * Description:
+ *   Initialize the ready FIFOs and the timer wheel of a work queue.
+ *
+ * Input parameters:
+ *   wqueue   - The work queue to initialize
+ *   nworkers - The number of worker threads of the work queue
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void work_qinit(FAR struct wqueue_s *wqueue, int nworkers);
+
+/****************************************************************************
+ * Name: work_qqueued
+ *
+ * Description:
+ *   Check whether work is pending on a work queue.  The work queue must be
+ *   locked.
+ *
+ * Input parameters:
+ *   wqueue - The work queue
+ *   work   - The work to check
+ *
+ * Returned Value:
+ *   true if the work is in a ready FIFO or in the timer wheel.
+ *
+ ****************************************************************************/
+
+bool work_qqueued(FAR struct wqueue_s *wqueue, FAR struct work_s *work);
+
+/****************************************************************************
+ * Name: work_qadd
+ *
+ * Description:
+ *   Add work to the ready FIFO of its class if its delay has elapsed or to
+ *   the timer wheel otherwise.  work->qtime, work->delay and work->wclass
+ *   must be set.  The work queue must be locked.
+ *
+ * Input parameters:
+ *   wqueue - The work queue
+ *   work   - The work to add
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void work_qadd(FAR struct wqueue_s *wqueue, FAR struct work_s *work);
+
+/****************************************************************************
+ * Name: work_qrem
+ *
+ * Description:
+ *   Remove work from the list holding it.  The work queue must be locked.
+ *
+ * Input parameters:
+ *   wqueue - The work queue
+ *   work   - The work to remove
+ *
+ * Returned Value:
+ *   true if the work was queued on this work queue, false otherwise.
+ *
+ ****************************************************************************/
+
+bool work_qrem(FAR struct wqueue_s *wqueue, FAR struct work_s *work);
+
+/****************************************************************************
+ * Name: work_qtake
+ *
+ * Description:
+ *   Remove the oldest ready work of the first class that has some.  Bulk
+ *   work is not taken if all of the other workers of a multi-threaded work
+ *   queue are already performing bulk work.  The work queue must be locked.
+ *
+ * Input parameters:
+ *   wqueue - The work queue
+ *
+ * Returned Value:
+ *   The work to perform, or NULL if there is none.
+ *
+ ****************************************************************************/
+
+FAR struct work_s *work_qtake(FAR struct wqueue_s *wqueue);
+
+/****************************************************************************
+ * Name: work_qexpire
+ *
+ * Description:
+ *   Advance the timer wheel up to 'now' and move the work whose delay has
+ *   elapsed to the tail of the ready FIFO of its class.  The work queue must
+ *   be locked.
+ *
+ * Input parameters:
+ *   wqueue - The work queue
+ *   now    - The current time in clock ticks
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void work_qexpire(FAR struct wqueue_s *wqueue, clock_t now);
+
+/****************************************************************************
+ * Name: work_qnext
+ *
+ * Description:
+ *   Return the time at which the worker must next look at the timer wheel:
+ *   either the expiry of the earliest work or the time a slot holding it
+ *   is cascaded.  The work queue must be locked.
+ *
+ * Input parameters:
+ *   wqueue - The work queue
+ *   next   - Location to return the time in clock ticks
+ *
+ * Returned Value:
+ *   false if there is no delayed work.
+ *
+ ****************************************************************************/
+
+bool work_qnext(FAR struct wqueue_s *wqueue, FAR clock_t *next);
+
 /****************************************************************************
  * Name: work_qcancel
  *
@@ -231,13 +397,14 @@ int work_qcancel(FAR struct wqueue_s *wqueue, FAR struct work_s *work);
  *            int is invoked.
  *   delay  - Delay (in clock ticks) from the time queue until the worker
  *            is invoked. Zero means to perform the work immediately.
+ *   wclass - The priority class of the work, one of WORK_CLASS_*
  *
  * Returned Value:
  *   Zero (OK) on success, a negated errno on failure.
  *
  ****************************************************************************/
 
-int work_qqueue(FAR struct wqueue_s *wqueue, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay);
+int work_qqueue(FAR struct wqueue_s *wqueue, FAR struct work_s *work, worker_t worker, FAR void *arg, clock_t delay, uint8_t wclass);
 
 /****************************************************************************
  * Name: work_process
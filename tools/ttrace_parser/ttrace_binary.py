@@ -0,0 +1,375 @@
+#!/usr/bin/env python3
+###########################################################################
+#
+# Copyright 2019 Samsung Electronics All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific
+# language governing permissions and limitations under the License.
+#
+###########################################################################
+#
+# Convert a binary T-trace dump (CONFIG_TTRACE_BINARY) to the JSON trace
+# format of Chrome / Perfetto, or to a CTF trace.
+#
+# The input is either the raw dump read from the T-trace device, or a
+# console log of 'ttrace -p' in which the dump is printed as "TTRB:" lines.
+#
+# The layout of the dump is described in os/include/tinyara/ttrace.h.
+#
+
+import json
+import optparse
+import os
+import struct
+import sys
+
+DUMP_MAGIC = 0x42525454
+DUMP_VERSION = 1
+HEADER_SIZE = 24
+STRING_SIZE = 32
+TASK_SIZE = 16
+EVENT_SIZE = 16
+
+EVENT_BEGIN = 1
+EVENT_END = 2
+EVENT_BEGIN_UID = 3
+EVENT_END_UID = 4
+EVENT_SCHED = 5
+EVENT_IRQ_ENTER = 6
+EVENT_IRQ_LEAVE = 7
+EVENT_SEM_WAIT = 8
+EVENT_SEM_POST = 9
+EVENT_MQ_SEND = 10
+EVENT_MQ_RECEIVE = 11
+EVENT_SYSCALL_ENTER = 12
+EVENT_SYSCALL_LEAVE = 13
+
+TAG_NAMES = ["apps", "libs", "lock", "task", "ipc", "irq", "sys"]
+
+# Tracks that are not tasks in the JSON output
+
+PROCESS_ID = 0
+CPU_TID = 100000
+IRQ_TID = 100001
+
+
+class TraceDump:
+    def __init__(self, data):
+        if len(data) < HEADER_SIZE:
+            raise ValueError("dump is too short")
+
+        if struct.unpack("<I", data[:4])[0] == DUMP_MAGIC:
+            self.order = "<"
+        elif struct.unpack(">I", data[:4])[0] == DUMP_MAGIC:
+            self.order = ">"
+        else:
+            raise ValueError("not a binary T-trace dump")
+
+        (magic, self.version, self.evsize, self.freq, nevents, self.lost,
+         nstrings, ntasks) = struct.unpack(self.order + "IHHIIIHH", data[:HEADER_SIZE])
+        if self.version != DUMP_VERSION:
+            raise ValueError("unsupported dump version %d" % self.version)
+        if self.evsize != EVENT_SIZE:
+            raise ValueError("unsupported event size %d" % self.evsize)
+
+        offset = HEADER_SIZE
+        self.strings = {}
+        for i in range(nstrings):
+            raw = data[offset:offset + STRING_SIZE].split(b"\0", 1)[0]
+            if raw:
+                self.strings[i + 1] = raw.decode("utf-8", "replace")
+            offset += STRING_SIZE
+
+        self.tasks = {}
+        for i in range(ntasks):
+            pid, prio, pad, comm = struct.unpack(self.order + "hBB12s", data[offset:offset + TASK_SIZE])
+            self.tasks[pid] = comm.split(b"\0", 1)[0].decode("utf-8", "replace")
+            offset += TASK_SIZE
+
+        end = offset + nevents * EVENT_SIZE
+        if len(data) < end:
+            sys.stderr.write("warning: dump truncated, %d of %d events\n" %
+                             ((len(data) - offset) // EVENT_SIZE, nevents))
+            nevents = (len(data) - offset) // EVENT_SIZE
+            end = offset + nevents * EVENT_SIZE
+        self.rawevents = data[offset:end]
+
+        # Unwrap the 32-bit timestamps, which are in order
+
+        self.events = []
+        base = 0
+        last = None
+        for i in range(nevents):
+            ts, pid, type, tag, arg0, arg1 = struct.unpack(self.order + "IhBBII",
+                                                           self.rawevents[i * EVENT_SIZE:(i + 1) * EVENT_SIZE])
+            if last is not None and ts < last:
+                base += 1 << 32
+            last = ts
+            self.events.append((base + ts, pid, type, tag, arg0, arg1))
+        self.start = self.events[0][0] if self.events else 0
+
+    def string(self, id):
+        return self.strings.get(id, "string %d" % id)
+
+    def taskname(self, pid):
+        return self.tasks.get(pid, "pid %d" % pid)
+
+    def tagname(self, tag):
+        if tag < len(TAG_NAMES):
+            return TAG_NAMES[tag]
+        return "tag%d" % tag
+
+    def microseconds(self, ts):
+        # Relative to the first event, the counter may not start at zero
+
+        if self.freq == 0:
+            return float(ts - self.start)
+        return (ts - self.start) * 1000000.0 / self.freq
+
+
+def read_input(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if len(data) >= 4 and data[:4] in (b"TTRB", b"BRTT"):
+        return data
+
+    # Console log: "TTRB:<offset> <hex bytes>" lines, up to "TTRB:end <size>"
+
+    dump = bytearray()
+    size = None
+    for line in data.decode("latin-1").splitlines():
+        index = line.find("TTRB:")
+        if index < 0:
+            continue
+        fields = line[index + 5:].split()
+        if not fields:
+            continue
+        if fields[0] == "end":
+            size = int(fields[1], 16)
+            break
+        offset = int(fields[0], 16)
+        chunk = bytes.fromhex(fields[1]) if len(fields) > 1 else b""
+        if offset > len(dump):
+            dump.extend(b"\0" * (offset - len(dump)))
+        dump[offset:offset + len(chunk)] = chunk
+
+    if not dump:
+        raise ValueError("no binary T-trace dump in %s" % path)
+    if size is not None and size != len(dump):
+        sys.stderr.write("warning: dump has %d of %d bytes\n" % (len(dump), size))
+
+    return bytes(dump)
+
+
+def unpack_task(value):
+    pid = value & 0xffff
+    if pid >= 0x8000:
+        pid -= 0x10000
+    return pid, (value >> 16) & 0xff, (value >> 24) & 0xff
+
+
+def to_json(dump):
+    events = []
+    pids = set()
+    running = None
+
+    for ts, pid, type, tag, arg0, arg1 in dump.events:
+        us = dump.microseconds(ts)
+        cat = dump.tagname(tag)
+        common = {"pid": PROCESS_ID, "ts": us, "cat": cat}
+
+        if type == EVENT_BEGIN:
+            events.append(dict(common, ph="B", tid=pid, name=dump.string(arg0)))
+        elif type == EVENT_BEGIN_UID:
+            events.append(dict(common, ph="B", tid=pid, name="uid %d" % arg0))
+        elif type in (EVENT_END, EVENT_END_UID):
+            events.append(dict(common, ph="E", tid=pid))
+        elif type == EVENT_SCHED:
+            prev, prevprio, prevstate = unpack_task(arg0)
+            next, nextprio, nextstate = unpack_task(arg1)
+            if running is not None:
+                events.append(dict(common, ph="E", tid=CPU_TID))
+            events.append(dict(common, ph="B", tid=CPU_TID, name=dump.taskname(next),
+                               args={"prev_pid": prev, "prev_prio": prevprio, "prev_state": prevstate,
+                                     "next_pid": next, "next_prio": nextprio}))
+            running = next
+            pids.update((prev, next))
+        elif type == EVENT_IRQ_ENTER:
+            events.append(dict(common, ph="B", tid=IRQ_TID, name="irq %d" % arg0))
+        elif type == EVENT_IRQ_LEAVE:
+            events.append(dict(common, ph="E", tid=IRQ_TID))
+        elif type in (EVENT_SEM_WAIT, EVENT_SEM_POST):
+            count = arg1 - (1 << 32) if arg1 >= (1 << 31) else arg1
+            name = "sem_wait" if type == EVENT_SEM_WAIT else "sem_post"
+            events.append(dict(common, ph="i", s="t", tid=pid, name=name,
+                               args={"sem": "0x%08x" % arg0, "count": count}))
+        elif type in (EVENT_MQ_SEND, EVENT_MQ_RECEIVE):
+            name = "mq_send" if type == EVENT_MQ_SEND else "mq_receive"
+            events.append(dict(common, ph="i", s="t", tid=pid, name=name,
+                               args={"mq": "0x%08x" % arg0, "len": arg1 & 0xffff, "prio": arg1 >> 16}))
+        elif type == EVENT_SYSCALL_ENTER:
+            events.append(dict(common, ph="B", tid=pid, name="syscall %d" % arg0))
+        elif type == EVENT_SYSCALL_LEAVE:
+            events.append(dict(common, ph="E", tid=pid, args={"ret": arg0}))
+        else:
+            sys.stderr.write("warning: unknown event type %d\n" % type)
+            continue
+
+        pids.add(pid)
+
+    if running is not None and dump.events:
+        events.append({"pid": PROCESS_ID, "tid": CPU_TID, "ph": "E", "cat": "task",
+                       "ts": dump.microseconds(dump.events[-1][0])})
+
+    metadata = [{"pid": PROCESS_ID, "tid": 0, "ph": "M", "name": "process_name", "args": {"name": "TizenRT"}},
+                {"pid": PROCESS_ID, "tid": CPU_TID, "ph": "M", "name": "thread_name", "args": {"name": "CPU"}},
+                {"pid": PROCESS_ID, "tid": IRQ_TID, "ph": "M", "name": "thread_name", "args": {"name": "IRQ"}}]
+    for pid in sorted(pids | set(dump.tasks)):
+        metadata.append({"pid": PROCESS_ID, "tid": pid, "ph": "M", "name": "thread_name",
+                         "args": {"name": "%s-%d" % (dump.taskname(pid), pid)}})
+
+    return {"traceEvents": metadata + events, "displayTimeUnit": "ns",
+            "otherData": {"freq": dump.freq, "lost": dump.lost}}
+
+
+def tsdl_string(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def to_ctf(dump, path):
+    byte_order = "le" if dump.order == "<" else "be"
+
+    # The packed task and message arguments, low bits first in memory for
+    # little endian targets
+
+    task_fields = ["task_pid pid;", "uint8_t prio;", "uint8_t state;"]
+    msg_fields = ["uint16_t len;", "uint8_t prio;", "uint8_t pad;"]
+    if byte_order == "be":
+        task_fields.reverse()
+        msg_fields.reverse()
+
+    strings = ",\n\t".join("%s = %d" % (tsdl_string(s), id) for id, s in sorted(dump.strings.items()))
+    tasks = ",\n\t".join("%s = %d" % (tsdl_string("%s-%d" % (name, pid)), pid)
+                         for pid, name in sorted(dump.tasks.items()))
+
+    lines = ["/* CTF 1.8 */", "",
+             "typealias integer { size = 8; align = 8; signed = false; } := uint8_t;",
+             "typealias integer { size = 16; align = 8; signed = false; } := uint16_t;",
+             "typealias integer { size = 16; align = 8; signed = true; } := int16_t;",
+             "typealias integer { size = 32; align = 8; signed = false; } := uint32_t;",
+             "typealias integer { size = 32; align = 8; signed = true; } := int32_t;",
+             "typealias integer { size = 32; align = 8; signed = false; base = hex; } := xint32_t;",
+             "",
+             "trace {",
+             "\tmajor = 1;",
+             "\tminor = 8;",
+             "\tbyte_order = %s;" % byte_order,
+             "};",
+             "",
+             "clock {",
+             "\tname = ttrace;",
+             "\tfreq = %d;" % (dump.freq if dump.freq else 1000000),
+             "};",
+             "",
+             "typealias integer { size = 32; align = 8; signed = false; map = clock.ttrace.value; } := ttrace_clock_t;",
+             "",
+             "enum string_id : uint32_t {",
+             "\t" + (strings if strings else '"none" = 0'),
+             "};",
+             "",
+             "enum task_pid : int16_t {",
+             "\t" + (tasks if tasks else '"none" = -1'),
+             "};",
+             "",
+             "stream {",
+             "\tevent.header := struct {",
+             "\t\tttrace_clock_t timestamp;",
+             "\t\ttask_pid pid;",
+             "\t\tuint8_t id;",
+             "\t\tuint8_t tag;",
+             "\t};",
+             "};",
+             ""]
+
+    def event(id, name, fields):
+        lines.extend(["event {", "\tname = %s;" % tsdl_string(name), "\tid = %d;" % id, "\tfields := struct {"] +
+                     ["\t\t" + field for field in fields] + ["\t};", "};", ""])
+
+    event(EVENT_BEGIN, "begin", ["string_id name;", "uint32_t unused;"])
+    event(EVENT_END, "end", ["uint32_t unused0;", "uint32_t unused1;"])
+    event(EVENT_BEGIN_UID, "begin_uid", ["uint32_t uid;", "uint32_t unused;"])
+    event(EVENT_END_UID, "end_uid", ["uint32_t unused0;", "uint32_t unused1;"])
+    event(EVENT_SCHED, "sched_switch", ["struct { %s } prev;" % " ".join(task_fields),
+                                        "struct { %s } next;" % " ".join(task_fields)])
+    event(EVENT_IRQ_ENTER, "irq_enter", ["uint32_t irq;", "uint32_t unused;"])
+    event(EVENT_IRQ_LEAVE, "irq_leave", ["uint32_t irq;", "uint32_t unused;"])
+    event(EVENT_SEM_WAIT, "sem_wait", ["xint32_t sem;", "int32_t count;"])
+    event(EVENT_SEM_POST, "sem_post", ["xint32_t sem;", "int32_t count;"])
+    event(EVENT_MQ_SEND, "mq_send", ["xint32_t mq;", "struct { %s } msg;" % " ".join(msg_fields)])
+    event(EVENT_MQ_RECEIVE, "mq_receive", ["xint32_t mq;", "struct { %s } msg;" % " ".join(msg_fields)])
+    event(EVENT_SYSCALL_ENTER, "syscall_enter", ["uint32_t nr;", "uint32_t unused;"])
+    event(EVENT_SYSCALL_LEAVE, "syscall_exit", ["int32_t ret;", "uint32_t unused;"])
+
+    if not os.path.isdir(path):
+        os.makedirs(path)
+    with open(os.path.join(path, "metadata"), "w") as f:
+        f.write("\n".join(lines))
+
+    # The events of the dump are already a CTF event stream
+
+    with open(os.path.join(path, "stream"), "wb") as f:
+        f.write(dump.rawevents)
+
+
+def main():
+    usage = "Usage: %prog -i <input> [-o <output.json>] [-c <ctf directory>]"
+    desc = "Convert a binary T-trace dump to Chrome / Perfetto JSON or CTF"
+    parser = optparse.OptionParser(usage=usage, description=desc)
+    parser.add_option("-i", "--input", dest="inputFile",
+                      help="raw dump or console log of 'ttrace -p'")
+    parser.add_option("-o", "--output", dest="outputFile",
+                      help="JSON trace to write, <input>.json by default")
+    parser.add_option("-c", "--ctf", dest="ctfDir",
+                      help="directory to write a CTF trace to")
+    options, args = parser.parse_args()
+
+    if options.inputFile is None:
+        parser.print_help()
+        return 1
+
+    try:
+        dump = TraceDump(read_input(options.inputFile))
+    except (IOError, ValueError) as e:
+        print("ERROR: %s" % e)
+        return 1
+
+    if dump.freq == 0:
+        print("warning: unknown timestamp frequency, timestamps are in counter ticks")
+    if dump.lost:
+        print("warning: %d events were overwritten" % dump.lost)
+
+    if options.ctfDir:
+        to_ctf(dump, options.ctfDir)
+        print("CTF trace saved at %s" % options.ctfDir)
+
+    if options.outputFile or not options.ctfDir:
+        output = options.outputFile or os.path.splitext(options.inputFile)[0] + ".json"
+        with open(output, "w") as f:
+            json.dump(to_json(dump), f)
+        print("JSON trace saved at %s" % output)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())